@@ -0,0 +1,210 @@
+/*
+ * benchmark for `Chain.h`.
+ *
+ * compares the chain `Wavetable -> ADSR -> Filter -> Waveshaper` implemented as
+ *
+ * - hand-written fused loop ( one loop, all `process(float)` calls inline )
+ * - hand-written block calls ( block `process` of each processor in turn )
+ * - `Chain<...>::process` ( fused )
+ * - `Chain<...>::process_blockwise`
+ * - virtual per-sample chain ( array of pointers to a base class with `virtual float process(float)` )
+ * - virtual block chain ( array of pointers to a base class with `virtual void process(float*, uint32_t)` )
+ *
+ * and prints ns/sample for several block sizes. all variants must produce the same output, the exit code is 1 if
+ * they do not.
+ *
+ *     $ ./klangwellen_bench_chain
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "ADSR.h"
+#include "Chain.h"
+#include "Filter.h"
+#include "Waveshaper.h"
+#include "Wavetable.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t WAVETABLE_SIZE = 2048;
+
+struct Voice {
+    Wavetable  wavetable{WAVETABLE_SIZE, KlangWellen::DEFAULT_SAMPLE_RATE};
+    ADSR       adsr;
+    Filter     filter;
+    Waveshaper waveshaper;
+
+    Voice() {
+        Wavetable::fill(wavetable.get_wavetable(), WAVETABLE_SIZE, KlangWellen::WAVEFORM_SAWTOOTH);
+        wavetable.set_frequency(110.0f);
+        adsr.set_sustain(1.0f);
+        adsr.start();
+        filter.set(Filter::LPF, 0.0f, 1200.0f, 1.0f);
+    }
+};
+
+/* virtual-dispatch chain */
+
+class VirtualProcessor {
+public:
+    virtual ~VirtualProcessor()                                = default;
+    virtual float process(float signal)                        = 0;
+    virtual void  process(float* buffer, uint32_t length)      = 0;
+};
+
+template<typename T, bool GENERATOR>
+class VirtualProcessorT final : public VirtualProcessor {
+public:
+    explicit VirtualProcessorT(T& processor) : fProcessor(processor) {}
+
+    float process(float signal) override {
+        if constexpr (GENERATOR) {
+            (void) signal;
+            return fProcessor.process();
+        } else {
+            return fProcessor.process(signal);
+        }
+    }
+
+    void process(float* buffer, const uint32_t length) override {
+        fProcessor.process(buffer, length);
+    }
+
+private:
+    T& fProcessor;
+};
+
+struct VirtualChain {
+    VirtualProcessorT<Wavetable, true>   wavetable;
+    VirtualProcessorT<ADSR, false>       adsr;
+    VirtualProcessorT<Filter, false>     filter;
+    VirtualProcessorT<Waveshaper, false> waveshaper;
+    VirtualProcessor*                    processors[4];
+
+    explicit VirtualChain(Voice& v) : wavetable(v.wavetable), adsr(v.adsr), filter(v.filter), waveshaper(v.waveshaper) {
+        processors[0] = &wavetable;
+        processors[1] = &adsr;
+        processors[2] = &filter;
+        processors[3] = &waveshaper;
+    }
+};
+
+/* variants */
+
+struct Variant {
+    const char* name;
+    void (*run)(Voice&, float*, uint32_t);
+};
+
+static const Variant VARIANTS[] = {
+    {"hand-written fused", [](Voice& v, float* buffer, const uint32_t length) {
+         for (uint32_t i = 0; i < length; i++) {
+             buffer[i] = v.waveshaper.process(v.filter.process(v.adsr.process(v.wavetable.process())));
+         }
+     }},
+    {"hand-written block", [](Voice& v, float* buffer, const uint32_t length) {
+         v.wavetable.process(buffer, length);
+         v.adsr.process(buffer, length);
+         v.filter.process(buffer, length);
+         v.waveshaper.process(buffer, length);
+     }},
+    {"Chain fused", [](Voice& v, float* buffer, const uint32_t length) {
+         Chain mChain(v.wavetable, v.adsr, v.filter, v.waveshaper);
+         mChain.process(buffer, length);
+     }},
+    {"Chain blockwise", [](Voice& v, float* buffer, const uint32_t length) {
+         Chain mChain(v.wavetable, v.adsr, v.filter, v.waveshaper);
+         mChain.process_blockwise(buffer, length);
+     }},
+    {"virtual per-sample", [](Voice& v, float* buffer, const uint32_t length) {
+         VirtualChain mChain(v);
+         for (uint32_t i = 0; i < length; i++) {
+             float mSample = 0.0f;
+             for (VirtualProcessor* p : mChain.processors) {
+                 mSample = p->process(mSample);
+             }
+             buffer[i] = mSample;
+         }
+     }},
+    {"virtual block", [](Voice& v, float* buffer, const uint32_t length) {
+         VirtualChain mChain(v);
+         for (VirtualProcessor* p : mChain.processors) {
+             p->process(buffer, length);
+         }
+     }},
+};
+
+static constexpr uint32_t NUM_VARIANTS = sizeof(VARIANTS) / sizeof(VARIANTS[0]);
+
+static bool verify(const uint32_t length) {
+    std::vector<float> mReference(length * 8);
+    {
+        Voice v;
+        for (uint32_t i = 0; i < 8; i++) {
+            VARIANTS[0].run(v, mReference.data() + i * length, length);
+        }
+    }
+    bool mSuccess = true;
+    for (uint32_t k = 1; k < NUM_VARIANTS; k++) {
+        Voice              v;
+        std::vector<float> mOutput(length * 8);
+        for (uint32_t i = 0; i < 8; i++) {
+            VARIANTS[k].run(v, mOutput.data() + i * length, length);
+        }
+        for (uint32_t i = 0; i < mOutput.size(); i++) {
+            if (std::fabs(mOutput[i] - mReference[i]) > 1e-5f) {
+                fprintf(stderr, "ERROR: '%s' differs from '%s' at sample %u\n", VARIANTS[k].name, VARIANTS[0].name, i);
+                mSuccess = false;
+                break;
+            }
+        }
+    }
+    return mSuccess;
+}
+
+static double measure(const Variant& variant, const uint32_t length) {
+    const uint64_t     mTargetSamples = 1 << 22;
+    const uint32_t     mIterations    = static_cast<uint32_t>(mTargetSamples / length);
+    std::vector<float> mBuffer(length);
+    double             mBest = 1e9;
+    for (uint8_t r = 0; r < 3; r++) {
+        Voice      v;
+        const auto mStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < mIterations; i++) {
+            variant.run(v, mBuffer.data(), length);
+        }
+        const auto   mEnd = std::chrono::steady_clock::now();
+        const double mNs  = std::chrono::duration<double, std::nano>(mEnd - mStart).count();
+        mBest             = std::min(mBest, mNs / (static_cast<double>(mIterations) * length));
+    }
+    return mBest;
+}
+
+int main() {
+    static const uint32_t SIZES[] = {16, 64, 256, 1024};
+
+    bool mSuccess = true;
+    for (const uint32_t mSize : SIZES) {
+        mSuccess &= verify(mSize);
+    }
+
+    printf("chain: Wavetable -> ADSR -> Filter -> Waveshaper ( ns/sample, lower is better )\n\n");
+    printf("%-20s", "variant");
+    for (const uint32_t mSize : SIZES) {
+        printf("%10u", mSize);
+    }
+    printf("\n");
+    for (const Variant& mVariant : VARIANTS) {
+        printf("%-20s", mVariant.name);
+        for (const uint32_t mSize : SIZES) {
+            printf("%10.2f", measure(mVariant, mSize));
+        }
+        printf("\n");
+    }
+    return mSuccess ? 0 : 1;
+}
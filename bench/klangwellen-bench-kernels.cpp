@@ -0,0 +1,125 @@
+/*
+ * micro-benchmark for the vectorized buffer kernels in `BufferKernels.h`.
+ *
+ * measures samples/ns for each kernel and each instruction set supported by the CPU at several buffer sizes. the
+ * result of every kernel is checked against the scalar kernel first.
+ *
+ *     $ ./klangwellen_bench_kernels
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "BufferKernels.h"
+
+using namespace klangwellen;
+
+static volatile float fSink = 0.0f;
+
+struct Kernel {
+    const char* name;
+    void (*run)(const BufferKernels::Table&, float*, const float*, uint32_t);
+};
+
+static const Kernel KERNELS[] = {
+    {"add", [](const BufferKernels::Table& t, float* a, const float* b, uint32_t n) { t.add(a, b, n); }},
+    {"sub", [](const BufferKernels::Table& t, float* a, const float* b, uint32_t n) { t.sub(a, b, n); }},
+    {"mult", [](const BufferKernels::Table& t, float* a, const float* b, uint32_t n) { t.mult(a, b, n); }},
+    {"div", [](const BufferKernels::Table& t, float* a, const float* b, uint32_t n) { t.div(a, b, n); }},
+    {"add_scalar", [](const BufferKernels::Table& t, float* a, const float*, uint32_t n) { t.add_scalar(a, 0.25f, n); }},
+    {"mult_scalar", [](const BufferKernels::Table& t, float* a, const float*, uint32_t n) { t.mult_scalar(a, -1.0f, n); }},
+    {"fill", [](const BufferKernels::Table& t, float* a, const float*, uint32_t n) { t.fill(a, 0.5f, n); }},
+    {"normalize", [](const BufferKernels::Table& t, float* a, const float*, uint32_t n) {
+         const float mPeak = t.abs_max(a, n);
+         if (mPeak > 0.0f) {
+             t.mult_scalar(a, 1.0f / mPeak, n);
+         }
+     }},
+    {"peak", [](const BufferKernels::Table& t, float* a, const float*, uint32_t n) {
+         float mMin, mMax;
+         t.min_max(a, n, mMin, mMax);
+         fSink = fSink + mMin + mMax;
+     }},
+};
+
+static void fill_test_signal(float* buffer, const uint32_t length, const float offset) {
+    for (uint32_t i = 0; i < length; i++) {
+        buffer[i] = std::sin(static_cast<float>(i) * 0.01f + offset) * 0.8f + 1.5f;
+    }
+}
+
+static bool verify(const Kernel& kernel, const BufferKernels::Table& table, const uint32_t length) {
+    const BufferKernels::Table* mScalar = BufferKernels::table(BufferKernels::ISA_SCALAR);
+    std::vector<float>          a(length), b(length), a_ref(length);
+    fill_test_signal(a.data(), length, 0.0f);
+    fill_test_signal(b.data(), length, 1.0f);
+    a_ref = a;
+    kernel.run(table, a.data(), b.data(), length);
+    kernel.run(*mScalar, a_ref.data(), b.data(), length);
+    for (uint32_t i = 0; i < length; i++) {
+        if (std::fabs(a[i] - a_ref[i]) > 1e-6f * std::fabs(a_ref[i]) + 1e-6f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double measure(const Kernel& kernel, const BufferKernels::Table& table, const uint32_t length) {
+    /* `b` is all ones so that repeated `mult` and `div` neither overflow nor decay into denormals */
+    std::vector<float> a(length), b(length, 1.0f);
+
+    const uint64_t mTargetSamples = 1 << 24;
+    const uint32_t mIterations    = static_cast<uint32_t>(mTargetSamples / length);
+    double         mBest          = 0.0;
+    for (uint8_t r = 0; r < 3; r++) {
+        fill_test_signal(a.data(), length, 0.0f);
+        const auto mStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < mIterations; i++) {
+            kernel.run(table, a.data(), b.data(), length);
+        }
+        const auto   mEnd     = std::chrono::steady_clock::now();
+        const double mNanos   = std::chrono::duration<double, std::nano>(mEnd - mStart).count();
+        const double mSamples = static_cast<double>(mIterations) * length;
+        if (mSamples / mNanos > mBest) {
+            mBest = mSamples / mNanos;
+        }
+        fSink = fSink + a[length / 2];
+    }
+    return mBest;
+}
+
+int main() {
+    static const uint32_t SIZES[] = {64, 256, 1024, 4096};
+
+    printf("detected ISA ... : %s\n", BufferKernels::table(BufferKernels::detect_isa())->name);
+    printf("%-12s %-8s", "kernel", "isa");
+    for (const uint32_t mSize: SIZES) {
+        printf(" %10u", mSize);
+    }
+    printf("   [samples/ns]\n");
+
+    int mFailures = 0;
+    for (const Kernel& mKernel: KERNELS) {
+        for (uint8_t mISA = 0; mISA < BufferKernels::NUM_ISA; mISA++) {
+            const BufferKernels::Table* mTable = BufferKernels::table(mISA);
+            if (mTable == nullptr) {
+                continue;
+            }
+            printf("%-12s %-8s", mKernel.name, mTable->name);
+            for (const uint32_t mSize: SIZES) {
+                if (!verify(mKernel, *mTable, mSize + 3)) {
+                    printf(" %10s", "MISMATCH");
+                    mFailures++;
+                    continue;
+                }
+                printf(" %10.2f", measure(mKernel, *mTable, mSize));
+            }
+            printf("\n");
+        }
+    }
+    return mFailures > 0 ? 1 : 0;
+}
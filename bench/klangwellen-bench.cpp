@@ -0,0 +1,884 @@
+/*
+ * benchmark suite for the processors in `src/`.
+ *
+ * measures ns/sample and samples/sec of every processor in per-sample form ( `float process()` or
+ * `float process(float)` ) and in block form ( `void process(float*, uint32_t)` or the stereo equivalent ) at several
+ * block sizes and sample rates. results are written as JSON. with `--compare` the results are checked against a
+ * baseline file written by an earlier run and regressions are reported. processors with a `get_memory_size()` method
+ * also report their memory use in bytes at each sample rate.
+ *
+ *     $ ./klangwellen_bench --output baseline.json
+ *     $ ./klangwellen_bench --compare baseline.json --threshold 0.1
+ *
+ * options:
+ *
+ *     --output <file>       write JSON to file instead of stdout
+ *     --compare <file>      compare with baseline, exit code is 1 if a result is slower than the baseline by more
+ *                           than the threshold
+ *     --threshold <ratio>   regression threshold, default 0.1 ( i.e 10% )
+ *     --filter <text>       only run processors whose name contains text
+ *     --quick               fewer samples per measurement ( less accurate )
+ *     --list                list processor names and exit
+ *
+ * the input signal is copied into the work buffer before each call so that processors always see the same signal
+ * ( this adds the cost of a `memcpy` to every measurement ).
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ADSR.h"
+#include "BeatDSP.h"
+#include "Chain.h"
+#include "Clamp.h"
+#include "ConvolutionReverb.h"
+#include "Delay.h"
+#include "Envelope.h"
+#include "EnvelopeFollower.h"
+#include "ExponentialMovingAverage.h"
+#include "FMSynthesis.h"
+#include "FMSynthesisMultiOperator.h"
+#include "Filter.h"
+#include "FilterLowPassMoogLadder.h"
+#include "FilterStateVariable.h"
+#include "FilterStateVariableBank.h"
+#include "FilterVowelFormant.h"
+#include "Gain.h"
+#include "Noise.h"
+#include "OscillatorBank.h"
+#include "OscillatorFunction.h"
+#include "ProcessingGraph.h"
+#include "Ramp.h"
+#include "Resonator.h"
+#include "Reverb.h"
+#include "ReverbFDN.h"
+#include "RootMeanSquare.h"
+#include "SAM.h"
+#include "SOSFilter.h"
+#include "Sampler.h"
+#include "Stream.h"
+#include "Trigger.h"
+#include "Vocoder.h"
+#include "VocoderSTFT.h"
+#include "Waveshaper.h"
+#include "Wavetable.h"
+
+using namespace klangwellen;
+
+static const uint32_t SAMPLE_RATES[] = {22050, 44100, 48000, 96000, 192000};
+static const uint32_t BLOCK_SIZES[]  = {32, 128, 512, 2048};
+
+/* ------------------------------------------------------------------------------------------------------------- */
+
+/*
+ * a `Runner` holds one processor instance. `run_sample` calls the per-sample `process` method for each sample of the
+ * buffer, `run_block` calls the block `process` method once.
+ */
+class Runner {
+public:
+    virtual ~Runner()                                          = default;
+    virtual bool has_sample() const                            = 0;
+    virtual bool has_block() const                             = 0;
+    virtual void run_sample(float* left, float* right, uint32_t length) = 0;
+    virtual void run_block(float* left, float* right, uint32_t length)  = 0;
+    /* memory used by the processor in bytes or 0 if unknown */
+    virtual size_t memory_size() const                         = 0;
+};
+
+template<typename T, typename = void>
+struct has_process_float : std::false_type {};
+template<typename T>
+struct has_process_float<T, decltype(void(std::declval<T&>().process(0.0f)))> : std::true_type {};
+
+template<typename T, typename = void>
+struct has_process_void : std::false_type {};
+template<typename T>
+struct has_process_void<T, decltype(void(std::declval<T&>().process()))> : std::true_type {};
+
+template<typename T, typename = void>
+struct has_process_block : std::false_type {};
+template<typename T>
+struct has_process_block<T, decltype(void(std::declval<T&>().process(static_cast<float*>(nullptr), 0u)))> : std::true_type {};
+
+template<typename T, typename = void>
+struct has_memory_size : std::false_type {};
+template<typename T>
+struct has_memory_size<T, decltype(void(std::declval<const T&>().get_memory_size()))> : std::true_type {};
+
+template<typename T>
+static size_t memory_size_of(const T& processor) {
+    if constexpr (has_memory_size<T>::value) {
+        return processor.get_memory_size();
+    } else {
+        return 0;
+    }
+}
+
+/*
+ * runner that detects the available `process` methods. processors with `float process(float)` are measured as
+ * effects, all others as generators.
+ */
+template<typename T>
+class RunnerT final : public Runner {
+public:
+    explicit RunnerT(T* processor) : fProcessor(processor) {}
+
+    bool has_sample() const override {
+        return has_process_float<T>::value || has_process_void<T>::value;
+    }
+
+    bool has_block() const override {
+        return has_process_block<T>::value;
+    }
+
+    void run_sample(float* left, float*, const uint32_t length) override {
+        T& p = *fProcessor;
+        if constexpr (has_process_float<T>::value) {
+            for (uint32_t i = 0; i < length; i++) {
+                left[i] = p.process(left[i]);
+            }
+        } else if constexpr (has_process_void<T>::value) {
+            for (uint32_t i = 0; i < length; i++) {
+                left[i] = p.process();
+            }
+        }
+    }
+
+    void run_block(float* left, float*, const uint32_t length) override {
+        if constexpr (has_process_block<T>::value) {
+            fProcessor->process(left, length);
+        }
+    }
+
+    size_t memory_size() const override {
+        return memory_size_of(*fProcessor);
+    }
+
+private:
+    std::unique_ptr<T> fProcessor;
+};
+
+/* runner with explicit functions for processors with an unusual interface */
+template<typename T>
+class RunnerCustom final : public Runner {
+public:
+    using Function = void (*)(T&, float*, float*, uint32_t);
+
+    RunnerCustom(T* processor, Function sample, Function block) : fProcessor(processor), fSample(sample), fBlock(block) {}
+
+    bool has_sample() const override {
+        return fSample != nullptr;
+    }
+
+    bool has_block() const override {
+        return fBlock != nullptr;
+    }
+
+    void run_sample(float* left, float* right, const uint32_t length) override {
+        fSample(*fProcessor, left, right, length);
+    }
+
+    void run_block(float* left, float* right, const uint32_t length) override {
+        fBlock(*fProcessor, left, right, length);
+    }
+
+    size_t memory_size() const override {
+        return memory_size_of(*fProcessor);
+    }
+
+private:
+    std::unique_ptr<T> fProcessor;
+    Function           fSample;
+    Function           fBlock;
+};
+
+struct Case {
+    std::string                                            name;
+    std::function<std::unique_ptr<Runner>(uint32_t, uint32_t)> create; // sample rate, block size
+};
+
+template<typename T, typename CREATE>
+static Case make_case(const char* name, CREATE create) {
+    return {name, [create](const uint32_t sample_rate, const uint32_t block_size) -> std::unique_ptr<Runner> {
+                return std::unique_ptr<Runner>(new RunnerT<T>(create(sample_rate, block_size)));
+            }};
+}
+
+template<typename T, typename CREATE>
+static Case make_case_custom(const char*                        name,
+                             CREATE                             create,
+                             typename RunnerCustom<T>::Function sample,
+                             typename RunnerCustom<T>::Function block) {
+    return {name, [create, sample, block](const uint32_t sample_rate, const uint32_t block_size) -> std::unique_ptr<Runner> {
+                return std::unique_ptr<Runner>(new RunnerCustom<T>(create(sample_rate, block_size), sample, block));
+            }};
+}
+
+/* ------------------------------------------------------------------------------------------------------------- */
+
+static constexpr uint32_t WAVETABLE_SIZE = 2048;
+
+static Wavetable* create_wavetable(const uint32_t sample_rate) {
+    Wavetable* mWavetable = new Wavetable(WAVETABLE_SIZE, sample_rate);
+    Wavetable::fill(mWavetable->get_wavetable(), WAVETABLE_SIZE, KlangWellen::WAVEFORM_SAWTOOTH);
+    mWavetable->set_frequency(220.0f);
+    return mWavetable;
+}
+
+/* exponential sweep between 500 Hz and 4000 Hz, used to modulate filters at audio rate */
+static float sweep_frequency(const float frequency) {
+    const float mNext = frequency * 1.0001f;
+    return mNext > 4000.0f ? 500.0f : mNext;
+}
+
+/* impulse response of noise decaying by 60 dB over `seconds`, partitioned by the block size */
+static ConvolutionReverb* create_convolution_reverb(const uint32_t sample_rate, const uint32_t block_size, const float seconds, const bool background_thread) {
+    ConvolutionReverb* mReverb = new ConvolutionReverb(sample_rate, block_size, background_thread);
+    std::vector<float> mImpulseResponse(static_cast<size_t>(seconds * static_cast<float>(sample_rate)));
+    const float        mDecay = std::pow(0.001f, 1.0f / static_cast<float>(mImpulseResponse.size()));
+    float              mGain  = 0.1f;
+    for (float& mSample : mImpulseResponse) {
+        mSample = KlangWellen::random() * mGain;
+        mGain *= mDecay;
+    }
+    mReverb->load(mImpulseResponse.data(), static_cast<uint32_t>(mImpulseResponse.size()));
+    return mReverb;
+}
+
+class SineStreamDataProvider final : public StreamDataProvider {
+public:
+    void fill_buffer(float* buffer, const uint32_t length) override {
+        for (uint32_t i = 0; i < length; i++) {
+            buffer[i] = std::sin(fPhase);
+            fPhase += 0.05f;
+        }
+    }
+
+private:
+    float fPhase = 0.0f;
+};
+
+/* composite cases own their processors */
+struct ChainCase {
+    Wavetable  wavetable;
+    Filter     filter;
+    Waveshaper waveshaper;
+    Chain<Wavetable, Filter, Waveshaper> chain;
+
+    explicit ChainCase(const uint32_t sample_rate) : wavetable(WAVETABLE_SIZE, sample_rate),
+                                                     filter(Filter::LPF, 0.0f, 1200.0f, 1.0f, true, sample_rate),
+                                                     chain(wavetable, filter, waveshaper) {
+        Wavetable::fill(wavetable.get_wavetable(), WAVETABLE_SIZE, KlangWellen::WAVEFORM_SAWTOOTH);
+        wavetable.set_frequency(220.0f);
+    }
+
+    float process() {
+        return chain.process();
+    }
+
+    void process(float* buffer, const uint32_t length) {
+        chain.process(buffer, length);
+    }
+};
+
+struct GraphCase {
+    Wavetable       wavetable;
+    Filter          filter;
+    Waveshaper      waveshaper;
+    ProcessingGraph graph;
+
+    GraphCase(const uint32_t sample_rate, const uint32_t block_size) : wavetable(WAVETABLE_SIZE, sample_rate),
+                                                                       filter(Filter::LPF, 0.0f, 1200.0f, 1.0f, true, sample_rate),
+                                                                       graph(1, block_size) {
+        Wavetable::fill(wavetable.get_wavetable(), WAVETABLE_SIZE, KlangWellen::WAVEFORM_SAWTOOTH);
+        wavetable.set_frequency(220.0f);
+        graph.chain({graph.add(wavetable), graph.add(filter), graph.add(waveshaper)});
+        graph.set_output(2);
+        graph.compile();
+    }
+
+    void process(float* buffer, const uint32_t length) {
+        graph.process(buffer, length);
+    }
+};
+
+/* 16 voices with audio-rate cutoff buffers. the measured buffer is the input of all voices and the output of voice 0 */
+struct FilterStateVariableBankCase {
+    static constexpr uint32_t NUM_VOICES = 16;
+
+    const uint32_t          block_size;
+    FilterStateVariableBank bank;
+    std::vector<float>      voices;
+    std::vector<float>      frequencies;
+
+    FilterStateVariableBankCase(const uint32_t sample_rate, const uint32_t block_size) : block_size(block_size),
+                                                                                         bank(NUM_VOICES, static_cast<float>(sample_rate)),
+                                                                                         voices(static_cast<size_t>(NUM_VOICES) * block_size),
+                                                                                         frequencies(static_cast<size_t>(NUM_VOICES) * block_size) {
+        bank.set_resonance(0.7f);
+        for (uint32_t v = 0; v < NUM_VOICES; v++) {
+            float mFrequency = 500.0f + 200.0f * static_cast<float>(v);
+            for (uint32_t i = 0; i < block_size; i++) {
+                mFrequency                      = sweep_frequency(mFrequency);
+                frequencies[v * block_size + i] = mFrequency;
+            }
+        }
+    }
+
+    void process(float* buffer, const uint32_t length) {
+        float*       mBuffers[NUM_VOICES];
+        const float* mFrequencies[NUM_VOICES];
+        for (uint32_t v = 0; v < NUM_VOICES; v++) {
+            mBuffers[v]     = v == 0 ? buffer : voices.data() + v * block_size;
+            mFrequencies[v] = frequencies.data() + v * block_size;
+            if (v > 0) {
+                std::copy_n(buffer, length, mBuffers[v]);
+            }
+        }
+        bank.process(mBuffers, NUM_VOICES, length, mFrequencies);
+    }
+};
+
+/*
+ * one modulator driving 8 carriers. with `shared` the modulator is analyzed once per block, otherwise each carrier
+ * runs a complete vocoder. the measured buffer is the modulator, the carriers and outputs are internal.
+ */
+struct VocoderCarriersCase {
+    static constexpr uint32_t NUM_CARRIERS = 8;
+
+    const bool                            shared;
+    const uint32_t                        block_size;
+    Vocoder                               analysis;
+    std::vector<std::unique_ptr<Vocoder>> carriers;
+    std::vector<float>                    envelopes;
+    std::vector<float>                    signals;
+
+    VocoderCarriersCase(const uint32_t sample_rate, const uint32_t block_size, const bool shared) : shared(shared),
+                                                                                                   block_size(block_size),
+                                                                                                   analysis(24, 4, sample_rate),
+                                                                                                   envelopes(analysis.get_envelope_buffer_size(block_size)),
+                                                                                                   signals(static_cast<size_t>(NUM_CARRIERS) * 2 * block_size) {
+        for (uint32_t c = 0; c < NUM_CARRIERS; c++) {
+            carriers.emplace_back(new Vocoder(24, 4, sample_rate));
+            float* mCarrier = signals.data() + c * 2 * block_size;
+            for (uint32_t i = 0; i < block_size; i++) {
+                mCarrier[i] = std::fmod(static_cast<float>(i) * 0.01f * static_cast<float>(c + 1), 2.0f) - 1.0f;
+            }
+        }
+    }
+
+    void process(float* buffer, const uint32_t length) {
+        if (shared) {
+            analysis.analyze(buffer, envelopes.data(), length);
+        }
+        for (uint32_t c = 0; c < NUM_CARRIERS; c++) {
+            float* mCarrier = signals.data() + c * 2 * block_size;
+            float* mOutput  = signals.data() + c * 2 * block_size + block_size;
+            if (shared) {
+                carriers[c]->synthesize(envelopes.data(), mCarrier, mOutput, length);
+            } else {
+                carriers[c]->process(mCarrier, buffer, mOutput, length);
+            }
+        }
+    }
+};
+
+static Case make_reverb_fdn_case(const char* name, const uint8_t num_lines, const uint8_t matrix) {
+    return make_case_custom<ReverbFDN>(
+        name,
+        [num_lines, matrix](uint32_t sr, uint32_t) { return new ReverbFDN(num_lines, sr, matrix); },
+        [](ReverbFDN& p, float* left, float*, uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) {
+                left[i] = p.process(left[i]);
+            }
+        },
+        [](ReverbFDN& p, float* left, float* right, uint32_t length) { p.process(left, right, length); });
+}
+
+static std::vector<Case> create_cases() {
+    std::vector<Case> c;
+    c.push_back(make_case<ADSR>("ADSR", [](uint32_t sr, uint32_t) {
+        ADSR* p = new ADSR(sr);
+        p->set_sustain(1.0f);
+        p->start();
+        return p;
+    }));
+    c.push_back(make_case<BeatDSP>("BeatDSP", [](uint32_t sr, uint32_t) { return new BeatDSP(sr); }));
+    c.push_back(make_case<Clamp>("Clamp", [](uint32_t, uint32_t) { return new Clamp(); }));
+    c.push_back(make_case<ConvolutionReverb>("ConvolutionReverb(1 s IR)", [](uint32_t sr, uint32_t bs) { return create_convolution_reverb(sr, bs, 1.0f, true); }));
+    c.push_back(make_case<ConvolutionReverb>("ConvolutionReverb(10 s IR)", [](uint32_t sr, uint32_t bs) { return create_convolution_reverb(sr, bs, 10.0f, true); }));
+    c.push_back(make_case<ConvolutionReverb>("ConvolutionReverb(10 s IR, no thread)", [](uint32_t sr, uint32_t bs) { return create_convolution_reverb(sr, bs, 10.0f, false); }));
+    c.push_back(make_case<Delay>("Delay", [](uint32_t sr, uint32_t) { return new Delay(0.5f, 0.75f, 0.8f, sr); }));
+    c.push_back(make_case<Envelope>("Envelope", [](uint32_t sr, uint32_t) {
+        Envelope* p = new Envelope(sr);
+        p->add_stage(0.0f, 0.5f);
+        p->add_stage(1.0f, 1000.0f);
+        p->add_stage(0.0f);
+        p->start();
+        return p;
+    }));
+    c.push_back(make_case<EnvelopeFollower>("EnvelopeFollower", [](uint32_t sr, uint32_t) { return new EnvelopeFollower(0.01f, 0.1f, sr); }));
+    c.push_back(make_case<ExponentialMovingAverage>("ExponentialMovingAverage", [](uint32_t, uint32_t) { return new ExponentialMovingAverage(0.1f); }));
+    c.push_back(make_case<FMSynthesis>("FMSynthesis", [](uint32_t sr, uint32_t) { return new FMSynthesis(WAVETABLE_SIZE, sr); }));
+    c.push_back(make_case<FMSynthesisMultiOperator>("FMSynthesisMultiOperator(64x6)", [](uint32_t sr, uint32_t) {
+        FMSynthesisMultiOperator* p = new FMSynthesisMultiOperator(64, 6, sr);
+        p->set_algorithm(FMSynthesisMultiOperator::ALGORITHM_PAIRS);
+        p->set_feedback(5, 1.0f);
+        for (uint32_t i = 0; i < p->get_num_voices(); i++) {
+            p->note_on(i, 55.0f * static_cast<float>(i % 12 + 1));
+        }
+        return p;
+    }));
+    c.push_back(make_case<Filter>("Filter", [](uint32_t sr, uint32_t) { return new Filter(Filter::LPF, 0.0f, 1200.0f, 1.0f, true, sr); }));
+    c.push_back(make_case_custom<Filter>(
+        "Filter(modulated)",
+        [](uint32_t sr, uint32_t) { return new Filter(Filter::LPF, 0.0f, 500.0f, 1.0f, true, static_cast<float>(sr)); },
+        [](Filter& p, float* left, float*, uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) {
+                p.set_frequency(sweep_frequency(p.get_frequency()));
+                left[i] = p.process(left[i]);
+            }
+        },
+        nullptr));
+    c.push_back(make_case_custom<Filter>(
+        "Filter(modulated, interpolated)",
+        [](uint32_t sr, uint32_t) {
+            Filter* p = new Filter(Filter::LPF, 0.0f, 500.0f, 1.0f, true, static_cast<float>(sr));
+            p->set_coefficient_interpolation(32);
+            return p;
+        },
+        [](Filter& p, float* left, float*, uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) {
+                p.set_frequency(sweep_frequency(p.get_frequency()));
+                left[i] = p.process(left[i]);
+            }
+        },
+        nullptr));
+    c.push_back(make_case<FilterLowPassMoogLadder>("FilterLowPassMoogLadder", [](uint32_t sr, uint32_t) { return new FilterLowPassMoogLadder(sr); }));
+    c.push_back(make_case<FilterStateVariable>("FilterStateVariable", [](uint32_t sr, uint32_t) { return new FilterStateVariable(static_cast<float>(sr)); }));
+    c.push_back(make_case_custom<FilterStateVariable>(
+        "FilterStateVariable(modulated)",
+        [](uint32_t sr, uint32_t) { return new FilterStateVariable(static_cast<float>(sr)); },
+        [](FilterStateVariable& p, float* left, float*, uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) {
+                p.set_frequency(sweep_frequency(p.get_frequency()));
+                left[i] = p.process(left[i]);
+            }
+        },
+        nullptr));
+    c.push_back(make_case<FilterStateVariableBankCase>("FilterStateVariableBank(16 voices, modulated)", [](uint32_t sr, uint32_t bs) { return new FilterStateVariableBankCase(sr, bs); }));
+    c.push_back(make_case<FilterVowelFormant>("FilterVowelFormant", [](uint32_t, uint32_t) { return new FilterVowelFormant(); }));
+    c.push_back(make_case<Gain>("Gain", [](uint32_t, uint32_t) { return new Gain(); }));
+    c.push_back(make_case<Noise>("Noise", [](uint32_t, uint32_t) { return new Noise(); }));
+    c.push_back(make_case<PinkNoise>("PinkNoise", [](uint32_t, uint32_t) { return new PinkNoise(); }));
+    c.push_back(make_case<SimplexNoise>("SimplexNoise", [](uint32_t, uint32_t) { return new SimplexNoise(); }));
+    c.push_back(make_case<GaussianWhiteNoise>("GaussianWhiteNoise", [](uint32_t, uint32_t) { return new GaussianWhiteNoise(); }));
+    c.push_back(make_case<WhiteNoise>("WhiteNoise", [](uint32_t, uint32_t) { return new WhiteNoise(); }));
+    c.push_back(make_case<WhiteNoiseFast>("WhiteNoiseFast", [](uint32_t, uint32_t) { return new WhiteNoiseFast(); }));
+    c.push_back(make_case<OscillatorBank>("OscillatorBank(64)", [](uint32_t sr, uint32_t) {
+        OscillatorBank* p = new OscillatorBank(64, 1, WAVETABLE_SIZE, sr);
+        for (uint32_t i = 0; i < p->get_num_oscillators(); i++) {
+            p->set_frequency(i, 55.0f * static_cast<float>(i + 1));
+            p->set_amplitude(i, 1.0f / static_cast<float>(i + 1));
+        }
+        return p;
+    }));
+    c.push_back(make_case<OscillatorFunction>("OscillatorFunction", [](uint32_t sr, uint32_t) {
+        OscillatorFunction* p = new OscillatorFunction(sr);
+        p->set_waveform(KlangWellen::WAVEFORM_SAWTOOTH);
+        p->set_frequency(220.0f);
+        return p;
+    }));
+    c.push_back(make_case<OscillatorFunction>("OscillatorFunction(band-limited)", [](uint32_t sr, uint32_t) {
+        OscillatorFunction* p = new OscillatorFunction(sr);
+        p->set_waveform(KlangWellen::WAVEFORM_SAWTOOTH);
+        p->set_frequency(220.0f);
+        p->set_band_limited(true);
+        return p;
+    }));
+    c.push_back(make_case<Ramp>("Ramp", [](uint32_t sr, uint32_t) {
+        Ramp* p = new Ramp(sr);
+        p->set_duration(1000.0f);
+        p->start();
+        return p;
+    }));
+    c.push_back(make_case<Resonator>("Resonator", [](uint32_t sr, uint32_t) { return new Resonator(440.0f, sr, 1.0f); }));
+    c.push_back(make_case_custom<Reverb>(
+        "Reverb",
+        [](uint32_t sr, uint32_t) { return new Reverb(sr); },
+        [](Reverb& p, float* left, float*, uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) {
+                left[i] = p.process(left[i]);
+            }
+        },
+        [](Reverb& p, float* left, float* right, uint32_t length) { p.process(left, right, length); }));
+    c.push_back(make_case_custom<Reverb>(
+        "Reverb(silent input)",
+        [](uint32_t sr, uint32_t) {
+            /* starts asleep, i.e measures a reverb whose tail has decayed */
+            Reverb* p = new Reverb(sr);
+            float   mLeft[64]{};
+            float   mRight[64]{};
+            while (!p->is_sleeping()) {
+                p->process(mLeft, mRight, 64);
+            }
+            return p;
+        },
+        nullptr,
+        [](Reverb& p, float* left, float* right, uint32_t length) {
+            std::fill_n(left, length, 0.0f);
+            std::fill_n(right, length, 0.0f);
+            p.process(left, right, length);
+        }));
+    c.push_back(make_reverb_fdn_case("ReverbFDN(8 lines)", 8, ReverbFDN::HADAMARD));
+    c.push_back(make_reverb_fdn_case("ReverbFDN(16 lines)", 16, ReverbFDN::HADAMARD));
+    c.push_back(make_reverb_fdn_case("ReverbFDN(16 lines, Householder)", 16, ReverbFDN::HOUSEHOLDER));
+    c.push_back(make_reverb_fdn_case("ReverbFDN(32 lines)", 32, ReverbFDN::HADAMARD));
+    c.push_back(make_case<RootMeanSquare>("RootMeanSquare", [](uint32_t, uint32_t) { return new RootMeanSquare(16); }));
+    c.push_back(make_case_custom<SAM>(
+        "SAM",
+        [](uint32_t, uint32_t) {
+            SAM* p = new SAM();
+            p->speak("hello world");
+            return p;
+        },
+        nullptr,
+        [](SAM& p, float* left, float*, uint32_t length) { p.process(left, length); }));
+    c.push_back(make_case<SOSFilter>("SOSFilter(4 sections)", [](uint32_t sr, uint32_t) {
+        SOSFilter* p = new SOSFilter(4, 1, static_cast<float>(sr));
+        for (uint32_t k = 0; k < p->get_num_sections(); k++) {
+            p->set_section(k, Filter::PEQ, 3.0f, 250.0f * static_cast<float>(1 << k), 1.0f);
+        }
+        return p;
+    }));
+    c.push_back(make_case<Sampler>("Sampler", [](uint32_t sr, uint32_t) {
+        Sampler* p = new Sampler(static_cast<int32_t>(sr), sr);
+        for (int32_t i = 0; i < p->get_buffer_length(); i++) {
+            p->get_buffer()[i] = std::sin(static_cast<float>(i) * 0.05f);
+        }
+        p->set_loop_all();
+        p->play();
+        return p;
+    }));
+    c.push_back(make_case<Stream>("Stream", [](uint32_t sr, uint32_t) {
+        static SineStreamDataProvider mProvider;
+        return new Stream(&mProvider, 8192, 4, 1, sr);
+    }));
+    c.push_back(make_case<Trigger>("Trigger", [](uint32_t, uint32_t) { return new Trigger(); }));
+    c.push_back(make_case_custom<Vocoder>(
+        "Vocoder",
+        [](uint32_t sr, uint32_t) { return new Vocoder(24, 4, sr); },
+        [](Vocoder& p, float* left, float* right, uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) {
+                left[i] = p.process(right[i], left[i]);
+            }
+        },
+        [](Vocoder& p, float* left, float* right, uint32_t length) { p.process(right, left, left, length); }));
+    c.push_back(make_case_custom<Vocoder>(
+        "Vocoder(64 bands)",
+        [](uint32_t sr, uint32_t) { return new Vocoder(64, 4, sr); },
+        nullptr,
+        [](Vocoder& p, float* left, float* right, uint32_t length) { p.process(right, left, left, length); }));
+    c.push_back(make_case<VocoderCarriersCase>("Vocoder(8 carriers)", [](uint32_t sr, uint32_t bs) { return new VocoderCarriersCase(sr, bs, false); }));
+    c.push_back(make_case<VocoderCarriersCase>("Vocoder(8 carriers, shared analysis)", [](uint32_t sr, uint32_t bs) { return new VocoderCarriersCase(sr, bs, true); }));
+    c.push_back(make_case_custom<VocoderSTFT>(
+        "VocoderSTFT",
+        [](uint32_t sr, uint32_t) { return new VocoderSTFT(24, 1024, sr); },
+        nullptr,
+        [](VocoderSTFT& p, float* left, float* right, uint32_t length) { p.process(right, left, left, length); }));
+    c.push_back(make_case_custom<VocoderSTFT>(
+        "VocoderSTFT(128 bands)",
+        [](uint32_t sr, uint32_t) { return new VocoderSTFT(128, 1024, sr); },
+        nullptr,
+        [](VocoderSTFT& p, float* left, float* right, uint32_t length) { p.process(right, left, left, length); }));
+    c.push_back(make_case<Waveshaper>("Waveshaper", [](uint32_t, uint32_t) { return new Waveshaper(); }));
+    c.push_back(make_case<Wavetable>("Wavetable", [](uint32_t sr, uint32_t) { return create_wavetable(sr); }));
+    c.push_back(make_case<Wavetable>("Wavetable(phase accumulator)", [](uint32_t sr, uint32_t) {
+        Wavetable* p = create_wavetable(sr);
+        p->set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
+        p->set_phase_accumulator(true);
+        return p;
+    }));
+    c.push_back(make_case_custom<Wavetable>(
+        "Wavetable(audio-rate FM)",
+        [](uint32_t sr, uint32_t) {
+            Wavetable* p = create_wavetable(sr);
+            p->set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
+            p->set_phase_accumulator(true);
+            return p;
+        },
+        nullptr,
+        [](Wavetable& p, float* left, float*, uint32_t length) {
+            static std::vector<float> mFrequency;
+            if (mFrequency.size() < length) {
+                mFrequency.resize(length);
+                for (uint32_t i = 0; i < length; i++) {
+                    mFrequency[i] = 220.0f + 110.0f * std::sin(static_cast<float>(i) * 0.01f);
+                }
+            }
+            p.process(left, mFrequency.data(), length);
+        }));
+    c.push_back(make_case_custom<Wavetable>(
+        "Wavetable(audio-rate PM)",
+        [](uint32_t sr, uint32_t) {
+            Wavetable* p = create_wavetable(sr);
+            p->set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
+            return p;
+        },
+        nullptr,
+        [](Wavetable& p, float* left, float*, uint32_t length) {
+            static std::vector<float> mPhaseOffset;
+            if (mPhaseOffset.size() < length) {
+                mPhaseOffset.resize(length);
+                for (uint32_t i = 0; i < length; i++) {
+                    mPhaseOffset[i] = 0.25f * std::sin(static_cast<float>(i) * 0.01f);
+                }
+            }
+            p.process(left, nullptr, mPhaseOffset.data(), nullptr, length);
+        }));
+    c.push_back(make_case<Wavetable>("Wavetable(mipmap)", [](uint32_t sr, uint32_t) {
+        static WavetableMipmap mMipmap(KlangWellen::WAVEFORM_SAWTOOTH, WAVETABLE_SIZE);
+        Wavetable*             p = create_wavetable(sr);
+        p->set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
+        p->set_mipmap(&mMipmap);
+        p->set_frequency(1760.0f);
+        return p;
+    }));
+    c.push_back(make_case<ChainCase>("Chain(Wavetable,Filter,Waveshaper)", [](uint32_t sr, uint32_t) { return new ChainCase(sr); }));
+    c.push_back(make_case<GraphCase>("ProcessingGraph(Wavetable,Filter,Waveshaper)", [](uint32_t sr, uint32_t bs) { return new GraphCase(sr, bs); }));
+    return c;
+}
+
+/* ------------------------------------------------------------------------------------------------------------- */
+
+struct Result {
+    std::string name;
+    std::string mode;
+    uint32_t    sample_rate;
+    uint32_t    block_size;
+    double      ns_per_sample;
+    size_t      memory_bytes;
+};
+
+static std::string key(const Result& r) {
+    return r.name + "|" + r.mode + "|" + std::to_string(r.sample_rate) + "|" + std::to_string(r.block_size);
+}
+
+static double measure(const Case& c, const bool per_sample, const uint32_t sample_rate, const uint32_t block_size, const uint64_t target_samples) {
+    std::vector<float> mInputLeft(block_size), mInputRight(block_size), mLeft(block_size), mRight(block_size);
+    for (uint32_t i = 0; i < block_size; i++) {
+        mInputLeft[i]  = 0.5f * std::sin(static_cast<float>(i) * 0.031f) + 0.01f * std::sin(static_cast<float>(i) * 1.7f);
+        mInputRight[i] = 0.5f * std::sin(static_cast<float>(i) * 0.017f);
+    }
+    const uint32_t mIterations = static_cast<uint32_t>(std::max<uint64_t>(1, target_samples / block_size));
+    double         mBest       = 1e12;
+    for (uint8_t r = 0; r < 3; r++) {
+        std::unique_ptr<Runner> mRunner = c.create(sample_rate, block_size);
+        const auto              mStart  = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < mIterations; i++) {
+            std::copy(mInputLeft.begin(), mInputLeft.end(), mLeft.begin());
+            std::copy(mInputRight.begin(), mInputRight.end(), mRight.begin());
+            if (per_sample) {
+                mRunner->run_sample(mLeft.data(), mRight.data(), block_size);
+            } else {
+                mRunner->run_block(mLeft.data(), mRight.data(), block_size);
+            }
+        }
+        const auto   mEnd = std::chrono::steady_clock::now();
+        const double mNs  = std::chrono::duration<double, std::nano>(mEnd - mStart).count();
+        mBest             = std::min(mBest, mNs / (static_cast<double>(mIterations) * block_size));
+    }
+    return mBest;
+}
+
+static void write_json(FILE* out, const std::vector<Result>& results) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"version\": 1,\n");
+    fprintf(out, "  \"unit\": \"ns_per_sample\",\n");
+    fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        char          mMemory[48] = "";
+        if (r.memory_bytes > 0) {
+            snprintf(mMemory, sizeof(mMemory), ", \"memory_bytes\": %zu", r.memory_bytes);
+        }
+        fprintf(out,
+                "    {\"name\": \"%s\", \"mode\": \"%s\", \"sample_rate\": %u, \"block_size\": %u, "
+                "\"ns_per_sample\": %.4f, \"samples_per_second\": %.0f%s}%s\n",
+                r.name.c_str(),
+                r.mode.c_str(),
+                r.sample_rate,
+                r.block_size,
+                r.ns_per_sample,
+                1e9 / r.ns_per_sample,
+                mMemory,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+/* minimal reader for the JSON written by `write_json`, expects one result object per line */
+static bool find_value(const std::string& line, const char* name, std::string& value) {
+    const std::string mKey = std::string("\"") + name + "\":";
+    size_t            mPos = line.find(mKey);
+    if (mPos == std::string::npos) {
+        return false;
+    }
+    mPos += mKey.size();
+    while (mPos < line.size() && line[mPos] == ' ') {
+        mPos++;
+    }
+    if (mPos < line.size() && line[mPos] == '"') {
+        const size_t mEnd = line.find('"', mPos + 1);
+        value             = line.substr(mPos + 1, mEnd - mPos - 1);
+    } else {
+        const size_t mEnd = line.find_first_of(",}", mPos);
+        value             = line.substr(mPos, mEnd - mPos);
+    }
+    return true;
+}
+
+static bool read_json(const char* path, std::vector<Result>& results) {
+    std::ifstream mFile(path);
+    if (!mFile) {
+        return false;
+    }
+    std::string mLine;
+    while (std::getline(mFile, mLine)) {
+        std::string mName, mMode, mSampleRate, mBlockSize, mNs;
+        if (find_value(mLine, "name", mName) &&
+            find_value(mLine, "mode", mMode) &&
+            find_value(mLine, "sample_rate", mSampleRate) &&
+            find_value(mLine, "block_size", mBlockSize) &&
+            find_value(mLine, "ns_per_sample", mNs)) {
+            results.push_back({mName,
+                               mMode,
+                               static_cast<uint32_t>(std::stoul(mSampleRate)),
+                               static_cast<uint32_t>(std::stoul(mBlockSize)),
+                               std::stod(mNs),
+                               0});
+        }
+    }
+    return true;
+}
+
+static int compare(const std::vector<Result>& baseline, const std::vector<Result>& results, const double threshold) {
+    uint32_t mRegressions  = 0;
+    uint32_t mImprovements = 0;
+    uint32_t mCompared     = 0;
+    for (const Result& r : results) {
+        const auto it = std::find_if(baseline.begin(), baseline.end(), [&](const Result& b) { return key(b) == key(r); });
+        if (it == baseline.end() || it->ns_per_sample <= 0.0) {
+            continue;
+        }
+        mCompared++;
+        const double mRatio = r.ns_per_sample / it->ns_per_sample;
+        if (mRatio > 1.0 + threshold) {
+            mRegressions++;
+            fprintf(stderr,
+                    "REGRESSION  %-46s %-6s %6u Hz %5u : %9.3f -> %9.3f ns/sample ( +%.1f%% )\n",
+                    r.name.c_str(), r.mode.c_str(), r.sample_rate, r.block_size, it->ns_per_sample, r.ns_per_sample, (mRatio - 1.0) * 100.0);
+        } else if (mRatio < 1.0 - threshold) {
+            mImprovements++;
+            fprintf(stderr,
+                    "IMPROVEMENT %-46s %-6s %6u Hz %5u : %9.3f -> %9.3f ns/sample ( -%.1f%% )\n",
+                    r.name.c_str(), r.mode.c_str(), r.sample_rate, r.block_size, it->ns_per_sample, r.ns_per_sample, (1.0 - mRatio) * 100.0);
+        }
+    }
+    fprintf(stderr,
+            "compared %u results with baseline: %u regressions, %u improvements ( threshold %.1f%% )\n",
+            mCompared, mRegressions, mImprovements, threshold * 100.0);
+    return mRegressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* mOutputPath   = nullptr;
+    const char* mBaselinePath = nullptr;
+    const char* mFilter       = nullptr;
+    double      mThreshold    = 0.1;
+    uint64_t    mTarget       = 1 << 18;
+    bool        mList         = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            mOutputPath = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            mBaselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            mThreshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            mFilter = argv[++i];
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            mTarget = 1 << 14;
+        } else if (strcmp(argv[i], "--list") == 0) {
+            mList = true;
+        } else {
+            fprintf(stderr, "usage: %s [--output <file>] [--compare <file>] [--threshold <ratio>] [--filter <text>] [--quick] [--list]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const std::vector<Case> mCases = create_cases();
+    if (mList) {
+        for (const Case& c : mCases) {
+            printf("%s\n", c.name.c_str());
+        }
+        return 0;
+    }
+
+    std::vector<Result> mBaseline;
+    if (mBaselinePath != nullptr && !read_json(mBaselinePath, mBaseline)) {
+        fprintf(stderr, "ERROR: could not read baseline '%s'\n", mBaselinePath);
+        return 2;
+    }
+
+    std::vector<Result> mResults;
+    for (const Case& c : mCases) {
+        if (mFilter != nullptr && c.name.find(mFilter) == std::string::npos) {
+            continue;
+        }
+        fprintf(stderr, "%s\n", c.name.c_str());
+        const std::unique_ptr<Runner> mProbe = c.create(KlangWellen::DEFAULT_SAMPLE_RATE, BLOCK_SIZES[0]);
+        for (const uint32_t mSampleRate : SAMPLE_RATES) {
+            const size_t mMemory = c.create(mSampleRate, BLOCK_SIZES[0])->memory_size();
+            for (const uint32_t mBlockSize : BLOCK_SIZES) {
+                if (mProbe->has_sample()) {
+                    mResults.push_back({c.name, "sample", mSampleRate, mBlockSize, measure(c, true, mSampleRate, mBlockSize, mTarget), mMemory});
+                }
+                if (mProbe->has_block()) {
+                    mResults.push_back({c.name, "block", mSampleRate, mBlockSize, measure(c, false, mSampleRate, mBlockSize, mTarget), mMemory});
+                }
+            }
+        }
+    }
+
+    FILE* mOut = stdout;
+    if (mOutputPath != nullptr) {
+        mOut = fopen(mOutputPath, "w");
+        if (mOut == nullptr) {
+            fprintf(stderr, "ERROR: could not write '%s'\n", mOutputPath);
+            return 2;
+        }
+    }
+    write_json(mOut, mResults);
+    if (mOut != stdout) {
+        fclose(mOut);
+    }
+
+    if (mBaselinePath != nullptr) {
+        return compare(mBaseline, mResults, mThreshold);
+    }
+    return 0;
+}
@@ -25,12 +25,14 @@
  * - [x] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [x] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
 
 #include "KlangWellen.h"
 #include "AudioSignal.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
     class ADSR {
@@ -96,6 +98,16 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            const uint8_t mChannels = buffer.num_channels();
+            for (uint32_t i = 0; i < buffer.num_frames(); i++) {
+                step();
+                for (uint8_t j = 0; j < mChannels; j++) {
+                    buffer[j][i] *= fAmp;
+                }
+            }
+        }
+
         void start() {
             check_scheduled_attack_state();
         }
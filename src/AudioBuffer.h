@@ -0,0 +1,229 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <algorithm>
+
+#include "KlangWellen.h"
+
+#ifndef KLANGWELLEN_AUDIOBUFFER_MAX_CHANNELS
+#define KLANGWELLEN_AUDIOBUFFER_MAX_CHANNELS 16
+#endif
+
+namespace klangwellen {
+    /**
+     * multichannel block of samples with planar storage ( i.e one contiguous array per channel ).
+     * <p>
+     * an `AudioBuffer` either owns its memory or is a view onto memory owned by someone else ( e.g another
+     * `AudioBuffer` or the buffers passed in by an audio callback ). owned memory is allocated once at construction,
+     * each channel starts at a 64-byte boundary. views ( see `slice` and `select_channels` ) never copy or allocate
+     * and are therefore safe to create in the audio thread.
+     * <p>
+     * processors accept an `AudioBuffer` via `process(AudioBuffer&)`. processors that are stateless or that have a
+     * stereo variant process all channels. mono processors with internal state ( e.g `Filter` ) process the first
+     * channel only ( use one instance per channel together with `select_channels` for multichannel signals ).
+     * generators write into the first channel and copy the result into all other channels.
+     */
+    class AudioBuffer {
+    public:
+        static constexpr uint8_t  MAX_CHANNELS = KLANGWELLEN_AUDIOBUFFER_MAX_CHANNELS;
+        static constexpr uint32_t ALIGNMENT    = 64;
+
+        /**
+         * allocates aligned planar storage for `num_channels` channels with `num_frames` samples each. all samples
+         * are set to zero.
+         */
+        AudioBuffer(const uint8_t num_channels, const uint32_t num_frames) : fNumChannels(std::min(num_channels, MAX_CHANNELS)),
+                                                                             fNumFrames(num_frames),
+                                                                             fMemory(nullptr) {
+            const uint32_t mStride = aligned_stride(num_frames);
+            fMemory                = new uint8_t[static_cast<size_t>(mStride) * fNumChannels * sizeof(float) + ALIGNMENT];
+            const uintptr_t mAddr  = reinterpret_cast<uintptr_t>(fMemory);
+            float*          mBase  = reinterpret_cast<float*>((mAddr + ALIGNMENT - 1) & ~static_cast<uintptr_t>(ALIGNMENT - 1));
+            for (uint8_t i = 0; i < fNumChannels; i++) {
+                fChannels[i] = mBase + static_cast<size_t>(i) * mStride;
+            }
+            clear();
+        }
+
+        /**
+         * creates a view onto externally owned channel buffers. the buffers are neither copied nor freed.
+         */
+        AudioBuffer(float* const* channels, const uint8_t num_channels, const uint32_t num_frames) : fNumChannels(std::min(num_channels, MAX_CHANNELS)),
+                                                                                                   fNumFrames(num_frames),
+                                                                                                   fMemory(nullptr) {
+            for (uint8_t i = 0; i < fNumChannels; i++) {
+                fChannels[i] = channels[i];
+            }
+        }
+
+        /**
+         * creates a mono view onto an externally owned buffer.
+         */
+        AudioBuffer(float* signal_buffer, const uint32_t num_frames) : AudioBuffer(&signal_buffer, 1, num_frames) {}
+
+        /**
+         * creates a stereo view onto externally owned buffers.
+         */
+        AudioBuffer(float* signal_buffer_left, float* signal_buffer_right, const uint32_t num_frames) : fNumChannels(2),
+                                                                                                        fNumFrames(num_frames),
+                                                                                                        fMemory(nullptr) {
+            fChannels[0] = signal_buffer_left;
+            fChannels[1] = signal_buffer_right;
+        }
+
+        AudioBuffer(const AudioBuffer&)            = delete;
+        AudioBuffer& operator=(const AudioBuffer&) = delete;
+
+        AudioBuffer(AudioBuffer&& other) noexcept : fNumChannels(other.fNumChannels),
+                                                    fNumFrames(other.fNumFrames),
+                                                    fMemory(other.fMemory) {
+            std::copy_n(other.fChannels, fNumChannels, fChannels);
+            other.fMemory = nullptr;
+        }
+
+        ~AudioBuffer() {
+            delete[] fMemory;
+        }
+
+        uint8_t num_channels() const {
+            return fNumChannels;
+        }
+
+        uint32_t num_frames() const {
+            return fNumFrames;
+        }
+
+        float* channel(const uint8_t index) {
+            return fChannels[index];
+        }
+
+        const float* channel(const uint8_t index) const {
+            return fChannels[index];
+        }
+
+        float* operator[](const uint8_t index) {
+            return fChannels[index];
+        }
+
+        const float* operator[](const uint8_t index) const {
+            return fChannels[index];
+        }
+
+        /**
+         * @return true if the buffer owns its memory, false if it is a view
+         */
+        bool owns_memory() const {
+            return fMemory != nullptr;
+        }
+
+        /**
+         * @return true if all channels start at a 64-byte boundary
+         */
+        bool is_aligned() const {
+            for (uint8_t i = 0; i < fNumChannels; i++) {
+                if ((reinterpret_cast<uintptr_t>(fChannels[i]) & (ALIGNMENT - 1)) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @return view onto `length` frames starting at frame `offset` of all channels. slices starting at multiples
+         * of 16 frames keep the alignment of the buffer.
+         */
+        AudioBuffer slice(const uint32_t offset, const uint32_t length) {
+            const uint32_t mOffset = std::min(offset, fNumFrames);
+            const uint32_t mLength = std::min(length, fNumFrames - mOffset);
+            float*         mChannels[MAX_CHANNELS];
+            for (uint8_t i = 0; i < fNumChannels; i++) {
+                mChannels[i] = fChannels[i] + mOffset;
+            }
+            return AudioBuffer(mChannels, fNumChannels, mLength);
+        }
+
+        /**
+         * @return view onto `count` channels starting at channel `first`
+         */
+        AudioBuffer select_channels(const uint8_t first, const uint8_t count) {
+            const uint8_t mFirst = std::min(first, fNumChannels);
+            const uint8_t mCount = std::min(count, static_cast<uint8_t>(fNumChannels - mFirst));
+            return AudioBuffer(fChannels + mFirst, mCount, fNumFrames);
+        }
+
+        void clear() {
+            fill(0.0f);
+        }
+
+        void fill(const float value) {
+            for (uint8_t i = 0; i < fNumChannels; i++) {
+                KlangWellen::fill(fChannels[i], value, fNumFrames);
+            }
+        }
+
+        /**
+         * copies the samples of channel `source` into all other channels.
+         */
+        void broadcast_channel(const uint8_t source = 0) {
+            for (uint8_t i = 0; i < fNumChannels; i++) {
+                if (i != source) {
+                    std::copy_n(fChannels[source], fNumFrames, fChannels[i]);
+                }
+            }
+        }
+
+        /**
+         * copies samples from `other` into this buffer. channel and frame counts are clipped to the smaller buffer.
+         */
+        void copy_from(const AudioBuffer& other) {
+            const uint8_t  mChannels = std::min(fNumChannels, other.fNumChannels);
+            const uint32_t mFrames   = std::min(fNumFrames, other.fNumFrames);
+            for (uint8_t i = 0; i < mChannels; i++) {
+                std::copy_n(other.fChannels[i], mFrames, fChannels[i]);
+            }
+        }
+
+        /**
+         * adds samples from `other` to this buffer. channel and frame counts are clipped to the smaller buffer.
+         */
+        void add(const AudioBuffer& other) {
+            const uint8_t  mChannels = std::min(fNumChannels, other.fNumChannels);
+            const uint32_t mFrames   = std::min(fNumFrames, other.fNumFrames);
+            for (uint8_t i = 0; i < mChannels; i++) {
+                KlangWellen::add(fChannels[i], other.fChannels[i], mFrames);
+            }
+        }
+
+        static uint32_t aligned_stride(const uint32_t num_frames) {
+            constexpr uint32_t mFloatsPerAlignment = ALIGNMENT / sizeof(float);
+            return (num_frames + mFloatsPerAlignment - 1) & ~(mFloatsPerAlignment - 1);
+        }
+
+    private:
+        uint8_t  fNumChannels;
+        uint32_t fNumFrames;
+        float*   fChannels[MAX_CHANNELS]{};
+        uint8_t* fMemory;
+    };
+} // namespace klangwellen
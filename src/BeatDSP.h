@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t) *no overwrites*
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -34,6 +35,7 @@
 #include <vector>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
 
 /**
  * similar to {@link wellen.Beat} with the exception that events are triggered from {@link DSP}.
@@ -107,6 +109,13 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+        }
+
         /* --- function callback --- */
 
     private:
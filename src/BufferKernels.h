@@ -0,0 +1,459 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * SIMD paths are only compiled on x86 with GCC or Clang. the kernels are compiled with per-function `target`
+ * attributes, so no extra compiler flags are needed and the best path is selected at runtime. on all other
+ * platforms ( e.g microcontrollers ) only the scalar kernels are compiled. define `KLANGWELLEN_ENABLE_SIMD 0`
+ * to force scalar kernels everywhere.
+ */
+#ifndef KLANGWELLEN_ENABLE_SIMD
+#define KLANGWELLEN_ENABLE_SIMD 1
+#endif
+
+#if KLANGWELLEN_ENABLE_SIMD && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define KLANGWELLEN_SIMD_X86 1
+#include <immintrin.h>
+#define KLANGWELLEN_TARGET_SSE2   __attribute__((target("sse2")))
+#define KLANGWELLEN_TARGET_AVX2   __attribute__((target("avx2,fma")))
+#define KLANGWELLEN_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define KLANGWELLEN_SIMD_X86 0
+#endif
+
+namespace klangwellen {
+    /**
+     * vectorized buffer kernels with a scalar fallback. the widest instruction set supported by the CPU is detected
+     * once at runtime. `KlangWellen::add`, `sub`, `mult`, `div`, `fill`, `normalize` and `peak` are dispatched
+     * through these kernels.
+     */
+    class BufferKernels {
+    public:
+        static constexpr uint8_t ISA_SCALAR = 0;
+        static constexpr uint8_t ISA_SSE2   = 1;
+        static constexpr uint8_t ISA_AVX2   = 2;
+        static constexpr uint8_t ISA_AVX512 = 3;
+        static constexpr uint8_t NUM_ISA    = 4;
+
+        struct Table {
+            uint8_t isa;
+            const char* name;
+            void (*add)(float*, const float*, uint32_t);
+            void (*sub)(float*, const float*, uint32_t);
+            void (*mult)(float*, const float*, uint32_t);
+            void (*div)(float*, const float*, uint32_t);
+            void (*add_scalar)(float*, float, uint32_t);
+            void (*sub_scalar)(float*, float, uint32_t);
+            void (*mult_scalar)(float*, float, uint32_t);
+            void (*div_scalar)(float*, float, uint32_t);
+            void (*fill)(float*, float, uint32_t);
+            float (*abs_max)(const float*, uint32_t);
+            void (*min_max)(const float*, uint32_t, float&, float&);
+        };
+
+        /**
+         * @return true if the kernels for the instruction set are compiled in and supported by the CPU
+         */
+        static bool supports(const uint8_t isa) {
+            switch (isa) {
+                case ISA_SCALAR:
+                    return true;
+#if KLANGWELLEN_SIMD_X86
+                case ISA_SSE2:
+                    return __builtin_cpu_supports("sse2");
+                case ISA_AVX2:
+                    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+                case ISA_AVX512:
+                    return __builtin_cpu_supports("avx512f");
+#endif
+                default:
+                    return false;
+            }
+        }
+
+        /**
+         * @return kernel table for a specific instruction set or `nullptr` if it is not supported
+         */
+        static const Table* table(const uint8_t isa) {
+            static const Table mTables[NUM_ISA] = {
+                {ISA_SCALAR, "scalar", add_scalar_v, sub_scalar_v, mult_scalar_v, div_scalar_v, add_scalar_s, sub_scalar_s, mult_scalar_s, div_scalar_s, fill_scalar, abs_max_scalar, min_max_scalar},
+#if KLANGWELLEN_SIMD_X86
+                {ISA_SSE2, "sse2", add_sse2_v, sub_sse2_v, mult_sse2_v, div_sse2_v, add_sse2_s, sub_sse2_s, mult_sse2_s, div_sse2_s, fill_sse2, abs_max_sse2, min_max_sse2},
+                {ISA_AVX2, "avx2", add_avx2_v, sub_avx2_v, mult_avx2_v, div_avx2_v, add_avx2_s, sub_avx2_s, mult_avx2_s, div_avx2_s, fill_avx2, abs_max_avx2, min_max_avx2},
+                {ISA_AVX512, "avx512", add_avx512_v, sub_avx512_v, mult_avx512_v, div_avx512_v, add_avx512_s, sub_avx512_s, mult_avx512_s, div_avx512_s, fill_avx512, abs_max_avx512, min_max_avx512},
+#endif
+            };
+            if (isa >= NUM_ISA || !supports(isa)) {
+                return nullptr;
+            }
+            return &mTables[isa];
+        }
+
+        /**
+         * @return widest instruction set supported by the CPU
+         */
+        static uint8_t detect_isa() {
+            for (uint8_t i = NUM_ISA - 1; i > ISA_SCALAR; i--) {
+                if (supports(i)) {
+                    return i;
+                }
+            }
+            return ISA_SCALAR;
+        }
+
+        /**
+         * @return currently active kernel table
+         */
+        static const Table& active() {
+            if (fActive != nullptr) {
+                return *fActive;
+            }
+            static const Table* mDetected = table(detect_isa());
+            return *mDetected;
+        }
+
+        /**
+         * forces a specific instruction set ( e.g for benchmarking or testing ). this is not thread-safe and should
+         * not be called while audio is processed.
+         *
+         * @return false if the instruction set is not supported
+         */
+        static bool set_isa(const uint8_t isa) {
+            const Table* mTable = table(isa);
+            if (mTable == nullptr) {
+                return false;
+            }
+            fActive = mTable;
+            return true;
+        }
+
+        static uint8_t get_isa() {
+            return active().isa;
+        }
+
+        static void add(float* a, const float* b, const uint32_t length) { active().add(a, b, length); }
+        static void sub(float* a, const float* b, const uint32_t length) { active().sub(a, b, length); }
+        static void mult(float* a, const float* b, const uint32_t length) { active().mult(a, b, length); }
+        static void div(float* a, const float* b, const uint32_t length) { active().div(a, b, length); }
+        static void add(float* a, const float s, const uint32_t length) { active().add_scalar(a, s, length); }
+        static void sub(float* a, const float s, const uint32_t length) { active().sub_scalar(a, s, length); }
+        static void mult(float* a, const float s, const uint32_t length) { active().mult_scalar(a, s, length); }
+        static void div(float* a, const float s, const uint32_t length) { active().div_scalar(a, s, length); }
+        static void fill(float* a, const float value, const uint32_t length) { active().fill(a, value, length); }
+        static float abs_max(const float* a, const uint32_t length) { return active().abs_max(a, length); }
+        static void  min_max(const float* a, const uint32_t length, float& min, float& max) { active().min_max(a, length, min, max); }
+
+#if KLANGWELLEN_SIMD_X86
+        /**
+         * transposes 8 vectors of 8 floats in place, e.g to process 8 channels with one channel per lane.
+         */
+        KLANGWELLEN_TARGET_AVX2
+        static void transpose_8x8_avx2(__m256* r) {
+            const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+            const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+            const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+            const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+            const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+            const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+            const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+            const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+            const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+            r[0]            = _mm256_permute2f128_ps(u0, u4, 0x20);
+            r[1]            = _mm256_permute2f128_ps(u1, u5, 0x20);
+            r[2]            = _mm256_permute2f128_ps(u2, u6, 0x20);
+            r[3]            = _mm256_permute2f128_ps(u3, u7, 0x20);
+            r[4]            = _mm256_permute2f128_ps(u0, u4, 0x31);
+            r[5]            = _mm256_permute2f128_ps(u1, u5, 0x31);
+            r[6]            = _mm256_permute2f128_ps(u2, u6, 0x31);
+            r[7]            = _mm256_permute2f128_ps(u3, u7, 0x31);
+        }
+#endif
+
+    private:
+        inline static const Table* fActive = nullptr;
+
+        /* --- scalar --- */
+
+        static void add_scalar_v(float* a, const float* b, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] += b[i]; }
+        }
+
+        static void sub_scalar_v(float* a, const float* b, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] -= b[i]; }
+        }
+
+        static void mult_scalar_v(float* a, const float* b, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] *= b[i]; }
+        }
+
+        static void div_scalar_v(float* a, const float* b, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] /= b[i]; }
+        }
+
+        static void add_scalar_s(float* a, const float s, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] += s; }
+        }
+
+        static void sub_scalar_s(float* a, const float s, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] -= s; }
+        }
+
+        static void mult_scalar_s(float* a, const float s, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] *= s; }
+        }
+
+        static void div_scalar_s(float* a, const float s, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] /= s; }
+        }
+
+        static void fill_scalar(float* a, const float value, const uint32_t length) {
+            for (uint32_t i = 0; i < length; i++) { a[i] = value; }
+        }
+
+        static float abs_max_scalar(const float* a, const uint32_t length) {
+            float mPeak = 0.0f;
+            for (uint32_t i = 0; i < length; i++) {
+                const float mSample = a[i] < 0 ? -a[i] : a[i];
+                if (mSample > mPeak) {
+                    mPeak = mSample;
+                }
+            }
+            return mPeak;
+        }
+
+        static void min_max_scalar(const float* a, const uint32_t length, float& min, float& max) {
+            min = 0.0f;
+            max = 0.0f;
+            for (uint32_t i = 0; i < length; i++) {
+                const float mSample = a[i];
+                if (mSample < min) {
+                    min = mSample;
+                }
+                if (mSample > max) {
+                    max = mSample;
+                }
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        /*
+         * element-wise kernels share one body per instruction set. `VEC` is the register type, `WIDTH` the number of
+         * floats per register. remaining samples are processed with scalar code.
+         */
+#define KLANGWELLEN_KERNEL_BINARY(NAME, ISA, TARGET, VEC, WIDTH, LOAD, STORE, SET1, OP, SCALAR_OP)     \
+    TARGET static void NAME##_##ISA##_v(float* a, const float* b, const uint32_t length) {             \
+        uint32_t i = 0;                                                                                \
+        for (; i + WIDTH <= length; i += WIDTH) {                                                      \
+            STORE(a + i, OP(LOAD(a + i), LOAD(b + i)));                                                \
+        }                                                                                              \
+        for (; i < length; i++) { a[i] SCALAR_OP b[i]; }                                               \
+    }                                                                                                  \
+    TARGET static void NAME##_##ISA##_s(float* a, const float s, const uint32_t length) {              \
+        const VEC mS = SET1(s);                                                                        \
+        uint32_t  i  = 0;                                                                              \
+        for (; i + WIDTH <= length; i += WIDTH) {                                                      \
+            STORE(a + i, OP(LOAD(a + i), mS));                                                         \
+        }                                                                                              \
+        for (; i < length; i++) { a[i] SCALAR_OP s; }                                                  \
+    }
+
+        /* --- SSE2 --- */
+
+        KLANGWELLEN_KERNEL_BINARY(add, sse2, KLANGWELLEN_TARGET_SSE2, __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_add_ps, +=)
+        KLANGWELLEN_KERNEL_BINARY(sub, sse2, KLANGWELLEN_TARGET_SSE2, __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_sub_ps, -=)
+        KLANGWELLEN_KERNEL_BINARY(mult, sse2, KLANGWELLEN_TARGET_SSE2, __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_mul_ps, *=)
+        KLANGWELLEN_KERNEL_BINARY(div, sse2, KLANGWELLEN_TARGET_SSE2, __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_div_ps, /=)
+
+        KLANGWELLEN_TARGET_SSE2 static void fill_sse2(float* a, const float value, const uint32_t length) {
+            const __m128 mValue = _mm_set1_ps(value);
+            uint32_t     i      = 0;
+            for (; i + 4 <= length; i += 4) {
+                _mm_storeu_ps(a + i, mValue);
+            }
+            for (; i < length; i++) { a[i] = value; }
+        }
+
+        KLANGWELLEN_TARGET_SSE2 static float abs_max_sse2(const float* a, const uint32_t length) {
+            const __m128 mSignMask = _mm_set1_ps(-0.0f);
+            __m128       mMax      = _mm_setzero_ps();
+            uint32_t     i         = 0;
+            for (; i + 4 <= length; i += 4) {
+                mMax = _mm_max_ps(mMax, _mm_andnot_ps(mSignMask, _mm_loadu_ps(a + i)));
+            }
+            float mLanes[4];
+            _mm_storeu_ps(mLanes, mMax);
+            float mPeak = mLanes[0];
+            for (uint8_t j = 1; j < 4; j++) {
+                if (mLanes[j] > mPeak) { mPeak = mLanes[j]; }
+            }
+            for (; i < length; i++) {
+                const float mSample = a[i] < 0 ? -a[i] : a[i];
+                if (mSample > mPeak) { mPeak = mSample; }
+            }
+            return mPeak;
+        }
+
+        KLANGWELLEN_TARGET_SSE2 static void min_max_sse2(const float* a, const uint32_t length, float& min, float& max) {
+            __m128   mMin = _mm_setzero_ps();
+            __m128   mMax = _mm_setzero_ps();
+            uint32_t i    = 0;
+            for (; i + 4 <= length; i += 4) {
+                const __m128 mSample = _mm_loadu_ps(a + i);
+                mMin                 = _mm_min_ps(mMin, mSample);
+                mMax                 = _mm_max_ps(mMax, mSample);
+            }
+            float mLanesMin[4];
+            float mLanesMax[4];
+            _mm_storeu_ps(mLanesMin, mMin);
+            _mm_storeu_ps(mLanesMax, mMax);
+            reduce_min_max(mLanesMin, mLanesMax, 4, a + i, length - i, min, max);
+        }
+
+        /* --- AVX2 --- */
+
+        KLANGWELLEN_KERNEL_BINARY(add, avx2, KLANGWELLEN_TARGET_AVX2, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_add_ps, +=)
+        KLANGWELLEN_KERNEL_BINARY(sub, avx2, KLANGWELLEN_TARGET_AVX2, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_sub_ps, -=)
+        KLANGWELLEN_KERNEL_BINARY(mult, avx2, KLANGWELLEN_TARGET_AVX2, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_mul_ps, *=)
+        KLANGWELLEN_KERNEL_BINARY(div, avx2, KLANGWELLEN_TARGET_AVX2, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_div_ps, /=)
+
+        KLANGWELLEN_TARGET_AVX2 static void fill_avx2(float* a, const float value, const uint32_t length) {
+            const __m256 mValue = _mm256_set1_ps(value);
+            uint32_t     i      = 0;
+            for (; i + 8 <= length; i += 8) {
+                _mm256_storeu_ps(a + i, mValue);
+            }
+            for (; i < length; i++) { a[i] = value; }
+        }
+
+        KLANGWELLEN_TARGET_AVX2 static float abs_max_avx2(const float* a, const uint32_t length) {
+            const __m256 mSignMask = _mm256_set1_ps(-0.0f);
+            __m256       mMax      = _mm256_setzero_ps();
+            uint32_t     i         = 0;
+            for (; i + 8 <= length; i += 8) {
+                mMax = _mm256_max_ps(mMax, _mm256_andnot_ps(mSignMask, _mm256_loadu_ps(a + i)));
+            }
+            float mLanes[8];
+            _mm256_storeu_ps(mLanes, mMax);
+            float mPeak = mLanes[0];
+            for (uint8_t j = 1; j < 8; j++) {
+                if (mLanes[j] > mPeak) { mPeak = mLanes[j]; }
+            }
+            for (; i < length; i++) {
+                const float mSample = a[i] < 0 ? -a[i] : a[i];
+                if (mSample > mPeak) { mPeak = mSample; }
+            }
+            return mPeak;
+        }
+
+        KLANGWELLEN_TARGET_AVX2 static void min_max_avx2(const float* a, const uint32_t length, float& min, float& max) {
+            __m256   mMin = _mm256_setzero_ps();
+            __m256   mMax = _mm256_setzero_ps();
+            uint32_t i    = 0;
+            for (; i + 8 <= length; i += 8) {
+                const __m256 mSample = _mm256_loadu_ps(a + i);
+                mMin                 = _mm256_min_ps(mMin, mSample);
+                mMax                 = _mm256_max_ps(mMax, mSample);
+            }
+            float mLanesMin[8];
+            float mLanesMax[8];
+            _mm256_storeu_ps(mLanesMin, mMin);
+            _mm256_storeu_ps(mLanesMax, mMax);
+            reduce_min_max(mLanesMin, mLanesMax, 8, a + i, length - i, min, max);
+        }
+
+        /* --- AVX-512 --- */
+
+        KLANGWELLEN_KERNEL_BINARY(add, avx512, KLANGWELLEN_TARGET_AVX512, __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_add_ps, +=)
+        KLANGWELLEN_KERNEL_BINARY(sub, avx512, KLANGWELLEN_TARGET_AVX512, __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_sub_ps, -=)
+        KLANGWELLEN_KERNEL_BINARY(mult, avx512, KLANGWELLEN_TARGET_AVX512, __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_mul_ps, *=)
+        KLANGWELLEN_KERNEL_BINARY(div, avx512, KLANGWELLEN_TARGET_AVX512, __m512, 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_div_ps, /=)
+
+        KLANGWELLEN_TARGET_AVX512 static void fill_avx512(float* a, const float value, const uint32_t length) {
+            const __m512 mValue = _mm512_set1_ps(value);
+            uint32_t     i      = 0;
+            for (; i + 16 <= length; i += 16) {
+                _mm512_storeu_ps(a + i, mValue);
+            }
+            for (; i < length; i++) { a[i] = value; }
+        }
+
+        KLANGWELLEN_TARGET_AVX512 static float abs_max_avx512(const float* a, const uint32_t length) {
+            __m512   mMax = _mm512_setzero_ps();
+            uint32_t i    = 0;
+            for (; i + 16 <= length; i += 16) {
+                mMax = _mm512_max_ps(mMax, _mm512_abs_ps(_mm512_loadu_ps(a + i)));
+            }
+            float mPeak = _mm512_reduce_max_ps(mMax);
+            for (; i < length; i++) {
+                const float mSample = a[i] < 0 ? -a[i] : a[i];
+                if (mSample > mPeak) { mPeak = mSample; }
+            }
+            return mPeak;
+        }
+
+        KLANGWELLEN_TARGET_AVX512 static void min_max_avx512(const float* a, const uint32_t length, float& min, float& max) {
+            __m512   mMin = _mm512_setzero_ps();
+            __m512   mMax = _mm512_setzero_ps();
+            uint32_t i    = 0;
+            for (; i + 16 <= length; i += 16) {
+                const __m512 mSample = _mm512_loadu_ps(a + i);
+                mMin                 = _mm512_min_ps(mMin, mSample);
+                mMax                 = _mm512_max_ps(mMax, mSample);
+            }
+            float mLanesMin[16];
+            float mLanesMax[16];
+            _mm512_storeu_ps(mLanesMin, mMin);
+            _mm512_storeu_ps(mLanesMax, mMax);
+            reduce_min_max(mLanesMin, mLanesMax, 16, a + i, length - i, min, max);
+        }
+
+#undef KLANGWELLEN_KERNEL_BINARY
+
+        static void reduce_min_max(const float* lanes_min,
+                                   const float* lanes_max,
+                                   const uint8_t num_lanes,
+                                   const float* remainder,
+                                   const uint32_t remainder_length,
+                                   float& min,
+                                   float& max) {
+            min = 0.0f;
+            max = 0.0f;
+            for (uint8_t j = 0; j < num_lanes; j++) {
+                if (lanes_min[j] < min) { min = lanes_min[j]; }
+                if (lanes_max[j] > max) { max = lanes_max[j]; }
+            }
+            for (uint32_t j = 0; j < remainder_length; j++) {
+                if (remainder[j] < min) { min = remainder[j]; }
+                if (remainder[j] > max) { max = remainder[j]; }
+            }
+        }
+#endif // KLANGWELLEN_SIMD_X86
+    };
+} // namespace klangwellen
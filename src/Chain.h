@@ -0,0 +1,155 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [x] float process()
+ * - [x] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t)
+ * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+
+namespace klangwellen {
+    /**
+     * connects processors in series at compile time, e.g:
+     * <p>
+     * `Chain mChain(wavetable, adsr, filter, waveshaper);`
+     * <p>
+     * `process(float*, uint32_t)` runs a single loop over the block in which the `process(float)` methods of all
+     * processors are called for each sample. since the processor types are known at compile time these calls are
+     * inlined, there are no virtual calls and no intermediate buffers. `process_blockwise(float*, uint32_t)` instead
+     * calls the block `process` method of each processor one after another.
+     * <p>
+     * the fused loop keeps the sample in a register and is usually faster for chains of cheap processors. the
+     * block-wise variant allows each processor to run its own ( possibly vectorized ) loop and keeps the state of only
+     * one processor in use at a time, which can be faster for long chains of expensive processors. see
+     * `bench/klangwellen-bench-chain.cpp` for a comparison with hand-written loops and a virtual-dispatch chain.
+     * <p>
+     * if the first processor has no `float process(float)` method ( e.g `Wavetable` ) it is treated as a generator,
+     * i.e its `float process()` method produces the signal for the rest of the chain. processors are referenced, not
+     * copied.
+     */
+    template<typename... PROCESSORS>
+    class Chain {
+        static_assert(sizeof...(PROCESSORS) > 0, "a chain needs at least one processor");
+
+        template<typename T, typename = void>
+        struct has_process_float : std::false_type {};
+
+        template<typename T>
+        struct has_process_float<T, decltype(void(std::declval<T&>().process(0.0f)))> : std::true_type {};
+
+    public:
+        static constexpr size_t NUM_PROCESSORS = sizeof...(PROCESSORS);
+
+        using First = typename std::tuple_element<0, std::tuple<PROCESSORS...>>::type;
+
+        /**
+         * true if the first processor generates the signal ( i.e it only implements `float process()` )
+         */
+        static constexpr bool IS_GENERATOR = !has_process_float<First>::value;
+
+        explicit Chain(PROCESSORS&... processors) : fProcessors(processors...) {}
+
+        /**
+         * @return processor at position `INDEX` in the chain
+         */
+        template<size_t INDEX>
+        typename std::tuple_element<INDEX, std::tuple<PROCESSORS...>>::type& get() {
+            return std::get<INDEX>(fProcessors);
+        }
+
+        /**
+         * generates a sample with the first processor and passes it through the rest of the chain.
+         */
+        float process() {
+            return tick<1>(std::get<0>(fProcessors).process());
+        }
+
+        float process(float signal) {
+            return tick<0>(signal);
+        }
+
+        /**
+         * processes a block in a single fused loop. if the chain starts with a generator the buffer is overwritten.
+         */
+        void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            if constexpr (IS_GENERATOR) {
+                for (uint32_t i = 0; i < buffer_length; i++) {
+                    signal_buffer[i] = process();
+                }
+            } else {
+                for (uint32_t i = 0; i < buffer_length; i++) {
+                    signal_buffer[i] = tick<0>(signal_buffer[i]);
+                }
+            }
+        }
+
+        /**
+         * processes a block by calling the block `process` method of each processor in turn.
+         */
+        void process_blockwise(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_blockwise(signal_buffer, buffer_length, std::index_sequence_for<PROCESSORS...>{});
+        }
+
+        /**
+         * processes the first channel. if the chain starts with a generator the result is copied into all channels.
+         */
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            if constexpr (IS_GENERATOR) {
+                buffer.broadcast_channel(0);
+            }
+        }
+
+    private:
+        std::tuple<PROCESSORS&...> fProcessors;
+
+        template<size_t INDEX>
+        inline float tick(const float signal) {
+            if constexpr (INDEX == NUM_PROCESSORS) {
+                return signal;
+            } else {
+                return tick<INDEX + 1>(std::get<INDEX>(fProcessors).process(signal));
+            }
+        }
+
+        template<size_t... INDICES>
+        void process_blockwise(float* signal_buffer, const uint32_t buffer_length, std::index_sequence<INDICES...>) {
+            (std::get<INDICES>(fProcessors).process(signal_buffer, buffer_length), ...);
+        }
+    };
+} // namespace klangwellen
@@ -25,6 +25,7 @@
  * - [x] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [x] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -33,6 +34,7 @@
 
 #include "KlangWellen.h"
 #include "AudioSignal.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
     class Clamp {
@@ -64,6 +66,12 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            for (uint8_t i = 0; i < buffer.num_channels(); i++) {
+                process(buffer.channel(i), buffer.num_frames());
+            }
+        }
+
         void set_min(const float min) {
             fMin = min;
         }
@@ -0,0 +1,615 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [x] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t)
+ * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "BufferKernels.h"
+#include "FFT.h"
+#include "WAV.h"
+
+namespace klangwellen {
+    /**
+     * convolves a signal with an impulse response ( e.g of a room or a speaker cabinet ).
+     * <p>
+     * the impulse response is split into stages of uniform partitions that grow by `STAGE_FACTOR` from stage to stage
+     * ( i.e a non-uniformly partitioned convolution ). the head, the first `2 * STAGE_FACTOR` partitions of
+     * `partition_size` samples, is computed on the audio thread. each following stage starts two of its partitions into
+     * the impulse response and is computed by its own background thread. the last stage, with partitions of at most
+     * `MAX_PARTITION_SIZE` samples, covers the rest of the impulse response. every stage is an overlap-save FFT
+     * convolution with a frequency-domain delay line, i.e the spectrum of each input partition is computed once and
+     * multiplied with the spectra of all partitions of the impulse response. the long partitions of the late stages keep
+     * the number of spectra per sample low, which is what limits the cost of long impulse responses.
+     * <p>
+     * the latency is `partition_size` samples, e.g one block if the partition size is the block size of the host. a
+     * partition of the input of a background stage is handed to its thread once it is complete, its result is needed one
+     * partition of that stage later. the audio thread only waits if a background thread misses this deadline. without
+     * background threads the audio thread computes a stage whenever one of its partitions is complete, which produces the
+     * same output but makes the cost per block very uneven.
+     * <p>
+     * the reverb processes one channel, use one instance per channel for stereo impulse responses. `load` allocates
+     * memory and starts the background threads, it must not be called while the reverb is processing.
+     */
+    class ConvolutionReverb {
+    public:
+        static constexpr uint32_t STAGE_FACTOR       = 16;
+        static constexpr uint32_t MIN_PARTITION_SIZE = 16;
+        static constexpr uint32_t MAX_PARTITION_SIZE = 65536;
+
+        /**
+         * @param sample_rate       sample rate in Hz, impulse responses loaded from WAV files are resampled to it
+         * @param partition_size    size of the head partitions and latency in samples, rounded up to a power of two
+         *                          between `MIN_PARTITION_SIZE` and `MAX_PARTITION_SIZE`
+         * @param background_thread compute the stages after the head on background threads
+         */
+        explicit ConvolutionReverb(const uint32_t sample_rate       = KlangWellen::DEFAULT_SAMPLE_RATE,
+                                   const uint32_t partition_size    = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE,
+                                   const bool     background_thread = true) : fSampleRate(sample_rate),
+                                                                              fPartitionSize(power_of_two(partition_size)),
+                                                                              fBackgroundThread(background_thread),
+                                                                              fHead(fPartitionSize),
+                                                                              fInput(fPartitionSize, 0.0f),
+                                                                              fOutput(fPartitionSize, 0.0f),
+                                                                              fHeadOutput(fPartitionSize, 0.0f) {}
+
+        ConvolutionReverb(const ConvolutionReverb&)            = delete;
+        ConvolutionReverb& operator=(const ConvolutionReverb&) = delete;
+
+        /**
+         * sets the impulse response. allocates memory, must not be called while the reverb is processing.
+         *
+         * @param impulse_response samples of the impulse response at the sample rate of the reverb
+         * @param length           number of samples
+         */
+        void load(const float* impulse_response, const uint32_t length) {
+            fLength = impulse_response != nullptr ? length : 0;
+            fStages.clear();
+            uint32_t mStart = 2 * fPartitionSize * STAGE_FACTOR;
+            fHead.set_impulse_response(impulse_response, std::min(fLength, mStart));
+            for (uint32_t mSize = fPartitionSize * STAGE_FACTOR; mStart < fLength; mSize *= STAGE_FACTOR) {
+                /* the last stage covers the rest of the impulse response */
+                const bool     mLast = mSize * STAGE_FACTOR > MAX_PARTITION_SIZE;
+                const uint32_t mEnd  = mLast ? fLength : std::min(fLength, 2 * mSize * STAGE_FACTOR);
+                fStages.emplace_back(new TailStage(mSize, fBackgroundThread));
+                fStages.back()->set_impulse_response(impulse_response + mStart, mEnd - mStart);
+                mStart = mEnd;
+            }
+            reset();
+        }
+
+        /**
+         * loads an impulse response from a file of raw 32 bit floating-point samples in the byte order of the machine.
+         *
+         * @return false if the file cannot be read
+         */
+        bool load_raw(const char* path) {
+            FILE* mFile = fopen(path, "rb");
+            if (mFile == nullptr) {
+                return false;
+            }
+            std::vector<float> mSamples;
+            float              mChunk[1024];
+            size_t             mRead;
+            while ((mRead = fread(mChunk, sizeof(float), 1024, mFile)) > 0) {
+                mSamples.insert(mSamples.end(), mChunk, mChunk + mRead);
+            }
+            fclose(mFile);
+            load(mSamples.data(), static_cast<uint32_t>(mSamples.size()));
+            return true;
+        }
+
+        /**
+         * loads one channel of a WAV file as impulse response ( see `WAV` ). if the sample rate of the file differs from
+         * the sample rate of the reverb the impulse response is resampled with linear interpolation.
+         *
+         * @return false if the file cannot be read or does not have the channel
+         */
+        bool load_wav(const char* path, const uint16_t channel = 0) {
+            std::vector<float> mSamples;
+            uint16_t           mChannels;
+            uint32_t           mSampleRate;
+            if (!WAV::load(path, mSamples, mChannels, mSampleRate) || channel >= mChannels) {
+                return false;
+            }
+            const size_t       mFrames = mSamples.size() / mChannels;
+            std::vector<float> mImpulseResponse(mFrames);
+            for (size_t i = 0; i < mFrames; i++) {
+                mImpulseResponse[i] = mSamples[i * mChannels + channel];
+            }
+            if (mSampleRate != fSampleRate && mFrames > 1) {
+                mImpulseResponse = resample(mImpulseResponse, mSampleRate, fSampleRate);
+            }
+            load(mImpulseResponse.data(), static_cast<uint32_t>(mImpulseResponse.size()));
+            return true;
+        }
+
+        /**
+         * @return length of the impulse response in samples
+         */
+        uint32_t get_length() const {
+            return fLength;
+        }
+
+        uint32_t get_partition_size() const {
+            return fPartitionSize;
+        }
+
+        /**
+         * @return latency in samples
+         */
+        uint32_t get_latency() const {
+            return fPartitionSize;
+        }
+
+        /**
+         * @return number of samples the output continues after the input stopped
+         */
+        uint32_t get_tail_length() const {
+            return fLength + fPartitionSize;
+        }
+
+        uint32_t get_sample_rate() const {
+            return fSampleRate;
+        }
+
+        /**
+         * @return number of stages including the head, i.e one more than the number of background threads
+         */
+        uint32_t get_num_stages() const {
+            return static_cast<uint32_t>(fStages.size()) + 1;
+        }
+
+        bool has_background_thread() const {
+            return fBackgroundThread;
+        }
+
+        /**
+         * @param wet amount of the convolved signal, the dry signal is mixed with `1 - wet` and delayed by the latency
+         */
+        void set_wet(const float wet) {
+            fWet = KlangWellen::clamp(wet, 0, 1);
+        }
+
+        float get_wet() const {
+            return fWet;
+        }
+
+        /**
+         * clears the history of the reverb. must not be called while the reverb is processing.
+         */
+        void reset() {
+            fHead.reset();
+            for (auto& mStage : fStages) {
+                mStage->reset();
+            }
+            std::fill(fInput.begin(), fInput.end(), 0.0f);
+            std::fill(fOutput.begin(), fOutput.end(), 0.0f);
+            fFill = 0;
+        }
+
+        /**
+         * @return memory used by the reverb including impulse response and delay lines in bytes
+         */
+        size_t get_memory_size() const {
+            size_t mSize = sizeof(ConvolutionReverb) + fHead.get_memory_size();
+            mSize += (fInput.capacity() + fOutput.capacity() + fHeadOutput.capacity()) * sizeof(float);
+            for (const auto& mStage : fStages) {
+                mSize += mStage->get_memory_size();
+            }
+            return mSize;
+        }
+
+        float process(const float signal) {
+            fInput[fFill]      = signal;
+            const float mValue = fOutput[fFill];
+            fFill++;
+            if (fFill == fPartitionSize) {
+                process_partition();
+                fFill = 0;
+            }
+            return mValue;
+        }
+
+        void process(float*         signal_buffer,
+                     const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            uint32_t i = 0;
+            while (i < length) {
+                const uint32_t mLength = std::min(fPartitionSize - fFill, length - i);
+                std::copy_n(signal_buffer + i, mLength, fInput.data() + fFill);
+                std::copy_n(fOutput.data() + fFill, mLength, signal_buffer + i);
+                fFill += mLength;
+                i += mLength;
+                if (fFill == fPartitionSize) {
+                    process_partition();
+                    fFill = 0;
+                }
+            }
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+        }
+
+    private:
+        /* uniformly partitioned overlap-save convolution with a frequency-domain delay line */
+        class Stage {
+        public:
+            explicit Stage(const uint32_t partition_size) : fSize(partition_size),
+                                                            fStride((partition_size + 1 + 7) & ~7u),
+                                                            fFFT(2 * partition_size),
+                                                            fWindow(2 * partition_size, 0.0f),
+                                                            fSpectrum(2 * partition_size + 2, 0.0f),
+                                                            fResult(2 * partition_size, 0.0f),
+                                                            fAccumulator(2 * fStride, 0.0f) {}
+
+            uint32_t get_partition_size() const {
+                return fSize;
+            }
+
+            uint32_t get_num_partitions() const {
+                return fNumPartitions;
+            }
+
+            size_t get_memory_size() const {
+                const size_t mFloats = fWindow.capacity() + fSpectrum.capacity() + fResult.capacity() + fAccumulator.capacity() +
+                                       fPartitions.capacity() + fDelayLine.capacity();
+                return mFloats * sizeof(float) + fFFT.get_memory_size();
+            }
+
+            void set_impulse_response(const float* impulse_response, const uint32_t length) {
+                fNumPartitions = (length + fSize - 1) / fSize;
+                fPartitions.assign(static_cast<size_t>(fNumPartitions) * 2 * fStride, 0.0f);
+                fDelayLine.assign(static_cast<size_t>(fNumPartitions) * 2 * fStride, 0.0f);
+                for (uint32_t p = 0; p < fNumPartitions; p++) {
+                    const uint32_t mLength = std::min(fSize, length - p * fSize);
+                    std::fill(fWindow.begin(), fWindow.end(), 0.0f);
+                    std::copy_n(impulse_response + p * fSize, mLength, fWindow.data());
+                    fFFT.forward(fWindow.data(), fSpectrum.data());
+                    deinterleave(fSpectrum.data(), partition(p));
+                }
+                if (fNumPartitions == 0) {
+                    fPartitions.shrink_to_fit();
+                    fDelayLine.shrink_to_fit();
+                }
+                reset();
+            }
+
+            void reset() {
+                std::fill(fWindow.begin(), fWindow.end(), 0.0f);
+                std::fill(fDelayLine.begin(), fDelayLine.end(), 0.0f);
+                fPosition = 0;
+            }
+
+            /* convolves the next `partition_size` input samples, `output` may alias `input` */
+            void process(const float* input, float* output) {
+                if (fNumPartitions == 0) {
+                    std::fill_n(output, fSize, 0.0f);
+                    return;
+                }
+                /* the window holds the previous and the current input */
+                std::copy_n(input, fSize, fWindow.data() + fSize);
+                fFFT.forward(fWindow.data(), fSpectrum.data());
+                std::copy_n(fWindow.data() + fSize, fSize, fWindow.data());
+                deinterleave(fSpectrum.data(), delay_line(fPosition));
+
+                /* `Y = sum( X[k - j] H[j] )` over the delay line, newest input spectrum first */
+                std::fill(fAccumulator.begin(), fAccumulator.end(), 0.0f);
+                uint32_t mSlot = fPosition;
+                for (uint32_t j = 0; j < fNumPartitions; j++) {
+                    multiply_add(fAccumulator.data(), delay_line(mSlot), partition(j), fStride);
+                    mSlot = mSlot == 0 ? fNumPartitions - 1 : mSlot - 1;
+                }
+                fPosition = fPosition + 1 == fNumPartitions ? 0 : fPosition + 1;
+
+                /* overlap-save: the second half of the circular convolution is the output */
+                const uint32_t mBins = fSize + 1;
+                for (uint32_t k = 0; k < mBins; k++) {
+                    fSpectrum[k * 2]     = fAccumulator[k];
+                    fSpectrum[k * 2 + 1] = fAccumulator[fStride + k];
+                }
+                fFFT.inverse(fSpectrum.data(), fResult.data());
+                std::copy_n(fResult.data() + fSize, fSize, output);
+            }
+
+        private:
+            const uint32_t     fSize;
+            const uint32_t     fStride;
+            FFT                fFFT;
+            std::vector<float> fWindow;
+            std::vector<float> fSpectrum;
+            std::vector<float> fResult;
+            std::vector<float> fAccumulator;
+            /* spectra of the impulse response partitions and of the last inputs as `[partition][real, imaginary][bin]`
+             * with `fStride` bins, the padding bins are zero */
+            std::vector<float> fPartitions;
+            std::vector<float> fDelayLine;
+            uint32_t           fNumPartitions = 0;
+            uint32_t           fPosition      = 0;
+
+            float* partition(const uint32_t p) {
+                return fPartitions.data() + static_cast<size_t>(p) * 2 * fStride;
+            }
+
+            float* delay_line(const uint32_t p) {
+                return fDelayLine.data() + static_cast<size_t>(p) * 2 * fStride;
+            }
+
+            void deinterleave(const float* spectrum, float* split) const {
+                for (uint32_t k = 0; k < fSize + 1; k++) {
+                    split[k]           = spectrum[k * 2];
+                    split[fStride + k] = spectrum[k * 2 + 1];
+                }
+            }
+        };
+
+        /*
+         * a stage after the head. its input is collected in one buffer while the background thread reads the other one,
+         * its output is read from one buffer while the background thread writes the other one. the stage starts two
+         * partitions into its part of the timeline, so the result of a partition completed now is needed from one
+         * partition on, and the result of the partition handed off one partition ago is needed now.
+         */
+        class TailStage {
+        public:
+            TailStage(const uint32_t partition_size, const bool background_thread) : fStage(partition_size) {
+                for (uint8_t i = 0; i < 2; i++) {
+                    fInput[i].assign(partition_size, 0.0f);
+                    fOutput[i].assign(partition_size, 0.0f);
+                }
+                if (background_thread) {
+                    fThread = std::thread(&TailStage::worker_loop, this);
+                }
+            }
+
+            TailStage(const TailStage&)            = delete;
+            TailStage& operator=(const TailStage&) = delete;
+
+            ~TailStage() {
+                if (fThread.joinable()) {
+                    {
+                        std::lock_guard<std::mutex> mLock(fMutex);
+                        fQuit = true;
+                    }
+                    fCondition.notify_one();
+                    fThread.join();
+                }
+            }
+
+            void set_impulse_response(const float* impulse_response, const uint32_t length) {
+                wait();
+                fStage.set_impulse_response(impulse_response, length);
+                reset();
+            }
+
+            void reset() {
+                wait();
+                fStage.reset();
+                for (uint8_t i = 0; i < 2; i++) {
+                    std::fill(fInput[i].begin(), fInput[i].end(), 0.0f);
+                    std::fill(fOutput[i].begin(), fOutput[i].end(), 0.0f);
+                }
+                fFill    = 0;
+                fJobs    = 0;
+                fRead    = 1;
+                fCollect = 0;
+            }
+
+            size_t get_memory_size() const {
+                size_t mSize = sizeof(TailStage) + fStage.get_memory_size();
+                for (uint8_t i = 0; i < 2; i++) {
+                    mSize += (fInput[i].capacity() + fOutput[i].capacity()) * sizeof(float);
+                }
+                return mSize;
+            }
+
+            /* output of the stage for the next samples, must be read before their input is added */
+            const float* output() const {
+                return fOutput[fRead].data() + fFill;
+            }
+
+            /* adds the next `length` input samples, `length` divides the partition size of the stage */
+            void add(const float* input, const uint32_t length) {
+                std::copy_n(input, length, fInput[fCollect].data() + fFill);
+                fFill += length;
+                if (fFill == fStage.get_partition_size()) {
+                    hand_off();
+                    fFill = 0;
+                }
+            }
+
+        private:
+            Stage                   fStage;
+            std::vector<float>      fInput[2];
+            std::vector<float>      fOutput[2];
+            uint32_t                fFill      = 0;
+            uint8_t                 fCollect   = 0;
+            uint8_t                 fRead      = 1;
+            uint64_t                fJobs      = 0;
+            const float*            fJobInput  = nullptr;
+            float*                  fJobOutput = nullptr;
+            std::thread             fThread;
+            std::mutex              fMutex;
+            std::condition_variable fCondition;
+            bool                    fQuit = false;
+            std::atomic<uint64_t>   fJobsPosted{0};
+            std::atomic<uint64_t>   fJobsDone{0};
+            std::atomic<bool>       fWorkerSleeping{false};
+
+            void hand_off() {
+                wait();
+                if (fJobs > 0) {
+                    fRead = static_cast<uint8_t>((fJobs - 1) % 2);
+                }
+                fJobInput  = fInput[fCollect].data();
+                fJobOutput = fOutput[fJobs % 2].data();
+                fCollect   = 1 - fCollect;
+                fJobs++;
+                if (!fThread.joinable()) {
+                    fStage.process(fJobInput, fJobOutput);
+                    return;
+                }
+                fJobsPosted.fetch_add(1, std::memory_order_seq_cst);
+                if (fWorkerSleeping.load(std::memory_order_seq_cst)) {
+                    { std::lock_guard<std::mutex> mLock(fMutex); }
+                    fCondition.notify_one();
+                }
+            }
+
+            void wait() const {
+                while (fJobsDone.load(std::memory_order_acquire) != fJobsPosted.load(std::memory_order_relaxed)) {
+                    std::this_thread::yield();
+                }
+            }
+
+            void worker_loop() {
+                uint64_t mDone = 0;
+                while (true) {
+                    if (fJobsPosted.load(std::memory_order_seq_cst) == mDone) {
+                        std::unique_lock<std::mutex> mLock(fMutex);
+                        fWorkerSleeping.store(true, std::memory_order_seq_cst);
+                        fCondition.wait(mLock, [this, mDone] { return fQuit || fJobsPosted.load(std::memory_order_seq_cst) != mDone; });
+                        fWorkerSleeping.store(false, std::memory_order_relaxed);
+                        if (fQuit) {
+                            return;
+                        }
+                    }
+                    fStage.process(fJobInput, fJobOutput);
+                    mDone++;
+                    fJobsDone.store(mDone, std::memory_order_release);
+                }
+            }
+        };
+
+        const uint32_t                          fSampleRate;
+        const uint32_t                          fPartitionSize;
+        const bool                              fBackgroundThread;
+        Stage                                   fHead;
+        std::vector<std::unique_ptr<TailStage>> fStages; /* only allocated if the impulse response is longer than the head */
+        uint32_t                                fLength = 0;
+        float                                   fWet    = 1.0f;
+        /* input and output of the current head partition, the output lags the input by one partition */
+        std::vector<float>                      fInput;
+        std::vector<float>                      fOutput;
+        std::vector<float>                      fHeadOutput;
+        uint32_t                                fFill = 0;
+
+        static uint32_t power_of_two(const uint32_t value) {
+            const uint32_t mValue = std::min(value, MAX_PARTITION_SIZE);
+            uint32_t       mSize  = MIN_PARTITION_SIZE;
+            while (mSize < mValue) {
+                mSize <<= 1;
+            }
+            return mSize;
+        }
+
+        void process_partition() {
+            fHead.process(fInput.data(), fHeadOutput.data());
+            for (auto& mStage : fStages) {
+                const float* mOutput = mStage->output();
+                for (uint32_t i = 0; i < fPartitionSize; i++) {
+                    fHeadOutput[i] += mOutput[i];
+                }
+                mStage->add(fInput.data(), fPartitionSize);
+            }
+            const float mDry = 1.0f - fWet;
+            for (uint32_t i = 0; i < fPartitionSize; i++) {
+                fOutput[i] = mDry * fInput[i] + fWet * fHeadOutput[i];
+            }
+        }
+
+        /* `accumulator += a * b` for complex numbers stored as `[real, imaginary][bin]` */
+        static void multiply_add(float* accumulator, const float* a, const float* b, const uint32_t stride) {
+#if KLANGWELLEN_SIMD_X86
+            if (BufferKernels::get_isa() >= BufferKernels::ISA_AVX2) {
+                multiply_add_avx2(accumulator, a, b, stride);
+                return;
+            }
+#endif
+            for (uint32_t k = 0; k < stride; k++) {
+                const float ar = a[k];
+                const float ai = a[stride + k];
+                const float br = b[k];
+                const float bi = b[stride + k];
+                accumulator[k] += ar * br - ai * bi;
+                accumulator[stride + k] += ar * bi + ai * br;
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        /* `stride` is a multiple of 8 */
+        KLANGWELLEN_TARGET_AVX2 static void multiply_add_avx2(float* accumulator, const float* a, const float* b, const uint32_t stride) {
+            for (uint32_t k = 0; k < stride; k += 8) {
+                const __m256 ar = _mm256_loadu_ps(a + k);
+                const __m256 ai = _mm256_loadu_ps(a + stride + k);
+                const __m256 br = _mm256_loadu_ps(b + k);
+                const __m256 bi = _mm256_loadu_ps(b + stride + k);
+                __m256       yr = _mm256_loadu_ps(accumulator + k);
+                __m256       yi = _mm256_loadu_ps(accumulator + stride + k);
+                yr              = _mm256_fnmadd_ps(ai, bi, _mm256_fmadd_ps(ar, br, yr));
+                yi              = _mm256_fmadd_ps(ai, br, _mm256_fmadd_ps(ar, bi, yi));
+                _mm256_storeu_ps(accumulator + k, yr);
+                _mm256_storeu_ps(accumulator + stride + k, yi);
+            }
+        }
+#endif
+
+        static std::vector<float> resample(const std::vector<float>& samples, const uint32_t from, const uint32_t to) {
+            const double       mStep   = static_cast<double>(from) / static_cast<double>(to);
+            const size_t       mLength = static_cast<size_t>(static_cast<double>(samples.size() - 1) / mStep) + 1;
+            /* keeps the gain, e.g the sum of the samples of a low pass impulse response */
+            const float        mGain   = static_cast<float>(mStep);
+            std::vector<float> mResampled(mLength);
+            for (size_t i = 0; i < mLength; i++) {
+                const double mPosition = static_cast<double>(i) * mStep;
+                const size_t j         = static_cast<size_t>(mPosition);
+                const float  t         = static_cast<float>(mPosition - static_cast<double>(j));
+                const float  a         = samples[j];
+                const float  b         = j + 1 < samples.size() ? samples[j + 1] : 0.0f;
+                mResampled[i]          = mGain * (a + (b - a) * t);
+            }
+            return mResampled;
+        }
+    };
+} // namespace klangwellen
@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 // @TODO Delay is broken, fix it
@@ -34,13 +35,20 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <algorithm>
+
 #include "KlangWellen.h"
 #include "AudioSignal.h"
+#include "AudioBuffer.h"
+#include "SilenceDetector.h"
 
 namespace klangwellen {
 
     /**
      * a delay line.
+     * <p>
+     * once input and echoes are below the silence threshold ( see `SilenceDetector` ) the block `process` functions
+     * clear the delay line and write zeros without processing until the input returns.
      */
     class Delay {
     public:
@@ -84,6 +92,32 @@ namespace klangwellen {
             return fWet;
         }
 
+        /**
+         * @param threshold amplitude below which input and output count as silent, 0 disables the silence detection
+         */
+        void set_silence_threshold(const float threshold) {
+            fSilence.set_threshold(threshold);
+        }
+
+        float get_silence_threshold() const {
+            return fSilence.get_threshold();
+        }
+
+        /**
+         * @return true if the delay skips processing because input and echoes are silent
+         */
+        bool is_sleeping() const {
+            return fSilence.is_sleeping();
+        }
+
+        /**
+         * @return estimated number of samples the echoes take to decay below the silence threshold after the input
+         *         stopped
+         */
+        uint32_t get_tail_length() const {
+            return SilenceDetector::decay_length(fBufferLength, fDecayRate * fWet, fSilence.get_threshold());
+        }
+
         float process(float signal) {
             adaptEchoLength();
 
@@ -101,20 +135,35 @@ namespace klangwellen {
 
         void process(float*         signal_buffer,
                      const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            if (fSilence.skip(signal_buffer, length)) {
+                std::fill_n(signal_buffer, length, 0.0f);
+                return;
+            }
             for (uint32_t i = 0; i < length; i++) {
                 signal_buffer[i] = process(signal_buffer[i]);
             }
+            if (fSilence.update(signal_buffer, length)) {
+                std::fill_n(fBuffer, fBufferLength, 0.0f);
+            }
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
         }
 
     private:
-        int32_t  fBufferPosition  = 0;
-        float    fDecayRate       = 0;
-        float    fWet             = 0;
-        float*   fBuffer          = nullptr;
-        bool     fAllocatedBuffer = false;
-        int32_t  fBufferLength    = 0;
-        float    fNewEchoLength   = 0;
-        uint32_t fSampleRate;
+        int32_t         fBufferPosition  = 0;
+        float           fDecayRate       = 0;
+        float           fWet             = 0;
+        float*          fBuffer          = nullptr;
+        bool            fAllocatedBuffer = false;
+        int32_t         fBufferLength    = 0;
+        float           fNewEchoLength   = 0;
+        uint32_t        fSampleRate;
+        SilenceDetector fSilence; /* holds for one delay length, the longest the output is silent while echoes remain */
 
         void adaptEchoLength() {
             if (fNewEchoLength > 0) {
@@ -136,6 +185,7 @@ namespace klangwellen {
                 fAllocatedBuffer = true;
                 fBuffer          = mNewBuffer;
                 fBufferLength    = mNewBufferLength;
+                fSilence.set_hold(mNewBufferLength);
             }
             fNewEchoLength = -1;
         }
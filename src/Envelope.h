@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t) *overwrite*
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 /**
@@ -73,6 +74,7 @@
 
 #include "KlangWellen.h"
 #include "AudioSignal.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
     class Envelope {
@@ -157,6 +159,14 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
         /**
          * clears all current stages from the envelope and creates a ramp from start to end value in specified duration.
          *
@@ -0,0 +1,211 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace klangwellen {
+    /**
+     * fast fourier transform of real signals with a power-of-two size.
+     * <p>
+     * a signal of `size` samples is transformed into `size / 2 + 1` complex bins ( DC up to nyquist ) stored as
+     * interleaved real and imaginary parts, i.e a spectrum has `size + 2` floats. the transform of size `N` is computed
+     * as a complex radix-2 transform of size `N / 2` with precomputed twiddle factors and bit-reversal table, so
+     * `forward` and `inverse` do not allocate memory and can be called from the audio thread.
+     * <p>
+     * the forward transform is not normalized, `inverse` divides by the size so that `inverse( forward( x ) ) == x`.
+     */
+    class FFT {
+    public:
+        static constexpr uint32_t MAX_SIZE = 1u << 31;
+
+        /**
+         * @param size size of the transform, rounded up to a power of two ( at least 4, at most `MAX_SIZE` )
+         */
+        explicit FFT(const uint32_t size) : fSize(power_of_two(size)),
+                                            fHalf(fSize / 2),
+                                            fWork(fSize),
+                                            fTwiddle(fHalf),
+                                            fRealTwiddle(fSize),
+                                            fReversed(fHalf) {
+            /* twiddle factors of the complex transform `exp( -2 PI i j / half )` ... */
+            for (uint32_t j = 0; j < fHalf / 2; j++) {
+                const double r      = 2.0 * M_PI * static_cast<double>(j) / static_cast<double>(fHalf);
+                fTwiddle[j * 2]     = static_cast<float>(std::cos(r));
+                fTwiddle[j * 2 + 1] = static_cast<float>(-std::sin(r));
+            }
+            /* ... and of the split into the real spectrum `exp( -2 PI i k / size )` */
+            for (uint32_t k = 0; k < fHalf; k++) {
+                const double r          = 2.0 * M_PI * static_cast<double>(k) / static_cast<double>(fSize);
+                fRealTwiddle[k * 2]     = static_cast<float>(std::cos(r));
+                fRealTwiddle[k * 2 + 1] = static_cast<float>(-std::sin(r));
+            }
+            uint8_t mBits = 0;
+            while ((1u << mBits) < fHalf) {
+                mBits++;
+            }
+            for (uint32_t i = 0; i < fHalf; i++) {
+                uint32_t mReversed = 0;
+                for (uint8_t b = 0; b < mBits; b++) {
+                    mReversed |= ((i >> b) & 1) << (mBits - 1 - b);
+                }
+                fReversed[i] = mReversed;
+            }
+        }
+
+        uint32_t get_size() const {
+            return fSize;
+        }
+
+        /**
+         * @return number of complex bins of a spectrum ( `size / 2 + 1` )
+         */
+        uint32_t get_num_bins() const {
+            return fHalf + 1;
+        }
+
+        size_t get_memory_size() const {
+            return (fWork.capacity() + fTwiddle.capacity() + fRealTwiddle.capacity()) * sizeof(float) + fReversed.capacity() * sizeof(uint32_t);
+        }
+
+        /**
+         * @param signal   `size` samples
+         * @param spectrum `size + 2` floats, interleaved real and imaginary parts of the bins
+         */
+        void forward(const float* signal, float* spectrum) {
+            /* the even and odd samples are the real and imaginary parts of a complex signal of half the size */
+            float* z = fWork.data();
+            for (uint32_t i = 0; i < fHalf; i++) {
+                const uint32_t j = fReversed[i];
+                z[j * 2]         = signal[i * 2];
+                z[j * 2 + 1]     = signal[i * 2 + 1];
+            }
+            transform(z, false);
+
+            spectrum[0]         = z[0] + z[1];
+            spectrum[1]         = 0.0f;
+            spectrum[fSize]     = z[0] - z[1];
+            spectrum[fSize + 1] = 0.0f;
+            for (uint32_t k = 1; k < fHalf; k++) {
+                const float zr = z[k * 2];
+                const float zi = z[k * 2 + 1];
+                const float cr = z[(fHalf - k) * 2];
+                const float ci = -z[(fHalf - k) * 2 + 1];
+                /* even part `( Z[k] + conj( Z[N/2 - k] ) ) / 2`, odd part `( Z[k] - conj( Z[N/2 - k] ) ) / 2i` */
+                const float er      = 0.5f * (zr + cr);
+                const float ei      = 0.5f * (zi + ci);
+                const float orr     = 0.5f * (zi - ci);
+                const float oi      = -0.5f * (zr - cr);
+                const float wr      = fRealTwiddle[k * 2];
+                const float wi      = fRealTwiddle[k * 2 + 1];
+                spectrum[k * 2]     = er + wr * orr - wi * oi;
+                spectrum[k * 2 + 1] = ei + wr * oi + wi * orr;
+            }
+        }
+
+        /**
+         * @param spectrum `size + 2` floats, interleaved real and imaginary parts of the bins
+         * @param signal   `size` samples
+         */
+        void inverse(const float* spectrum, float* signal) {
+            float* z = fWork.data();
+            for (uint32_t k = 0; k < fHalf; k++) {
+                const float xr = spectrum[k * 2];
+                const float xi = spectrum[k * 2 + 1];
+                const float cr = spectrum[(fHalf - k) * 2];
+                const float ci = -spectrum[(fHalf - k) * 2 + 1];
+                /* inverts the split of `forward`: `Z[k] = E + i O` with `E = ( X[k] + conj( X[N/2 - k] ) ) / 2` and
+                 * `O = ( X[k] - conj( X[N/2 - k] ) ) conj( W ) / 2` */
+                const float    er  = 0.5f * (xr + cr);
+                const float    ei  = 0.5f * (xi + ci);
+                const float    dr  = 0.5f * (xr - cr);
+                const float    di  = 0.5f * (xi - ci);
+                const float    wr  = fRealTwiddle[k * 2];
+                const float    wi  = -fRealTwiddle[k * 2 + 1];
+                const float    orr = dr * wr - di * wi;
+                const float    oi  = dr * wi + di * wr;
+                const uint32_t j   = fReversed[k];
+                z[j * 2]           = er - oi;
+                z[j * 2 + 1]       = ei + orr;
+            }
+            transform(z, true);
+
+            const float mScale = 1.0f / static_cast<float>(fHalf);
+            for (uint32_t i = 0; i < fSize; i++) {
+                signal[i] = z[i] * mScale;
+            }
+        }
+
+    private:
+        const uint32_t        fSize;
+        const uint32_t        fHalf;
+        std::vector<float>    fWork;
+        std::vector<float>    fTwiddle;
+        std::vector<float>    fRealTwiddle;
+        std::vector<uint32_t> fReversed;
+
+        static uint32_t power_of_two(const uint32_t value) {
+            const uint32_t mValue = std::min(value, MAX_SIZE);
+            uint32_t       mSize  = 4;
+            while (mSize < mValue) {
+                mSize <<= 1;
+            }
+            return mSize;
+        }
+
+        /* in-place radix-2 decimation-in-time transform of `fHalf` complex values in bit-reversed order */
+        void transform(float* z, const bool inverse) const {
+            const float mSign = inverse ? -1.0f : 1.0f;
+            /* the first pass only adds and subtracts neighbours */
+            for (uint32_t i = 0; i < fHalf * 2; i += 4) {
+                const float ar = z[i];
+                const float ai = z[i + 1];
+                const float br = z[i + 2];
+                const float bi = z[i + 3];
+                z[i]           = ar + br;
+                z[i + 1]       = ai + bi;
+                z[i + 2]       = ar - br;
+                z[i + 3]       = ai - bi;
+            }
+            for (uint32_t mLength = 4; mLength <= fHalf; mLength <<= 1) {
+                const uint32_t mSpan = mLength / 2;
+                const uint32_t mStep = fHalf / mLength;
+                for (uint32_t i = 0; i < fHalf; i += mLength) {
+                    float* __restrict a = z + i * 2;
+                    float* __restrict b = z + (i + mSpan) * 2;
+                    for (uint32_t j = 0; j < mSpan; j++) {
+                        const float wr = fTwiddle[j * mStep * 2];
+                        const float wi = fTwiddle[j * mStep * 2 + 1] * mSign;
+                        const float tr = b[j * 2] * wr - b[j * 2 + 1] * wi;
+                        const float ti = b[j * 2] * wi + b[j * 2 + 1] * wr;
+                        b[j * 2]       = a[j * 2] - tr;
+                        b[j * 2 + 1]   = a[j * 2 + 1] - ti;
+                        a[j * 2]       = a[j * 2] + tr;
+                        a[j * 2 + 1]   = a[j * 2 + 1] + ti;
+                    }
+                }
+            }
+        }
+    };
+} // namespace klangwellen
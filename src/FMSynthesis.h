@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -35,8 +36,14 @@
 
 #include "KlangWellen.h"
 #include "Wavetable.h"
+#include "WavetableBank.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
+    /**
+     * two operator FM synthesis from a carrier and a modulator `Wavetable`. see `FMSynthesisMultiOperator` for more
+     * operators, algorithms and many voices.
+     */
     class FMSynthesis {
     public:
         FMSynthesis(Wavetable* pCarrier, Wavetable* pModulator) : mAmplitude(1.0f),
@@ -44,20 +51,34 @@ namespace klangwellen {
                                                                   mModulationDepth(1.0f),
                                                                   mModulator(pModulator) {
             fDeleteCarrier = false;
+            fOwnCarrier    = nullptr;
+            fOwnModulator  = nullptr;
         }
 
+        /**
+         * creates carrier and modulator from the sine table shared via `WavetableBank`.
+         */
         FMSynthesis(const uint32_t wavetable_size, const uint32_t sampling_rate) : mAmplitude(1.0f),
-                                                                                   mCarrier(new Wavetable(wavetable_size, sampling_rate)),
+                                                                                   mCarrier(new Wavetable(WavetableBank::acquire(KlangWellen::WAVEFORM_SINE, wavetable_size), sampling_rate)),
                                                                                    mModulationDepth(1.0f),
-                                                                                   mModulator(new Wavetable(wavetable_size, sampling_rate)) {
+                                                                                   mModulator(new Wavetable(WavetableBank::acquire(KlangWellen::WAVEFORM_SINE, wavetable_size), sampling_rate)) {
             mCarrier->set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
-            Wavetable::fill(mCarrier->get_wavetable(), mCarrier->get_wavetable_size(), KlangWellen::WAVEFORM_SINE);
-
             mModulator->set_interpolation(KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR);
-            Wavetable::fill(mModulator->get_wavetable(), mModulator->get_wavetable_size(), KlangWellen::WAVEFORM_SINE);
             fDeleteCarrier = true;
+            fOwnCarrier    = mCarrier;
+            fOwnModulator  = mModulator;
+        }
+
+        ~FMSynthesis() {
+            if (fDeleteCarrier) {
+                delete fOwnCarrier;
+                delete fOwnModulator;
+            }
         }
 
+        FMSynthesis(const FMSynthesis&)            = delete;
+        FMSynthesis& operator=(const FMSynthesis&) = delete;
+
         Wavetable* get_modulator() const {
             return mModulator;
         }
@@ -103,11 +124,21 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) const {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
     private:
         float      mAmplitude;
         Wavetable* mCarrier;
         float      mModulationDepth;
         Wavetable* mModulator;
         bool       fDeleteCarrier;
+        Wavetable* fOwnCarrier;
+        Wavetable* fOwnModulator;
     };
 } // namespace klangwellen
\ No newline at end of file
@@ -0,0 +1,767 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [x] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t) *overwrite*
+ * - [x] void process(float*, float*, uint32_t) *overwrite*
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "BufferKernels.h"
+#include "WavetableBank.h"
+
+namespace klangwellen {
+    /**
+     * polyphonic phase modulation synthesizer with up to 6 sine operators per voice.
+     * <p>
+     * each operator runs at the frequency of its voice multiplied by a ratio plus a detune in Hz and has its own level
+     * and ADSR envelope. the operators are connected by a modulation matrix: the output of operator `source` shifts
+     * the phase of operator `target` by `amount * output` radians. operators are computed from the highest to the
+     * lowest index, i.e a higher operator modulates a lower one with the current sample and a lower operator modulates a
+     * higher one with the previous sample. each operator can modulate itself ( feedback ) with the average of its last
+     * two outputs. the output of a voice is the sum of the operators weighted by their carrier level.
+     * <p>
+     * the voices are the SIMD lanes: the state of all operators of all voices is stored in structure-of-arrays form and 8
+     * ( AVX2 ) or 16 ( AVX-512 ) voices are computed by one instruction. the sine is read from a 32-bit fixed-point phase
+     * with linear interpolation from a table shared via `WavetableBank`. envelopes are evaluated every 32 samples and
+     * interpolated linearly, voices whose envelopes are idle are skipped.
+     * <p>
+     * `set_algorithm` selects one of the built-in algorithms, `set_modulation` and `set_carrier` edit the matrix.
+     */
+    class FMSynthesisMultiOperator {
+    public:
+        static constexpr uint8_t MAX_OPERATORS = 6;
+
+        /** operator `n` modulates operator `n-1`, operator 0 is the only carrier */
+        static constexpr uint8_t ALGORITHM_STACK = 0;
+        /** stacks of two operators ( 1 -> 0, 3 -> 2, 5 -> 4 ), even operators are carriers */
+        static constexpr uint8_t ALGORITHM_PAIRS = 1;
+        /** all other operators modulate operator 0, which is the only carrier */
+        static constexpr uint8_t ALGORITHM_BRANCH = 2;
+        /** the highest operator modulates all other operators, which are carriers */
+        static constexpr uint8_t ALGORITHM_ONE_TO_MANY = 3;
+        /** all operators are carriers ( additive ) */
+        static constexpr uint8_t ALGORITHM_PARALLEL = 4;
+        static constexpr uint8_t NUM_ALGORITHMS     = 5;
+
+        /**
+         * @param num_voices    number of voices
+         * @param num_operators number of operators per voice ( 1 ... 6 )
+         * @param sampling_rate sampling rate
+         */
+        FMSynthesisMultiOperator(const uint32_t num_voices,
+                                 const uint8_t  num_operators = MAX_OPERATORS,
+                                 const uint32_t sampling_rate = KlangWellen::DEFAULT_SAMPLE_RATE) : fNumVoices(num_voices),
+                                                                                                    fNumPadded((num_voices + LANES - 1) / LANES * LANES),
+                                                                                                    fNumOperators(num_operators < 1 ? 1 : (num_operators > MAX_OPERATORS ? MAX_OPERATORS : num_operators)),
+                                                                                                    fSamplingRate(sampling_rate),
+                                                                                                    fSine(WavetableBank::acquire(KlangWellen::WAVEFORM_SINE, TABLE_SIZE)),
+                                                                                                    fAmplitude(1.0f),
+                                                                                                    fFrequency(fNumPadded, 0.0f),
+                                                                                                    fVelocity(fNumPadded, 0.0f),
+                                                                                                    fActive(fNumPadded, 0),
+                                                                                                    fPhase(static_cast<size_t>(fNumOperators) * fNumPadded, 0),
+                                                                                                    fIncrement(static_cast<size_t>(fNumOperators) * fNumPadded, 0),
+                                                                                                    fOutput(static_cast<size_t>(fNumOperators) * fNumPadded, 0.0f),
+                                                                                                    fOutputPrevious(static_cast<size_t>(fNumOperators) * fNumPadded, 0.0f),
+                                                                                                    fEnvelope(static_cast<size_t>(fNumOperators) * fNumPadded, 0.0f),
+                                                                                                    fEnvelopeDelta(static_cast<size_t>(fNumOperators) * fNumPadded, 0.0f),
+                                                                                                    fEnvelopeLevel(static_cast<size_t>(fNumOperators) * fNumPadded, 0.0f),
+                                                                                                    fEnvelopeRelease(static_cast<size_t>(fNumOperators) * fNumPadded, 0.0f),
+                                                                                                    fEnvelopeStage(static_cast<size_t>(fNumOperators) * fNumPadded, IDLE),
+                                                                                                    fAccumulator(static_cast<size_t>(CHUNK_SIZE) * LANES, 0.0f) {
+            for (uint8_t k = 0; k < MAX_OPERATORS; k++) {
+                Operator& mOperator = fOperators[k];
+                mOperator.ratio     = 1.0f;
+                mOperator.detune    = 0.0f;
+                mOperator.level     = 1.0f;
+                mOperator.feedback  = 0.0f;
+                mOperator.carrier   = 0.0f;
+                mOperator.attack    = KlangWellen::DEFAULT_ATTACK;
+                mOperator.decay     = KlangWellen::DEFAULT_DECAY;
+                mOperator.sustain   = KlangWellen::DEFAULT_SUSTAIN;
+                mOperator.release   = KlangWellen::DEFAULT_RELEASE;
+                for (uint8_t j = 0; j < MAX_OPERATORS; j++) {
+                    fModulation[k][j] = 0.0f;
+                }
+            }
+            set_algorithm(ALGORITHM_STACK);
+        }
+
+        uint32_t get_num_voices() const {
+            return fNumVoices;
+        }
+
+        uint8_t get_num_operators() const {
+            return fNumOperators;
+        }
+
+        /**
+         * replaces the modulation matrix and the carrier levels with one of the built-in algorithms ( e.g
+         * `ALGORITHM_STACK` ). modulation amounts are set to 1.0 and carriers to `1 / number of carriers`, feedback is
+         * not changed.
+         */
+        void set_algorithm(const uint8_t algorithm) {
+            fAlgorithm = algorithm < NUM_ALGORITHMS ? algorithm : ALGORITHM_STACK;
+            for (uint8_t k = 0; k < MAX_OPERATORS; k++) {
+                fOperators[k].carrier = 0.0f;
+                for (uint8_t j = 0; j < MAX_OPERATORS; j++) {
+                    fModulation[k][j] = 0.0f;
+                }
+            }
+            const uint8_t N = fNumOperators;
+            for (uint8_t k = 0; k < N; k++) {
+                switch (fAlgorithm) {
+                    case ALGORITHM_PAIRS:
+                        if (k % 2 == 0) {
+                            fOperators[k].carrier = 1.0f;
+                        } else {
+                            fModulation[k - 1][k] = 1.0f;
+                        }
+                        break;
+                    case ALGORITHM_BRANCH:
+                        if (k == 0) {
+                            fOperators[k].carrier = 1.0f;
+                        } else {
+                            fModulation[0][k] = 1.0f;
+                        }
+                        break;
+                    case ALGORITHM_ONE_TO_MANY:
+                        if (k == N - 1 && N > 1) {
+                            for (uint8_t j = 0; j < k; j++) {
+                                fModulation[j][k] = 1.0f;
+                            }
+                        } else {
+                            fOperators[k].carrier = 1.0f;
+                        }
+                        break;
+                    case ALGORITHM_PARALLEL:
+                        fOperators[k].carrier = 1.0f;
+                        break;
+                    default:
+                        if (k == 0) {
+                            fOperators[k].carrier = 1.0f;
+                        } else {
+                            fModulation[k - 1][k] = 1.0f;
+                        }
+                        break;
+                }
+            }
+            uint8_t mCarriers = 0;
+            for (uint8_t k = 0; k < N; k++) {
+                mCarriers += fOperators[k].carrier > 0.0f ? 1 : 0;
+            }
+            for (uint8_t k = 0; k < N; k++) {
+                fOperators[k].carrier /= static_cast<float>(mCarriers);
+            }
+            update_matrix();
+        }
+
+        uint8_t get_algorithm() const {
+            return fAlgorithm;
+        }
+
+        /**
+         * sets the amount by which the output of operator `source` modulates the phase of operator `target` ( in
+         * radians per unit ). use `set_feedback` for `source == target`.
+         */
+        void set_modulation(const uint8_t source, const uint8_t target, const float amount) {
+            if (source < fNumOperators && target < fNumOperators && source != target) {
+                fModulation[target][source] = amount;
+                update_matrix();
+            }
+        }
+
+        float get_modulation(const uint8_t source, const uint8_t target) const {
+            return source < MAX_OPERATORS && target < MAX_OPERATORS ? fModulation[target][source] : 0.0f;
+        }
+
+        /**
+         * sets the level with which an operator is added to the output of a voice. operators with a level of 0.0 are
+         * only modulators.
+         */
+        void set_carrier(const uint8_t op, const float level) {
+            if (op < fNumOperators) {
+                fOperators[op].carrier = level;
+                update_matrix();
+            }
+        }
+
+        float get_carrier(const uint8_t op) const {
+            return op < MAX_OPERATORS ? fOperators[op].carrier : 0.0f;
+        }
+
+        /**
+         * sets the amount by which an operator modulates itself ( in radians per unit ).
+         */
+        void set_feedback(const uint8_t op, const float feedback) {
+            if (op < fNumOperators) {
+                fOperators[op].feedback = feedback;
+                update_matrix();
+            }
+        }
+
+        float get_feedback(const uint8_t op) const {
+            return op < MAX_OPERATORS ? fOperators[op].feedback : 0.0f;
+        }
+
+        /**
+         * sets the frequency of an operator to `voice frequency * ratio + detune`.
+         */
+        void set_operator_frequency(const uint8_t op, const float ratio, const float detune = 0.0f) {
+            if (op < fNumOperators) {
+                fOperators[op].ratio  = ratio;
+                fOperators[op].detune = detune;
+                for (uint32_t v = 0; v < fNumVoices; v++) {
+                    update_increment(op, v);
+                }
+            }
+        }
+
+        float get_operator_ratio(const uint8_t op) const {
+            return op < MAX_OPERATORS ? fOperators[op].ratio : 0.0f;
+        }
+
+        float get_operator_detune(const uint8_t op) const {
+            return op < MAX_OPERATORS ? fOperators[op].detune : 0.0f;
+        }
+
+        /**
+         * sets the output level of an operator, for modulators this is the modulation index.
+         */
+        void set_operator_level(const uint8_t op, const float level) {
+            if (op < fNumOperators) {
+                fOperators[op].level = level;
+            }
+        }
+
+        float get_operator_level(const uint8_t op) const {
+            return op < MAX_OPERATORS ? fOperators[op].level : 0.0f;
+        }
+
+        /**
+         * sets the envelope of an operator.
+         *
+         * @param attack  attack time in seconds
+         * @param decay   decay time in seconds
+         * @param sustain sustain level ( 0.0 ... 1.0 )
+         * @param release release time in seconds
+         */
+        void set_operator_envelope(const uint8_t op, const float attack, const float decay, const float sustain, const float release) {
+            if (op < fNumOperators) {
+                fOperators[op].attack  = attack;
+                fOperators[op].decay   = decay;
+                fOperators[op].sustain = sustain;
+                fOperators[op].release = release;
+            }
+        }
+
+        float get_amplitude() const {
+            return fAmplitude;
+        }
+
+        void set_amplitude(const float amplitude) {
+            fAmplitude = amplitude;
+        }
+
+        /**
+         * starts the envelopes of a voice. a voice that is idle starts with all phases at 0, a voice that is still
+         * sounding restarts its envelopes from their current level.
+         */
+        void note_on(const uint32_t voice, const float frequency, const float velocity = 1.0f) {
+            if (voice >= fNumVoices) {
+                return;
+            }
+            const bool mIdle = !is_active(voice);
+            fVelocity[voice] = velocity;
+            set_frequency(voice, frequency);
+            for (uint8_t k = 0; k < fNumOperators; k++) {
+                const size_t n = index(k, voice);
+                if (mIdle) {
+                    fPhase[n]          = 0;
+                    fOutput[n]         = 0.0f;
+                    fOutputPrevious[n] = 0.0f;
+                    fEnvelopeLevel[n]  = 0.0f;
+                }
+                fEnvelopeStage[n] = ATTACK;
+            }
+            fActive[voice] = 1;
+        }
+
+        /**
+         * starts the release stage of the envelopes of a voice.
+         */
+        void note_off(const uint32_t voice) {
+            if (voice >= fNumVoices) {
+                return;
+            }
+            for (uint8_t k = 0; k < fNumOperators; k++) {
+                const size_t n = index(k, voice);
+                if (fEnvelopeStage[n] != IDLE) {
+                    fEnvelopeStage[n]   = RELEASE;
+                    fEnvelopeRelease[n] = rate(fEnvelopeLevel[n], fOperators[k].release);
+                }
+            }
+        }
+
+        /**
+         * @return true if any envelope of the voice is not idle
+         */
+        bool is_active(const uint32_t voice) const {
+            if (voice >= fNumVoices) {
+                return false;
+            }
+            for (uint8_t k = 0; k < fNumOperators; k++) {
+                if (fEnvelopeStage[index(k, voice)] != IDLE) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void set_frequency(const uint32_t voice, const float frequency) {
+            if (voice < fNumVoices) {
+                fFrequency[voice] = frequency;
+                for (uint8_t k = 0; k < fNumOperators; k++) {
+                    update_increment(k, voice);
+                }
+            }
+        }
+
+        float get_frequency(const uint32_t voice) const {
+            return voice < fNumVoices ? fFrequency[voice] : 0.0f;
+        }
+
+        /**
+         * @return next sample of the sum of all voices
+         */
+        float process() {
+            float mSample;
+            process(&mSample, 1);
+            return mSample;
+        }
+
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            for (uint32_t mStart = 0; mStart < buffer_length; mStart += CHUNK_SIZE) {
+                const uint32_t mLength = std::min(CHUNK_SIZE, buffer_length - mStart);
+                float*         mOutput = signal_buffer + mStart;
+                update_envelopes(mLength);
+                uint32_t mLanes;
+                switch (BufferKernels::get_isa()) {
+#if KLANGWELLEN_SIMD_X86
+                    case BufferKernels::ISA_AVX512:
+                        render_avx512(mLength);
+                        mLanes = 16;
+                        break;
+                    case BufferKernels::ISA_AVX2:
+                        render_avx2(mLength);
+                        mLanes = 8;
+                        break;
+#endif
+                    default:
+                        render_scalar(mLength);
+                        mLanes = 1;
+                        break;
+                }
+                /* sum the lanes of the accumulator */
+                for (uint32_t i = 0; i < mLength; i++) {
+                    float mSum = 0.0f;
+                    for (uint32_t j = 0; j < mLanes; j++) {
+                        mSum += fAccumulator[i * mLanes + j];
+                    }
+                    mOutput[i] = mSum * fAmplitude;
+                }
+            }
+        }
+
+        void process(float* signal_buffer_left, float* signal_buffer_right, const uint32_t buffer_length) {
+            process(signal_buffer_left, buffer_length);
+            std::copy_n(signal_buffer_left, buffer_length, signal_buffer_right);
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
+    private:
+        static constexpr uint32_t LANES               = 16;
+        static constexpr uint32_t CHUNK_SIZE          = 32;
+        static constexpr uint32_t TABLE_SIZE          = 4096;
+        static constexpr uint32_t PHASE_SHIFT         = 20; /* 32 - log2(TABLE_SIZE) */
+        static constexpr double   NORMALIZED_TO_PHASE = 4294967296.0;
+
+        enum ENVELOPE_STAGE : uint8_t {
+            IDLE,
+            ATTACK,
+            DECAY,
+            SUSTAIN,
+            RELEASE
+        };
+
+        struct Operator {
+            float ratio;
+            float detune;
+            float level;
+            float feedback;
+            float carrier;
+            float attack;
+            float decay;
+            float sustain;
+            float release;
+        };
+
+        const uint32_t                 fNumVoices;
+        const uint32_t                 fNumPadded;
+        const uint8_t                  fNumOperators;
+        const uint32_t                 fSamplingRate;
+        WavetableBank::SharedWavetable fSine;
+        float                          fAmplitude;
+        uint8_t                        fAlgorithm;
+        Operator                       fOperators[MAX_OPERATORS];
+        float                          fModulation[MAX_OPERATORS][MAX_OPERATORS];
+        /* matrix in the form used by the kernels, amounts are in cycles per unit */
+        uint8_t                        fNumSources[MAX_OPERATORS];
+        uint8_t                        fSources[MAX_OPERATORS][MAX_OPERATORS];
+        float                          fSourceAmount[MAX_OPERATORS][MAX_OPERATORS];
+        float                          fFeedbackAmount[MAX_OPERATORS];
+        float                          fCarrierLevel[MAX_OPERATORS];
+        std::vector<float>             fFrequency;
+        std::vector<float>             fVelocity;
+        std::vector<uint8_t>           fActive;
+        /* per operator and voice, `[operator * fNumPadded + voice]` */
+        std::vector<uint32_t>          fPhase;
+        std::vector<uint32_t>          fIncrement;
+        std::vector<float>             fOutput;
+        std::vector<float>             fOutputPrevious;
+        std::vector<float>             fEnvelope;
+        std::vector<float>             fEnvelopeDelta;
+        std::vector<float>             fEnvelopeLevel;
+        std::vector<float>             fEnvelopeRelease;
+        std::vector<uint8_t>           fEnvelopeStage;
+        std::vector<float>             fAccumulator;
+
+        size_t index(const uint8_t op, const uint32_t voice) const {
+            return static_cast<size_t>(op) * fNumPadded + voice;
+        }
+
+        void update_increment(const uint8_t op, const uint32_t voice) {
+            const double mFrequency      = static_cast<double>(fFrequency[voice]) * fOperators[op].ratio + fOperators[op].detune;
+            const double mNormalized     = std::fabs(mFrequency) / fSamplingRate;
+            const double mFraction       = mNormalized - floor(mNormalized);
+            fIncrement[index(op, voice)] = static_cast<uint32_t>(static_cast<uint64_t>(mFraction * NORMALIZED_TO_PHASE + 0.5) & 0xFFFFFFFF);
+        }
+
+        void update_matrix() {
+            const float mRadiansToCycles = static_cast<float>(1.0 / TWO_PI);
+            for (uint8_t k = 0; k < MAX_OPERATORS; k++) {
+                fNumSources[k] = 0;
+                if (k >= fNumOperators) {
+                    fFeedbackAmount[k] = 0.0f;
+                    fCarrierLevel[k]   = 0.0f;
+                    continue;
+                }
+                for (uint8_t j = 0; j < fNumOperators; j++) {
+                    if (j != k && fModulation[k][j] != 0.0f) {
+                        fSources[k][fNumSources[k]]      = j;
+                        fSourceAmount[k][fNumSources[k]] = fModulation[k][j] * mRadiansToCycles;
+                        fNumSources[k]++;
+                    }
+                }
+                /* feedback uses the average of the last two outputs */
+                fFeedbackAmount[k] = fOperators[k].feedback * mRadiansToCycles * 0.5f;
+                fCarrierLevel[k]   = fOperators[k].carrier;
+            }
+        }
+
+        /* per sample rate of a segment that covers `distance` in `time` seconds */
+        float rate(const float distance, const float time) const {
+            const float mSamples = time * static_cast<float>(fSamplingRate);
+            return mSamples > 1.0f ? distance / mSamples : distance;
+        }
+
+        /* advances the envelope of one operator of one voice by `samples` */
+        void advance_envelope(const uint8_t op, const size_t n, uint32_t samples) {
+            const Operator& mOperator = fOperators[op];
+            float&          mLevel    = fEnvelopeLevel[n];
+            uint8_t&        mStage    = fEnvelopeStage[n];
+            while (samples > 0) {
+                float mTarget;
+                float mRate;
+                switch (mStage) {
+                    case ATTACK:
+                        mTarget = 1.0f;
+                        mRate   = rate(1.0f, mOperator.attack);
+                        break;
+                    case DECAY:
+                        mTarget = mOperator.sustain;
+                        mRate   = -rate(1.0f - mOperator.sustain, mOperator.decay);
+                        break;
+                    case RELEASE:
+                        mTarget = 0.0f;
+                        mRate   = -fEnvelopeRelease[n];
+                        break;
+                    case SUSTAIN:
+                        mLevel = mOperator.sustain;
+                        return;
+                    default:
+                        mLevel = 0.0f;
+                        return;
+                }
+                const float    mDistance = mTarget - mLevel;
+                const uint32_t mSteps    = mRate == 0.0f || mDistance * mRate <= 0.0f ? 0 : static_cast<uint32_t>(std::ceil(mDistance / mRate));
+                if (mSteps > samples) {
+                    mLevel += mRate * static_cast<float>(samples);
+                    return;
+                }
+                samples -= mSteps;
+                mLevel = mTarget;
+                mStage = mStage == ATTACK ? DECAY : (mStage == DECAY ? SUSTAIN : IDLE);
+            }
+        }
+
+        /* computes start value and per sample increment of the envelopes for the next chunk */
+        void update_envelopes(const uint32_t length) {
+            const float mScale = 1.0f / static_cast<float>(length);
+            for (uint32_t v = 0; v < fNumVoices; v++) {
+                fActive[v] = is_active(v) ? 1 : 0;
+                for (uint8_t k = 0; k < fNumOperators; k++) {
+                    const size_t n     = index(k, v);
+                    const float  mFrom = fEnvelopeLevel[n];
+                    advance_envelope(k, n, length);
+                    fEnvelope[n]      = mFrom * fOperators[k].level;
+                    fEnvelopeDelta[n] = (fEnvelopeLevel[n] - mFrom) * fOperators[k].level * mScale;
+                }
+            }
+        }
+
+        bool is_group_active(const uint32_t voice, const uint32_t lanes) const {
+            for (uint32_t j = 0; j < lanes; j++) {
+                if (fActive[voice + j]) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /*
+         * the kernels compute the operators of a group of voices over the chunk, keeping their state in registers, and
+         * accumulate the voices into `fAccumulator` ( one vector per sample ).
+         */
+        void render_scalar(const uint32_t length) {
+            std::fill(fAccumulator.begin(), fAccumulator.end(), 0.0f);
+            constexpr float    mFractionScale = 1.0f / static_cast<float>(1u << PHASE_SHIFT);
+            constexpr uint32_t mFractionMask  = (1u << PHASE_SHIFT) - 1;
+            const float*       mTable         = fSine.get();
+            for (uint32_t v = 0; v < fNumVoices; v++) {
+                if (!fActive[v]) {
+                    continue;
+                }
+                uint32_t mPhase[MAX_OPERATORS];
+                uint32_t mIncrement[MAX_OPERATORS];
+                float    mOutput[MAX_OPERATORS];
+                float    mPrevious[MAX_OPERATORS];
+                float    mEnvelope[MAX_OPERATORS];
+                float    mDelta[MAX_OPERATORS];
+                for (uint8_t k = 0; k < fNumOperators; k++) {
+                    const size_t n = index(k, v);
+                    mPhase[k]      = fPhase[n];
+                    mIncrement[k]  = fIncrement[n];
+                    mOutput[k]     = fOutput[n];
+                    mPrevious[k]   = fOutputPrevious[n];
+                    mEnvelope[k]   = fEnvelope[n];
+                    mDelta[k]      = fEnvelopeDelta[n];
+                }
+                for (uint32_t i = 0; i < length; i++) {
+                    float mSum = 0.0f;
+                    for (int8_t k = static_cast<int8_t>(fNumOperators - 1); k >= 0; k--) {
+                        float mModulation = fFeedbackAmount[k] * (mOutput[k] + mPrevious[k]);
+                        for (uint8_t s = 0; s < fNumSources[k]; s++) {
+                            mModulation += fSourceAmount[k][s] * mOutput[fSources[k][s]];
+                        }
+                        mModulation -= std::floor(mModulation);
+                        const uint32_t p       = mPhase[k] + static_cast<uint32_t>(static_cast<int64_t>(mModulation * 4294967296.0f));
+                        const uint32_t mIndex  = p >> PHASE_SHIFT;
+                        const float    mFrac   = static_cast<float>(p & mFractionMask) * mFractionScale;
+                        const float    a       = mTable[mIndex];
+                        const float    b       = mTable[(mIndex + 1) & (TABLE_SIZE - 1)];
+                        const float    mSample = (a + mFrac * (b - a)) * mEnvelope[k];
+                        mPrevious[k]           = mOutput[k];
+                        mOutput[k]             = mSample;
+                        mSum += fCarrierLevel[k] * mSample;
+                        mPhase[k] += mIncrement[k];
+                        mEnvelope[k] += mDelta[k];
+                    }
+                    fAccumulator[i] += mSum * fVelocity[v];
+                }
+                for (uint8_t k = 0; k < fNumOperators; k++) {
+                    const size_t n     = index(k, v);
+                    fPhase[n]          = mPhase[k];
+                    fOutput[n]         = mOutput[k];
+                    fOutputPrevious[n] = mPrevious[k];
+                }
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        KLANGWELLEN_TARGET_AVX2
+        void render_avx2(const uint32_t length) {
+            constexpr uint32_t mLanes = 8;
+            std::fill(fAccumulator.begin(), fAccumulator.end(), 0.0f);
+            const __m256  mFractionScale = _mm256_set1_ps(1.0f / static_cast<float>(1u << PHASE_SHIFT));
+            const __m256i mFractionMask  = _mm256_set1_epi32((1 << PHASE_SHIFT) - 1);
+            const __m256i mTableMask     = _mm256_set1_epi32(TABLE_SIZE - 1);
+            const __m256i mOne           = _mm256_set1_epi32(1);
+            const __m256  mPhaseScale    = _mm256_set1_ps(4294967296.0f);
+            const float*  mTable         = fSine.get();
+            for (uint32_t v = 0; v < fNumPadded; v += mLanes) {
+                if (!is_group_active(v, mLanes)) {
+                    continue;
+                }
+                __m256i mPhase[MAX_OPERATORS];
+                __m256i mIncrement[MAX_OPERATORS];
+                __m256  mOutput[MAX_OPERATORS];
+                __m256  mPrevious[MAX_OPERATORS];
+                __m256  mEnvelope[MAX_OPERATORS];
+                __m256  mDelta[MAX_OPERATORS];
+                for (uint8_t k = 0; k < fNumOperators; k++) {
+                    const size_t n = index(k, v);
+                    mPhase[k]      = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fPhase.data() + n));
+                    mIncrement[k]  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fIncrement.data() + n));
+                    mOutput[k]     = _mm256_loadu_ps(fOutput.data() + n);
+                    mPrevious[k]   = _mm256_loadu_ps(fOutputPrevious.data() + n);
+                    mEnvelope[k]   = _mm256_loadu_ps(fEnvelope.data() + n);
+                    mDelta[k]      = _mm256_loadu_ps(fEnvelopeDelta.data() + n);
+                }
+                const __m256 mVelocity = _mm256_loadu_ps(fVelocity.data() + v);
+                for (uint32_t i = 0; i < length; i++) {
+                    __m256 mSum = _mm256_setzero_ps();
+                    for (int8_t k = static_cast<int8_t>(fNumOperators - 1); k >= 0; k--) {
+                        __m256 mModulation = _mm256_mul_ps(_mm256_set1_ps(fFeedbackAmount[k]), _mm256_add_ps(mOutput[k], mPrevious[k]));
+                        for (uint8_t s = 0; s < fNumSources[k]; s++) {
+                            mModulation = _mm256_fmadd_ps(_mm256_set1_ps(fSourceAmount[k][s]), mOutput[fSources[k][s]], mModulation);
+                        }
+                        /* the fraction ( -0.5 ... 0.5 ) of the modulation in cycles as a fixed-point phase */
+                        mModulation           = _mm256_sub_ps(mModulation, _mm256_round_ps(mModulation, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+                        const __m256i p       = _mm256_add_epi32(mPhase[k], _mm256_cvtps_epi32(_mm256_mul_ps(mModulation, mPhaseScale)));
+                        const __m256i mIndex  = _mm256_srli_epi32(p, PHASE_SHIFT);
+                        const __m256  mFrac   = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(p, mFractionMask)), mFractionScale);
+                        const __m256  a       = _mm256_i32gather_ps(mTable, mIndex, 4);
+                        const __m256  b       = _mm256_i32gather_ps(mTable, _mm256_and_si256(_mm256_add_epi32(mIndex, mOne), mTableMask), 4);
+                        const __m256  mSample = _mm256_mul_ps(_mm256_fmadd_ps(mFrac, _mm256_sub_ps(b, a), a), mEnvelope[k]);
+                        mPrevious[k]          = mOutput[k];
+                        mOutput[k]            = mSample;
+                        mSum                  = _mm256_fmadd_ps(_mm256_set1_ps(fCarrierLevel[k]), mSample, mSum);
+                        mPhase[k]             = _mm256_add_epi32(mPhase[k], mIncrement[k]);
+                        mEnvelope[k]          = _mm256_add_ps(mEnvelope[k], mDelta[k]);
+                    }
+                    float* mAccumulator = fAccumulator.data() + i * mLanes;
+                    _mm256_storeu_ps(mAccumulator, _mm256_fmadd_ps(mSum, mVelocity, _mm256_loadu_ps(mAccumulator)));
+                }
+                for (uint8_t k = 0; k < fNumOperators; k++) {
+                    const size_t n = index(k, v);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(fPhase.data() + n), mPhase[k]);
+                    _mm256_storeu_ps(fOutput.data() + n, mOutput[k]);
+                    _mm256_storeu_ps(fOutputPrevious.data() + n, mPrevious[k]);
+                }
+            }
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        void render_avx512(const uint32_t length) {
+            constexpr uint32_t mLanes = 16;
+            std::fill(fAccumulator.begin(), fAccumulator.end(), 0.0f);
+            const __m512  mFractionScale = _mm512_set1_ps(1.0f / static_cast<float>(1u << PHASE_SHIFT));
+            const __m512i mFractionMask  = _mm512_set1_epi32((1 << PHASE_SHIFT) - 1);
+            const __m512i mTableMask     = _mm512_set1_epi32(TABLE_SIZE - 1);
+            const __m512i mOne           = _mm512_set1_epi32(1);
+            const __m512  mPhaseScale    = _mm512_set1_ps(4294967296.0f);
+            const float*  mTable         = fSine.get();
+            for (uint32_t v = 0; v < fNumPadded; v += mLanes) {
+                if (!is_group_active(v, mLanes)) {
+                    continue;
+                }
+                __m512i mPhase[MAX_OPERATORS];
+                __m512i mIncrement[MAX_OPERATORS];
+                __m512  mOutput[MAX_OPERATORS];
+                __m512  mPrevious[MAX_OPERATORS];
+                __m512  mEnvelope[MAX_OPERATORS];
+                __m512  mDelta[MAX_OPERATORS];
+                for (uint8_t k = 0; k < fNumOperators; k++) {
+                    const size_t n = index(k, v);
+                    mPhase[k]      = _mm512_loadu_si512(fPhase.data() + n);
+                    mIncrement[k]  = _mm512_loadu_si512(fIncrement.data() + n);
+                    mOutput[k]     = _mm512_loadu_ps(fOutput.data() + n);
+                    mPrevious[k]   = _mm512_loadu_ps(fOutputPrevious.data() + n);
+                    mEnvelope[k]   = _mm512_loadu_ps(fEnvelope.data() + n);
+                    mDelta[k]      = _mm512_loadu_ps(fEnvelopeDelta.data() + n);
+                }
+                const __m512 mVelocity = _mm512_loadu_ps(fVelocity.data() + v);
+                for (uint32_t i = 0; i < length; i++) {
+                    __m512 mSum = _mm512_setzero_ps();
+                    for (int8_t k = static_cast<int8_t>(fNumOperators - 1); k >= 0; k--) {
+                        __m512 mModulation = _mm512_mul_ps(_mm512_set1_ps(fFeedbackAmount[k]), _mm512_add_ps(mOutput[k], mPrevious[k]));
+                        for (uint8_t s = 0; s < fNumSources[k]; s++) {
+                            mModulation = _mm512_fmadd_ps(_mm512_set1_ps(fSourceAmount[k][s]), mOutput[fSources[k][s]], mModulation);
+                        }
+                        mModulation           = _mm512_sub_ps(mModulation, _mm512_roundscale_ps(mModulation, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+                        const __m512i p       = _mm512_add_epi32(mPhase[k], _mm512_cvtps_epi32(_mm512_mul_ps(mModulation, mPhaseScale)));
+                        const __m512i mIndex  = _mm512_srli_epi32(p, PHASE_SHIFT);
+                        const __m512  mFrac   = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(p, mFractionMask)), mFractionScale);
+                        const __m512  a       = _mm512_i32gather_ps(mIndex, mTable, 4);
+                        const __m512  b       = _mm512_i32gather_ps(_mm512_and_si512(_mm512_add_epi32(mIndex, mOne), mTableMask), mTable, 4);
+                        const __m512  mSample = _mm512_mul_ps(_mm512_fmadd_ps(mFrac, _mm512_sub_ps(b, a), a), mEnvelope[k]);
+                        mPrevious[k]          = mOutput[k];
+                        mOutput[k]            = mSample;
+                        mSum                  = _mm512_fmadd_ps(_mm512_set1_ps(fCarrierLevel[k]), mSample, mSum);
+                        mPhase[k]             = _mm512_add_epi32(mPhase[k], mIncrement[k]);
+                        mEnvelope[k]          = _mm512_add_ps(mEnvelope[k], mDelta[k]);
+                    }
+                    float* mAccumulator = fAccumulator.data() + i * mLanes;
+                    _mm512_storeu_ps(mAccumulator, _mm512_fmadd_ps(mSum, mVelocity, _mm512_loadu_ps(mAccumulator)));
+                }
+                for (uint8_t k = 0; k < fNumOperators; k++) {
+                    const size_t n = index(k, v);
+                    _mm512_storeu_si512(fPhase.data() + n, mPhase[k]);
+                    _mm512_storeu_ps(fOutput.data() + n, mOutput[k]);
+                    _mm512_storeu_ps(fOutputPrevious.data() + n, mPrevious[k]);
+                }
+            }
+        }
+#endif
+    };
+} // namespace klangwellen
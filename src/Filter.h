@@ -25,15 +25,39 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
 
 #include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "SilenceDetector.h"
 
 namespace klangwellen {
+    /**
+     * biquad filter in direct form I.
+     * <p>
+     * by default `set` designs the coefficients immediately. for filters that are modulated ( e.g by an LFO or an
+     * envelope ) `set_coefficient_interpolation` enables a mode in which parameter changes only store the parameters.
+     * the coefficients are designed at most once every `n` samples and the filter moves to them linearly over the next
+     * `n` samples, which removes zipper noise and the cost of designing coefficients at audio rate. every intermediate
+     * set of coefficients is a stable filter since the stable region of `a1, a2` is convex, this does however not make
+     * the time-varying filter stable, i.e fast sweeps at high resonance can still overshoot. `set_coefficient_cache`
+     * additionally quantizes the parameters ( ~9 cents for frequency and bandwidth, 0.1 dB for gain ) and keeps the
+     * designed coefficients in a small cache.
+     * <p>
+     * once input and output stayed below the silence threshold ( see `SilenceDetector` ) for `get_tail_length()`
+     * samples the block `process` functions reset the filter and write zeros without processing until the input
+     * returns.
+     */
     class Filter {
     public:
         /* filter types. */
@@ -46,6 +70,8 @@ namespace klangwellen {
         static const uint8_t HSH              = 6; /* High shelf filter */
         static const uint8_t NUM_FILTER_TYPES = 7;
 
+        static constexpr uint32_t COEFFICIENT_CACHE_SIZE = 512;
+
         Filter(bool use_fast_math = true) : __USE_FAST_TRIG(use_fast_math) {
             set(LPF, 0.0, 1000, 100, KlangWellen::DEFAULT_SAMPLE_RATE);
         }
@@ -60,38 +86,182 @@ namespace klangwellen {
         }
 
         float process(float sample) {
-            const float r0     = biquad_a0 * sample;
-            const float r1     = biquad_a1 * biquad_x1;
-            const float r2     = biquad_a2 * biquad_x2;
-            const float r3     = biquad_a3 * biquad_y1;
-            const float r4     = biquad_a4 * biquad_y2;
-            const float r5     = r0 + r1;
-            const float r6     = r2 - r3 - r4;
-            const float result = r5 + r6;
-
-            /* shift x1 to x2, sample to x1. */
-            biquad_x2 = biquad_x1;
-            biquad_x1 = sample;
-
-            /* shift y1 to y2, result to y1. */
-            biquad_y2 = biquad_y1;
-            biquad_y1 = result;
-
-            return result;
+            if (fInterpolationLength > 0) {
+                if (fInterpolationRemaining == 0 && fParametersChanged) {
+                    begin_interpolation();
+                }
+                if (fInterpolationRemaining > 0) {
+                    step_interpolation();
+                }
+            }
+            return process_sample(sample);
         }
 
         void process(float*         signal_buffer,
                      const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                signal_buffer[i] = process(signal_buffer[i]);
+            update_hold();
+            if (fSilence.skip(signal_buffer, length)) {
+                std::fill_n(signal_buffer, length, 0.0f);
+                return;
+            }
+            process_block(signal_buffer, length);
+            /* a ramp may begin or end within the block */
+            update_hold();
+            if (fSilence.update(signal_buffer, length)) {
+                reset();
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+        }
+
         void set(uint8_t type,
                  float   dbGain, /* gain of filter */
                  float   center_frequency,
                  float   bandwidth, /* bandwidth in octaves */
                  float   sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) {
+            if (type >= NUM_FILTER_TYPES) {
+                return;
+            }
+            fType       = type;
+            fGain       = dbGain;
+            fFrequency  = center_frequency;
+            fBandwidth  = bandwidth;
+            fSampleRate = sample_rate;
+            if (fInterpolationLength > 0) {
+                fParametersChanged = true;
+                return;
+            }
+            float mCoefficients[5];
+            design(mCoefficients);
+            biquad_a0    = mCoefficients[0];
+            biquad_a1    = mCoefficients[1];
+            biquad_a2    = mCoefficients[2];
+            biquad_a3    = mCoefficients[3];
+            biquad_a4    = mCoefficients[4];
+            fHoldChanged = true;
+        }
+
+        void set_type(const uint8_t type) {
+            set(type, fGain, fFrequency, fBandwidth, fSampleRate);
+        }
+
+        uint8_t get_type() const {
+            return fType;
+        }
+
+        void set_gain(const float dbGain) {
+            set(fType, dbGain, fFrequency, fBandwidth, fSampleRate);
+        }
+
+        float get_gain() const {
+            return fGain;
+        }
+
+        void set_frequency(const float center_frequency) {
+            set(fType, fGain, center_frequency, fBandwidth, fSampleRate);
+        }
+
+        float get_frequency() const {
+            return fFrequency;
+        }
+
+        void set_bandwidth(const float bandwidth) {
+            set(fType, fGain, fFrequency, bandwidth, fSampleRate);
+        }
+
+        float get_bandwidth() const {
+            return fBandwidth;
+        }
+
+        /**
+         * sets the number of samples over which the coefficients move to a new setting. parameter changes are applied
+         * at most once per interpolation period. 0 ( default ) applies parameter changes immediately.
+         *
+         * @param samples interpolation period in samples ( e.g 32 )
+         */
+        void set_coefficient_interpolation(const uint32_t samples) {
+            fInterpolationLength = samples;
+            if (samples == 0) {
+                if (fInterpolationRemaining > 0) {
+                    /* a ramp that is cut short jumps to its target instead of keeping intermediate coefficients */
+                    fInterpolationRemaining = 0;
+                    apply_target();
+                }
+                if (fParametersChanged) {
+                    fParametersChanged = false;
+                    set(fType, fGain, fFrequency, fBandwidth, fSampleRate);
+                }
+            }
+        }
+
+        uint32_t get_coefficient_interpolation() const {
+            return fInterpolationLength;
+        }
+
+        /**
+         * enables a cache of designed coefficients. the parameters are quantized to ~9 cents ( frequency and bandwidth )
+         * and 0.1 dB ( gain ) before the coefficients are designed, whether they are found in the cache or not.
+         */
+        void set_coefficient_cache(const bool enable) {
+            if (enable) {
+                fCache.resize(COEFFICIENT_CACHE_SIZE);
+                for (CacheEntry& mEntry : fCache) {
+                    mEntry.valid = false;
+                }
+            } else {
+                fCache.clear();
+                fCache.shrink_to_fit();
+            }
+        }
+
+        bool get_coefficient_cache() const {
+            return !fCache.empty();
+        }
+
+        /**
+         * @param threshold amplitude below which input and output count as silent, 0 disables the silence detection
+         */
+        void set_silence_threshold(const float threshold) {
+            fSilence.set_threshold(threshold);
+            fHoldChanged = true;
+        }
+
+        float get_silence_threshold() const {
+            return fSilence.get_threshold();
+        }
+
+        /**
+         * @return true if the filter skips processing because input and output are silent
+         */
+        bool is_sleeping() const {
+            return fSilence.is_sleeping();
+        }
+
+        /**
+         * @return estimated number of samples the impulse response of the current coefficients takes to decay below the
+         *         silence threshold, derived from the pole with the largest radius
+         */
+        uint32_t get_tail_length() const {
+            return tail_length(biquad_a3, biquad_a4);
+        }
+
+        /**
+         * computes the coefficients of a filter normalized to `a0`, i.e `{ b0, b1, b2, a1, a2 }`.
+         *
+         * @return false if the filter type is unknown
+         */
+        static bool compute_coefficients(float*  coefficients,
+                                         uint8_t type,
+                                         float   dbGain,
+                                         float   center_frequency,
+                                         float   bandwidth,
+                                         float   sample_rate   = KlangWellen::DEFAULT_SAMPLE_RATE,
+                                         bool    use_fast_math = true) {
             // float A, omega, sn, cs, alpha, beta;
             float a0, a1, a2, b0, b1, b2;
 
@@ -101,7 +271,7 @@ namespace klangwellen {
             float       cs;
             float       alpha;
             float       beta;
-            if (__USE_FAST_TRIG) {
+            if (use_fast_math) {
                 sn    = KlangWellen::fast_sin(omega);
                 cs    = KlangWellen::fast_cos(omega);
                 alpha = sn * KlangWellen::fast_sinh(FILTER_LN2 / 2 * bandwidth * omega / sn);
@@ -170,15 +340,16 @@ namespace klangwellen {
                     a2 = (A + 1) - (A - 1) * cs - beta * sn;
                     break;
                 default:
-                    return;
+                    return false;
             }
 
             /* precompute the coefficients. */
-            biquad_a0 = b0 / a0;
-            biquad_a1 = b1 / a0;
-            biquad_a2 = b2 / a0;
-            biquad_a3 = a1 / a0;
-            biquad_a4 = a2 / a0;
+            coefficients[0] = b0 / a0;
+            coefficients[1] = b1 / a0;
+            coefficients[2] = b2 / a0;
+            coefficients[3] = a1 / a0;
+            coefficients[4] = a2 / a0;
+            return true;
         }
 
         void reset() {
@@ -187,11 +358,197 @@ namespace klangwellen {
         }
 
     private:
-        static constexpr float FILTER_LN2 = 0.69314718055994530942;
-        static constexpr float FILTER_PI  = 3.14159265358979323846;
-        float                  biquad_a0, biquad_a1, biquad_a2, biquad_a3, biquad_a4 = 0;
-        float                  biquad_x1, biquad_x2, biquad_y1, biquad_y2 = 0;
-        const bool             __USE_FAST_TRIG;
+        /* the upper 7 bits of the mantissa, i.e 128 steps per octave */
+        static constexpr uint32_t QUANTIZE_LOG_SHIFT = 16;
+        static constexpr float    QUANTIZE_GAIN      = 10.0f;
+
+        struct CacheEntry {
+            bool     valid;
+            uint8_t  type;
+            uint32_t frequency;
+            uint32_t bandwidth;
+            int32_t  gain;
+            float    sample_rate;
+            float    coefficients[5];
+        };
+
+        static constexpr float  FILTER_LN2 = 0.69314718055994530942;
+        static constexpr float  FILTER_PI  = 3.14159265358979323846;
+        float                   biquad_a0 = 0, biquad_a1 = 0, biquad_a2 = 0, biquad_a3 = 0, biquad_a4 = 0;
+        float                   biquad_x1 = 0, biquad_x2 = 0, biquad_y1 = 0, biquad_y2 = 0;
+        const bool              __USE_FAST_TRIG;
+        uint8_t                 fType                   = LPF;
+        float                   fGain                   = 0.0f;
+        float                   fFrequency              = 1000.0f;
+        float                   fBandwidth              = 100.0f;
+        float                   fSampleRate             = KlangWellen::DEFAULT_SAMPLE_RATE;
+        bool                    fParametersChanged      = false;
+        uint32_t                fInterpolationLength    = 0;
+        uint32_t                fInterpolationRemaining = 0;
+        float                   fDelta[5]               = {};
+        float                   fTarget[5]              = {};
+        std::vector<CacheEntry> fCache;
+        SilenceDetector         fSilence;
+        /* the hold of `fSilence` is updated by the next block after the coefficients or the threshold changed */
+        bool                    fHoldChanged = true;
+
+        static uint32_t quantize_log(const float value) {
+            uint32_t mBits;
+            memcpy(&mBits, &value, sizeof(mBits));
+            return mBits >> QUANTIZE_LOG_SHIFT;
+        }
+
+        /* center of the quantization step */
+        static float dequantize_log(const uint32_t quantized) {
+            const uint32_t mBits = (quantized << QUANTIZE_LOG_SHIFT) | (1u << (QUANTIZE_LOG_SHIFT - 1));
+            float          mValue;
+            memcpy(&mValue, &mBits, sizeof(mValue));
+            return mValue;
+        }
+
+        /* designs the coefficients for the current parameters, using the cache if enabled */
+        void design(float* coefficients) {
+            if (fCache.empty()) {
+                compute_coefficients(coefficients, fType, fGain, fFrequency, fBandwidth, fSampleRate, __USE_FAST_TRIG);
+                return;
+            }
+            const uint32_t mFrequency = quantize_log(fFrequency);
+            const uint32_t mBandwidth = quantize_log(fBandwidth);
+            const int32_t  mGain      = static_cast<int32_t>(fGain * QUANTIZE_GAIN + (fGain < 0.0f ? -0.5f : 0.5f));
+            const uint32_t mHash      = (mFrequency * 0x9E3779B1u) ^ (mBandwidth * 0x85EBCA77u) ^ (static_cast<uint32_t>(mGain) * 0xC2B2AE3Du) ^ fType;
+            CacheEntry&    mEntry     = fCache[(mHash ^ (mHash >> 15)) % COEFFICIENT_CACHE_SIZE];
+            if (!mEntry.valid ||
+                mEntry.type != fType ||
+                mEntry.frequency != mFrequency ||
+                mEntry.bandwidth != mBandwidth ||
+                mEntry.gain != mGain ||
+                mEntry.sample_rate != fSampleRate) {
+                mEntry.valid       = true;
+                mEntry.type        = fType;
+                mEntry.frequency   = mFrequency;
+                mEntry.bandwidth   = mBandwidth;
+                mEntry.gain        = mGain;
+                mEntry.sample_rate = fSampleRate;
+                compute_coefficients(mEntry.coefficients,
+                                     fType,
+                                     static_cast<float>(mGain) / QUANTIZE_GAIN,
+                                     dequantize_log(mFrequency),
+                                     dequantize_log(mBandwidth),
+                                     fSampleRate,
+                                     __USE_FAST_TRIG);
+            }
+            memcpy(coefficients, mEntry.coefficients, sizeof(mEntry.coefficients));
+        }
+
+        void process_block(float* signal_buffer, const uint32_t length) {
+            if (fInterpolationLength == 0) {
+                for (uint32_t i = 0; i < length; i++) {
+                    signal_buffer[i] = process(signal_buffer[i]);
+                }
+                return;
+            }
+            uint32_t i = 0;
+            while (i < length) {
+                if (fInterpolationRemaining == 0) {
+                    if (!fParametersChanged) {
+                        for (; i < length; i++) {
+                            signal_buffer[i] = process(signal_buffer[i]);
+                        }
+                        return;
+                    }
+                    begin_interpolation();
+                }
+                const uint32_t mSteps = fInterpolationRemaining < length - i ? fInterpolationRemaining : length - i;
+                for (uint32_t j = 0; j < mSteps; j++) {
+                    step_interpolation();
+                    signal_buffer[i + j] = process_sample(signal_buffer[i + j]);
+                }
+                i += mSteps;
+            }
+        }
+
+        float process_sample(float sample) {
+            const float r0     = biquad_a0 * sample;
+            const float r1     = biquad_a1 * biquad_x1;
+            const float r2     = biquad_a2 * biquad_x2;
+            const float r3     = biquad_a3 * biquad_y1;
+            const float r4     = biquad_a4 * biquad_y2;
+            const float r5     = r0 + r1;
+            const float r6     = r2 - r3 - r4;
+            const float result = r5 + r6;
+
+            /* shift x1 to x2, sample to x1. */
+            biquad_x2 = biquad_x1;
+            biquad_x1 = sample;
+
+            /* shift y1 to y2, result to y1. */
+            biquad_y2 = biquad_y1;
+            biquad_y1 = result;
+
+            return result;
+        }
+
+        /* poles are the roots of `z^2 + a1 z + a2` */
+        uint32_t tail_length(const float a1, const float a2) const {
+            const float mDiscriminant = a1 * a1 - 4.0f * a2;
+            float       mRadius;
+            if (mDiscriminant < 0.0f) {
+                mRadius = std::sqrt(a2);
+            } else {
+                const float mRoot = std::sqrt(mDiscriminant);
+                mRadius           = std::max(std::fabs(-a1 + mRoot), std::fabs(-a1 - mRoot)) * 0.5f;
+            }
+            return SilenceDetector::decay_length(1, mRadius, fSilence.get_threshold());
+        }
+
+        /* the hold covers the tail of the current coefficients and, during a ramp, of the target coefficients */
+        void update_hold() {
+            if (!fHoldChanged) {
+                return;
+            }
+            fHoldChanged   = false;
+            uint32_t mHold = get_tail_length();
+            if (fInterpolationRemaining > 0) {
+                mHold = std::max(mHold, tail_length(fTarget[3], fTarget[4]));
+            }
+            fSilence.set_hold(mHold);
+        }
+
+        void begin_interpolation() {
+            fParametersChanged = false;
+            design(fTarget);
+            const float mScale = 1.0f / static_cast<float>(fInterpolationLength);
+            fDelta[0]          = (fTarget[0] - biquad_a0) * mScale;
+            fDelta[1]          = (fTarget[1] - biquad_a1) * mScale;
+            fDelta[2]          = (fTarget[2] - biquad_a2) * mScale;
+            fDelta[3]          = (fTarget[3] - biquad_a3) * mScale;
+            fDelta[4]          = (fTarget[4] - biquad_a4) * mScale;
+
+            fInterpolationRemaining = fInterpolationLength;
+            fHoldChanged            = true;
+        }
+
+        void step_interpolation() {
+            fInterpolationRemaining--;
+            if (fInterpolationRemaining == 0) {
+                apply_target();
+                return;
+            }
+            biquad_a0 += fDelta[0];
+            biquad_a1 += fDelta[1];
+            biquad_a2 += fDelta[2];
+            biquad_a3 += fDelta[3];
+            biquad_a4 += fDelta[4];
+        }
+
+        void apply_target() {
+            biquad_a0    = fTarget[0];
+            biquad_a1    = fTarget[1];
+            biquad_a2    = fTarget[2];
+            biquad_a3    = fTarget[3];
+            biquad_a4    = fTarget[4];
+            fHoldChanged = true;
+        }
     };
 
 } // namespace klangwellen
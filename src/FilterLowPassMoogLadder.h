@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -34,9 +35,14 @@
 #include <cmath>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "SilenceDetector.h"
 
 /**
  * low-pass filter implementing the <em>Moog Ladder</em>.
+ * <p>
+ * once input and output stayed below the silence threshold ( see `SilenceDetector` ) for `get_tail_length()` samples
+ * the block `process` functions reset the filter and write zeros without processing until the input returns.
  */
 namespace klangwellen {
     class FilterLowPassMoogLadder {
@@ -48,15 +54,18 @@ namespace klangwellen {
          * Original author(s) : Victor Lazzarini, John ffitch (fast tanh), Bob Moog
          */
 
-        const float fSampleRate;
-        float       fCutoffFrequency;
-        float       fDelay[6]{};
-        float       fOldAcr;
-        float       fOldFreq;
-        float       fOldRes;
-        float       fOldTune;
-        float       fResonance;
-        float       fTanhstg[3]{};
+        const float     fSampleRate;
+        float           fCutoffFrequency;
+        float           fDelay[6]{};
+        float           fOldAcr;
+        float           fOldFreq;
+        float           fOldRes;
+        float           fOldTune;
+        float           fResonance;
+        float           fTanhstg[3]{};
+        SilenceDetector fSilence;
+        /* the hold of `fSilence` is updated before the next block after frequency, resonance or threshold changed */
+        bool            fHoldChanged = true;
 
     public:
         FilterLowPassMoogLadder() : FilterLowPassMoogLadder(KlangWellen::DEFAULT_SAMPLE_RATE) {}
@@ -76,9 +85,27 @@ namespace klangwellen {
 
         void process(float*         signal_buffer,
                      const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            if (fHoldChanged) {
+                fHoldChanged = false;
+                fSilence.set_hold(get_tail_length());
+            }
+            if (fSilence.skip(signal_buffer, length)) {
+                std::fill_n(signal_buffer, length, 0.0f);
+                return;
+            }
             for (uint32_t i = 0; i < length; i++) {
                 signal_buffer[i] = process(signal_buffer[i]);
             }
+            if (fSilence.update(signal_buffer, length)) {
+                reset();
+            }
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
         }
 
         float process(float signal) {
@@ -86,17 +113,10 @@ namespace klangwellen {
             const float     res  = std::max(fResonance, 0.0f);
             float           stg[4];
             float           acr, tune;
-            constexpr float THERMAL = 0.000025f;
 
             if (fOldFreq != freq || fOldRes != res) {
-                fOldFreq        = freq;
-                const float fc  = (freq / fSampleRate);
-                const float f   = 0.5f * fc;
-                const float fc2 = fc * fc;
-                const float fc3 = fc2 * fc2;
-                const float fcr = 1.8730f * fc3 + 0.4955f * fc2 - 0.6490f * fc + 0.9988f;
-                acr             = -3.9364f * fc2 + 1.8409f * fc + 0.9968f;
-                tune            = (1.0f - std::exp(-((2 * static_cast<float>(M_PI)) * f * fcr))) / THERMAL;
+                fOldFreq = freq;
+                tuning(freq / fSampleRate, acr, tune);
 
                 fOldRes  = res;
                 fOldAcr  = acr;
@@ -132,6 +152,7 @@ namespace klangwellen {
          */
         void set_frequency(const float pCutoffFrequency) {
             fCutoffFrequency = pCutoffFrequency;
+            fHoldChanged     = true;
         }
 
         float get_resonance() const {
@@ -142,10 +163,64 @@ namespace klangwellen {
          * @param pResonance resonance factor [0.0, 1.0] ( becomes unstable close to 1.0 )
          */
         void set_resonance(const float pResonance) {
-            fResonance = pResonance;
+            fResonance   = pResonance;
+            fHoldChanged = true;
+        }
+
+        void reset() {
+            for (uint8_t i = 0; i < 6; i++) {
+                fDelay[i]       = 0.0f;
+                fTanhstg[i % 3] = 0.0f;
+            }
+        }
+
+        /**
+         * @param threshold amplitude below which input and output count as silent, 0 disables the silence detection
+         */
+        void set_silence_threshold(const float threshold) {
+            fSilence.set_threshold(threshold);
+            fHoldChanged = true;
+        }
+
+        float get_silence_threshold() const {
+            return fSilence.get_threshold();
+        }
+
+        /**
+         * @return true if the filter skips processing because input and output are silent
+         */
+        bool is_sleeping() const {
+            return fSilence.is_sleeping();
+        }
+
+        /**
+         * @return estimated number of samples the filter rings after the input stopped until it decays below the
+         *         silence threshold. the estimate follows the slowest pole of the linearized ladder, which reaches the
+         *         unit circle ( i.e the filter self-oscillates ) at a resonance of about 1.
+         */
+        uint32_t get_tail_length() const {
+            float acr, tune;
+            tuning(fCutoffFrequency / fSampleRate, acr, tune);
+            /* each stage is a one pole `y += g ( x - y )`, the feedback `k` moves the slowest pole of the ladder by
+             * `k^(1/4) cos( PI / 4 ) g` towards the unit circle. the ladder runs twice per sample. */
+            const float mG        = tune * THERMAL;
+            const float mFeedback = 4.0f * std::max(fResonance, 0.0f) * acr;
+            const float mPole     = 1.0f - mG * (1.0f - std::pow(mFeedback, 0.25f) * static_cast<float>(M_SQRT1_2));
+            return SilenceDetector::decay_length(1, mPole * mPole, fSilence.get_threshold());
         }
 
     private:
+        static constexpr float THERMAL = 0.000025f;
+
+        static void tuning(const float fc, float& acr, float& tune) {
+            const float f   = 0.5f * fc;
+            const float fc2 = fc * fc;
+            const float fc3 = fc2 * fc2;
+            const float fcr = 1.8730f * fc3 + 0.4955f * fc2 - 0.6490f * fc + 0.9988f;
+            acr             = -3.9364f * fc2 + 1.8409f * fc + 0.9968f;
+            tune            = (1.0f - std::exp(-((2 * static_cast<float>(M_PI)) * f * fcr))) / THERMAL;
+        }
+
         static float my_tanh(float x) {
             float sign = 1;
             if (x < 0) {
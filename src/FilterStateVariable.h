@@ -0,0 +1,300 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [x] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t)
+ * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cmath>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+
+namespace klangwellen {
+    /**
+     * state-variable filter in topology-preserving transform form ( TPT, also known as zero-delay feedback filter ).
+     * <p>
+     * the filter computes low pass, high pass, band pass and notch outputs at the same time. the output returned by
+     * `process` is selected with `set_mode`, all four outputs of the last sample are available via `get_lowpass` etc.
+     * or as separate buffers from the multi-output block `process` method.
+     * <p>
+     * unlike the biquad in `Filter` the state of the filter does not depend on its coefficients, so cutoff frequency
+     * and resonance can change every sample without clicks or instability. both can be driven by per-sample buffers.
+     * the prewarping `tan` is replaced by a rational approximation ( see `tan_approximation` ), so updating the
+     * coefficients per sample costs a few multiplications and one division.
+     * <p>
+     * see `FilterStateVariableBank` to process many voices at once.
+     */
+    class FilterStateVariable {
+    public:
+        static constexpr uint8_t LOWPASS  = 0;
+        static constexpr uint8_t HIGHPASS = 1;
+        static constexpr uint8_t BANDPASS = 2;
+        static constexpr uint8_t NOTCH    = 3;
+
+        /* highest cutoff frequency relative to the sampling rate */
+        static constexpr float MAX_FREQUENCY = 0.49f;
+
+        FilterStateVariable() : FilterStateVariable(KlangWellen::DEFAULT_SAMPLE_RATE) {}
+
+        explicit FilterStateVariable(const float sample_rate) : fSampleRate(sample_rate),
+                                                                fFrequency(1000.0f),
+                                                                fResonance(0.3f),
+                                                                fMode(LOWPASS),
+                                                                fIC1(0.0f),
+                                                                fIC2(0.0f),
+                                                                fLowpass(0.0f),
+                                                                fHighpass(0.0f),
+                                                                fBandpass(0.0f),
+                                                                fNotch(0.0f) {
+            update_coefficients();
+        }
+
+        float get_frequency() const {
+            return fFrequency;
+        }
+
+        /**
+         * @param frequency cutoff frequency in Hz ( clamped to 0.49 times the sampling rate )
+         */
+        void set_frequency(const float frequency) {
+            fFrequency = frequency;
+            update_coefficients();
+        }
+
+        float get_resonance() const {
+            return fResonance;
+        }
+
+        /**
+         * @param resonance resonance factor [0.0, 1.0] ( 0.0 is a Q of 0.5, 1.0 oscillates )
+         */
+        void set_resonance(const float resonance) {
+            fResonance = resonance;
+            update_coefficients();
+        }
+
+        uint8_t get_mode() const {
+            return fMode;
+        }
+
+        /**
+         * @param mode output returned by `process`: `LOWPASS`, `HIGHPASS`, `BANDPASS` or `NOTCH`
+         */
+        void set_mode(const uint8_t mode) {
+            fMode = mode;
+        }
+
+        float get_lowpass() const {
+            return fLowpass;
+        }
+
+        float get_highpass() const {
+            return fHighpass;
+        }
+
+        float get_bandpass() const {
+            return fBandpass;
+        }
+
+        float get_notch() const {
+            return fNotch;
+        }
+
+        void reset() {
+            fIC1 = 0.0f;
+            fIC2 = 0.0f;
+        }
+
+        float process(const float signal) {
+            tick(signal, fG, fK, fA1);
+            return output();
+        }
+
+        void process(float* signal_buffer, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            for (uint32_t i = 0; i < length; i++) {
+                tick(signal_buffer[i], fG, fK, fA1);
+                signal_buffer[i] = output();
+            }
+        }
+
+        /**
+         * filters the buffer with per-sample cutoff frequency and resonance. a `nullptr` buffer uses the value set with
+         * `set_frequency` or `set_resonance`.
+         *
+         * @param signal_buffer    signal, replaced by the output selected with `set_mode`
+         * @param frequency_buffer cutoff frequency in Hz per sample or `nullptr`
+         * @param resonance_buffer resonance per sample or `nullptr`
+         * @param length           number of samples
+         */
+        void process(float*         signal_buffer,
+                     const float*   frequency_buffer,
+                     const float*   resonance_buffer,
+                     const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process(signal_buffer,
+                    fMode == LOWPASS ? signal_buffer : nullptr,
+                    fMode == HIGHPASS ? signal_buffer : nullptr,
+                    fMode == BANDPASS ? signal_buffer : nullptr,
+                    fMode == NOTCH ? signal_buffer : nullptr,
+                    length,
+                    frequency_buffer,
+                    resonance_buffer);
+        }
+
+        /**
+         * filters the buffer into separate outputs. any output buffer may be `nullptr` and any output buffer may be the
+         * signal buffer.
+         *
+         * @param signal_buffer    signal
+         * @param lowpass_buffer   low pass output or `nullptr`
+         * @param highpass_buffer  high pass output or `nullptr`
+         * @param bandpass_buffer  band pass output or `nullptr`
+         * @param notch_buffer     notch output or `nullptr`
+         * @param length           number of samples
+         * @param frequency_buffer cutoff frequency in Hz per sample or `nullptr`
+         * @param resonance_buffer resonance per sample or `nullptr`
+         */
+        void process(const float*   signal_buffer,
+                     float*         lowpass_buffer,
+                     float*         highpass_buffer,
+                     float*         bandpass_buffer,
+                     float*         notch_buffer,
+                     const uint32_t length,
+                     const float*   frequency_buffer = nullptr,
+                     const float*   resonance_buffer = nullptr) {
+            const bool mModulated = frequency_buffer != nullptr || resonance_buffer != nullptr;
+            float      mG         = fG;
+            float      mK         = fK;
+            float      mA1        = fA1;
+            for (uint32_t i = 0; i < length; i++) {
+                if (mModulated) {
+                    mG  = frequency_buffer != nullptr ? compute_g(frequency_buffer[i], fSampleRate) : fG;
+                    mK  = resonance_buffer != nullptr ? compute_k(resonance_buffer[i]) : fK;
+                    mA1 = 1.0f / (1.0f + mG * (mG + mK));
+                }
+                tick(signal_buffer[i], mG, mK, mA1);
+                if (lowpass_buffer != nullptr) {
+                    lowpass_buffer[i] = fLowpass;
+                }
+                if (highpass_buffer != nullptr) {
+                    highpass_buffer[i] = fHighpass;
+                }
+                if (bandpass_buffer != nullptr) {
+                    bandpass_buffer[i] = fBandpass;
+                }
+                if (notch_buffer != nullptr) {
+                    notch_buffer[i] = fNotch;
+                }
+            }
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+        }
+
+        /**
+         * rational approximation of `tan(x)` for `x` in [0, PI / 2). the relative error is about 1e-7 up to a cutoff
+         * frequency of 0.3 times the sampling rate and below 3e-4 at 0.49 times the sampling rate.
+         */
+        static float tan_approximation(const float x) {
+            const float x2 = x * x;
+            return x * (945.0f + x2 * (-105.0f + x2)) / (945.0f + x2 * (-420.0f + x2 * 15.0f));
+        }
+
+        /**
+         * @return integrator gain `g = tan( PI * frequency / sample_rate )` of the filter
+         */
+        static float compute_g(const float frequency, const float sample_rate) {
+            const float mFrequency = frequency < 0.0f ? 0.0f : (frequency > sample_rate * MAX_FREQUENCY ? sample_rate * MAX_FREQUENCY : frequency);
+            return tan_approximation(static_cast<float>(M_PI) * mFrequency / sample_rate);
+        }
+
+        /**
+         * @return damping `k = 1 / Q` of the filter
+         */
+        static float compute_k(const float resonance) {
+            const float mResonance = resonance < 0.0f ? 0.0f : (resonance > 1.0f ? 1.0f : resonance);
+            return 2.0f - 2.0f * mResonance;
+        }
+
+    private:
+        const float fSampleRate;
+        float       fFrequency;
+        float       fResonance;
+        uint8_t     fMode;
+        float       fG;
+        float       fK;
+        float       fA1;
+        /* integrator states */
+        float fIC1;
+        float fIC2;
+        float fLowpass;
+        float fHighpass;
+        float fBandpass;
+        float fNotch;
+
+        void update_coefficients() {
+            fG  = compute_g(fFrequency, fSampleRate);
+            fK  = compute_k(fResonance);
+            fA1 = 1.0f / (1.0f + fG * (fG + fK));
+        }
+
+        /* solves the zero-delay feedback loop of both integrators ( A. Simper, "Linear Trapezoidal Integrated SVF" ) */
+        void tick(const float v0, const float g, const float k, const float a1) {
+            const float a2 = g * a1;
+            const float a3 = g * a2;
+            const float v3 = v0 - fIC2;
+            const float v1 = a1 * fIC1 + a2 * v3;
+            const float v2 = fIC2 + a2 * fIC1 + a3 * v3;
+            fIC1           = 2.0f * v1 - fIC1;
+            fIC2           = 2.0f * v2 - fIC2;
+            fLowpass       = v2;
+            fBandpass      = v1;
+            fHighpass      = v0 - k * v1 - v2;
+            fNotch         = v0 - k * v1;
+        }
+
+        float output() const {
+            switch (fMode) {
+                case HIGHPASS:
+                    return fHighpass;
+                case BANDPASS:
+                    return fBandpass;
+                case NOTCH:
+                    return fNotch;
+                default:
+                    return fLowpass;
+            }
+        }
+    };
+} // namespace klangwellen
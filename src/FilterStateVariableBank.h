@@ -0,0 +1,395 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [ ] void process(float*, uint32_t)
+ * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "BufferKernels.h"
+#include "FilterStateVariable.h"
+
+namespace klangwellen {
+    /**
+     * state-variable filters ( see `FilterStateVariable` ) for a number of voices, e.g one filter per voice of a
+     * polyphonic synthesizer.
+     * <p>
+     * each voice filters its own buffer and has its own cutoff frequency, resonance and output mode. cutoff frequency
+     * and resonance can be driven by one buffer per voice. parameters and states are stored in structure-of-arrays
+     * form and blocks of 4 or more voices are computed 8 voices at a time ( AVX2 ) with one voice per lane.
+     */
+    class FilterStateVariableBank {
+    public:
+        static constexpr uint32_t ALL_VOICES = 0xFFFFFFFF;
+
+        /**
+         * @param num_voices  number of voices
+         * @param sample_rate sampling rate
+         */
+        explicit FilterStateVariableBank(const uint32_t num_voices,
+                                         const float    sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) : fNumVoices(num_voices),
+                                                                                                         fNumPadded((num_voices + GROUP_SIZE - 1) / GROUP_SIZE * GROUP_SIZE),
+                                                                                                         fSampleRate(sample_rate),
+                                                                                                         fFrequency(fNumPadded, 1000.0f),
+                                                                                                         fResonance(fNumPadded, 0.3f),
+                                                                                                         fMode(fNumPadded, FilterStateVariable::LOWPASS),
+                                                                                                         fG(fNumPadded, 0.0f),
+                                                                                                         fK(fNumPadded, 0.0f),
+                                                                                                         fA1(fNumPadded, 0.0f),
+                                                                                                         fMix(fNumPadded * NUM_MIX, 0.0f),
+                                                                                                         fIC1(fNumPadded, 0.0f),
+                                                                                                         fIC2(fNumPadded, 0.0f) {
+            for (uint32_t v = 0; v < fNumPadded; v++) {
+                update(v);
+            }
+        }
+
+        uint32_t get_num_voices() const {
+            return fNumVoices;
+        }
+
+        float get_frequency(const uint32_t voice) const {
+            return voice < fNumVoices ? fFrequency[voice] : 0.0f;
+        }
+
+        /**
+         * @param frequency cutoff frequency in Hz
+         * @param voice     index of voice or `ALL_VOICES`
+         */
+        void set_frequency(const float frequency, const uint32_t voice = ALL_VOICES) {
+            for (uint32_t v = 0; v < fNumVoices; v++) {
+                if (voice == ALL_VOICES || voice == v) {
+                    fFrequency[v] = frequency;
+                    update(v);
+                }
+            }
+        }
+
+        float get_resonance(const uint32_t voice) const {
+            return voice < fNumVoices ? fResonance[voice] : 0.0f;
+        }
+
+        /**
+         * @param resonance resonance factor [0.0, 1.0]
+         * @param voice     index of voice or `ALL_VOICES`
+         */
+        void set_resonance(const float resonance, const uint32_t voice = ALL_VOICES) {
+            for (uint32_t v = 0; v < fNumVoices; v++) {
+                if (voice == ALL_VOICES || voice == v) {
+                    fResonance[v] = resonance;
+                    update(v);
+                }
+            }
+        }
+
+        uint8_t get_mode(const uint32_t voice) const {
+            return voice < fNumVoices ? fMode[voice] : FilterStateVariable::LOWPASS;
+        }
+
+        /**
+         * @param mode  `FilterStateVariable::LOWPASS`, `HIGHPASS`, `BANDPASS` or `NOTCH`
+         * @param voice index of voice or `ALL_VOICES`
+         */
+        void set_mode(const uint8_t mode, const uint32_t voice = ALL_VOICES) {
+            for (uint32_t v = 0; v < fNumVoices; v++) {
+                if (voice == ALL_VOICES || voice == v) {
+                    fMode[v] = mode;
+                    update(v);
+                }
+            }
+        }
+
+        /**
+         * @param voice index of voice or `ALL_VOICES`
+         */
+        void reset(const uint32_t voice = ALL_VOICES) {
+            for (uint32_t v = 0; v < fNumVoices; v++) {
+                if (voice == ALL_VOICES || voice == v) {
+                    fIC1[v] = 0.0f;
+                    fIC2[v] = 0.0f;
+                }
+            }
+        }
+
+        /**
+         * filters channel `c` of the buffer with voice `c`. channels without a matching voice are not changed.
+         */
+        void process(AudioBuffer& buffer) {
+            const uint32_t mChannels = buffer.num_channels() < fNumVoices ? buffer.num_channels() : fNumVoices;
+            float*         mBuffers[AudioBuffer::MAX_CHANNELS];
+            for (uint32_t c = 0; c < mChannels; c++) {
+                mBuffers[c] = buffer.channel(c);
+            }
+            process(mBuffers, mChannels, buffer.num_frames());
+        }
+
+        /**
+         * filters the buffers `0 ... num_buffers - 1` with the voices `0 ... num_buffers - 1`. each buffer is replaced
+         * by the output selected with `set_mode`.
+         *
+         * @param buffers           signal buffer per voice
+         * @param num_buffers       number of buffers
+         * @param length            number of samples
+         * @param frequency_buffers cutoff frequency in Hz per voice and sample or `nullptr`. a `nullptr` entry uses the
+         *                          value set with `set_frequency` for that voice.
+         * @param resonance_buffers resonance per voice and sample or `nullptr`. a `nullptr` entry uses the value set with
+         *                          `set_resonance` for that voice.
+         */
+        void process(float* const*       buffers,
+                     const uint32_t      num_buffers,
+                     const uint32_t      length,
+                     const float* const* frequency_buffers = nullptr,
+                     const float* const* resonance_buffers = nullptr) {
+            const uint32_t mVoices = num_buffers < fNumVoices ? num_buffers : fNumVoices;
+            uint32_t       v       = 0;
+#if KLANGWELLEN_SIMD_X86
+            if (BufferKernels::get_isa() >= BufferKernels::ISA_AVX2) {
+                /* groups of voices, the last group may be partially filled */
+                for (; v + MIN_GROUP_VOICES <= mVoices; v += GROUP_SIZE) {
+                    const uint32_t mGroup = mVoices - v < GROUP_SIZE ? mVoices - v : GROUP_SIZE;
+                    process_voices_avx2(buffers, frequency_buffers, resonance_buffers, v, mGroup, length);
+                }
+            }
+#endif
+            for (; v < mVoices; v++) {
+                process_voice(buffers[v],
+                              frequency_buffers != nullptr ? frequency_buffers[v] : nullptr,
+                              resonance_buffers != nullptr ? resonance_buffers[v] : nullptr,
+                              v,
+                              length);
+            }
+        }
+
+    private:
+        static constexpr uint32_t GROUP_SIZE       = 8;
+        static constexpr uint32_t MIN_GROUP_VOICES = 4;
+        static constexpr uint32_t NUM_MIX          = 3;
+
+        const uint32_t       fNumVoices;
+        const uint32_t       fNumPadded;
+        const float          fSampleRate;
+        std::vector<float>   fFrequency;
+        std::vector<float>   fResonance;
+        std::vector<uint8_t> fMode;
+        std::vector<float>   fG;
+        std::vector<float>   fK;
+        std::vector<float>   fA1;
+        /* gains of low pass, band pass and high pass output per voice, `[output][voice]` */
+        std::vector<float> fMix;
+        /* integrator states */
+        std::vector<float> fIC1;
+        std::vector<float> fIC2;
+
+        void update(const uint32_t voice) {
+            fG[voice]  = FilterStateVariable::compute_g(fFrequency[voice], fSampleRate);
+            fK[voice]  = FilterStateVariable::compute_k(fResonance[voice]);
+            fA1[voice] = 1.0f / (1.0f + fG[voice] * (fG[voice] + fK[voice]));
+            /* the notch output is the sum of low pass and high pass */
+            const uint8_t mMode          = fMode[voice];
+            fMix[voice]                  = mMode == FilterStateVariable::LOWPASS || mMode == FilterStateVariable::NOTCH ? 1.0f : 0.0f;
+            fMix[fNumPadded + voice]     = mMode == FilterStateVariable::BANDPASS ? 1.0f : 0.0f;
+            fMix[fNumPadded * 2 + voice] = mMode == FilterStateVariable::HIGHPASS || mMode == FilterStateVariable::NOTCH ? 1.0f : 0.0f;
+        }
+
+        void process_voice(float* signal_buffer, const float* frequency_buffer, const float* resonance_buffer, const uint32_t voice, const uint32_t length) {
+            const bool  mModulated = frequency_buffer != nullptr || resonance_buffer != nullptr;
+            const float mLowpass   = fMix[voice];
+            const float mBandpass  = fMix[fNumPadded + voice];
+            const float mHighpass  = fMix[fNumPadded * 2 + voice];
+            float       mIC1       = fIC1[voice];
+            float       mIC2       = fIC2[voice];
+            float       g          = fG[voice];
+            float       k          = fK[voice];
+            float       a1         = fA1[voice];
+            for (uint32_t i = 0; i < length; i++) {
+                if (mModulated) {
+                    g  = frequency_buffer != nullptr ? FilterStateVariable::compute_g(frequency_buffer[i], fSampleRate) : fG[voice];
+                    k  = resonance_buffer != nullptr ? FilterStateVariable::compute_k(resonance_buffer[i]) : fK[voice];
+                    a1 = 1.0f / (1.0f + g * (g + k));
+                }
+                const float v0   = signal_buffer[i];
+                const float a2   = g * a1;
+                const float a3   = g * a2;
+                const float v3   = v0 - mIC2;
+                const float v1   = a1 * mIC1 + a2 * v3;
+                const float v2   = mIC2 + a2 * mIC1 + a3 * v3;
+                mIC1             = 2.0f * v1 - mIC1;
+                mIC2             = 2.0f * v2 - mIC2;
+                signal_buffer[i] = mLowpass * v2 + mBandpass * v1 + mHighpass * (v0 - k * v1 - v2);
+            }
+            fIC1[voice] = mIC1;
+            fIC2[voice] = mIC2;
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        /*
+         * loads 8 samples of up to 8 buffers and transposes them, so that `x[j]` holds sample `i + j` of all voices.
+         * missing buffers are replaced by `fallback`.
+         */
+        KLANGWELLEN_TARGET_AVX2
+        static void load_tile_avx2(__m256* x, const float* const* buffers, const float* fallback, const uint32_t count, const uint32_t i, const uint32_t tile) {
+            for (uint32_t c = 0; c < GROUP_SIZE; c++) {
+                const float* mBuffer = c < count ? buffers[c] : nullptr;
+                if (mBuffer == nullptr) {
+                    x[c] = _mm256_set1_ps(fallback[c]);
+                } else if (tile == GROUP_SIZE) {
+                    x[c] = _mm256_loadu_ps(mBuffer + i);
+                } else {
+                    alignas(32) float mPartial[GROUP_SIZE] = {};
+                    std::copy_n(mBuffer + i, tile, mPartial);
+                    x[c] = _mm256_load_ps(mPartial);
+                }
+            }
+            BufferKernels::transpose_8x8_avx2(x);
+        }
+
+        /*
+         * computes up to 8 voices with one voice per lane. the buffers are transposed in tiles of 8 samples, each tile
+         * is filtered and transposed back.
+         */
+        KLANGWELLEN_TARGET_AVX2
+        void process_voices_avx2(float* const*       buffers,
+                                 const float* const* frequency_buffers,
+                                 const float* const* resonance_buffers,
+                                 const uint32_t      first,
+                                 const uint32_t      count,
+                                 const uint32_t      length) {
+            const float* mFrequencies[GROUP_SIZE] = {};
+            const float* mResonances[GROUP_SIZE]  = {};
+            bool         mModulateFrequency       = false;
+            bool         mModulateResonance       = false;
+            for (uint32_t c = 0; c < count; c++) {
+                if (frequency_buffers != nullptr && frequency_buffers[first + c] != nullptr) {
+                    mFrequencies[c]    = frequency_buffers[first + c];
+                    mModulateFrequency = true;
+                }
+                if (resonance_buffers != nullptr && resonance_buffers[first + c] != nullptr) {
+                    mResonances[c]     = resonance_buffers[first + c];
+                    mModulateResonance = true;
+                }
+            }
+
+            const __m256 mLowpass  = _mm256_loadu_ps(fMix.data() + first);
+            const __m256 mBandpass = _mm256_loadu_ps(fMix.data() + fNumPadded + first);
+            const __m256 mHighpass = _mm256_loadu_ps(fMix.data() + fNumPadded * 2 + first);
+            const __m256 mTwo      = _mm256_set1_ps(2.0f);
+            const __m256 mOne      = _mm256_set1_ps(1.0f);
+            const __m256 mZero     = _mm256_setzero_ps();
+            const __m256 mMaxFreq  = _mm256_set1_ps(fSampleRate * FilterStateVariable::MAX_FREQUENCY);
+            const __m256 mPiOverSR = _mm256_set1_ps(static_cast<float>(M_PI) / fSampleRate);
+            const __m256 mC945     = _mm256_set1_ps(945.0f);
+            const __m256 mC105     = _mm256_set1_ps(-105.0f);
+            const __m256 mC420     = _mm256_set1_ps(-420.0f);
+            const __m256 mC15      = _mm256_set1_ps(15.0f);
+            const __m256 mStaticG  = _mm256_loadu_ps(fG.data() + first);
+            const __m256 mStaticK  = _mm256_loadu_ps(fK.data() + first);
+            const __m256 mStaticA1 = _mm256_loadu_ps(fA1.data() + first);
+            __m256       mIC1      = _mm256_loadu_ps(fIC1.data() + first);
+            __m256       mIC2      = _mm256_loadu_ps(fIC2.data() + first);
+
+            for (uint32_t i = 0; i < length; i += GROUP_SIZE) {
+                const uint32_t mTile = length - i < GROUP_SIZE ? length - i : GROUP_SIZE;
+                __m256         x[GROUP_SIZE];
+                __m256         f[GROUP_SIZE];
+                __m256         r[GROUP_SIZE];
+                for (uint32_t c = 0; c < GROUP_SIZE; c++) {
+                    if (c >= count) {
+                        x[c] = _mm256_setzero_ps();
+                    } else if (mTile == GROUP_SIZE) {
+                        x[c] = _mm256_loadu_ps(buffers[first + c] + i);
+                    } else {
+                        alignas(32) float mPartial[GROUP_SIZE] = {};
+                        std::copy_n(buffers[first + c] + i, mTile, mPartial);
+                        x[c] = _mm256_load_ps(mPartial);
+                    }
+                }
+                BufferKernels::transpose_8x8_avx2(x);
+                if (mModulateFrequency) {
+                    load_tile_avx2(f, mFrequencies, fFrequency.data() + first, count, i, mTile);
+                }
+                if (mModulateResonance) {
+                    load_tile_avx2(r, mResonances, fResonance.data() + first, count, i, mTile);
+                }
+                for (uint32_t j = 0; j < mTile; j++) {
+                    __m256 g  = mStaticG;
+                    __m256 k  = mStaticK;
+                    __m256 a1 = mStaticA1;
+                    if (mModulateFrequency) {
+                        /* see `FilterStateVariable::tan_approximation` */
+                        const __m256 w  = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(f[j], mZero), mMaxFreq), mPiOverSR);
+                        const __m256 w2 = _mm256_mul_ps(w, w);
+                        const __m256 n  = _mm256_mul_ps(w, _mm256_fmadd_ps(w2, _mm256_add_ps(mC105, w2), mC945));
+                        const __m256 d  = _mm256_fmadd_ps(w2, _mm256_fmadd_ps(w2, mC15, mC420), mC945);
+                        g               = _mm256_div_ps(n, d);
+                    }
+                    if (mModulateResonance) {
+                        const __m256 mResonance = _mm256_min_ps(_mm256_max_ps(r[j], mZero), mOne);
+                        k                       = _mm256_fnmadd_ps(mTwo, mResonance, mTwo);
+                    }
+                    if (mModulateFrequency || mModulateResonance) {
+                        a1 = _mm256_div_ps(mOne, _mm256_fmadd_ps(g, _mm256_add_ps(g, k), mOne));
+                    }
+                    const __m256 v0 = x[j];
+                    const __m256 a2 = _mm256_mul_ps(g, a1);
+                    const __m256 a3 = _mm256_mul_ps(g, a2);
+                    const __m256 v3 = _mm256_sub_ps(v0, mIC2);
+                    const __m256 v1 = _mm256_fmadd_ps(a1, mIC1, _mm256_mul_ps(a2, v3));
+                    const __m256 v2 = _mm256_add_ps(mIC2, _mm256_fmadd_ps(a2, mIC1, _mm256_mul_ps(a3, v3)));
+                    mIC1            = _mm256_fmsub_ps(mTwo, v1, mIC1);
+                    mIC2            = _mm256_fmsub_ps(mTwo, v2, mIC2);
+                    const __m256 hp = _mm256_sub_ps(_mm256_fnmadd_ps(k, v1, v0), v2);
+                    x[j]            = _mm256_fmadd_ps(mLowpass, v2, _mm256_fmadd_ps(mBandpass, v1, _mm256_mul_ps(mHighpass, hp)));
+                }
+                BufferKernels::transpose_8x8_avx2(x);
+                for (uint32_t c = 0; c < count; c++) {
+                    if (mTile == GROUP_SIZE) {
+                        _mm256_storeu_ps(buffers[first + c] + i, x[c]);
+                    } else {
+                        alignas(32) float mPartial[GROUP_SIZE];
+                        _mm256_store_ps(mPartial, x[c]);
+                        std::copy_n(mPartial, mTile, buffers[first + c] + i);
+                    }
+                }
+            }
+            /* lanes beyond `count` may belong to voices that were not processed */
+            alignas(32) float mState[2][GROUP_SIZE];
+            _mm256_store_ps(mState[0], mIC1);
+            _mm256_store_ps(mState[1], mIC2);
+            std::copy_n(mState[0], count, fIC1.data() + first);
+            std::copy_n(mState[1], count, fIC2.data() + first);
+        }
+#endif
+    };
+} // namespace klangwellen
@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -33,6 +34,7 @@
 
 #include "KlangWellen.h"
 #include "AudioSignal.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
     class FilterVowelFormant {
@@ -61,6 +63,13 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+        }
+
         float process(float signal) {
             double mSignal = (mCoeff[0] * signal +
                               mCoeff[1] * memory[0] +
@@ -25,13 +25,16 @@
  * - [x] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [x] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
 
 #include <stdint.h>
 
+#include "KlangWellen.h"
 #include "AudioSignal.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
     class Gain {
@@ -73,5 +76,11 @@ namespace klangwellen {
                 signal_buffer[i] *= mGain;
             }
         }
+
+        void process(AudioBuffer& buffer) {
+            for (uint8_t i = 0; i < buffer.num_channels(); i++) {
+                KlangWellen::mult(buffer.channel(i), mGain, buffer.num_frames());
+            }
+        }
     };
 } // namespace klangwellen
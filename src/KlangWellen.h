@@ -24,6 +24,9 @@
 #include <limits>
 #include <algorithm>
 
+#include "BufferKernels.h"
+#include "Random.h"
+
 #ifndef PI
 #define PI M_PI
 #endif
@@ -48,6 +51,14 @@
 #define KLANGWELLEN_WAVETABLE_INTERPOLATE_SAMPLES 1
 #endif
 
+#ifndef KLANGWELLEN_THREAD_LOCAL
+#if defined(ARDUINO)
+#define KLANGWELLEN_THREAD_LOCAL
+#else
+#define KLANGWELLEN_THREAD_LOCAL thread_local
+#endif
+#endif
+
 namespace klangwellen {
     class KlangWellen {
     public:
@@ -173,15 +184,8 @@ namespace klangwellen {
                 return;
             }
 
-            float peakValue = 0.0f;
-
             // find the peak value in the buffer
-            for (uint32_t i = 0; i < numSamples; i++) {
-                const float sample = std::abs(buffer[i]);
-                if (sample > peakValue) {
-                    peakValue = sample;
-                }
-            }
+            const float peakValue = BufferKernels::abs_max(buffer, numSamples);
 
             // avoid division by zero
             if (peakValue == 0.0f) {
@@ -191,28 +195,14 @@ namespace klangwellen {
             const float normalizationFactor = 1.0f / peakValue;
 
             // normalize the buffer
-            for (uint32_t i = 0; i < numSamples; i++) {
-                buffer[i] *= normalizationFactor;
-            }
+            BufferKernels::mult(buffer, normalizationFactor, numSamples);
         }
 
         static void peak(const float* buffer, const uint32_t length, float& min, float& max) {
             if (buffer == nullptr || length == 0) {
                 return;
             }
-
-            min = 0.0f;
-            max = 0.0f;
-
-            for (uint32_t i = 0; i < length; i++) {
-                const float sample = buffer[i];
-                if (sample < min) {
-                    min = sample;
-                }
-                if (sample > max) {
-                    max = sample;
-                }
-            }
+            BufferKernels::min_max(buffer, length, min, max);
         }
 
         /* --- math --- */
@@ -220,10 +210,8 @@ namespace klangwellen {
         // static uint32_t millis_to_samples(float pMillis, float pSampleRate);
         // static uint32_t millis_to_samples(float pMillis);
         // static float    random_normalized();
-        // static uint32_t x32Seed;
         // static uint32_t xorshift32();
         // static float    random();
-        inline static uint32_t x32Seed = 23;
 
         static uint32_t millis_to_samples(const float pMillis, const float pSampleRate) {
             return static_cast<uint32_t>(pMillis / 1000.0f * pSampleRate);
@@ -233,13 +221,32 @@ namespace klangwellen {
             return static_cast<uint32_t>(pMillis / 1000.0f * static_cast<float>(DEFAULT_SAMPLE_RATE));
         }
 
-        /* xorshift32 ( ref: https://en.wikipedia.org/wiki/Xorshift ) */
-        // static uint32_t x32Seed = 23;
+        /**
+         * returns the random number generator used by `random` and `random_normalized`. each thread has its own
+         * generator ( unless `KLANGWELLEN_THREAD_LOCAL` is defined empty ), processors that need reproducible noise
+         * should own a `Random` instance instead.
+         */
+        static Random& random_generator() {
+            static KLANGWELLEN_THREAD_LOCAL Random mRandom;
+            return mRandom;
+        }
+
+        static void set_random_seed(const uint32_t seed) {
+            random_generator().set_seed(seed);
+        }
+
+        /**
+         * returns a random number between 0 ... 2^32-1
+         */
+        static uint32_t random_uint32() {
+            return random_generator().next_uint32();
+        }
+
+        /**
+         * @deprecated use `random_uint32`. kept for compatibility, no longer an xorshift generator.
+         */
         static uint32_t xorshift32() {
-            x32Seed ^= x32Seed << 13;
-            x32Seed ^= x32Seed >> 17;
-            x32Seed ^= x32Seed << 5;
-            return x32Seed;
+            return random_uint32();
         }
 
         static float constexpr UINT32_MAX_INV = 1.0f / static_cast<float>(UINT32_MAX);
@@ -248,14 +255,14 @@ namespace klangwellen {
          * returns a random number between 0.0 ... 1.0
          */
         static float random_normalized() {
-            return static_cast<float>(xorshift32()) * UINT32_MAX_INV;
+            return random_generator().next_normalized();
         }
 
         /**
          * returns a random number between -1.0 ... 1.0
          */
         static float random() {
-            return static_cast<float>(xorshift32()) * UINT32_MAX_INV * 2 - 1;
+            return random_generator().next();
         }
 
         static float clamp(const float value,
@@ -525,10 +532,12 @@ namespace klangwellen {
 
         /* --- buffer --- */
 
+        /*
+         * the buffer functions below are dispatched to vectorized kernels ( see `BufferKernels` ).
+         */
+
         static void fill(float* buffer, const float value, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer[i] = value;
-            }
+            BufferKernels::fill(buffer, value, length);
         }
 
         /**
@@ -542,60 +551,44 @@ namespace klangwellen {
          * adds buffer_b to buffer_a. result will be stored in buffer_a, buffer_b will not be changed.
          */
         static void add(float* buffer_a, const float* buffer_b, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer_a[i] += buffer_b[i];
-            }
+            BufferKernels::add(buffer_a, buffer_b, length);
         }
 
         static void add(float* buffer_a, const float scalar, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer_a[i] += scalar;
-            }
+            BufferKernels::add(buffer_a, scalar, length);
         }
 
         /**
          * subtracts buffer_b from buffer_a. result will be stored in buffer_a, buffer_b will not be changed.
          */
         static void sub(float* buffer_a, const float* buffer_b, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer_a[i] -= buffer_b[i];
-            }
+            BufferKernels::sub(buffer_a, buffer_b, length);
         }
 
         static void sub(float* buffer_a, const float scalar, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer_a[i] -= scalar;
-            }
+            BufferKernels::sub(buffer_a, scalar, length);
         }
 
         /**
          * multiplies buffer_b with buffer_a. result will be stored in buffer_a, buffer_b will not be changed.
          */
         static void mult(float* buffer_a, const float* buffer_b, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer_a[i] *= buffer_b[i];
-            }
+            BufferKernels::mult(buffer_a, buffer_b, length);
         }
 
         static void mult(float* buffer_a, const float scalar, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer_a[i] *= scalar;
-            }
+            BufferKernels::mult(buffer_a, scalar, length);
         }
 
         /**
          * divides buffer_b from buffer_a. result will be stored in buffer_a, buffer_b will not be changed.
          */
         static void div(float* buffer_a, const float* buffer_b, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer_a[i] /= buffer_b[i];
-            }
+            BufferKernels::div(buffer_a, buffer_b, length);
         }
 
         static void div(float* buffer_a, const float scalar, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            for (uint32_t i = 0; i < length; i++) {
-                buffer_a[i] /= scalar;
-            }
+            BufferKernels::div(buffer_a, scalar, length);
         }
     };
 } // namespace klangwellen
@@ -25,12 +25,14 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <cmath>
 #include <math.h>
 #include <assert.h>
@@ -39,6 +41,8 @@
 #include <random>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "Random.h"
 
 namespace klangwellen {
     /**
@@ -47,50 +51,90 @@ namespace klangwellen {
 
     class WhiteNoise {
     public:
+        explicit WhiteNoise(const uint32_t seed = Random::next_seed()) : fRandom(seed) {}
+
+        void set_seed(const uint32_t seed) {
+            fRandom.set_seed(seed);
+        }
+
         float process() {
-            return 2.0f * static_cast<float>(rand()) / static_cast<float>(RAND_MAX) - 1.0;
+            return fRandom.next();
+        }
+
+        void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            fRandom.fill(signal_buffer, buffer_length);
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
         }
+
+    private:
+        Random fRandom;
     };
 
-    class WhiteNoiseFast {
+    /**
+     * same as `WhiteNoise`, kept for compatibility.
+     */
+    class WhiteNoiseFast : public WhiteNoise {
     public:
-        float process() {
-            return KlangWellen::random() * 2.0 - 1.0;
-        }
+        explicit WhiteNoiseFast(const uint32_t seed = Random::next_seed()) : WhiteNoise(seed) {}
     };
 
     class PinkNoise {
     public:
-        PinkNoise() {
-            srand(time(nullptr)); // initialize random generator
+        explicit PinkNoise(const uint32_t seed = Random::next_seed()) : fRandom(seed) {
             clear();
         }
 
+        void set_seed(const uint32_t seed) {
+            fRandom.set_seed(seed);
+        }
+
         void clear() {
             for (size_t i = 0; i < PINK_NOISE_NUM_STAGES; i++)
                 state[i] = 0.0;
         }
 
         float process() {
-            static constexpr float RMI2   = 2.0 / static_cast<float>(RAND_MAX); // + 1.0; // change for range [0,1)
+            static constexpr float RMI2   = 2.0; // random numbers are in range [0,1)
             static constexpr float offset = A[0] + A[1] + A[2];
 
             // unrolled loop
-            float temp = static_cast<float>(rand());
+            float temp = fRandom.next_normalized();
             state[0]   = P[0] * (state[0] - temp) + temp;
-            temp       = static_cast<float>(rand());
+            temp       = fRandom.next_normalized();
             state[1]   = P[1] * (state[1] - temp) + temp;
-            temp       = static_cast<float>(rand());
+            temp       = fRandom.next_normalized();
             state[2]   = P[2] * (state[2] - temp) + temp;
             return ((A[0] * state[0] + A[1] * state[1] + A[2] * state[2]) * RMI2 - offset) * fScale;
         }
 
+        void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] = process();
+            }
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
     private:
         static constexpr uint8_t PINK_NOISE_NUM_STAGES    = 3;
         static constexpr float   A[PINK_NOISE_NUM_STAGES] = {0.02109238, 0.07113478, 0.68873558};
         static constexpr float   P[PINK_NOISE_NUM_STAGES] = {0.3190, 0.7756, 0.9613};
         float                    state[PINK_NOISE_NUM_STAGES];
         float                    fScale = 7.0f;
+        Random                   fRandom;
     };
 
     class SimplexNoise {
@@ -321,7 +365,12 @@ namespace klangwellen {
 
     class GaussianWhiteNoise {
     public:
-        GaussianWhiteNoise() : mPN_b{}, mPN_state{}, mWN_y2(0) {}
+        explicit GaussianWhiteNoise(const uint32_t seed = Random::next_seed()) : mWN_y2(0), fRandom(seed) {}
+
+        void set_seed(const uint32_t seed) {
+            fRandom.set_seed(seed);
+            mWN_pass = false;
+        }
 
         float process() {
             // from [Gaussian White Noise](https://www.musicdsp.org/en/latest/Synthesis/109-gaussian-white-noise.html)
@@ -334,10 +383,10 @@ namespace klangwellen {
                 float x2;
                 float w;
                 do {
-                    x1 = 2.0 * KlangWellen::random() - 1.0;
-                    x2 = 2.0 * KlangWellen::random() - 1.0;
+                    x1 = fRandom.next();
+                    x2 = fRandom.next();
                     w  = x1 * x1 + x2 * x2;
-                } while (w >= 1.0);
+                } while (w >= 1.0 || w == 0.0);
 
                 w      = static_cast<float>(sqrt(-2.0 * log(w) / w));
                 y1     = x1 * w;
@@ -348,11 +397,24 @@ namespace klangwellen {
             return y1 * mScale;
         }
 
+        void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] = process();
+            }
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
     private:
-        float mPN_b[7];
-        float mPN_state[3];
-        bool  mWN_pass = false;
-        float mWN_y2;
+        bool   mWN_pass = false;
+        float  mWN_y2;
+        Random fRandom;
     };
 
     class Noise {
@@ -360,9 +422,10 @@ namespace klangwellen {
         //      pink noises sound so different ) better and maybe add some more noise types ( i.e brown, grey ))
 
     public:
-        Noise() {
+        explicit Noise(const uint32_t seed = Random::next_seed()) {
             fAmplitude = 1.0f;
             fType      = KlangWellen::NOISE_WHITE;
+            set_seed(seed);
         }
 
         float get_amplitude() const {
@@ -381,14 +444,21 @@ namespace klangwellen {
             fType = type;
         }
 
+        /**
+         * seeds all noise generators of this instance. instances with the same seed produce the same signal.
+         */
+        void set_seed(const uint32_t seed) {
+            fRandom.set_seed(seed);
+            mWhiteNoise.set_seed(Random::hash(seed + 1));
+            mPinkNoise.set_seed(Random::hash(seed + 2));
+            mGaussianWhiteNoise.set_seed(Random::hash(seed + 3));
+        }
+
         float process() {
             float mSignal;
             switch (fType) {
-                case KlangWellen::NOISE_WHITE_FAST:
-                    mSignal = getWhiteNoise();
-                    break;
                 case KlangWellen::NOISE_GAUSSIAN_WHITE_FAST:
-                    mSignal = getGaussianWhiteNoiseFast();
+                    mSignal = gaussian_white_noise_fast();
                     break;
                 case KlangWellen::NOISE_GAUSSIAN_WHITE:
                     mSignal = mGaussianWhiteNoise.process();
@@ -399,35 +469,76 @@ namespace klangwellen {
                 case KlangWellen::NOISE_SIMPLEX:
                     mSignal = mSimplexNoise.process();
                     break;
+                case KlangWellen::NOISE_WHITE_FAST:
                 case KlangWellen::NOISE_WHITE:
                 default:
-                    mSignal = getWhiteNoise();
+                    mSignal = mWhiteNoise.process();
                     break;
             }
             return mSignal * fAmplitude;
         }
 
+        void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            if (fType == KlangWellen::NOISE_WHITE || fType == KlangWellen::NOISE_WHITE_FAST) {
+                mWhiteNoise.process(signal_buffer, buffer_length);
+                if (fAmplitude != 1.0f) {
+                    KlangWellen::mult(signal_buffer, fAmplitude, buffer_length);
+                }
+                return;
+            }
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] = process();
+            }
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
+        /**
+         * uses the thread-local generator of `KlangWellen`, kept for compatibility.
+         */
         static float getGaussianWhiteNoiseFast() {
-            // from [Gaussian White Noise](https://www.musicdsp.org/en/latest/Synthesis/113-gaussian-white-noise.html)
-            const float R1 = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-            const float R2 = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-            const float X  = sqrt(-2.0f * log(R1)) * cos(2.0f * PI * R2);
-            return X;
+            return gaussian(KlangWellen::random_generator());
         }
 
+        /**
+         * uses the thread-local generator of `KlangWellen`, kept for compatibility.
+         */
         static float getWhiteNoise() {
-            return 2.0f * static_cast<float>(rand()) / static_cast<float>(RAND_MAX) - 1.0;
+            return KlangWellen::random();
         }
 
+        /**
+         * uses the thread-local generator of `KlangWellen`, kept for compatibility.
+         */
         static float getWhiteNoiseFast() {
-            return KlangWellen::random() * 2.0 - 1.0;
+            return KlangWellen::random();
         }
 
     private:
         float              fAmplitude;
         int                fType;
+        Random             fRandom;
+        WhiteNoise         mWhiteNoise;
         SimplexNoise       mSimplexNoise;
         PinkNoise          mPinkNoise;
         GaussianWhiteNoise mGaussianWhiteNoise;
+
+        float gaussian_white_noise_fast() {
+            return gaussian(fRandom);
+        }
+
+        static float gaussian(Random& random) {
+            // from [Gaussian White Noise](https://www.musicdsp.org/en/latest/Synthesis/113-gaussian-white-noise.html)
+            const float R1 = 1.0f - random.next_normalized(); // range (0,1] avoids log(0)
+            const float R2 = random.next_normalized();
+            const float X  = sqrt(-2.0f * log(R1)) * cos(2.0f * PI * R2);
+            return X;
+        }
     };
-} // namespace klangwellen
\ No newline at end of file
+} // namespace klangwellen
@@ -0,0 +1,429 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [x] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t) *overwrite*
+ * - [x] void process(float*, float*, uint32_t) *overwrite*
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "BufferKernels.h"
+#include "Wavetable.h"
+
+namespace klangwellen {
+    /**
+     * plays back a large number of wavetable oscillators ( e.g the partials of an additive patch or the voices of a
+     * unison patch ) and sums them into one or more outputs.
+     * <p>
+     * the state of all oscillators is stored in structure-of-arrays form ( phases, phase increments, amplitudes, table
+     * offsets and output gains ), so that 8 ( AVX2 ) or 16 ( AVX-512 ) oscillators are advanced by one instruction. each
+     * oscillator uses a 32-bit fixed-point phase ( see `Wavetable::set_phase_accumulator` ) and linear interpolation.
+     * the oscillators read from tables that are copied into the bank with `add_wavetable`, all tables have the same
+     * power-of-two size.
+     * <p>
+     * output `c` is the sum of all oscillators multiplied by their amplitude and their gain for output `c`. gains
+     * default to 1.0, which plays all oscillators on all outputs. all oscillators start with frequency and amplitude 0.
+     */
+    class OscillatorBank {
+    public:
+        static constexpr uint8_t  MAX_OUTPUTS        = KLANGWELLEN_AUDIOBUFFER_MAX_CHANNELS;
+        static constexpr uint32_t MAX_WAVETABLE_SIZE = 1u << 31;
+
+        /**
+         * @param num_oscillators number of oscillators
+         * @param num_outputs     number of outputs
+         * @param wavetable_size  size of all wavetables, rounded up to a power of two and at most `MAX_WAVETABLE_SIZE`
+         *                        ( see `get_wavetable_size` )
+         * @param sampling_rate   sampling rate
+         */
+        OscillatorBank(const uint32_t num_oscillators,
+                       const uint8_t  num_outputs    = 1,
+                       const uint32_t wavetable_size = 2048,
+                       const uint32_t sampling_rate  = KlangWellen::DEFAULT_SAMPLE_RATE) : fNumOscillators(num_oscillators),
+                                                                                           fNumPadded((num_oscillators + LANES - 1) / LANES * LANES),
+                                                                                           fNumOutputs(num_outputs < 1 ? 1 : (num_outputs > MAX_OUTPUTS ? MAX_OUTPUTS : num_outputs)),
+                                                                                           fWavetableSize(power_of_two(wavetable_size)),
+                                                                                           fSamplingRate(sampling_rate),
+                                                                                           fPhaseShift(32 - log2_size(fWavetableSize)),
+                                                                                           fPhase(fNumPadded, 0),
+                                                                                           fIncrement(fNumPadded, 0),
+                                                                                           fTableOffset(fNumPadded, 0),
+                                                                                           fAmplitude(fNumPadded, 0.0f),
+                                                                                           fGain(static_cast<size_t>(fNumOutputs) * fNumPadded, 1.0f),
+                                                                                           fAccumulator(static_cast<size_t>(fNumOutputs) * CHUNK_SIZE * LANES, 0.0f) {
+            add_wavetable(KlangWellen::WAVEFORM_SINE);
+        }
+
+        uint32_t get_num_oscillators() const {
+            return fNumOscillators;
+        }
+
+        uint8_t get_num_outputs() const {
+            return fNumOutputs;
+        }
+
+        /**
+         * @return size of all wavetables, i.e the size passed to the constructor rounded up to a power of two ( at most
+         *         `MAX_WAVETABLE_SIZE` )
+         */
+        uint32_t get_wavetable_size() const {
+            return fWavetableSize;
+        }
+
+        /**
+         * copies a wavetable into the bank. table 0 is a sine wave which is used by all oscillators by default.
+         *
+         * @param wavetable table with `get_wavetable_size()` samples
+         * @return id of the table ( see `set_wavetable` )
+         */
+        uint32_t add_wavetable(const float* wavetable) {
+            const uint32_t mID = get_num_wavetables();
+            fTables.insert(fTables.end(), wavetable, wavetable + fWavetableSize);
+            /* guard sample so that linear interpolation does not need to wrap the index */
+            fTables.push_back(wavetable[0]);
+            return mID;
+        }
+
+        /**
+         * copies one of the built-in waveforms into the bank ( see `Wavetable::fill` ).
+         */
+        uint32_t add_wavetable(const uint8_t waveform) {
+            std::vector<float> mTable(fWavetableSize);
+            Wavetable::fill(mTable.data(), fWavetableSize, waveform);
+            return add_wavetable(mTable.data());
+        }
+
+        uint32_t get_num_wavetables() const {
+            return static_cast<uint32_t>(fTables.size() / (fWavetableSize + 1));
+        }
+
+        void set_wavetable(const uint32_t oscillator, const uint32_t wavetable_id) {
+            if (oscillator < fNumOscillators && wavetable_id < get_num_wavetables()) {
+                fTableOffset[oscillator] = static_cast<int32_t>(wavetable_id * (fWavetableSize + 1));
+            }
+        }
+
+        void set_frequency(const uint32_t oscillator, const float frequency) {
+            if (oscillator < fNumOscillators) {
+                fIncrement[oscillator] = to_phase(std::fabs(static_cast<double>(frequency)) / fSamplingRate);
+            }
+        }
+
+        float get_frequency(const uint32_t oscillator) const {
+            if (oscillator < fNumOscillators) {
+                return static_cast<float>(fIncrement[oscillator] * PHASE_TO_NORMALIZED * fSamplingRate);
+            }
+            return 0.0f;
+        }
+
+        void set_amplitude(const uint32_t oscillator, const float amplitude) {
+            if (oscillator < fNumOscillators) {
+                fAmplitude[oscillator] = amplitude;
+            }
+        }
+
+        float get_amplitude(const uint32_t oscillator) const {
+            return oscillator < fNumOscillators ? fAmplitude[oscillator] : 0.0f;
+        }
+
+        /**
+         * sets the gain with which an oscillator is added to an output ( e.g to pan oscillators ).
+         */
+        void set_gain(const uint32_t oscillator, const uint8_t output, const float gain) {
+            if (oscillator < fNumOscillators && output < fNumOutputs) {
+                fGain[static_cast<size_t>(output) * fNumPadded + oscillator] = gain;
+            }
+        }
+
+        float get_gain(const uint32_t oscillator, const uint8_t output) const {
+            if (oscillator < fNumOscillators && output < fNumOutputs) {
+                return fGain[static_cast<size_t>(output) * fNumPadded + oscillator];
+            }
+            return 0.0f;
+        }
+
+        /**
+         * sets the phase of an oscillator.
+         *
+         * @param phase normalized phase ( 0.0 ... 1.0 )
+         */
+        void set_phase(const uint32_t oscillator, const float phase) {
+            if (oscillator < fNumOscillators) {
+                fPhase[oscillator] = to_phase(phase);
+            }
+        }
+
+        float get_phase(const uint32_t oscillator) const {
+            return oscillator < fNumOscillators ? static_cast<float>(fPhase[oscillator] * PHASE_TO_NORMALIZED) : 0.0f;
+        }
+
+        /**
+         * sets the phases of all oscillators to 0.
+         */
+        void reset() {
+            std::fill(fPhase.begin(), fPhase.end(), 0);
+        }
+
+        /**
+         * @return next sample of the first output
+         */
+        float process() {
+            float mSample;
+            render(&mSample, 1, 0);
+            return mSample;
+        }
+
+        /**
+         * writes the first output into the buffer.
+         */
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            float* mOutputs[MAX_OUTPUTS] = {signal_buffer};
+            render(mOutputs, buffer_length);
+        }
+
+        /**
+         * writes the first two outputs into the buffers. with a single output both buffers receive the same signal.
+         */
+        void process(float* signal_buffer_left, float* signal_buffer_right, const uint32_t buffer_length) {
+            if (fNumOutputs == 1) {
+                process(signal_buffer_left, buffer_length);
+                std::copy_n(signal_buffer_left, buffer_length, signal_buffer_right);
+                return;
+            }
+            float* mOutputs[MAX_OUTPUTS] = {signal_buffer_left, signal_buffer_right};
+            render(mOutputs, buffer_length);
+        }
+
+        /**
+         * writes output `c` into channel `c`. channels without a matching output receive a copy of the first channel.
+         */
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            float*        mOutputs[MAX_OUTPUTS] = {};
+            const uint8_t mChannels             = std::min(buffer.num_channels(), fNumOutputs);
+            for (uint8_t c = 0; c < mChannels; c++) {
+                mOutputs[c] = buffer.channel(c);
+            }
+            render(mOutputs, buffer.num_frames());
+            for (uint8_t c = mChannels; c < buffer.num_channels(); c++) {
+                std::copy_n(buffer.channel(0), buffer.num_frames(), buffer.channel(c));
+            }
+        }
+
+    private:
+        static constexpr uint32_t LANES               = 16;
+        static constexpr uint32_t CHUNK_SIZE          = 64;
+        static constexpr double   NORMALIZED_TO_PHASE = 4294967296.0;
+        static constexpr double   PHASE_TO_NORMALIZED = 1.0 / 4294967296.0;
+
+        const uint32_t        fNumOscillators;
+        const uint32_t        fNumPadded;
+        const uint8_t         fNumOutputs;
+        const uint32_t        fWavetableSize;
+        const uint32_t        fSamplingRate;
+        const uint8_t         fPhaseShift;
+        std::vector<uint32_t> fPhase;
+        std::vector<uint32_t> fIncrement;
+        std::vector<int32_t>  fTableOffset;
+        std::vector<float>    fAmplitude;
+        std::vector<float>    fGain;
+        std::vector<float>    fAccumulator;
+        std::vector<float>    fTables;
+
+        static uint32_t to_phase(const double normalized) {
+            const double mFraction = normalized - floor(normalized);
+            return static_cast<uint32_t>(static_cast<uint64_t>(mFraction * NORMALIZED_TO_PHASE + 0.5) & 0xFFFFFFFF);
+        }
+
+        /* the phase masking requires a power-of-two table size, at least 2 */
+        static uint32_t power_of_two(const uint32_t value) {
+            const uint32_t mValue = std::min(value, MAX_WAVETABLE_SIZE);
+            uint32_t       mSize  = 2;
+            while (mSize < mValue) {
+                mSize <<= 1;
+            }
+            return mSize;
+        }
+
+        static uint8_t log2_size(uint32_t value) {
+            uint8_t mBits = 0;
+            while (value > 1) {
+                value >>= 1;
+                mBits++;
+            }
+            return mBits;
+        }
+
+        /* renders a single output, used by `float process()` */
+        void render(float* output, const uint32_t length, const uint8_t output_index) {
+            float* mOutputs[MAX_OUTPUTS] = {};
+            mOutputs[output_index]       = output;
+            render(mOutputs, length);
+        }
+
+        /* outputs that are `nullptr` are computed but not written */
+        void render(float* const* outputs, const uint32_t length) {
+            for (uint32_t mStart = 0; mStart < length; mStart += CHUNK_SIZE) {
+                const uint32_t mLength = std::min(CHUNK_SIZE, length - mStart);
+                uint32_t       mLanes;
+                switch (BufferKernels::get_isa()) {
+#if KLANGWELLEN_SIMD_X86
+                    case BufferKernels::ISA_AVX512:
+                        render_avx512(mLength);
+                        mLanes = 16;
+                        break;
+                    case BufferKernels::ISA_AVX2:
+                        render_avx2(mLength);
+                        mLanes = 8;
+                        break;
+#endif
+                    default:
+                        render_scalar(mLength);
+                        mLanes = 1;
+                        break;
+                }
+                /* sum the lanes of the accumulator */
+                for (uint8_t c = 0; c < fNumOutputs; c++) {
+                    if (outputs[c] == nullptr) {
+                        continue;
+                    }
+                    const float* mAccumulator = fAccumulator.data() + static_cast<size_t>(c) * CHUNK_SIZE * LANES;
+                    float*       mOutput      = outputs[c] + mStart;
+                    for (uint32_t i = 0; i < mLength; i++) {
+                        float mSum = 0.0f;
+                        for (uint32_t j = 0; j < mLanes; j++) {
+                            mSum += mAccumulator[i * mLanes + j];
+                        }
+                        mOutput[i] = mSum;
+                    }
+                }
+            }
+        }
+
+        /*
+         * the kernels advance a group of oscillators over the chunk, keeping their state in registers, and accumulate
+         * the lanes into `fAccumulator` ( `CHUNK_SIZE` vectors per output ).
+         */
+        void render_scalar(const uint32_t length) {
+            std::fill(fAccumulator.begin(), fAccumulator.end(), 0.0f);
+            const float    mFractionScale = 1.0f / static_cast<float>(1u << fPhaseShift);
+            const uint32_t mFractionMask  = (1u << fPhaseShift) - 1;
+            const float*   mTables        = fTables.data();
+            for (uint32_t k = 0; k < fNumOscillators; k++) {
+                uint32_t     mPhase     = fPhase[k];
+                const float* mTable     = mTables + fTableOffset[k];
+                const float  mAmplitude = fAmplitude[k];
+                for (uint32_t i = 0; i < length; i++) {
+                    const uint32_t mIndex  = mPhase >> fPhaseShift;
+                    const float    mFrac   = static_cast<float>(mPhase & mFractionMask) * mFractionScale;
+                    const float    a       = mTable[mIndex];
+                    const float    mSample = (a + mFrac * (mTable[mIndex + 1] - a)) * mAmplitude;
+                    for (uint8_t c = 0; c < fNumOutputs; c++) {
+                        fAccumulator[static_cast<size_t>(c) * CHUNK_SIZE * LANES + i] += mSample * fGain[static_cast<size_t>(c) * fNumPadded + k];
+                    }
+                    mPhase += fIncrement[k];
+                }
+                fPhase[k] = mPhase;
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        KLANGWELLEN_TARGET_AVX2
+        void render_avx2(const uint32_t length) {
+            constexpr uint32_t mLanes = 8;
+            std::fill(fAccumulator.begin(), fAccumulator.end(), 0.0f);
+            const __m256  mFractionScale = _mm256_set1_ps(1.0f / static_cast<float>(1u << fPhaseShift));
+            const __m256i mFractionMask  = _mm256_set1_epi32(static_cast<int>((1u << fPhaseShift) - 1));
+            const __m128i mShift         = _mm_cvtsi32_si128(fPhaseShift);
+            const __m256i mOne           = _mm256_set1_epi32(1);
+            const float*  mTables        = fTables.data();
+            float*        mAccumulator   = fAccumulator.data();
+            for (uint32_t k = 0; k < fNumPadded; k += mLanes) {
+                __m256i       mPhase     = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fPhase.data() + k));
+                const __m256i mIncrement = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fIncrement.data() + k));
+                const __m256i mOffset    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(fTableOffset.data() + k));
+                const __m256  mAmplitude = _mm256_loadu_ps(fAmplitude.data() + k);
+                for (uint32_t i = 0; i < length; i++) {
+                    const __m256i mIndex  = _mm256_add_epi32(mOffset, _mm256_srl_epi32(mPhase, mShift));
+                    const __m256  mFrac   = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(mPhase, mFractionMask)), mFractionScale);
+                    const __m256  a       = _mm256_i32gather_ps(mTables, mIndex, 4);
+                    const __m256  b       = _mm256_i32gather_ps(mTables, _mm256_add_epi32(mIndex, mOne), 4);
+                    const __m256  mSample = _mm256_mul_ps(_mm256_fmadd_ps(mFrac, _mm256_sub_ps(b, a), a), mAmplitude);
+                    for (uint8_t c = 0; c < fNumOutputs; c++) {
+                        float*       mSum  = mAccumulator + static_cast<size_t>(c) * CHUNK_SIZE * LANES + i * mLanes;
+                        const __m256 mGain = _mm256_loadu_ps(fGain.data() + static_cast<size_t>(c) * fNumPadded + k);
+                        _mm256_storeu_ps(mSum, _mm256_fmadd_ps(mSample, mGain, _mm256_loadu_ps(mSum)));
+                    }
+                    mPhase = _mm256_add_epi32(mPhase, mIncrement);
+                }
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(fPhase.data() + k), mPhase);
+            }
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        void render_avx512(const uint32_t length) {
+            constexpr uint32_t mLanes = 16;
+            std::fill(fAccumulator.begin(), fAccumulator.end(), 0.0f);
+            const __m512  mFractionScale = _mm512_set1_ps(1.0f / static_cast<float>(1u << fPhaseShift));
+            const __m512i mFractionMask  = _mm512_set1_epi32(static_cast<int>((1u << fPhaseShift) - 1));
+            const __m128i mShift         = _mm_cvtsi32_si128(fPhaseShift);
+            const __m512i mOne           = _mm512_set1_epi32(1);
+            const float*  mTables        = fTables.data();
+            float*        mAccumulator   = fAccumulator.data();
+            for (uint32_t k = 0; k < fNumPadded; k += mLanes) {
+                __m512i       mPhase     = _mm512_loadu_si512(fPhase.data() + k);
+                const __m512i mIncrement = _mm512_loadu_si512(fIncrement.data() + k);
+                const __m512i mOffset    = _mm512_loadu_si512(fTableOffset.data() + k);
+                const __m512  mAmplitude = _mm512_loadu_ps(fAmplitude.data() + k);
+                for (uint32_t i = 0; i < length; i++) {
+                    const __m512i mIndex  = _mm512_add_epi32(mOffset, _mm512_srl_epi32(mPhase, mShift));
+                    const __m512  mFrac   = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(mPhase, mFractionMask)), mFractionScale);
+                    const __m512  a       = _mm512_i32gather_ps(mIndex, mTables, 4);
+                    const __m512  b       = _mm512_i32gather_ps(_mm512_add_epi32(mIndex, mOne), mTables, 4);
+                    const __m512  mSample = _mm512_mul_ps(_mm512_fmadd_ps(mFrac, _mm512_sub_ps(b, a), a), mAmplitude);
+                    for (uint8_t c = 0; c < fNumOutputs; c++) {
+                        float*       mSum  = mAccumulator + static_cast<size_t>(c) * CHUNK_SIZE * LANES + i * mLanes;
+                        const __m512 mGain = _mm512_loadu_ps(fGain.data() + static_cast<size_t>(c) * fNumPadded + k);
+                        _mm512_storeu_ps(mSum, _mm512_fmadd_ps(mSample, mGain, _mm512_loadu_ps(mSum)));
+                    }
+                    mPhase = _mm512_add_epi32(mPhase, mIncrement);
+                }
+                _mm512_storeu_si512(fPhase.data() + k, mPhase);
+            }
+        }
+#endif
+    };
+} // namespace klangwellen
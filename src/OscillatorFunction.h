@@ -25,17 +25,38 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t) *overwrite*
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
 
+#include <stdint.h>
+
+#include <cmath>
+
 #include "KlangWellen.h"
+#include "BufferKernels.h"
+#include "Random.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
+    /**
+     * oscillator that computes its waveform from a function instead of reading it from a table.
+     * <p>
+     * by default triangle, sawtooth, square and pulse are computed from the naive function, which aliases at higher
+     * frequencies. `set_band_limited(true)` computes them in float from a 32-bit fixed-point phase and corrects the
+     * discontinuities with polynomial band-limited steps ( PolyBLEP ) for sawtooth, square and pulse and with
+     * polynomial band-limited ramps ( PolyBLAMP ) for the corners of the triangle. this is considerably cheaper than
+     * a mipmapped wavetable for oscillators whose pitch is modulated heavily, the block `process` method computes 8 (
+     * AVX2 ) or 16 ( AVX-512 ) samples at a time.
+     */
     class OscillatorFunction {
     public:
         explicit OscillatorFunction(const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) : mSamplingRate(sample_rate) {
-            mWaveform = KlangWellen::WAVEFORM_SINE;
+            mWaveform  = KlangWellen::WAVEFORM_SINE;
+            mFrequency = 0.0;
+            mOffset    = 0.0f;
+            mPhase     = 0.0;
             set_frequency(DEFAULT_FREQUENCY);
             set_amplitude(DEFAULT_AMPLITUDE);
         }
@@ -48,6 +69,13 @@ namespace klangwellen {
             return mWaveform;
         }
 
+        /**
+         * seeds the random number generator of the noise waveform.
+         */
+        void set_seed(const uint32_t seed) {
+            fRandom.set_seed(seed);
+        }
+
         void set_waveform(const int pWaveform) {
             mWaveform = pWaveform;
         }
@@ -76,10 +104,40 @@ namespace klangwellen {
             if (mFrequency != pFrequency) {
                 mFrequency = pFrequency;
                 mStepSize  = mFrequency * (TWO_PI) / mSamplingRate;
+                update_phase_increment();
             }
         }
 
+        /**
+         * enables the band-limited computation of triangle, sawtooth, square and pulse. the band-limited mode keeps its
+         * own phase, sine and noise are not affected.
+         */
+        void set_band_limited(const bool band_limited) {
+            fBandLimited = band_limited;
+        }
+
+        bool get_band_limited() const {
+            return fBandLimited;
+        }
+
+        /**
+         * sets the width of the first ( low ) part of the pulse waveform.
+         *
+         * @param pulse_width width as fraction of a period ( 0.01 ... 0.99 )
+         */
+        void set_pulse_width(const float pulse_width) {
+            fPulseWidth = pulse_width < 0.01f ? 0.01f : (pulse_width > 0.99f ? 0.99f : pulse_width);
+        }
+
+        float get_pulse_width() const {
+            return fPulseWidth;
+        }
+
         float process() {
+            if (is_band_limited()) {
+                fPhaseFixed += fPhaseIncrement;
+                return band_limited(mWaveform, to_normalized(fPhaseFixed), phase_increment_normalized(), fPulseWidth) * mAmplitude + mOffset;
+            }
             double s;
             switch (mWaveform) {
                 case KlangWellen::WAVEFORM_SINE:
@@ -94,8 +152,11 @@ namespace klangwellen {
                 case KlangWellen::WAVEFORM_SQUARE:
                     s = process_square();
                     break;
+                case KlangWellen::WAVEFORM_PULSE:
+                    s = process_pulse();
+                    break;
                 case KlangWellen::WAVEFORM_NOISE:
-                    s = KlangWellen::random();
+                    s = fRandom.next();
                     break;
                 default:
                     s = 0.0f;
@@ -106,11 +167,40 @@ namespace klangwellen {
         }
 
         void process(float* signal_buffer, const uint32_t buffer_length) {
-            for (uint16_t i = 0; i < buffer_length; i++) {
+            if (mWaveform == KlangWellen::WAVEFORM_NOISE) {
+                fRandom.fill(signal_buffer, buffer_length);
+                for (uint32_t i = 0; i < buffer_length; i++) {
+                    signal_buffer[i] = static_cast<float>(static_cast<double>(signal_buffer[i]) * mAmplitude + mOffset);
+                }
+                return;
+            }
+            if (is_band_limited()) {
+                switch (BufferKernels::get_isa()) {
+#if KLANGWELLEN_SIMD_X86
+                    case BufferKernels::ISA_AVX512:
+                        process_band_limited_avx512(signal_buffer, buffer_length);
+                        return;
+                    case BufferKernels::ISA_AVX2:
+                        process_band_limited_avx2(signal_buffer, buffer_length);
+                        return;
+#endif
+                    default:
+                        break;
+                }
+            }
+            for (uint32_t i = 0; i < buffer_length; i++) {
                 signal_buffer[i] = process();
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
     private:
         static constexpr float DEFAULT_AMPLITUDE = 0.75f;
         static constexpr float DEFAULT_FREQUENCY = 220.0f;
@@ -122,6 +212,232 @@ namespace klangwellen {
         const double mSamplingRate;
         double       mStepSize;
         int          mWaveform;
+        Random       fRandom;
+        bool         fBandLimited    = false;
+        float        fPulseWidth     = 0.5f;
+        uint32_t     fPhaseFixed     = 0;
+        uint32_t     fPhaseIncrement = 0;
+
+        bool is_band_limited() const {
+            return fBandLimited && (mWaveform == KlangWellen::WAVEFORM_TRIANGLE ||
+                                    mWaveform == KlangWellen::WAVEFORM_SAWTOOTH ||
+                                    mWaveform == KlangWellen::WAVEFORM_SQUARE ||
+                                    mWaveform == KlangWellen::WAVEFORM_PULSE);
+        }
+
+        void update_phase_increment() {
+            const double mNormalized = std::fabs(mFrequency) / mSamplingRate;
+            /* the corrections require less than half a period per sample */
+            const double mFraction = mNormalized < 0.5 ? mNormalized : 0.5;
+            fPhaseIncrement        = static_cast<uint32_t>(mFraction * 4294967295.0);
+        }
+
+        /* the upper 24 bits of the phase are converted exactly */
+        static float to_normalized(const uint32_t phase) {
+            return static_cast<float>(phase >> 8) * (1.0f / 16777216.0f);
+        }
+
+        float phase_increment_normalized() const {
+            const float mIncrement = to_normalized(fPhaseIncrement);
+            return mIncrement > 0.0f ? mIncrement : 1.0f / 16777216.0f;
+        }
+
+        /* residual of a band-limited step of height 2 at `t = 0` */
+        static float blep(const float t, const float dt) {
+            if (t < dt) {
+                const float x = 1.0f - t / dt;
+                return -x * x;
+            }
+            if (t > 1.0f - dt) {
+                const float x = 1.0f + (t - 1.0f) / dt;
+                return x * x;
+            }
+            return 0.0f;
+        }
+
+        /* residual of a band-limited change of slope by 1 per sample at `t = 0` */
+        static float blamp(const float t, const float dt) {
+            if (t < dt) {
+                const float x = 1.0f - t / dt;
+                return x * x * x * (1.0f / 3.0f);
+            }
+            if (t > 1.0f - dt) {
+                const float x = 1.0f + (t - 1.0f) / dt;
+                return x * x * x * (1.0f / 3.0f);
+            }
+            return 0.0f;
+        }
+
+        static float wrap(const float t) {
+            return t < 0.0f ? t + 1.0f : t;
+        }
+
+        /* waveforms match the naive functions: ramp up sawtooth, square and pulse start low, triangle starts high */
+        static float band_limited(const int waveform, const float t, const float dt, const float pulse_width) {
+            switch (waveform) {
+                case KlangWellen::WAVEFORM_SAWTOOTH:
+                    return 2.0f * t - 1.0f - blep(t, dt);
+                case KlangWellen::WAVEFORM_TRIANGLE:
+                    return 4.0f * std::fabs(t - 0.5f) - 1.0f + 4.0f * dt * (blamp(wrap(t - 0.5f), dt) - blamp(t, dt));
+                default: {
+                    const float mWidth = waveform == KlangWellen::WAVEFORM_SQUARE ? 0.5f : pulse_width;
+                    return (t < mWidth ? -1.0f : 1.0f) - blep(t, dt) + blep(wrap(t - mWidth), dt);
+                }
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        KLANGWELLEN_TARGET_AVX2
+        static __m256 blep_avx2(const __m256 t, const __m256 dt, const __m256 inv_dt) {
+            const __m256 mOne   = _mm256_set1_ps(1.0f);
+            const __m256 a      = _mm256_fnmadd_ps(t, inv_dt, mOne);
+            const __m256 b      = _mm256_fmadd_ps(_mm256_sub_ps(t, mOne), inv_dt, mOne);
+            const __m256 mBegin = _mm256_cmp_ps(t, dt, _CMP_LT_OQ);
+            const __m256 mEnd   = _mm256_cmp_ps(t, _mm256_sub_ps(mOne, dt), _CMP_GT_OQ);
+            const __m256 r      = _mm256_and_ps(mEnd, _mm256_mul_ps(b, b));
+            return _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(a, a)), mBegin);
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        static __m256 blamp_avx2(const __m256 t, const __m256 dt, const __m256 inv_dt) {
+            const __m256 mOne   = _mm256_set1_ps(1.0f);
+            const __m256 mThird = _mm256_set1_ps(1.0f / 3.0f);
+            const __m256 a      = _mm256_fnmadd_ps(t, inv_dt, mOne);
+            const __m256 b      = _mm256_fmadd_ps(_mm256_sub_ps(t, mOne), inv_dt, mOne);
+            const __m256 mBegin = _mm256_cmp_ps(t, dt, _CMP_LT_OQ);
+            const __m256 mEnd   = _mm256_cmp_ps(t, _mm256_sub_ps(mOne, dt), _CMP_GT_OQ);
+            const __m256 x      = _mm256_blendv_ps(_mm256_and_ps(mEnd, b), a, mBegin);
+            return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(x, x), x), mThird);
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        static __m256 wrap_avx2(const __m256 t) {
+            return _mm256_add_ps(t, _mm256_and_ps(_mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_set1_ps(1.0f)));
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        void process_band_limited_avx2(float* signal_buffer, const uint32_t buffer_length) {
+            constexpr uint32_t mLanes      = 8;
+            const float        mDelta      = phase_increment_normalized();
+            const float        mWidth      = mWaveform == KlangWellen::WAVEFORM_SQUARE ? 0.5f : fPulseWidth;
+            const __m256       dt          = _mm256_set1_ps(mDelta);
+            const __m256       mInvDelta   = _mm256_set1_ps(1.0f / mDelta);
+            const __m256       mPulseWidth = _mm256_set1_ps(mWidth);
+            const __m256       mScale      = _mm256_set1_ps(1.0f / 16777216.0f);
+            const __m256       mOne        = _mm256_set1_ps(1.0f);
+            const __m256       mHalf       = _mm256_set1_ps(0.5f);
+            const __m256       mAbsMask    = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+            const __m256       mGain       = _mm256_set1_ps(mAmplitude);
+            const __m256       mBias       = _mm256_set1_ps(mOffset);
+            const __m256i      mIncrement  = _mm256_set1_epi32(static_cast<int>(fPhaseIncrement));
+            const __m256i      mStep       = _mm256_set1_epi32(static_cast<int>(fPhaseIncrement * mLanes));
+            __m256i            mPhase      = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(fPhaseFixed)),
+                                                              _mm256_mullo_epi32(_mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8), mIncrement));
+            uint32_t           i           = 0;
+            for (; i + mLanes <= buffer_length; i += mLanes) {
+                const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(mPhase, 8)), mScale);
+                __m256       s;
+                switch (mWaveform) {
+                    case KlangWellen::WAVEFORM_SAWTOOTH:
+                        s = _mm256_sub_ps(_mm256_fmsub_ps(_mm256_set1_ps(2.0f), t, mOne), blep_avx2(t, dt, mInvDelta));
+                        break;
+                    case KlangWellen::WAVEFORM_TRIANGLE: {
+                        const __m256 mCorners = _mm256_sub_ps(blamp_avx2(wrap_avx2(_mm256_sub_ps(t, mHalf)), dt, mInvDelta), blamp_avx2(t, dt, mInvDelta));
+                        s                     = _mm256_fmsub_ps(_mm256_set1_ps(4.0f), _mm256_and_ps(_mm256_sub_ps(t, mHalf), mAbsMask), mOne);
+                        s                     = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_set1_ps(4.0f), dt), mCorners, s);
+                        break;
+                    }
+                    default: {
+                        const __m256 mNaive = _mm256_blendv_ps(mOne, _mm256_set1_ps(-1.0f), _mm256_cmp_ps(t, mPulseWidth, _CMP_LT_OQ));
+                        s                   = _mm256_sub_ps(mNaive, blep_avx2(t, dt, mInvDelta));
+                        s                   = _mm256_add_ps(s, blep_avx2(wrap_avx2(_mm256_sub_ps(t, mPulseWidth)), dt, mInvDelta));
+                        break;
+                    }
+                }
+                _mm256_storeu_ps(signal_buffer + i, _mm256_fmadd_ps(s, mGain, mBias));
+                mPhase = _mm256_add_epi32(mPhase, mStep);
+            }
+            fPhaseFixed += fPhaseIncrement * i;
+            for (; i < buffer_length; i++) {
+                signal_buffer[i] = process();
+            }
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        static __m512 blep_avx512(const __m512 t, const __m512 dt, const __m512 inv_dt) {
+            const __m512    mOne   = _mm512_set1_ps(1.0f);
+            const __m512    a      = _mm512_fnmadd_ps(t, inv_dt, mOne);
+            const __m512    b      = _mm512_fmadd_ps(_mm512_sub_ps(t, mOne), inv_dt, mOne);
+            const __mmask16 mBegin = _mm512_cmp_ps_mask(t, dt, _CMP_LT_OQ);
+            const __mmask16 mEnd   = _mm512_cmp_ps_mask(t, _mm512_sub_ps(mOne, dt), _CMP_GT_OQ);
+            const __m512    r      = _mm512_maskz_mul_ps(mEnd, b, b);
+            return _mm512_mask_blend_ps(mBegin, r, _mm512_sub_ps(_mm512_setzero_ps(), _mm512_mul_ps(a, a)));
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        static __m512 blamp_avx512(const __m512 t, const __m512 dt, const __m512 inv_dt) {
+            const __m512    mOne   = _mm512_set1_ps(1.0f);
+            const __m512    mThird = _mm512_set1_ps(1.0f / 3.0f);
+            const __m512    a      = _mm512_fnmadd_ps(t, inv_dt, mOne);
+            const __m512    b      = _mm512_fmadd_ps(_mm512_sub_ps(t, mOne), inv_dt, mOne);
+            const __mmask16 mBegin = _mm512_cmp_ps_mask(t, dt, _CMP_LT_OQ);
+            const __mmask16 mEnd   = _mm512_cmp_ps_mask(t, _mm512_sub_ps(mOne, dt), _CMP_GT_OQ);
+            const __m512    x      = _mm512_mask_blend_ps(mBegin, _mm512_maskz_mov_ps(mEnd, b), a);
+            return _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(x, x), x), mThird);
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        static __m512 wrap_avx512(const __m512 t) {
+            return _mm512_mask_add_ps(t, _mm512_cmp_ps_mask(t, _mm512_setzero_ps(), _CMP_LT_OQ), t, _mm512_set1_ps(1.0f));
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        void process_band_limited_avx512(float* signal_buffer, const uint32_t buffer_length) {
+            constexpr uint32_t mLanes      = 16;
+            const float        mDelta      = phase_increment_normalized();
+            const float        mWidth      = mWaveform == KlangWellen::WAVEFORM_SQUARE ? 0.5f : fPulseWidth;
+            const __m512       dt          = _mm512_set1_ps(mDelta);
+            const __m512       mInvDelta   = _mm512_set1_ps(1.0f / mDelta);
+            const __m512       mPulseWidth = _mm512_set1_ps(mWidth);
+            const __m512       mScale      = _mm512_set1_ps(1.0f / 16777216.0f);
+            const __m512       mOne        = _mm512_set1_ps(1.0f);
+            const __m512       mHalf       = _mm512_set1_ps(0.5f);
+            const __m512       mGain       = _mm512_set1_ps(mAmplitude);
+            const __m512       mBias       = _mm512_set1_ps(mOffset);
+            const __m512i      mIncrement  = _mm512_set1_epi32(static_cast<int>(fPhaseIncrement));
+            const __m512i      mStep       = _mm512_set1_epi32(static_cast<int>(fPhaseIncrement * mLanes));
+            __m512i            mPhase      = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(fPhaseFixed)),
+                                                              _mm512_mullo_epi32(_mm512_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16), mIncrement));
+            uint32_t           i           = 0;
+            for (; i + mLanes <= buffer_length; i += mLanes) {
+                const __m512 t = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(mPhase, 8)), mScale);
+                __m512       s;
+                switch (mWaveform) {
+                    case KlangWellen::WAVEFORM_SAWTOOTH:
+                        s = _mm512_sub_ps(_mm512_fmsub_ps(_mm512_set1_ps(2.0f), t, mOne), blep_avx512(t, dt, mInvDelta));
+                        break;
+                    case KlangWellen::WAVEFORM_TRIANGLE: {
+                        const __m512 mCorners = _mm512_sub_ps(blamp_avx512(wrap_avx512(_mm512_sub_ps(t, mHalf)), dt, mInvDelta), blamp_avx512(t, dt, mInvDelta));
+                        s                     = _mm512_fmsub_ps(_mm512_set1_ps(4.0f), _mm512_abs_ps(_mm512_sub_ps(t, mHalf)), mOne);
+                        s                     = _mm512_fmadd_ps(_mm512_mul_ps(_mm512_set1_ps(4.0f), dt), mCorners, s);
+                        break;
+                    }
+                    default: {
+                        const __m512 mNaive = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(t, mPulseWidth, _CMP_LT_OQ), mOne, _mm512_set1_ps(-1.0f));
+                        s                   = _mm512_sub_ps(mNaive, blep_avx512(t, dt, mInvDelta));
+                        s                   = _mm512_add_ps(s, blep_avx512(wrap_avx512(_mm512_sub_ps(t, mPulseWidth)), dt, mInvDelta));
+                        break;
+                    }
+                }
+                _mm512_storeu_ps(signal_buffer + i, _mm512_fmadd_ps(s, mGain, mBias));
+                mPhase = _mm512_add_epi32(mPhase, mStep);
+            }
+            fPhaseFixed += fPhaseIncrement * i;
+            for (; i < buffer_length; i++) {
+                signal_buffer[i] = process();
+            }
+        }
+#endif
 
         double process_sawtooth() {
             mPhase += mFrequency;
@@ -143,6 +459,12 @@ namespace klangwellen {
             return mPhase > (mSamplingRate / 2.0f) ? KlangWellen::SIGNAL_MAX : KlangWellen::SIGNAL_MIN;
         }
 
+        double process_pulse() {
+            mPhase += mFrequency;
+            mPhase = mod(mPhase, mSamplingRate);
+            return mPhase > (mSamplingRate * fPulseWidth) ? KlangWellen::SIGNAL_MAX : KlangWellen::SIGNAL_MIN;
+        }
+
         double process_triangle() {
             mPhase += mFrequency;
             mPhase                        = mod(mPhase, mSamplingRate);
@@ -0,0 +1,516 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t)
+ * - [x] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "Scheduler.h"
+
+namespace klangwellen {
+    /**
+     * node in a `ProcessingGraph`. a node processes a complete block in place. the buffer passed to `process` holds
+     * the sum of all inputs connected to the node ( or silence if the node has no inputs ).
+     */
+    class ProcessingNode {
+    public:
+        virtual ~ProcessingNode() = default;
+
+        virtual void process(AudioBuffer& buffer) = 0;
+    };
+
+    /**
+     * wraps any processor that implements `void process(AudioBuffer&)`. the processor is referenced, not copied.
+     */
+    template<typename PROCESSOR_TYPE>
+    class ProcessingNodeProcessor final : public ProcessingNode {
+    public:
+        explicit ProcessingNodeProcessor(PROCESSOR_TYPE& processor) : fProcessor(processor) {}
+
+        void process(AudioBuffer& buffer) override {
+            fProcessor.process(buffer);
+        }
+
+    private:
+        PROCESSOR_TYPE& fProcessor;
+    };
+
+    /**
+     * renders a directed acyclic graph of processors block by block.
+     * <p>
+     * nodes are added with `add` ( or `add_input` for a node that receives the signal passed into `process` ) and
+     * connected with `connect`. a node receives the sum of all nodes connected to it. `set_output` selects the node
+     * whose signal is written to the output. after changing the graph `compile` must be called ( outside of the audio
+     * thread ) to update the processing order and the buffer assignment.
+     * <p>
+     * `compile` sorts the nodes topologically and computes for every node the position at which its signal is read for
+     * the last time. a buffer is returned to a pool after that position and is reused by the next node that needs one,
+     * and a node whose input dies at the node itself processes that input in place. the number of buffers therefore
+     * depends on the width of the graph ( i.e the maximum number of signals alive at the same time ) and not on the
+     * number of nodes. `process` does not allocate any memory and calls each node once per block.
+     * <p>
+     * with a `Scheduler` ( see `set_scheduler` ) independent branches of the graph are processed in parallel. buffer
+     * reuse then takes the possible concurrency into account, which may require more buffers.
+     * <p>
+     * all intermediate buffers have the same number of channels. blocks that are longer than the block size passed to
+     * the constructor are processed in multiple passes.
+     */
+    class ProcessingGraph {
+    public:
+        using NodeID = uint32_t;
+
+        static constexpr NodeID NO_NODE = 0xFFFFFFFF;
+
+        explicit ProcessingGraph(const uint8_t  num_channels = 2,
+                                 const uint32_t block_size   = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE)
+            : fNumChannels(num_channels),
+              fBlockSize(block_size),
+              fOutput(NO_NODE),
+              fCompiled(false) {}
+
+        ProcessingGraph(const ProcessingGraph&)            = delete;
+        ProcessingGraph& operator=(const ProcessingGraph&) = delete;
+
+        /**
+         * adds a processor to the graph. the processor must outlive the graph.
+         */
+        template<typename PROCESSOR_TYPE>
+        NodeID add(PROCESSOR_TYPE& processor) {
+            fOwnedNodes.emplace_back(new ProcessingNodeProcessor<PROCESSOR_TYPE>(processor));
+            return append_node(fOwnedNodes.back().get(), false);
+        }
+
+        /**
+         * adds a custom node to the graph. the node is not owned by the graph and must outlive it.
+         */
+        NodeID add_node(ProcessingNode* node) {
+            return append_node(node, false);
+        }
+
+        /**
+         * adds a node that receives the signal passed into `process`.
+         */
+        NodeID add_input() {
+            return append_node(nullptr, true);
+        }
+
+        /**
+         * connects the output of node `source` to the input of node `destination`.
+         * @return false if one of the nodes does not exist, if both are the same node or if the nodes are already
+         * connected.
+         */
+        bool connect(const NodeID source, const NodeID destination) {
+            if (source >= fNodes.size() || destination >= fNodes.size() || source == destination) {
+                return false;
+            }
+            std::vector<NodeID>& mInputs = fNodes[destination].inputs;
+            if (std::find(mInputs.begin(), mInputs.end(), source) != mInputs.end()) {
+                return false;
+            }
+            mInputs.push_back(source);
+            fCompiled = false;
+            return true;
+        }
+
+        bool disconnect(const NodeID source, const NodeID destination) {
+            if (destination >= fNodes.size()) {
+                return false;
+            }
+            std::vector<NodeID>& mInputs = fNodes[destination].inputs;
+            auto                  it      = std::find(mInputs.begin(), mInputs.end(), source);
+            if (it == mInputs.end()) {
+                return false;
+            }
+            mInputs.erase(it);
+            fCompiled = false;
+            return true;
+        }
+
+        /**
+         * connects a chain of nodes, e.g `chain({oscillator, envelope, filter})`.
+         */
+        bool chain(const std::initializer_list<NodeID> nodes) {
+            bool   mSuccess = true;
+            NodeID mPrev    = NO_NODE;
+            for (const NodeID mNode : nodes) {
+                if (mPrev != NO_NODE) {
+                    mSuccess &= connect(mPrev, mNode);
+                }
+                mPrev = mNode;
+            }
+            return mSuccess;
+        }
+
+        void set_output(const NodeID node) {
+            fOutput   = node;
+            fCompiled = false;
+        }
+
+        NodeID get_output() const {
+            return fOutput;
+        }
+
+        /**
+         * runs independent branches of the graph in parallel on the threads of `scheduler`. the scheduler must
+         * outlive the graph and must not be used by another graph at the same time. pass `nullptr` to process on the
+         * calling thread only. `compile` must be called afterwards.
+         */
+        void set_scheduler(Scheduler* scheduler) {
+            fScheduler = scheduler;
+            fCompiled  = false;
+        }
+
+        Scheduler* get_scheduler() const {
+            return fScheduler;
+        }
+
+        /**
+         * computes processing order and buffer assignment. must be called after the graph was changed and before
+         * `process`. allocates memory and should therefore not be called from the audio thread.
+         * @return false if the graph contains a cycle or if no valid output node is set
+         */
+        bool compile() {
+            fCompiled = false;
+            fSteps.clear();
+            fStepInputs.clear();
+            fBuffers.clear();
+
+            const NodeID mNumNodes = static_cast<NodeID>(fNodes.size());
+            if (fOutput >= mNumNodes) {
+                return false;
+            }
+
+            /* topological order ( Kahn ) */
+            std::vector<std::vector<NodeID>> mConsumers(mNumNodes);
+            std::vector<uint32_t>            mInDegree(mNumNodes, 0);
+            for (NodeID i = 0; i < mNumNodes; i++) {
+                for (const NodeID mInput : fNodes[i].inputs) {
+                    mConsumers[mInput].push_back(i);
+                    mInDegree[i]++;
+                }
+            }
+            std::vector<NodeID> mOrder;
+            mOrder.reserve(mNumNodes);
+            for (NodeID i = 0; i < mNumNodes; i++) {
+                if (mInDegree[i] == 0) {
+                    mOrder.push_back(i);
+                }
+            }
+            for (size_t i = 0; i < mOrder.size(); i++) {
+                for (const NodeID mConsumer : mConsumers[mOrder[i]]) {
+                    if (--mInDegree[mConsumer] == 0) {
+                        mOrder.push_back(mConsumer);
+                    }
+                }
+            }
+            if (mOrder.size() != mNumNodes) {
+                return false;
+            }
+
+            /* liveness: position of the last step that reads a node's signal */
+            std::vector<uint32_t> mPosition(mNumNodes);
+            for (uint32_t i = 0; i < mNumNodes; i++) {
+                mPosition[mOrder[i]] = i;
+            }
+            std::vector<uint32_t> mLastUse(mNumNodes);
+            for (NodeID i = 0; i < mNumNodes; i++) {
+                mLastUse[i] = mPosition[i];
+                for (const NodeID mConsumer : mConsumers[i]) {
+                    mLastUse[i] = std::max(mLastUse[i], mPosition[mConsumer]);
+                }
+            }
+            mLastUse[fOutput] = LIVE_UNTIL_END;
+
+            /*
+             * with a scheduler nodes on independent branches may run concurrently. a buffer may then only be reused by
+             * a node if the previous holder of the buffer and all nodes reading from it are ancestors of the node.
+             */
+            const bool             mParallel = fScheduler != nullptr;
+            const uint32_t         mWords    = (mNumNodes + 63) / 64;
+            std::vector<uint64_t>  mAncestors(mParallel ? static_cast<size_t>(mNumNodes) * mWords : 0, 0);
+            auto                   is_ancestor = [&](const NodeID ancestor, const NodeID node) {
+                return (mAncestors[static_cast<size_t>(node) * mWords + (ancestor >> 6)] >> (ancestor & 63)) & 1;
+            };
+            auto readers_precede = [&](const NodeID holder, const NodeID node) {
+                if (!mParallel) {
+                    return true;
+                }
+                if (holder != node && !is_ancestor(holder, node)) {
+                    return false;
+                }
+                for (const NodeID mConsumer : mConsumers[holder]) {
+                    if (mConsumer != node && !is_ancestor(mConsumer, node)) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+            if (mParallel) {
+                for (const NodeID mNodeID : mOrder) {
+                    uint64_t* mBits = &mAncestors[static_cast<size_t>(mNodeID) * mWords];
+                    for (const NodeID mInput : fNodes[mNodeID].inputs) {
+                        const uint64_t* mInputBits = &mAncestors[static_cast<size_t>(mInput) * mWords];
+                        for (uint32_t w = 0; w < mWords; w++) {
+                            mBits[w] |= mInputBits[w];
+                        }
+                        mBits[mInput >> 6] |= static_cast<uint64_t>(1) << (mInput & 63);
+                    }
+                }
+            }
+
+            /* buffer assignment */
+            std::vector<uint32_t> mBufferOf(mNumNodes, NO_BUFFER);
+            std::vector<NodeID>   mHolderOf;
+            std::vector<uint32_t> mFreeBuffers;
+            uint32_t              mNumBuffers = 0;
+            for (uint32_t mStepIndex = 0; mStepIndex < mNumNodes; mStepIndex++) {
+                const NodeID mNodeID = mOrder[mStepIndex];
+                const Node&  mNode   = fNodes[mNodeID];
+                Step         mStep{};
+                mStep.node        = mNode.node;
+                mStep.is_input    = mNode.is_input;
+                mStep.input_begin = static_cast<uint32_t>(fStepInputs.size());
+                mStep.in_place    = false;
+
+                /* process in place if one of the inputs is not read after this step */
+                NodeID mInPlaceInput = NO_NODE;
+                if (!mNode.is_input) {
+                    for (const NodeID mInput : mNode.inputs) {
+                        if (mLastUse[mInput] == mStepIndex && readers_precede(mInput, mNodeID)) {
+                            mInPlaceInput = mInput;
+                            break;
+                        }
+                    }
+                }
+                if (mInPlaceInput != NO_NODE) {
+                    mStep.buffer   = mBufferOf[mInPlaceInput];
+                    mStep.in_place = true;
+                } else {
+                    mStep.buffer = NO_BUFFER;
+                    for (size_t i = mFreeBuffers.size(); i-- > 0;) {
+                        if (readers_precede(mHolderOf[mFreeBuffers[i]], mNodeID)) {
+                            mStep.buffer = mFreeBuffers[i];
+                            mFreeBuffers.erase(mFreeBuffers.begin() + static_cast<std::ptrdiff_t>(i));
+                            break;
+                        }
+                    }
+                    if (mStep.buffer == NO_BUFFER) {
+                        mStep.buffer = mNumBuffers++;
+                        mHolderOf.push_back(mNodeID);
+                    }
+                }
+                mBufferOf[mNodeID]     = mStep.buffer;
+                mHolderOf[mStep.buffer] = mNodeID;
+
+                if (!mNode.is_input) {
+                    for (const NodeID mInput : mNode.inputs) {
+                        if (mInput != mInPlaceInput) {
+                            fStepInputs.push_back(mBufferOf[mInput]);
+                        }
+                    }
+                }
+                mStep.input_count = static_cast<uint32_t>(fStepInputs.size()) - mStep.input_begin;
+                fSteps.push_back(mStep);
+
+                /* release buffers of signals that are not read anymore */
+                for (const NodeID mInput : mNode.inputs) {
+                    if (mInput != mInPlaceInput && mLastUse[mInput] == mStepIndex) {
+                        mFreeBuffers.push_back(mBufferOf[mInput]);
+                    }
+                }
+                if (mLastUse[mNodeID] == mStepIndex) {
+                    mFreeBuffers.push_back(mStep.buffer);
+                }
+            }
+
+            fBuffers.reserve(mNumBuffers);
+            for (uint32_t i = 0; i < mNumBuffers; i++) {
+                fBuffers.emplace_back(fNumChannels, fBlockSize);
+            }
+            fOutputBuffer = mBufferOf[fOutput];
+
+            if (mParallel) {
+                fTaskSet.init(mNumNodes, execute_task, this);
+                for (uint32_t mStepIndex = 0; mStepIndex < mNumNodes; mStepIndex++) {
+                    for (const NodeID mInput : fNodes[mOrder[mStepIndex]].inputs) {
+                        fTaskSet.add_dependency(mPosition[mInput], mStepIndex);
+                    }
+                }
+                fScheduler->prepare(fTaskSet);
+            }
+            fCompiled = true;
+            return true;
+        }
+
+        bool is_compiled() const {
+            return fCompiled;
+        }
+
+        /**
+         * @return number of intermediate buffers allocated by the last call to `compile`
+         */
+        uint32_t num_buffers() const {
+            return static_cast<uint32_t>(fBuffers.size());
+        }
+
+        uint32_t num_nodes() const {
+            return static_cast<uint32_t>(fNodes.size());
+        }
+
+        uint8_t num_channels() const {
+            return fNumChannels;
+        }
+
+        uint32_t block_size() const {
+            return fBlockSize;
+        }
+
+        /**
+         * passes the buffer to the input nodes and overwrites it with the signal of the output node. channels that
+         * exceed the channel count of the graph are cleared.
+         */
+        void process(AudioBuffer& buffer) {
+            if (!fCompiled) {
+                buffer.clear();
+                return;
+            }
+            for (uint32_t mOffset = 0; mOffset < buffer.num_frames(); mOffset += fBlockSize) {
+                const uint32_t mLength = std::min(fBlockSize, buffer.num_frames() - mOffset);
+                AudioBuffer    mIO     = buffer.slice(mOffset, mLength);
+                process_block(mIO);
+            }
+        }
+
+        void process(float* signal_buffer, const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            AudioBuffer mBuffer(signal_buffer, buffer_length);
+            process(mBuffer);
+        }
+
+        void process(float*         signal_buffer_left,
+                     float*         signal_buffer_right,
+                     const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            AudioBuffer mBuffer(signal_buffer_left, signal_buffer_right, buffer_length);
+            process(mBuffer);
+        }
+
+    private:
+        static constexpr uint32_t NO_BUFFER      = 0xFFFFFFFF;
+        static constexpr uint32_t LIVE_UNTIL_END = 0xFFFFFFFF;
+
+        struct Node {
+            ProcessingNode*     node;
+            bool                is_input;
+            std::vector<NodeID> inputs;
+        };
+
+        struct Step {
+            ProcessingNode* node;
+            bool            is_input;
+            bool            in_place;
+            uint32_t        buffer;
+            uint32_t        input_begin;
+            uint32_t        input_count;
+        };
+
+        const uint8_t                                fNumChannels;
+        const uint32_t                               fBlockSize;
+        NodeID                                       fOutput;
+        bool                                         fCompiled;
+        uint32_t                                     fOutputBuffer = 0;
+        std::vector<Node>                            fNodes;
+        std::vector<std::unique_ptr<ProcessingNode>> fOwnedNodes;
+        std::vector<Step>                            fSteps;
+        std::vector<uint32_t>                        fStepInputs;
+        std::vector<AudioBuffer>                     fBuffers;
+        Scheduler*                                   fScheduler = nullptr;
+        TaskSet                                      fTaskSet;
+        AudioBuffer*                                 fCurrentIO = nullptr;
+
+        NodeID append_node(ProcessingNode* node, const bool is_input) {
+            fNodes.push_back({node, is_input, {}});
+            fCompiled = false;
+            return static_cast<NodeID>(fNodes.size() - 1);
+        }
+
+        static void execute_task(void* context, const uint32_t task) {
+            ProcessingGraph* mGraph = static_cast<ProcessingGraph*>(context);
+            mGraph->execute_step(mGraph->fSteps[task], *mGraph->fCurrentIO);
+        }
+
+        void execute_step(const Step& step, AudioBuffer& io) {
+            AudioBuffer mBuffer = fBuffers[step.buffer].slice(0, io.num_frames());
+            if (step.is_input) {
+                if (io.num_channels() < fNumChannels) {
+                    mBuffer.clear();
+                }
+                mBuffer.copy_from(io);
+                return;
+            }
+            uint32_t mFirst = 0;
+            if (!step.in_place) {
+                if (step.input_count == 0) {
+                    mBuffer.clear();
+                } else {
+                    mBuffer.copy_from(fBuffers[fStepInputs[step.input_begin]]);
+                    mFirst = 1;
+                }
+            }
+            for (uint32_t i = mFirst; i < step.input_count; i++) {
+                mBuffer.add(fBuffers[fStepInputs[step.input_begin + i]]);
+            }
+            if (step.node != nullptr) {
+                step.node->process(mBuffer);
+            }
+        }
+
+        void process_block(AudioBuffer& io) {
+            if (fScheduler != nullptr) {
+                fCurrentIO = &io;
+                fScheduler->run(fTaskSet);
+                fCurrentIO = nullptr;
+            } else {
+                for (const Step& mStep : fSteps) {
+                    execute_step(mStep, io);
+                }
+            }
+            io.copy_from(fBuffers[fOutputBuffer]);
+            for (uint8_t i = fNumChannels; i < io.num_channels(); i++) {
+                KlangWellen::fill(io.channel(i), 0.0f, io.num_frames());
+            }
+        }
+    };
+} // namespace klangwellen
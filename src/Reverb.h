@@ -25,11 +25,22 @@
  * - [x] void process(AudioSignal&)
  * - [ ] void process(float*, uint32_t)
  * - [x] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
 
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "KlangWellen.h"
 #include "AudioSignal.h"
+#include "AudioBuffer.h"
+#include "BufferKernels.h"
+#include "SilenceDetector.h"
 
 /**
  * applies reverb to a signal. {@link Reverb} uses an implementation of freeverb.
@@ -103,12 +114,42 @@ namespace klangwellen {
         // Code generated with Faust 0.9.9.5b2 (http://faust.grame.fr)
         //-----------------------------------------------------
 
+        /*
+         * the generated code is restructured for block processing: the 8 parallel comb filters of a channel run in the
+         * lanes of one vector ( see `process_combs_avx2` ) and the 4 allpasses run stage by stage over chunks of up to
+         * 64 samples. the delay lengths of the generated code are tuned for 44.1 kHz and are scaled to the sampling rate.
+         * each delay line is a ring buffer of exactly its delay length ( a sample is read before the sample that
+         * replaces it is written ), all delay lines are allocated in one block at construction.
+         * <p>
+         * once input and reverb tail are below the silence threshold ( see `SilenceDetector` ) the reverb clears its
+         * delay lines and writes zeros without processing until the input returns.
+         */
+
     public:
-        Reverb() {
+        explicit Reverb(const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) : fSampleRate(sample_rate),
+                                                                                         fDampExponent(static_cast<float>(TUNING_SAMPLE_RATE) / static_cast<float>(sample_rate)) {
             damp.set_now(0.5f);
             roomSize.set_now(0.5f);
             wet.set_now(0.3333f);
-            IOTA = 0;
+
+            uint32_t mMemorySize = 0;
+            fChunkSize           = CHUNK_SIZE;
+            for (uint8_t c = 0; c < 2; c++) {
+                for (uint8_t k = 0; k < NUM_COMBS + NUM_ALLPASSES; k++) {
+                    const uint32_t mTuning = k < NUM_COMBS ? COMB_TUNING[c][k] : ALLPASS_TUNING[c][k - NUM_COMBS];
+                    const uint8_t  mLine   = c * (NUM_COMBS + NUM_ALLPASSES) + k;
+                    const uint32_t mLength = static_cast<uint32_t>(std::lround(static_cast<double>(mTuning) * sample_rate / TUNING_SAMPLE_RATE));
+                    fLineSize[mLine]       = mLength < 1 ? 1 : mLength;
+                    fLineOffset[mLine]     = mMemorySize;
+                    fLinePosition[mLine]   = 0;
+                    mMemorySize += fLineSize[mLine];
+                    /* a chunk may not be longer than the shortest delay, see `process_allpasses` */
+                    fChunkSize = std::min(fChunkSize, fLineSize[mLine]);
+                }
+            }
+            fMemory.assign(mMemorySize, 0.0f);
+            /* the output is silent for at most the longest comb while the tail is still in the delay lines */
+            fSilence.set_hold(longest_comb());
         }
 
         void set_damp(float pDamp) {
@@ -135,6 +176,43 @@ namespace klangwellen {
             wet.set(pWet);
         }
 
+        uint32_t get_sample_rate() const {
+            return fSampleRate;
+        }
+
+        /**
+         * @return memory used by the reverb including its delay lines in bytes
+         */
+        size_t get_memory_size() const {
+            return sizeof(Reverb) + fMemory.size() * sizeof(float);
+        }
+
+        /**
+         * @param threshold amplitude below which input and output count as silent, 0 disables the silence detection
+         */
+        void set_silence_threshold(const float threshold) {
+            fSilence.set_threshold(threshold);
+        }
+
+        float get_silence_threshold() const {
+            return fSilence.get_threshold();
+        }
+
+        /**
+         * @return true if the reverb skips processing because input and tail are silent
+         */
+        bool is_sleeping() const {
+            return fSilence.is_sleeping();
+        }
+
+        /**
+         * @return estimated number of samples the reverb tail takes to decay below the silence threshold after the
+         *         input stopped
+         */
+        uint32_t get_tail_length() {
+            return SilenceDetector::decay_length(longest_comb(), 0.7f + 0.28f * roomSize.get_goal(), fSilence.get_threshold());
+        }
+
         void process(float*         output_signal_left,
                      float*         output_signal_right,
                      const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
@@ -143,493 +221,418 @@ namespace klangwellen {
                     output_signal_left, output_signal_right, buffer_length);
         }
 
+        /**
+         * processes the first two channels as a stereo signal. a mono buffer is processed as a mono signal.
+         */
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() >= 2) {
+                process(buffer.channel(0), buffer.channel(1), buffer.num_frames());
+            } else if (buffer.num_channels() == 1) {
+                process_frames(buffer.channel(0), nullptr, buffer.channel(0), nullptr, buffer.num_frames());
+            }
+        }
+
         void process(float*         output_signal_left,
                      float*         output_signal_right,
                      float*         input_signal_left,
                      float*         input_signal_right,
                      const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
-            fslider0 = damp.get();
-            fslider1 = roomSize.get();
-            fslider2 = wet.get();
-
-            const float fSlow0 = (0.4f * fslider0);
-            const float fSlow1 = (1 - fSlow0);
-            const float fSlow2 = (0.7f + (0.28f * fslider1));
-            const float fSlow3 = fslider2;
-            const float fSlow4 = (1 - fSlow3);
-            const int   count  = buffer_length;
-            for (int i = 0; i < count; i++) {
-                fRec9_0                = ((fSlow1 * fRec8_1) + (fSlow0 * fRec9_1));
-                const float fTemp0     = input_signal_right[i];
-                const float fTemp1     = input_signal_left[i];
-                const float fTemp2     = (1.500000e-02f * (fTemp1 + fTemp0));
-                const int   p          = IOTA & 2047;
-                fVec0[p]               = (fTemp2 + (fSlow2 * fRec9_0));
-                fRec8_0                = fVec0[(IOTA - 1617) & 2047];
-                fRec11_0               = ((fSlow1 * fRec10_1) + (fSlow0 * fRec11_1));
-                fVec1[p]               = (fTemp2 + (fSlow2 * fRec11_0));
-                fRec10_0               = fVec1[(IOTA - 1557) & 2047];
-                fRec13_0               = ((fSlow1 * fRec12_1) + (fSlow0 * fRec13_1));
-                fVec2[p]               = (fTemp2 + (fSlow2 * fRec13_0));
-                fRec12_0               = fVec2[(IOTA - 1491) & 2047];
-                fRec15_0               = ((fSlow1 * fRec14_1) + (fSlow0 * fRec15_1));
-                fVec3[p]               = (fTemp2 + (fSlow2 * fRec15_0));
-                fRec14_0               = fVec3[(IOTA - 1422) & 2047];
-                fRec17_0               = ((fSlow1 * fRec16_1) + (fSlow0 * fRec17_1));
-                fVec4[p]               = (fTemp2 + (fSlow2 * fRec17_0));
-                fRec16_0               = fVec4[(IOTA - 1356) & 2047];
-                fRec19_0               = ((fSlow1 * fRec18_1) + (fSlow0 * fRec19_1));
-                fVec5[p]               = (fTemp2 + (fSlow2 * fRec19_0));
-                fRec18_0               = fVec5[(IOTA - 1277) & 2047];
-                fRec21_0               = ((fSlow1 * fRec20_1) + (fSlow0 * fRec21_1));
-                fVec6[p]               = (fTemp2 + (fSlow2 * fRec21_0));
-                fRec20_0               = fVec6[(IOTA - 1188) & 2047];
-                fRec23_0               = ((fSlow1 * fRec22_1) + (fSlow0 * fRec23_1));
-                fVec7[p]               = (fTemp2 + (fSlow2 * fRec23_0));
-                fRec22_0               = fVec7[(IOTA - 1116) & 2047];
-                const float fTemp3     = (((((((fRec22_0 + fRec20_0) + fRec18_0) + fRec16_0) + fRec14_0) + fRec12_0) + fRec10_0) + fRec8_0);
-                fVec8[IOTA & 1023]     = (fTemp3 + (0.5f * fRec6_1));
-                fRec6_0                = fVec8[(IOTA - 556) & 1023];
-                const float fRec7      = (0 - (fTemp3 - fRec6_1));
-                fVec9[IOTA & 511]      = (fRec7 + (0.5f * fRec4_1));
-                fRec4_0                = fVec9[(IOTA - 441) & 511];
-                const float fRec5      = (fRec4_1 - fRec7);
-                fVec10[IOTA & 511]     = (fRec5 + (0.5f * fRec2_1));
-                fRec2_0                = fVec10[(IOTA - 341) & 511];
-                const float fRec3      = (fRec2_1 - fRec5);
-                fVec11[IOTA & 255]     = (fRec3 + (0.5f * fRec0_1));
-                fRec0_0                = fVec11[(IOTA - 225) & 255];
-                const float fRec1      = (fRec0_1 - fRec3);
-                output_signal_left[i]  = ((fSlow4 * fTemp1) + (fSlow3 * fRec1));
-                fRec33_0               = ((fSlow1 * fRec32_1) + (fSlow0 * fRec33_1));
-                fVec12[p]              = (fTemp2 + (fSlow2 * fRec33_0));
-                fRec32_0               = fVec12[(IOTA - 1640) & 2047];
-                fRec35_0               = ((fSlow1 * fRec34_1) + (fSlow0 * fRec35_1));
-                fVec13[p]              = (fTemp2 + (fSlow2 * fRec35_0));
-                fRec34_0               = fVec13[(IOTA - 1580) & 2047];
-                fRec37_0               = ((fSlow1 * fRec36_1) + (fSlow0 * fRec37_1));
-                fVec14[p]              = (fTemp2 + (fSlow2 * fRec37_0));
-                fRec36_0               = fVec14[(IOTA - 1514) & 2047];
-                fRec39_0               = ((fSlow1 * fRec38_1) + (fSlow0 * fRec39_1));
-                fVec15[p]              = (fTemp2 + (fSlow2 * fRec39_0));
-                fRec38_0               = fVec15[(IOTA - 1445) & 2047];
-                fRec41_0               = ((fSlow1 * fRec40_1) + (fSlow0 * fRec41_1));
-                fVec16[p]              = (fTemp2 + (fSlow2 * fRec41_0));
-                fRec40_0               = fVec16[(IOTA - 1379) & 2047];
-                fRec43_0               = ((fSlow1 * fRec42_1) + (fSlow0 * fRec43_1));
-                fVec17[p]              = (fTemp2 + (fSlow2 * fRec43_0));
-                fRec42_0               = fVec17[(IOTA - 1300) & 2047];
-                fRec45_0               = ((fSlow1 * fRec44_1) + (fSlow0 * fRec45_1));
-                fVec18[p]              = (fTemp2 + (fSlow2 * fRec45_0));
-                fRec44_0               = fVec18[(IOTA - 1211) & 2047];
-                fRec47_0               = ((fSlow1 * fRec46_1) + (fSlow0 * fRec47_1));
-                fVec19[p]              = (fTemp2 + (fSlow2 * fRec47_0));
-                fRec46_0               = fVec19[(IOTA - 1139) & 2047];
-                const float fTemp4     = (((((((fRec46_0 + fRec44_0) + fRec42_0) + fRec40_0) + fRec38_0) + fRec36_0) + fRec34_0) + fRec32_0);
-                fVec20[IOTA & 1023]    = (fTemp4 + (0.5f * fRec30_1));
-                fRec30_0               = fVec20[(IOTA - 579) & 1023];
-                const float fRec31     = (0 - (fTemp4 - fRec30_1));
-                fVec21[IOTA & 511]     = (fRec31 + (0.5f * fRec28_1));
-                fRec28_0               = fVec21[(IOTA - 464) & 511];
-                const float fRec29     = (fRec28_1 - fRec31);
-                fVec22[IOTA & 511]     = (fRec29 + (0.5f * fRec26_1));
-                fRec26_0               = fVec22[(IOTA - 364) & 511];
-                const float fRec27     = (fRec26_1 - fRec29);
-                fVec23[IOTA & 255]     = (fRec27 + (0.5f * fRec24_1));
-                fRec24_0               = fVec23[(IOTA - 248) & 255];
-                const float fRec25     = (fRec24_1 - fRec27);
-                output_signal_right[i] = ((fSlow4 * fTemp0) + (fSlow3 * fRec25));
-                // post processing
-                fRec24_1 = fRec24_0;
-                fRec26_1 = fRec26_0;
-                fRec28_1 = fRec28_0;
-                fRec30_1 = fRec30_0;
-                fRec46_1 = fRec46_0;
-                fRec47_1 = fRec47_0;
-                fRec44_1 = fRec44_0;
-                fRec45_1 = fRec45_0;
-                fRec42_1 = fRec42_0;
-                fRec43_1 = fRec43_0;
-                fRec40_1 = fRec40_0;
-                fRec41_1 = fRec41_0;
-                fRec38_1 = fRec38_0;
-                fRec39_1 = fRec39_0;
-                fRec36_1 = fRec36_0;
-                fRec37_1 = fRec37_0;
-                fRec34_1 = fRec34_0;
-                fRec35_1 = fRec35_0;
-                fRec32_1 = fRec32_0;
-                fRec33_1 = fRec33_0;
-                fRec0_1  = fRec0_0;
-                fRec2_1  = fRec2_0;
-                fRec4_1  = fRec4_0;
-                fRec6_1  = fRec6_0;
-                fRec22_1 = fRec22_0;
-                fRec23_1 = fRec23_0;
-                fRec20_1 = fRec20_0;
-                fRec21_1 = fRec21_0;
-                fRec18_1 = fRec18_0;
-                fRec19_1 = fRec19_0;
-                fRec16_1 = fRec16_0;
-                fRec17_1 = fRec17_0;
-                fRec14_1 = fRec14_0;
-                fRec15_1 = fRec15_0;
-                fRec12_1 = fRec12_0;
-                fRec13_1 = fRec13_0;
-                fRec10_1 = fRec10_0;
-                fRec11_1 = fRec11_0;
-                fRec8_1  = fRec8_0;
-                IOTA     = IOTA + 1;
-                fRec9_1  = fRec9_0;
-            }
+            process_frames(input_signal_left, input_signal_right, output_signal_left, output_signal_right, buffer_length);
         }
 
         void process(AudioSignal& signal) {
-            fslider0 = damp.get();
-            fslider1 = roomSize.get();
-            fslider2 = wet.get();
-
-            const float fSlow0 = (0.4f * fslider0);
-            const float fSlow1 = (1 - fSlow0);
-            const float fSlow2 = (0.7f + (0.28f * fslider1));
-            const float fSlow3 = fslider2;
-            const float fSlow4 = (1 - fSlow3);
-
-            fRec9_0             = ((fSlow1 * fRec8_1) + (fSlow0 * fRec9_1));
-            const float fTemp0  = signal.right;
-            const float fTemp1  = signal.left;
-            const float fTemp2  = (1.500000e-02f * (fTemp1 + fTemp0));
-            const int   p       = IOTA & 2047;
-            fVec0[p]            = (fTemp2 + (fSlow2 * fRec9_0));
-            fRec8_0             = fVec0[(IOTA - 1617) & 2047];
-            fRec11_0            = ((fSlow1 * fRec10_1) + (fSlow0 * fRec11_1));
-            fVec1[p]            = (fTemp2 + (fSlow2 * fRec11_0));
-            fRec10_0            = fVec1[(IOTA - 1557) & 2047];
-            fRec13_0            = ((fSlow1 * fRec12_1) + (fSlow0 * fRec13_1));
-            fVec2[p]            = (fTemp2 + (fSlow2 * fRec13_0));
-            fRec12_0            = fVec2[(IOTA - 1491) & 2047];
-            fRec15_0            = ((fSlow1 * fRec14_1) + (fSlow0 * fRec15_1));
-            fVec3[p]            = (fTemp2 + (fSlow2 * fRec15_0));
-            fRec14_0            = fVec3[(IOTA - 1422) & 2047];
-            fRec17_0            = ((fSlow1 * fRec16_1) + (fSlow0 * fRec17_1));
-            fVec4[p]            = (fTemp2 + (fSlow2 * fRec17_0));
-            fRec16_0            = fVec4[(IOTA - 1356) & 2047];
-            fRec19_0            = ((fSlow1 * fRec18_1) + (fSlow0 * fRec19_1));
-            fVec5[p]            = (fTemp2 + (fSlow2 * fRec19_0));
-            fRec18_0            = fVec5[(IOTA - 1277) & 2047];
-            fRec21_0            = ((fSlow1 * fRec20_1) + (fSlow0 * fRec21_1));
-            fVec6[p]            = (fTemp2 + (fSlow2 * fRec21_0));
-            fRec20_0            = fVec6[(IOTA - 1188) & 2047];
-            fRec23_0            = ((fSlow1 * fRec22_1) + (fSlow0 * fRec23_1));
-            fVec7[p]            = (fTemp2 + (fSlow2 * fRec23_0));
-            fRec22_0            = fVec7[(IOTA - 1116) & 2047];
-            const float fTemp3  = (((((((fRec22_0 + fRec20_0) + fRec18_0) + fRec16_0) + fRec14_0) + fRec12_0) + fRec10_0) + fRec8_0);
-            fVec8[IOTA & 1023]  = (fTemp3 + (0.5f * fRec6_1));
-            fRec6_0             = fVec8[(IOTA - 556) & 1023];
-            const float fRec7   = (0 - (fTemp3 - fRec6_1));
-            fVec9[IOTA & 511]   = (fRec7 + (0.5f * fRec4_1));
-            fRec4_0             = fVec9[(IOTA - 441) & 511];
-            const float fRec5   = (fRec4_1 - fRec7);
-            fVec10[IOTA & 511]  = (fRec5 + (0.5f * fRec2_1));
-            fRec2_0             = fVec10[(IOTA - 341) & 511];
-            const float fRec3   = (fRec2_1 - fRec5);
-            fVec11[IOTA & 255]  = (fRec3 + (0.5f * fRec0_1));
-            fRec0_0             = fVec11[(IOTA - 225) & 255];
-            const float fRec1   = (fRec0_1 - fRec3);
-            signal.left         = ((fSlow4 * fTemp1) + (fSlow3 * fRec1));
-            fRec33_0            = ((fSlow1 * fRec32_1) + (fSlow0 * fRec33_1));
-            fVec12[p]           = (fTemp2 + (fSlow2 * fRec33_0));
-            fRec32_0            = fVec12[(IOTA - 1640) & 2047];
-            fRec35_0            = ((fSlow1 * fRec34_1) + (fSlow0 * fRec35_1));
-            fVec13[p]           = (fTemp2 + (fSlow2 * fRec35_0));
-            fRec34_0            = fVec13[(IOTA - 1580) & 2047];
-            fRec37_0            = ((fSlow1 * fRec36_1) + (fSlow0 * fRec37_1));
-            fVec14[p]           = (fTemp2 + (fSlow2 * fRec37_0));
-            fRec36_0            = fVec14[(IOTA - 1514) & 2047];
-            fRec39_0            = ((fSlow1 * fRec38_1) + (fSlow0 * fRec39_1));
-            fVec15[p]           = (fTemp2 + (fSlow2 * fRec39_0));
-            fRec38_0            = fVec15[(IOTA - 1445) & 2047];
-            fRec41_0            = ((fSlow1 * fRec40_1) + (fSlow0 * fRec41_1));
-            fVec16[p]           = (fTemp2 + (fSlow2 * fRec41_0));
-            fRec40_0            = fVec16[(IOTA - 1379) & 2047];
-            fRec43_0            = ((fSlow1 * fRec42_1) + (fSlow0 * fRec43_1));
-            fVec17[p]           = (fTemp2 + (fSlow2 * fRec43_0));
-            fRec42_0            = fVec17[(IOTA - 1300) & 2047];
-            fRec45_0            = ((fSlow1 * fRec44_1) + (fSlow0 * fRec45_1));
-            fVec18[p]           = (fTemp2 + (fSlow2 * fRec45_0));
-            fRec44_0            = fVec18[(IOTA - 1211) & 2047];
-            fRec47_0            = ((fSlow1 * fRec46_1) + (fSlow0 * fRec47_1));
-            fVec19[p]           = (fTemp2 + (fSlow2 * fRec47_0));
-            fRec46_0            = fVec19[(IOTA - 1139) & 2047];
-            const float fTemp4  = (((((((fRec46_0 + fRec44_0) + fRec42_0) + fRec40_0) + fRec38_0) + fRec36_0) + fRec34_0) + fRec32_0);
-            fVec20[IOTA & 1023] = (fTemp4 + (0.5f * fRec30_1));
-            fRec30_0            = fVec20[(IOTA - 579) & 1023];
-            const float fRec31  = (0 - (fTemp4 - fRec30_1));
-            fVec21[IOTA & 511]  = (fRec31 + (0.5f * fRec28_1));
-            fRec28_0            = fVec21[(IOTA - 464) & 511];
-            const float fRec29  = (fRec28_1 - fRec31);
-            fVec22[IOTA & 511]  = (fRec29 + (0.5f * fRec26_1));
-            fRec26_0            = fVec22[(IOTA - 364) & 511];
-            const float fRec27  = (fRec26_1 - fRec29);
-            fVec23[IOTA & 255]  = (fRec27 + (0.5f * fRec24_1));
-            fRec24_0            = fVec23[(IOTA - 248) & 255];
-            const float fRec25  = (fRec24_1 - fRec27);
-            signal.right        = ((fSlow4 * fTemp0) + (fSlow3 * fRec25));
-            // post processing
-            fRec24_1 = fRec24_0;
-            fRec26_1 = fRec26_0;
-            fRec28_1 = fRec28_0;
-            fRec30_1 = fRec30_0;
-            fRec46_1 = fRec46_0;
-            fRec47_1 = fRec47_0;
-            fRec44_1 = fRec44_0;
-            fRec45_1 = fRec45_0;
-            fRec42_1 = fRec42_0;
-            fRec43_1 = fRec43_0;
-            fRec40_1 = fRec40_0;
-            fRec41_1 = fRec41_0;
-            fRec38_1 = fRec38_0;
-            fRec39_1 = fRec39_0;
-            fRec36_1 = fRec36_0;
-            fRec37_1 = fRec37_0;
-            fRec34_1 = fRec34_0;
-            fRec35_1 = fRec35_0;
-            fRec32_1 = fRec32_0;
-            fRec33_1 = fRec33_0;
-            fRec0_1  = fRec0_0;
-            fRec2_1  = fRec2_0;
-            fRec4_1  = fRec4_0;
-            fRec6_1  = fRec6_0;
-            fRec22_1 = fRec22_0;
-            fRec23_1 = fRec23_0;
-            fRec20_1 = fRec20_0;
-            fRec21_1 = fRec21_0;
-            fRec18_1 = fRec18_0;
-            fRec19_1 = fRec19_0;
-            fRec16_1 = fRec16_0;
-            fRec17_1 = fRec17_0;
-            fRec14_1 = fRec14_0;
-            fRec15_1 = fRec15_0;
-            fRec12_1 = fRec12_0;
-            fRec13_1 = fRec13_0;
-            fRec10_1 = fRec10_0;
-            fRec11_1 = fRec11_0;
-            fRec8_1  = fRec8_0;
-            IOTA     = IOTA + 1;
-            fRec9_1  = fRec9_0;
+            process_frame(signal.left, signal.right, 2, signal.left, signal.right);
         }
 
         float process(const float input) {
             float mOutput;
-            fslider0 = damp.get();
-            fslider1 = roomSize.get();
-            fslider2 = wet.get();
-
-            const float fSlow0 = (0.4f * fslider0);
-            const float fSlow1 = (1 - fSlow0);
-            const float fSlow2 = (0.7f + (0.28f * fslider1));
-            const float fSlow3 = fslider2;
-            const float fSlow4 = (1 - fSlow3);
-
-            fRec9_0            = ((fSlow1 * fRec8_1) + (fSlow0 * fRec9_1));
-            const float fTemp1 = input;
-            const float fTemp2 = (1.500000e-02f * (fTemp1 + fTemp1));
-            const int   p      = IOTA & 2047;
-            fVec0[p]           = (fTemp2 + (fSlow2 * fRec9_0));
-            fRec8_0            = fVec0[(IOTA - 1617) & 2047];
-            fRec11_0           = ((fSlow1 * fRec10_1) + (fSlow0 * fRec11_1));
-            fVec1[p]           = (fTemp2 + (fSlow2 * fRec11_0));
-            fRec10_0           = fVec1[(IOTA - 1557) & 2047];
-            fRec13_0           = ((fSlow1 * fRec12_1) + (fSlow0 * fRec13_1));
-            fVec2[p]           = (fTemp2 + (fSlow2 * fRec13_0));
-            fRec12_0           = fVec2[(IOTA - 1491) & 2047];
-            fRec15_0           = ((fSlow1 * fRec14_1) + (fSlow0 * fRec15_1));
-            fVec3[p]           = (fTemp2 + (fSlow2 * fRec15_0));
-            fRec14_0           = fVec3[(IOTA - 1422) & 2047];
-            fRec17_0           = ((fSlow1 * fRec16_1) + (fSlow0 * fRec17_1));
-            fVec4[p]           = (fTemp2 + (fSlow2 * fRec17_0));
-            fRec16_0           = fVec4[(IOTA - 1356) & 2047];
-            fRec19_0           = ((fSlow1 * fRec18_1) + (fSlow0 * fRec19_1));
-            fVec5[p]           = (fTemp2 + (fSlow2 * fRec19_0));
-            fRec18_0           = fVec5[(IOTA - 1277) & 2047];
-            fRec21_0           = ((fSlow1 * fRec20_1) + (fSlow0 * fRec21_1));
-            fVec6[p]           = (fTemp2 + (fSlow2 * fRec21_0));
-            fRec20_0           = fVec6[(IOTA - 1188) & 2047];
-            fRec23_0           = ((fSlow1 * fRec22_1) + (fSlow0 * fRec23_1));
-            fVec7[p]           = (fTemp2 + (fSlow2 * fRec23_0));
-            const float fTemp3 = (((((((fRec22_0 + fRec20_0) + fRec18_0) + fRec16_0) + fRec14_0) + fRec12_0) + fRec10_0) + fRec8_0);
-            fVec8[IOTA & 1023] = (fTemp3 + (0.5f * fRec6_1));
-            fRec6_0            = fVec8[(IOTA - 556) & 1023];
-            const float fRec7  = (0 - (fTemp3 - fRec6_1));
-            fVec9[IOTA & 511]  = (fRec7 + (0.5f * fRec4_1));
-            fRec4_0            = fVec9[(IOTA - 441) & 511];
-            const float fRec5  = (fRec4_1 - fRec7);
-            fVec10[IOTA & 511] = (fRec5 + (0.5f * fRec2_1));
-            fRec2_0            = fVec10[(IOTA - 341) & 511];
-            const float fRec3  = (fRec2_1 - fRec5);
-            fVec11[IOTA & 255] = (fRec3 + (0.5f * fRec0_1));
-            fRec0_0            = fVec11[(IOTA - 225) & 255];
-            const float fRec1  = (fRec0_1 - fRec3);
-            mOutput            = ((fSlow4 * fTemp1) + (fSlow3 * fRec1));
-
-            // post processing
-            fRec24_1 = fRec24_0;
-            fRec26_1 = fRec26_0;
-            fRec28_1 = fRec28_0;
-            fRec30_1 = fRec30_0;
-            fRec46_1 = fRec46_0;
-            fRec47_1 = fRec47_0;
-            fRec44_1 = fRec44_0;
-            fRec45_1 = fRec45_0;
-            fRec42_1 = fRec42_0;
-            fRec43_1 = fRec43_0;
-            fRec40_1 = fRec40_0;
-            fRec41_1 = fRec41_0;
-            fRec38_1 = fRec38_0;
-            fRec39_1 = fRec39_0;
-            fRec36_1 = fRec36_0;
-            fRec37_1 = fRec37_0;
-            fRec34_1 = fRec34_0;
-            fRec35_1 = fRec35_0;
-            fRec32_1 = fRec32_0;
-            fRec33_1 = fRec33_0;
-            fRec0_1  = fRec0_0;
-            fRec2_1  = fRec2_0;
-            fRec4_1  = fRec4_0;
-            fRec6_1  = fRec6_0;
-            fRec22_1 = fRec22_0;
-            fRec23_1 = fRec23_0;
-            fRec20_1 = fRec20_0;
-            fRec21_1 = fRec21_0;
-            fRec18_1 = fRec18_0;
-            fRec19_1 = fRec19_0;
-            fRec16_1 = fRec16_0;
-            fRec17_1 = fRec17_0;
-            fRec14_1 = fRec14_0;
-            fRec15_1 = fRec15_0;
-            fRec12_1 = fRec12_0;
-            fRec13_1 = fRec13_0;
-            fRec10_1 = fRec10_0;
-            fRec11_1 = fRec11_0;
-            fRec8_1  = fRec8_0;
-            IOTA     = IOTA + 1;
-            fRec9_1  = fRec9_0;
-
+            float mUnused;
+            process_frame(input, input, 1, mOutput, mUnused);
             return mOutput;
         }
 
     private:
-        static constexpr float largest_diff = 0.01f;
-        GlideVar               damp{0.5f, largest_diff};
-        GlideVar               roomSize{0.5f, largest_diff};
-        GlideVar               wet{0.3333f, largest_diff};
-        int                    IOTA;
-        float                  fRec0_0;
-        float                  fRec0_1;
-        float                  fRec10_0;
-        float                  fRec10_1;
-        float                  fRec11_0;
-        float                  fRec11_1;
-        float                  fRec12_0;
-        float                  fRec12_1;
-        float                  fRec13_0;
-        float                  fRec13_1;
-        float                  fRec14_0;
-        float                  fRec14_1;
-        float                  fRec15_0;
-        float                  fRec15_1;
-        float                  fRec16_0;
-        float                  fRec16_1;
-        float                  fRec17_0;
-        float                  fRec17_1;
-        float                  fRec18_0;
-        float                  fRec18_1;
-        float                  fRec19_0;
-        float                  fRec19_1;
-        float                  fRec20_0;
-        float                  fRec20_1;
-        float                  fRec21_0;
-        float                  fRec21_1;
-        float                  fRec22_0;
-        float                  fRec22_1;
-        float                  fRec23_0;
-        float                  fRec23_1;
-        float                  fRec24_0;
-        float                  fRec24_1;
-        float                  fRec26_0;
-        float                  fRec26_1;
-        float                  fRec28_0;
-        float                  fRec28_1;
-        float                  fRec2_0;
-        float                  fRec2_1;
-        float                  fRec30_0;
-        float                  fRec30_1;
-        float                  fRec32_0;
-        float                  fRec32_1;
-        float                  fRec33_0;
-        float                  fRec33_1;
-        float                  fRec34_0;
-        float                  fRec34_1;
-        float                  fRec35_0;
-        float                  fRec35_1;
-        float                  fRec36_0;
-        float                  fRec36_1;
-        float                  fRec37_0;
-        float                  fRec37_1;
-        float                  fRec38_0;
-        float                  fRec38_1;
-        float                  fRec39_0;
-        float                  fRec39_1;
-        float                  fRec40_0;
-        float                  fRec40_1;
-        float                  fRec41_0;
-        float                  fRec41_1;
-        float                  fRec42_0;
-        float                  fRec42_1;
-        float                  fRec43_0;
-        float                  fRec43_1;
-        float                  fRec44_0;
-        float                  fRec44_1;
-        float                  fRec45_0;
-        float                  fRec45_1;
-        float                  fRec46_0;
-        float                  fRec46_1;
-        float                  fRec47_0;
-        float                  fRec47_1;
-        float                  fRec4_0;
-        float                  fRec4_1;
-        float                  fRec6_0;
-        float                  fRec6_1;
-        float                  fRec8_0;
-        float                  fRec8_1;
-        float                  fRec9_0;
-        float                  fRec9_1;
-        float                  fVec0[2048];
-        float                  fVec1[2048];
-        float                  fVec10[512];
-        float                  fVec11[256];
-        float                  fVec12[2048];
-        float                  fVec13[2048];
-        float                  fVec14[2048];
-        float                  fVec15[2048];
-        float                  fVec16[2048];
-        float                  fVec17[2048];
-        float                  fVec18[2048];
-        float                  fVec19[2048];
-        float                  fVec2[2048];
-        float                  fVec20[1024];
-        float                  fVec21[512];
-        float                  fVec22[512];
-        float                  fVec23[256];
-        float                  fVec3[2048];
-        float                  fVec4[2048];
-        float                  fVec5[2048];
-        float                  fVec6[2048];
-        float                  fVec7[2048];
-        float                  fVec8[1024];
-        float                  fVec9[512];
-        float                  fslider0;
-        float                  fslider1;
-        float                  fslider2;
+        static constexpr uint8_t  NUM_COMBS                        = 8;
+        static constexpr uint8_t  NUM_ALLPASSES                    = 4;
+        static constexpr uint8_t  NUM_LINES                        = 2 * (NUM_COMBS + NUM_ALLPASSES);
+        static constexpr uint32_t TUNING_SAMPLE_RATE               = 44100;
+        static constexpr uint32_t COMB_TUNING[2][NUM_COMBS]        = {{1617, 1557, 1491, 1422, 1356, 1277, 1188, 1116},
+                                                                     {1640, 1580, 1514, 1445, 1379, 1300, 1211, 1139}};
+        static constexpr uint32_t ALLPASS_TUNING[2][NUM_ALLPASSES] = {{556, 441, 341, 225},
+                                                                     {579, 464, 364, 248}};
+        static constexpr uint32_t CHUNK_SIZE                       = 64;
+        static constexpr float    largest_diff                     = 0.01f;
+
+        const uint32_t fSampleRate;
+        GlideVar       damp{0.5f, largest_diff};
+        GlideVar       roomSize{0.5f, largest_diff};
+        GlideVar       wet{0.3333f, largest_diff};
+        uint32_t       fChunkSize;
+        /* exponent that scales the damping to the sample rate and the last damping it was applied to */
+        const float fDampExponent;
+        float       fDampInput  = -1.0f;
+        float       fDampScaled = 0.0f;
+        /* delay lines `[channel][combs, allpasses]` as offset into `fMemory`, length and current read/write position */
+        std::vector<float> fMemory;
+        uint32_t           fLineOffset[NUM_LINES];
+        uint32_t           fLineSize[NUM_LINES];
+        uint32_t           fLinePosition[NUM_LINES];
+        /* state of the damping low pass and the last output of each comb */
+        alignas(32) float fCombFilter[2][NUM_COMBS]{};
+        alignas(32) float fCombOutput[2][NUM_COMBS]{};
+        float             fAllpassOutput[2][NUM_ALLPASSES]{};
+        SilenceDetector   fSilence;
+
+        struct Parameters {
+            float damp;
+            float damp_inverse;
+            float feedback;
+            float wet;
+            float dry;
+        };
+
+        static uint8_t comb_line(const uint8_t channel, const uint8_t comb) {
+            return channel * (NUM_COMBS + NUM_ALLPASSES) + comb;
+        }
+
+        static uint8_t allpass_line(const uint8_t channel, const uint8_t allpass) {
+            return channel * (NUM_COMBS + NUM_ALLPASSES) + NUM_COMBS + allpass;
+        }
+
+        uint32_t longest_comb() const {
+            uint32_t mLength = 0;
+            for (uint8_t c = 0; c < 2; c++) {
+                for (uint8_t k = 0; k < NUM_COMBS; k++) {
+                    mLength = std::max(mLength, fLineSize[comb_line(c, k)]);
+                }
+            }
+            return mLength;
+        }
+
+        void clear_state() {
+            std::fill(fMemory.begin(), fMemory.end(), 0.0f);
+            std::fill_n(fCombFilter[0], 2 * NUM_COMBS, 0.0f);
+            std::fill_n(fCombOutput[0], 2 * NUM_COMBS, 0.0f);
+            std::fill_n(fAllpassOutput[0], 2 * NUM_ALLPASSES, 0.0f);
+        }
+
+        void advance_line(const uint8_t line) {
+            fLinePosition[line] = fLinePosition[line] + 1 == fLineSize[line] ? 0 : fLinePosition[line] + 1;
+        }
+
+        /* position of the line `offset` samples after its current position ( `offset` is less than the length ) */
+        uint32_t line_position(const uint8_t line, const uint32_t offset) const {
+            const uint32_t mPosition = fLinePosition[line] + offset;
+            return mPosition >= fLineSize[line] ? mPosition - fLineSize[line] : mPosition;
+        }
+
+        /* reads the glide variables, i.e advances them by one step */
+        Parameters next_parameters() {
+            Parameters p;
+            p.damp         = 0.4f * damp.get();
+            p.damp_inverse = 1 - p.damp;
+            p.feedback     = 0.7f + 0.28f * roomSize.get();
+            p.wet          = wet.get();
+            p.dry          = 1 - p.wet;
+            if (fSampleRate != TUNING_SAMPLE_RATE) {
+                /* keeps the cutoff frequency of the damping low pass, recomputed only while the damping changes */
+                if (p.damp != fDampInput) {
+                    fDampInput  = p.damp;
+                    fDampScaled = std::pow(p.damp, fDampExponent);
+                }
+                p.damp         = fDampScaled;
+                p.damp_inverse = 1 - p.damp;
+            }
+            return p;
+        }
+
+        /*
+         * processes a single frame directly on the delay lines, with the same result as `process_frames` with the
+         * scalar kernel. processes a mono signal if `channels` is 1, `right` is not written then.
+         */
+        void process_frame(const float input_left, const float input_right, const uint8_t channels, float& left, float& right) {
+            if (fSilence.skip(&input_left, channels == 2 ? &input_right : nullptr, 1)) {
+                left = 0.0f;
+                if (channels == 2) {
+                    right = 0.0f;
+                }
+                return;
+            }
+
+            const Parameters p      = next_parameters();
+            const float      mInput = 1.500000e-02f * (input_left + input_right);
+            const float      mDry[2]{input_left, input_right};
+            float* const     mOutput[2]{&left, &right};
+            for (uint8_t c = 0; c < channels; c++) {
+                float* const    mMemory   = fMemory.data();
+                const uint32_t* mOffset   = fLineOffset + comb_line(c, 0);
+                const uint32_t* mSize     = fLineSize + comb_line(c, 0);
+                uint32_t*       mPosition = fLinePosition + comb_line(c, 0);
+                float*          mFilter   = fCombFilter[c];
+                float*          mComb     = fCombOutput[c];
+                float           mWrite[NUM_COMBS];
+                for (uint8_t k = 0; k < NUM_COMBS; k++) {
+                    mFilter[k] = p.damp_inverse * mComb[k] + p.damp * mFilter[k];
+                    mWrite[k]  = mInput + p.feedback * mFilter[k];
+                }
+                for (uint8_t k = 0; k < NUM_COMBS; k++) {
+                    float* mSample = mMemory + mOffset[k] + mPosition[k];
+                    mComb[k]       = *mSample;
+                    *mSample       = mWrite[k];
+                }
+                for (uint8_t k = 0; k < NUM_COMBS; k++) {
+                    mPosition[k] = mPosition[k] + 1 == mSize[k] ? 0 : mPosition[k] + 1;
+                }
+                /* summed from the last to the first comb like the generated code */
+                float mSignal = mComb[NUM_COMBS - 1];
+                for (int8_t k = NUM_COMBS - 2; k >= 0; k--) {
+                    mSignal += mComb[k];
+                }
+                for (uint8_t k = 0; k < NUM_ALLPASSES; k++) {
+                    const uint8_t mLine     = allpass_line(c, k);
+                    float*        mSample   = fMemory.data() + fLineOffset[mLine] + fLinePosition[mLine];
+                    const float   mPrevious = fAllpassOutput[c][k];
+                    fAllpassOutput[c][k]    = *mSample;
+                    *mSample                = mSignal + 0.5f * mPrevious;
+                    mSignal                 = mPrevious - mSignal;
+                    advance_line(mLine);
+                }
+                *mOutput[c] = p.dry * mDry[c] + p.wet * mSignal;
+            }
+
+            if (fSilence.update(&left, channels == 2 ? &right : nullptr, 1)) {
+                clear_state();
+            }
+        }
+
+        /*
+         * processes a mono signal if `input_right` is `nullptr` ( only the left channel of the reverb runs and advances
+         * its delay lines ). each input frame is read before the output frame at the same position is written, so the
+         * output may alias the input.
+         */
+        void process_frames(const float*   input_left,
+                            const float*   input_right,
+                            float*         output_left,
+                            float*         output_right,
+                            const uint32_t length) {
+            if (length == 1) {
+                const uint8_t mChannels = input_right != nullptr ? 2 : 1;
+                process_frame(input_left[0],
+                              mChannels == 2 ? input_right[0] : input_left[0],
+                              mChannels,
+                              output_left[0],
+                              mChannels == 2 ? output_right[0] : output_left[0]);
+                return;
+            }
+            if (fSilence.skip(input_left, input_right, length)) {
+                std::fill_n(output_left, length, 0.0f);
+                if (input_right != nullptr) {
+                    std::fill_n(output_right, length, 0.0f);
+                }
+                return;
+            }
+
+            const Parameters p = next_parameters();
+
+            const uint8_t     mChannels = input_right != nullptr ? 2 : 1;
+            float* const      mOutput[2]{output_left, output_right};
+            alignas(32) float mInput[CHUNK_SIZE];
+            alignas(32) float mSignal[2][CHUNK_SIZE];
+            for (uint32_t i = 0; i < length; i += fChunkSize) {
+                const uint32_t mLength = std::min(fChunkSize, length - i);
+                for (uint32_t j = 0; j < mLength; j++) {
+                    const float mLeft  = input_left[i + j];
+                    const float mRight = mChannels == 2 ? input_right[i + j] : mLeft;
+                    mInput[j]          = 1.500000e-02f * (mLeft + mRight);
+                    /* the dry part goes to the output right away, the wet part is added below */
+                    mOutput[0][i + j] = p.dry * mLeft;
+                    if (mChannels == 2) {
+                        mOutput[1][i + j] = p.dry * mRight;
+                    }
+                }
+                /* the AVX2 kernel processes groups of 8 samples, the scalar kernel the rest */
+                uint32_t mProcessed = 0;
+#if KLANGWELLEN_SIMD_X86
+                if (BufferKernels::get_isa() >= BufferKernels::ISA_AVX2) {
+                    mProcessed = mLength & ~7u;
+                    if (mChannels == 2) {
+                        process_combs_avx2<2>(mInput, mSignal, mProcessed, p);
+                    } else {
+                        process_combs_avx2<1>(mInput, mSignal, mProcessed, p);
+                    }
+                }
+#endif
+                process_combs_scalar(mInput, mSignal, mChannels, mProcessed, mLength, p);
+                for (uint8_t c = 0; c < mChannels; c++) {
+                    process_allpasses(c, mSignal[c], mLength);
+                    for (uint32_t j = 0; j < mLength; j++) {
+                        mOutput[c][i + j] += p.wet * mSignal[c][j];
+                    }
+                }
+                for (uint8_t l = 0; l < mChannels * (NUM_COMBS + NUM_ALLPASSES); l++) {
+                    fLinePosition[l] = line_position(l, mLength);
+                }
+            }
+
+            if (fSilence.update(output_left, mChannels == 2 ? output_right : nullptr, length)) {
+                clear_state();
+            }
+        }
+
+        void process_combs_scalar(const float*      input,
+                                  float             output[2][CHUNK_SIZE],
+                                  const uint8_t     channels,
+                                  const uint32_t    offset,
+                                  const uint32_t    length,
+                                  const Parameters& p) {
+            for (uint8_t c = 0; c < channels; c++) {
+                float* mFilter = fCombFilter[c];
+                float* mComb   = fCombOutput[c];
+                for (uint32_t i = offset; i < length; i++) {
+                    for (uint8_t k = 0; k < NUM_COMBS; k++) {
+                        const uint8_t mLine   = comb_line(c, k);
+                        float*        mSample = fMemory.data() + fLineOffset[mLine] + line_position(mLine, i);
+                        mFilter[k]            = p.damp_inverse * mComb[k] + p.damp * mFilter[k];
+                        mComb[k]              = *mSample;
+                        *mSample              = input[i] + p.feedback * mFilter[k];
+                    }
+                    /* summed from the last to the first comb like the generated code */
+                    float mSum = mComb[NUM_COMBS - 1];
+                    for (int8_t k = NUM_COMBS - 2; k >= 0; k--) {
+                        mSum += mComb[k];
+                    }
+                    output[c][i] = mSum;
+                }
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        /*
+         * processes 8 samples at a time ( `length` is a multiple of 8 ): the 8 samples each comb reads are loaded from
+         * its delay line and transposed into one vector per sample with one comb per lane, the damping low passes of
+         * all combs run in these lanes and the samples to write are transposed back into the delay lines.
+         */
+        template <uint8_t CHANNELS>
+        KLANGWELLEN_TARGET_AVX2 void process_combs_avx2(const float*      input,
+                                                        float             output[2][CHUNK_SIZE],
+                                                        const uint32_t    length,
+                                                        const Parameters& p) {
+            const __m256 mDamp        = _mm256_set1_ps(p.damp);
+            const __m256 mDampInverse = _mm256_set1_ps(p.damp_inverse);
+            const __m256 mFeedback    = _mm256_set1_ps(p.feedback);
+            __m256       mFilter[CHANNELS];
+            __m256       mComb[CHANNELS];
+            for (uint8_t c = 0; c < CHANNELS; c++) {
+                mFilter[c] = _mm256_load_ps(fCombFilter[c]);
+                mComb[c]   = _mm256_load_ps(fCombOutput[c]);
+            }
+            /* the delay lines are copied to locals, the vector stores could alias the members */
+            float*   mLine[CHANNELS][NUM_COMBS];
+            uint32_t mSize[CHANNELS][NUM_COMBS];
+            uint32_t mPosition[CHANNELS][NUM_COMBS];
+            for (uint8_t c = 0; c < CHANNELS; c++) {
+                for (uint8_t k = 0; k < NUM_COMBS; k++) {
+                    mLine[c][k]     = fMemory.data() + fLineOffset[comb_line(c, k)];
+                    mSize[c][k]     = fLineSize[comb_line(c, k)];
+                    mPosition[c][k] = fLinePosition[comb_line(c, k)];
+                }
+            }
+            for (uint32_t i = 0; i < length; i += 8) {
+                __m256 mRows[CHANNELS][8];
+                for (uint8_t c = 0; c < CHANNELS; c++) {
+                    for (uint8_t k = 0; k < NUM_COMBS; k++) {
+                        mRows[c][k] = load_ring_avx2(mLine[c][k], mSize[c][k], mPosition[c][k]);
+                    }
+                    /* one vector per comb with one sample per lane, summed from the last to the first comb like the
+                     * generated code */
+                    __m256 mSum = mRows[c][NUM_COMBS - 1];
+                    for (int8_t k = NUM_COMBS - 2; k >= 0; k--) {
+                        mSum = _mm256_add_ps(mSum, mRows[c][k]);
+                    }
+                    _mm256_store_ps(output[c] + i, mSum);
+                    BufferKernels::transpose_8x8_avx2(mRows[c]);
+                }
+                /* one vector per sample, replaced by the samples written to the combs */
+                for (uint8_t j = 0; j < 8; j++) {
+                    const __m256 mInput = _mm256_set1_ps(input[i + j]);
+                    for (uint8_t c = 0; c < CHANNELS; c++) {
+                        mFilter[c]  = _mm256_add_ps(_mm256_mul_ps(mDampInverse, mComb[c]), _mm256_mul_ps(mDamp, mFilter[c]));
+                        mComb[c]    = mRows[c][j];
+                        mRows[c][j] = _mm256_add_ps(mInput, _mm256_mul_ps(mFeedback, mFilter[c]));
+                    }
+                }
+                for (uint8_t c = 0; c < CHANNELS; c++) {
+                    BufferKernels::transpose_8x8_avx2(mRows[c]);
+                    for (uint8_t k = 0; k < NUM_COMBS; k++) {
+                        store_ring_avx2(mLine[c][k], mSize[c][k], mPosition[c][k], mRows[c][k]);
+                        mPosition[c][k] = mPosition[c][k] + 8 >= mSize[c][k] ? mPosition[c][k] + 8 - mSize[c][k] : mPosition[c][k] + 8;
+                    }
+                }
+            }
+            for (uint8_t c = 0; c < CHANNELS; c++) {
+                _mm256_store_ps(fCombFilter[c], mFilter[c]);
+                _mm256_store_ps(fCombOutput[c], mComb[c]);
+            }
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        static __m256 load_ring_avx2(const float* ring, const uint32_t size, const uint32_t position) {
+            if (position + 8 <= size) {
+                return _mm256_loadu_ps(ring + position);
+            }
+            alignas(32) float mValues[8];
+            for (uint32_t j = 0; j < 8; j++) {
+                mValues[j] = ring[(position + j) % size];
+            }
+            return _mm256_load_ps(mValues);
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        static void store_ring_avx2(float* ring, const uint32_t size, const uint32_t position, const __m256 values) {
+            if (position + 8 <= size) {
+                _mm256_storeu_ps(ring + position, values);
+                return;
+            }
+            alignas(32) float mValues[8];
+            _mm256_store_ps(mValues, values);
+            for (uint32_t j = 0; j < 8; j++) {
+                ring[(position + j) % size] = mValues[j];
+            }
+        }
+#endif
+
+        /*
+         * runs the allpasses in series, each one over the whole chunk. the delays are at least as long as a chunk, so
+         * all samples a chunk reads are read before the chunk is written and the loops have no dependencies between
+         * samples.
+         */
+        void process_allpasses(const uint8_t channel, float* signal, const uint32_t length) {
+            float mPrevious[CHUNK_SIZE + 1];
+            float mWrite[CHUNK_SIZE];
+            for (uint8_t k = 0; k < NUM_ALLPASSES; k++) {
+                const uint8_t mLine   = allpass_line(channel, k);
+                float*        mMemory = fMemory.data() + fLineOffset[mLine];
+                mPrevious[0]          = fAllpassOutput[channel][k];
+                read_ring(mMemory, fLineSize[mLine], fLinePosition[mLine], mPrevious + 1, length);
+                for (uint32_t i = 0; i < length; i++) {
+                    mWrite[i] = signal[i] + 0.5f * mPrevious[i];
+                    signal[i] = mPrevious[i] - signal[i];
+                }
+                write_ring(mMemory, fLineSize[mLine], fLinePosition[mLine], mWrite, length);
+                fAllpassOutput[channel][k] = mPrevious[length];
+            }
+        }
+
+        static void read_ring(const float* ring, const uint32_t size, const uint32_t position, float* values, const uint32_t length) {
+            const uint32_t mFirst = std::min(length, size - position);
+            std::copy_n(ring + position, mFirst, values);
+            std::copy_n(ring, length - mFirst, values + mFirst);
+        }
+
+        static void write_ring(float* ring, const uint32_t size, const uint32_t position, const float* values, const uint32_t length) {
+            const uint32_t mFirst = std::min(length, size - position);
+            std::copy_n(values, mFirst, ring + position);
+            std::copy_n(values + mFirst, length - mFirst, ring);
+        }
     };
 } // namespace klangwellen
@@ -0,0 +1,645 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [x] float process(float)
+ * - [x] void process(AudioSignal&)
+ * - [ ] void process(float*, uint32_t)
+ * - [x] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "AudioSignal.h"
+#include "AudioBuffer.h"
+#include "BufferKernels.h"
+#include "SilenceDetector.h"
+
+namespace klangwellen {
+    /**
+     * applies reverb to a signal with a feedback delay network ( FDN ) of 8, 16 or 32 delay lines.
+     * <p>
+     * the outputs of the delay lines are damped, mixed by an orthogonal feedback matrix and written back into the lines
+     * together with the input. the matrix is either a normalized Hadamard matrix, applied as fast Walsh-Hadamard
+     * transform in `N log N` operations, or a Householder reflection `I - 2 / N` in `N` operations. the Hadamard
+     * matrix mixes every line into every other line, the Householder matrix is cheaper but keeps more of each line in
+     * itself. the delay lengths are primes spread exponentially between `MIN_DELAY` and `MAX_DELAY`, the read position
+     * of each line is modulated by a slow sine to smear the resonances of the lines.
+     * <p>
+     * each line has a gain and a one pole low pass so that every line decays by 60 dB within the decay time at low
+     * frequencies and within a shorter time at high frequencies ( see `set_damping` ), i.e the decay does not depend
+     * on the length of a line. compared to `Reverb` the network produces a denser tail for the same number of
+     * operations, since every sample read from a line is fed into all other lines.
+     */
+    class ReverbFDN {
+        /*
+         * the lines run in the lanes of vectors, one vector per 8 lines. all lines are ring buffers of the same power of
+         * two size in one block of memory, so a single write position addresses all of them and the modulated read
+         * positions are gathered with one index vector per 8 lines. the samples written to the lines are collected for 8
+         * samples and transposed into the lines, the shortest delay is longer than a chunk so no read depends on a
+         * sample that is not written yet.
+         * <p>
+         * once input and reverb tail are below the silence threshold ( see `SilenceDetector` ) the reverb clears its
+         * delay lines and writes zeros without processing until the input returns.
+         */
+    public:
+        static constexpr uint8_t HADAMARD             = 0;
+        static constexpr uint8_t HOUSEHOLDER          = 1;
+        static constexpr uint8_t MIN_LINES            = 8;
+        static constexpr uint8_t MAX_LINES            = 32;
+        static constexpr float   MIN_DELAY            = 0.011f; /* seconds */
+        static constexpr float   MAX_DELAY            = 0.053f; /* seconds */
+        static constexpr float   MAX_MODULATION_DEPTH = 0.002f; /* seconds */
+
+        /**
+         * @param num_lines   number of delay lines, rounded up to 8, 16 or 32
+         * @param sample_rate sample rate in Hz
+         * @param matrix      feedback matrix, `HADAMARD` or `HOUSEHOLDER`
+         */
+        explicit ReverbFDN(const uint8_t  num_lines   = 16,
+                           const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE,
+                           const uint8_t  matrix      = HADAMARD) : fSampleRate(sample_rate),
+                                                                    fNumLines(num_lines <= 8 ? 8 : (num_lines <= 16 ? 16 : 32)),
+                                                                    fMatrix(matrix == HOUSEHOLDER ? HOUSEHOLDER : HADAMARD) {
+            /* prime lengths keep the resonances of the lines from lining up */
+            uint32_t mPrevious = 0;
+            for (uint8_t i = 0; i < fNumLines; i++) {
+                const double mDelay = MIN_DELAY * std::pow(static_cast<double>(MAX_DELAY / MIN_DELAY), static_cast<double>(i) / (fNumLines - 1));
+                mPrevious           = next_prime(std::max(mPrevious + 1, static_cast<uint32_t>(std::lround(mDelay * sample_rate))));
+                fDelay[i]           = static_cast<int32_t>(mPrevious);
+            }
+            fMaxDepth = static_cast<uint32_t>(std::ceil(MAX_MODULATION_DEPTH * static_cast<float>(sample_rate)));
+
+            /* one more sample for the interpolation */
+            fLineSize = 1;
+            while (fLineSize < longest_line() + fMaxDepth + 2) {
+                fLineSize <<= 1;
+            }
+            const uint32_t mShortest = static_cast<uint32_t>(fDelay[0]) > fMaxDepth + 1 ? static_cast<uint32_t>(fDelay[0]) - fMaxDepth - 1 : 1;
+            fChunkSize               = std::min(CHUNK_SIZE, mShortest);
+            /* lines of a power of two size would start in the same cache set, one cache line between them spreads them */
+            fLineStride = fLineSize + 16;
+            fMemory.assign(static_cast<size_t>(fNumLines) * fLineStride, 0.0f);
+
+            /* the left input feeds the even lines, the right input the odd lines. the outputs tap the damped lines with
+             * the signs of the second and third row of the Hadamard matrix, so that the channels are decorrelated and
+             * the Hadamard transform computes them along the way. the output gain keeps the level independent of the
+             * number of lines ( about the level of `Reverb` ), the damped lines of the Hadamard matrix are already
+             * normalized ( see `update_coefficients` ) */
+            const float mInputGain = 1.0f / std::sqrt(static_cast<float>(fNumLines));
+            fOutputGain            = fMatrix == HADAMARD ? OUTPUT_GAIN * std::sqrt(static_cast<float>(fNumLines)) : OUTPUT_GAIN;
+            for (uint8_t i = 0; i < fNumLines; i++) {
+                const float mSign = (i & 4) ? -1.0f : 1.0f;
+                fInputLeft[i]     = (i & 1) ? 0.0f : mSign * mInputGain;
+                fInputRight[i]    = (i & 1) ? mSign * mInputGain : 0.0f;
+                fOutputLeft[i]    = ((i & 1) ? -1.0f : 1.0f) * fOutputGain;
+                fOutputRight[i]   = ((i & 2) ? -1.0f : 1.0f) * fOutputGain;
+                fPhase[i]         = static_cast<float>(2.0 * M_PI * i / fNumLines);
+                fRateSpread[i]    = 0.75f + 0.5f * static_cast<float>(i) / static_cast<float>(fNumLines - 1);
+            }
+            update_coefficients();
+            fSilence.set_hold(longest_line() + fMaxDepth + 1);
+        }
+
+        /**
+         * @param decay_time time in seconds the tail takes to decay by 60 dB at low frequencies
+         */
+        void set_decay_time(const float decay_time) {
+            fDecayTime = std::max(decay_time, 0.01f);
+            update_coefficients();
+        }
+
+        float get_decay_time() const {
+            return fDecayTime;
+        }
+
+        /**
+         * @param damping amount of high frequency damping between 0 and 1. at 1 high frequencies decay 20 times faster
+         *                than low frequencies.
+         */
+        void set_damping(const float damping) {
+            fDamping = KlangWellen::clamp(damping, 0, 1);
+            update_coefficients();
+        }
+
+        float get_damping() const {
+            return fDamping;
+        }
+
+        /**
+         * @param depth modulation depth of the delay lengths in seconds ( at most `MAX_MODULATION_DEPTH` )
+         */
+        void set_modulation_depth(const float depth) {
+            fModulationDepth = KlangWellen::clamp(depth, 0, MAX_MODULATION_DEPTH) * static_cast<float>(fSampleRate);
+        }
+
+        float get_modulation_depth() const {
+            return fModulationDepth / static_cast<float>(fSampleRate);
+        }
+
+        /**
+         * @param rate average modulation rate of the lines in Hz, each line runs at a slightly different rate
+         */
+        void set_modulation_rate(const float rate) {
+            fModulationRate = std::max(rate, 0.0f);
+        }
+
+        float get_modulation_rate() const {
+            return fModulationRate;
+        }
+
+        void set_wet(const float wet) {
+            fWet = KlangWellen::clamp(wet, 0, 1);
+        }
+
+        float get_wet() const {
+            return fWet;
+        }
+
+        uint8_t get_num_lines() const {
+            return fNumLines;
+        }
+
+        uint8_t get_matrix() const {
+            return fMatrix;
+        }
+
+        uint32_t get_sample_rate() const {
+            return fSampleRate;
+        }
+
+        /**
+         * @return memory used by the reverb including its delay lines in bytes
+         */
+        size_t get_memory_size() const {
+            return sizeof(ReverbFDN) + fMemory.capacity() * sizeof(float);
+        }
+
+        /**
+         * @param threshold amplitude below which input and output count as silent, 0 disables the silence detection
+         */
+        void set_silence_threshold(const float threshold) {
+            fSilence.set_threshold(threshold);
+        }
+
+        float get_silence_threshold() const {
+            return fSilence.get_threshold();
+        }
+
+        /**
+         * @return true if the reverb skips processing because input and tail are silent
+         */
+        bool is_sleeping() const {
+            return fSilence.is_sleeping();
+        }
+
+        /**
+         * @return estimated number of samples the reverb tail takes to decay below the silence threshold after the
+         *         input stopped
+         */
+        uint32_t get_tail_length() const {
+            return SilenceDetector::decay_length(longest_line(), line_gain(longest_line(), fDecayTime), fSilence.get_threshold());
+        }
+
+        /**
+         * clears the delay lines and filters
+         */
+        void reset() {
+            std::fill(fMemory.begin(), fMemory.end(), 0.0f);
+            std::fill_n(fFilter, MAX_LINES, 0.0f);
+        }
+
+        void process(float*         output_signal_left,
+                     float*         output_signal_right,
+                     const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process(output_signal_left,
+                    output_signal_right,
+                    output_signal_left, output_signal_right, buffer_length);
+        }
+
+        /**
+         * processes the first two channels as a stereo signal. a mono buffer is processed as a mono signal.
+         */
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() >= 2) {
+                process(buffer.channel(0), buffer.channel(1), buffer.num_frames());
+            } else if (buffer.num_channels() == 1) {
+                process_frames(buffer.channel(0), nullptr, buffer.channel(0), nullptr, buffer.num_frames());
+            }
+        }
+
+        void process(float*         output_signal_left,
+                     float*         output_signal_right,
+                     float*         input_signal_left,
+                     float*         input_signal_right,
+                     const uint32_t buffer_length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_frames(input_signal_left, input_signal_right, output_signal_left, output_signal_right, buffer_length);
+        }
+
+        void process(AudioSignal& signal) {
+            process_frames(&signal.left, &signal.right, &signal.left, &signal.right, 1);
+        }
+
+        float process(const float input) {
+            float mOutput;
+            process_frames(&input, nullptr, &mOutput, nullptr, 1);
+            return mOutput;
+        }
+
+    private:
+        static constexpr uint32_t CHUNK_SIZE  = 64;
+        static constexpr float    OUTPUT_GAIN = 0.35f;
+
+        const uint32_t fSampleRate;
+        const uint8_t  fNumLines;
+        const uint8_t  fMatrix;
+        float          fDecayTime       = 1.5f;
+        float          fDamping         = 0.5f;
+        float          fModulationDepth = 0.0003f * static_cast<float>(fSampleRate); /* samples */
+        float          fModulationRate  = 0.7f;
+        float          fWet             = 0.3333f;
+        float          fOutputGain;
+        uint32_t       fMaxDepth;
+        uint32_t       fChunkSize;
+        /* the lines `[line][fLineStride]`, of which the first `fLineSize` samples are used */
+        std::vector<float> fMemory;
+        uint32_t           fLineSize;
+        uint32_t           fLineStride;
+        uint32_t           fPosition = 0;
+        /* per line: delay length, coefficients of the damping low pass `y = pole * y + gain * x`, input and output
+         * taps and the delay modulation in samples, which moves by `fModulationStep` per sample towards a new target
+         * every `fChunkSize` samples */
+        alignas(32) int32_t fDelay[MAX_LINES]{};
+        alignas(32) float   fGain[MAX_LINES]{};
+        alignas(32) float   fPole[MAX_LINES]{};
+        alignas(32) float   fFilter[MAX_LINES]{};
+        alignas(32) float   fInputLeft[MAX_LINES]{};
+        alignas(32) float   fInputRight[MAX_LINES]{};
+        alignas(32) float   fOutputLeft[MAX_LINES]{};
+        alignas(32) float   fOutputRight[MAX_LINES]{};
+        alignas(32) float   fModulation[MAX_LINES]{};
+        alignas(32) float   fModulationStep[MAX_LINES]{};
+        float               fModulationTarget[MAX_LINES]{};
+        float               fPhase[MAX_LINES]{};
+        float               fRateSpread[MAX_LINES]{};
+        uint32_t            fModulationCountdown = 0;
+        SilenceDetector     fSilence;
+
+        static uint32_t next_prime(uint32_t value) {
+            while (true) {
+                bool mPrime = value > 1;
+                for (uint32_t d = 2; d * d <= value && mPrime; d++) {
+                    mPrime = value % d != 0;
+                }
+                if (mPrime) {
+                    return value;
+                }
+                value++;
+            }
+        }
+
+        uint32_t longest_line() const {
+            return static_cast<uint32_t>(fDelay[fNumLines - 1]);
+        }
+
+        /* gain that makes a line of `length` samples decay by 60 dB in `decay_time` seconds */
+        float line_gain(const uint32_t length, const float decay_time) const {
+            return std::pow(10.0f, -3.0f * static_cast<float>(length) / (decay_time * static_cast<float>(fSampleRate)));
+        }
+
+        /*
+         * the low pass of each line has the gain of the decay time at DC and the gain of the shorter high frequency
+         * decay time at nyquist. the normalization of the Hadamard matrix is part of the gain.
+         */
+        void update_coefficients() {
+            const float mHighDecayTime = fDecayTime * (1.0f - 0.95f * fDamping);
+            const float mScale         = fMatrix == HADAMARD ? 1.0f / std::sqrt(static_cast<float>(fNumLines)) : 1.0f;
+            for (uint8_t i = 0; i < fNumLines; i++) {
+                const float mLow  = line_gain(static_cast<uint32_t>(fDelay[i]), fDecayTime);
+                const float mHigh = line_gain(static_cast<uint32_t>(fDelay[i]), mHighDecayTime);
+                fPole[i]          = (mLow - mHigh) / (mLow + mHigh);
+                fGain[i]          = (1.0f - fPole[i]) * mLow * mScale;
+            }
+        }
+
+        void update_modulation() {
+            const float mOmega = static_cast<float>(2.0 * M_PI) * fModulationRate * static_cast<float>(fChunkSize) / static_cast<float>(fSampleRate);
+            for (uint8_t i = 0; i < fNumLines; i++) {
+                fPhase[i] += mOmega * fRateSpread[i];
+                if (fPhase[i] > static_cast<float>(2.0 * M_PI)) {
+                    fPhase[i] -= static_cast<float>(2.0 * M_PI);
+                }
+                fModulationTarget[i] = fModulationDepth * std::sin(fPhase[i]);
+                fModulationStep[i]   = (fModulationTarget[i] - fModulation[i]) / static_cast<float>(fChunkSize);
+            }
+            fModulationCountdown = fChunkSize;
+        }
+
+        /*
+         * processes a mono signal if `input_right` is `nullptr` ( only the left output is written ). all inputs of a
+         * chunk are read before its output is written, so the output may alias the input.
+         */
+        void process_frames(const float*   input_left,
+                            const float*   input_right,
+                            float*         output_left,
+                            float*         output_right,
+                            const uint32_t length) {
+            if (fSilence.skip(input_left, input_right, length)) {
+                std::fill_n(output_left, length, 0.0f);
+                if (input_right != nullptr) {
+                    std::fill_n(output_right, length, 0.0f);
+                }
+                return;
+            }
+
+            const float       mWet   = fWet;
+            const float       mDry   = 1.0f - mWet;
+            const float*      mRight = input_right != nullptr ? input_right : input_left;
+            alignas(32) float mSignal[2][CHUNK_SIZE];
+            for (uint32_t i = 0; i < length;) {
+                if (fModulationCountdown == 0) {
+                    update_modulation();
+                }
+                const uint32_t mLength = std::min(fModulationCountdown, length - i);
+#if KLANGWELLEN_SIMD_X86
+                if (BufferKernels::get_isa() >= BufferKernels::ISA_AVX2) {
+                    switch (fNumLines) {
+                        case 8:
+                            process_chunk_avx2<1>(input_left + i, mRight + i, mSignal, mLength);
+                            break;
+                        case 16:
+                            process_chunk_avx2<2>(input_left + i, mRight + i, mSignal, mLength);
+                            break;
+                        default:
+                            process_chunk_avx2<4>(input_left + i, mRight + i, mSignal, mLength);
+                            break;
+                    }
+                } else {
+                    process_chunk_scalar(input_left + i, mRight + i, mSignal, mLength);
+                }
+#else
+                process_chunk_scalar(input_left + i, mRight + i, mSignal, mLength);
+#endif
+                fPosition += mLength;
+                fModulationCountdown -= mLength;
+                if (fModulationCountdown == 0) {
+                    std::copy_n(fModulationTarget, fNumLines, fModulation);
+                }
+                for (uint32_t j = 0; j < mLength; j++) {
+                    output_left[i + j] = mDry * input_left[i + j] + mWet * mSignal[0][j];
+                }
+                if (input_right != nullptr) {
+                    for (uint32_t j = 0; j < mLength; j++) {
+                        output_right[i + j] = mDry * input_right[i + j] + mWet * mSignal[1][j];
+                    }
+                }
+                i += mLength;
+            }
+
+            if (fSilence.update(output_left, input_right != nullptr ? output_right : nullptr, length)) {
+                reset();
+            }
+        }
+
+        void process_chunk_scalar(const float*   input_left,
+                                  const float*   input_right,
+                                  float          output[2][CHUNK_SIZE],
+                                  const uint32_t length) {
+            /* the state is copied to locals, the writes to the lines could alias the members */
+            float* const   mLines = fMemory.data();
+            const uint32_t mMask  = fLineSize - 1;
+            float          mFilter[MAX_LINES];
+            float          mModulation[MAX_LINES];
+            float          mSignal[MAX_LINES];
+            std::copy_n(fFilter, fNumLines, mFilter);
+            std::copy_n(fModulation, fNumLines, mModulation);
+            for (uint32_t j = 0; j < length; j++) {
+                const uint32_t mPosition = fPosition + j;
+                float          mLeft     = 0.0f;
+                float          mRight    = 0.0f;
+                for (uint8_t l = 0; l < fNumLines; l++) {
+                    /* linear interpolation between the samples `delay + floor( modulation )` and one sample earlier */
+                    int32_t mFloor = static_cast<int32_t>(mModulation[l]);
+                    if (static_cast<float>(mFloor) > mModulation[l]) {
+                        mFloor--;
+                    }
+                    const float    mFraction = mModulation[l] - static_cast<float>(mFloor);
+                    const uint32_t mRead     = mPosition - static_cast<uint32_t>(fDelay[l] + mFloor);
+                    const float*   mLine     = mLines + static_cast<size_t>(l) * fLineStride;
+                    const float    a         = mLine[mRead & mMask];
+                    const float    b         = mLine[(mRead - 1) & mMask];
+                    const float    y         = a + mFraction * (b - a);
+                    mFilter[l]               = fPole[l] * mFilter[l] + fGain[l] * y;
+                    mSignal[l]               = mFilter[l];
+                    mLeft += fOutputLeft[l] * mSignal[l];
+                    mRight += fOutputRight[l] * mSignal[l];
+                    mModulation[l] += fModulationStep[l];
+                }
+                mix(mSignal);
+                for (uint8_t l = 0; l < fNumLines; l++) {
+                    mLines[static_cast<size_t>(l) * fLineStride + (mPosition & mMask)] = mSignal[l] + fInputLeft[l] * input_left[j] + fInputRight[l] * input_right[j];
+                }
+                output[0][j] = mLeft;
+                output[1][j] = mRight;
+            }
+            std::copy_n(mFilter, fNumLines, fFilter);
+            std::copy_n(mModulation, fNumLines, fModulation);
+        }
+
+        void mix(float* signal) const {
+            if (fMatrix == HADAMARD) {
+                /* fast Walsh-Hadamard transform, the normalization is part of the line gains */
+                for (uint8_t h = 1; h < fNumLines; h <<= 1) {
+                    for (uint8_t i = 0; i < fNumLines; i += 2 * h) {
+                        for (uint8_t j = i; j < i + h; j++) {
+                            const float a = signal[j];
+                            const float b = signal[j + h];
+                            signal[j]     = a + b;
+                            signal[j + h] = a - b;
+                        }
+                    }
+                }
+            } else {
+                float mSum = 0.0f;
+                for (uint8_t i = 0; i < fNumLines; i++) {
+                    mSum += signal[i];
+                }
+                mSum *= 2.0f / static_cast<float>(fNumLines);
+                for (uint8_t i = 0; i < fNumLines; i++) {
+                    signal[i] -= mSum;
+                }
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        /*
+         * processes the lines in `VECTORS` vectors of 8 lines. the two samples around each modulated read position are
+         * gathered from the lines, the Hadamard transform runs its first three stages inside the vectors and the
+         * remaining stages between the vectors.
+         */
+        template <uint8_t VECTORS>
+        KLANGWELLEN_TARGET_AVX2 void process_chunk_avx2(const float*   input_left,
+                                                        const float*   input_right,
+                                                        float          output[2][CHUNK_SIZE],
+                                                        const uint32_t length) {
+            const float*  mLines = fMemory.data();
+            const __m256i mMask  = _mm256_set1_epi32(static_cast<int32_t>(fLineSize - 1));
+            const __m256i mOne   = _mm256_set1_epi32(1);
+            __m256i       mOffset[VECTORS];
+            __m256i       mDelay[VECTORS];
+            __m256        mModulation[VECTORS];
+            __m256        mModulationStep[VECTORS];
+            __m256        mFilter[VECTORS];
+            for (uint8_t v = 0; v < VECTORS; v++) {
+                const int32_t mFirst = v * 8 * static_cast<int32_t>(fLineStride);
+                const int32_t mSize  = static_cast<int32_t>(fLineStride);
+                mOffset[v]           = _mm256_setr_epi32(mFirst, mFirst + mSize, mFirst + 2 * mSize, mFirst + 3 * mSize,
+                                                         mFirst + 4 * mSize, mFirst + 5 * mSize, mFirst + 6 * mSize, mFirst + 7 * mSize);
+                mDelay[v]            = _mm256_load_si256(reinterpret_cast<const __m256i*>(fDelay + v * 8));
+                mModulation[v]       = _mm256_load_ps(fModulation + v * 8);
+                mModulationStep[v]   = _mm256_load_ps(fModulationStep + v * 8);
+                mFilter[v]           = _mm256_load_ps(fFilter + v * 8);
+            }
+            /* the samples written to the lines, one vector per sample, transposed into the lines every 8 samples */
+            __m256 mRows[VECTORS][8];
+            for (uint32_t j = 0; j < length; j++) {
+                const __m256i mPosition = _mm256_set1_epi32(static_cast<int32_t>(fPosition + j));
+                __m256        mSignal[VECTORS];
+                for (uint8_t v = 0; v < VECTORS; v++) {
+                    const __m256  mFloor    = _mm256_floor_ps(mModulation[v]);
+                    const __m256  mFraction = _mm256_sub_ps(mModulation[v], mFloor);
+                    const __m256i mRead     = _mm256_sub_epi32(mPosition, _mm256_add_epi32(mDelay[v], _mm256_cvttps_epi32(mFloor)));
+                    const __m256i mIndexA   = _mm256_add_epi32(mOffset[v], _mm256_and_si256(mRead, mMask));
+                    const __m256i mIndexB   = _mm256_add_epi32(mOffset[v], _mm256_and_si256(_mm256_sub_epi32(mRead, mOne), mMask));
+                    const __m256  a         = _mm256_i32gather_ps(mLines, mIndexA, 4);
+                    const __m256  b         = _mm256_i32gather_ps(mLines, mIndexB, 4);
+                    const __m256  y         = _mm256_fmadd_ps(mFraction, _mm256_sub_ps(b, a), a);
+                    mFilter[v]              = _mm256_fmadd_ps(_mm256_load_ps(fPole + v * 8), mFilter[v], _mm256_mul_ps(_mm256_load_ps(fGain + v * 8), y));
+                    mSignal[v]              = mFilter[v];
+                    mModulation[v]          = _mm256_add_ps(mModulation[v], mModulationStep[v]);
+                }
+                mix_avx2<VECTORS>(mSignal, output[0][j], output[1][j]);
+                const __m256 mInputLeft  = _mm256_set1_ps(input_left[j]);
+                const __m256 mInputRight = _mm256_set1_ps(input_right[j]);
+                for (uint8_t v = 0; v < VECTORS; v++) {
+                    const __m256 mInput = _mm256_fmadd_ps(_mm256_load_ps(fInputRight + v * 8), mInputRight,
+                                                          _mm256_mul_ps(_mm256_load_ps(fInputLeft + v * 8), mInputLeft));
+                    mRows[v][j & 7]     = _mm256_add_ps(mSignal[v], mInput);
+                }
+                if ((j & 7) == 7) {
+                    write_rows_avx2<VECTORS>(mRows, fPosition + j - 7, 8);
+                }
+            }
+            if ((length & 7) != 0) {
+                write_rows_avx2<VECTORS>(mRows, fPosition + (length & ~7u), length & 7);
+            }
+            for (uint8_t v = 0; v < VECTORS; v++) {
+                _mm256_store_ps(fModulation + v * 8, mModulation[v]);
+                _mm256_store_ps(fFilter + v * 8, mFilter[v]);
+            }
+        }
+
+        /* writes `length` samples starting at `position` into the lines */
+        template <uint8_t VECTORS>
+        KLANGWELLEN_TARGET_AVX2 void write_rows_avx2(__m256 rows[VECTORS][8], const uint32_t position, const uint32_t length) {
+            const uint32_t mMask  = fLineSize - 1;
+            const uint32_t mStart = position & mMask;
+            for (uint8_t v = 0; v < VECTORS; v++) {
+                float* mLine = fMemory.data() + static_cast<size_t>(v) * 8 * fLineStride;
+                if (length == 8 && mStart + 8 <= fLineSize) {
+                    BufferKernels::transpose_8x8_avx2(rows[v]);
+                    for (uint8_t k = 0; k < 8; k++) {
+                        _mm256_storeu_ps(mLine + static_cast<size_t>(k) * fLineStride + mStart, rows[v][k]);
+                    }
+                    continue;
+                }
+                alignas(32) float mValues[8];
+                for (uint32_t j = 0; j < length; j++) {
+                    _mm256_store_ps(mValues, rows[v][j]);
+                    for (uint8_t k = 0; k < 8; k++) {
+                        mLine[static_cast<size_t>(k) * fLineStride + ((position + j) & mMask)] = mValues[k];
+                    }
+                }
+            }
+        }
+
+        /* mixes the lines and computes the outputs, which tap the lines before they are mixed */
+        template <uint8_t VECTORS>
+        KLANGWELLEN_TARGET_AVX2 void mix_avx2(__m256 signal[VECTORS], float& left, float& right) const {
+            if (fMatrix == HADAMARD) {
+                /* butterflies between neighbouring lanes, pairs of lanes and halves of the vectors ... */
+                const __m256 mSign1 = _mm256_setr_ps(1, -1, 1, -1, 1, -1, 1, -1);
+                const __m256 mSign2 = _mm256_setr_ps(1, 1, -1, -1, 1, 1, -1, -1);
+                const __m256 mSign4 = _mm256_setr_ps(1, 1, 1, 1, -1, -1, -1, -1);
+                for (uint8_t v = 0; v < VECTORS; v++) {
+                    __m256 x  = signal[v];
+                    x         = _mm256_fmadd_ps(x, mSign1, _mm256_permute_ps(x, 0xB1));
+                    x         = _mm256_fmadd_ps(x, mSign2, _mm256_permute_ps(x, 0x4E));
+                    x         = _mm256_fmadd_ps(x, mSign4, _mm256_permute2f128_ps(x, x, 0x01));
+                    signal[v] = x;
+                }
+                /* ... and between the vectors */
+                for (uint8_t h = 1; h < VECTORS; h <<= 1) {
+                    for (uint8_t i = 0; i < VECTORS; i += 2 * h) {
+                        for (uint8_t j = i; j < i + h; j++) {
+                            const __m256 a = signal[j];
+                            const __m256 b = signal[j + h];
+                            signal[j]      = _mm256_add_ps(a, b);
+                            signal[j + h]  = _mm256_sub_ps(a, b);
+                        }
+                    }
+                }
+                /* the second and third line of the transform are the outputs */
+                const __m128 mFirst = _mm256_castps256_ps128(signal[0]);
+                left                = fOutputGain * _mm_cvtss_f32(_mm_movehdup_ps(mFirst));
+                right               = fOutputGain * _mm_cvtss_f32(_mm_movehl_ps(mFirst, mFirst));
+            } else {
+                __m256 mSum   = signal[0];
+                __m256 mLeft  = _mm256_mul_ps(_mm256_load_ps(fOutputLeft), signal[0]);
+                __m256 mRight = _mm256_mul_ps(_mm256_load_ps(fOutputRight), signal[0]);
+                for (uint8_t v = 1; v < VECTORS; v++) {
+                    mSum   = _mm256_add_ps(mSum, signal[v]);
+                    mLeft  = _mm256_fmadd_ps(_mm256_load_ps(fOutputLeft + v * 8), signal[v], mLeft);
+                    mRight = _mm256_fmadd_ps(_mm256_load_ps(fOutputRight + v * 8), signal[v], mRight);
+                }
+                /* the three sums in the first lanes of one vector */
+                const __m256 mPairs = _mm256_hadd_ps(_mm256_hadd_ps(mSum, mLeft), _mm256_hadd_ps(mRight, mRight));
+                const __m128 mSums  = _mm_add_ps(_mm256_castps256_ps128(mPairs), _mm256_extractf128_ps(mPairs, 1));
+                const __m256 mReflection = _mm256_set1_ps(_mm_cvtss_f32(mSums) * 2.0f / static_cast<float>(VECTORS * 8));
+                left                     = _mm_cvtss_f32(_mm_movehdup_ps(mSums));
+                right                    = _mm_cvtss_f32(_mm_movehl_ps(mSums, mSums));
+                for (uint8_t v = 0; v < VECTORS; v++) {
+                    signal[v] = _mm256_sub_ps(signal[v], mReflection);
+                }
+            }
+        }
+#endif
+    };
+} // namespace klangwellen
@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -39,6 +40,7 @@
 #include <string>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
 
 using namespace std;
 
@@ -4498,6 +4500,14 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
         uint8_t set_pitch_from_MIDI_note(uint8_t MIDI_note) {
             if (MIDI_note >= 21 && MIDI_note <= 127) {
                 const uint8_t mSAMPitch = SAM_MIDI_NOTE_TOSAM_PITCH_MAP[MIDI_note - 21];
@@ -0,0 +1,444 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [x] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t)
+ * - [x] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "BufferKernels.h"
+#include "Filter.h"
+
+namespace klangwellen {
+    /**
+     * cascade of biquad filters ( second-order sections ) for one or more channels, e.g a parametric EQ or a high-order
+     * low pass filter.
+     * <p>
+     * the coefficients and the state of all sections and channels are stored contiguously and the sections are computed
+     * in transposed direct form II. blocks of 4 or more channels are computed 8 channels at a time ( AVX2 ). single
+     * channels are computed with the sections as SIMD lanes: section `k` processes sample `n - k` while section `k - 1`
+     * processes sample `n - k + 1`, which runs up to 8 ( AVX2 ) or 16 ( AVX-512 ) sections in parallel without latency.
+     * <p>
+     * sections pass the signal unchanged until they are configured with `set_section` or `set_coefficients`. channel 0
+     * is used by `float process(float)` and `void process(float*, uint32_t)`, channel 0 and 1 by the stereo `process`
+     * method.
+     */
+    class SOSFilter {
+    public:
+        static constexpr uint8_t MAX_CHANNELS = KLANGWELLEN_AUDIOBUFFER_MAX_CHANNELS;
+        static constexpr uint8_t ALL_CHANNELS = 0xFF;
+
+        /**
+         * @param num_sections number of biquad sections
+         * @param num_channels number of channels
+         * @param sample_rate  sampling rate
+         */
+        SOSFilter(const uint32_t num_sections,
+                  const uint8_t  num_channels = 1,
+                  const float    sample_rate  = KlangWellen::DEFAULT_SAMPLE_RATE) : fNumSections(num_sections < 1 ? 1 : num_sections),
+                                                                                   fNumChannels(num_channels < 1 ? 1 : (num_channels > MAX_CHANNELS ? MAX_CHANNELS : num_channels)),
+                                                                                   fSampleRate(sample_rate),
+                                                                                   fCoefficients(static_cast<size_t>(fNumChannels) * fNumSections * NUM_COEFFICIENTS, 0.0f),
+                                                                                   fState(static_cast<size_t>(fNumChannels) * fNumSections * 2, 0.0f),
+                                                                                   fGroupCoefficients(static_cast<size_t>(fNumSections) * NUM_COEFFICIENTS * GROUP_SIZE, 0.0f),
+                                                                                   fGroupState(static_cast<size_t>(fNumSections) * 2 * GROUP_SIZE, 0.0f) {
+            for (uint8_t c = 0; c < fNumChannels; c++) {
+                for (uint32_t k = 0; k < fNumSections; k++) {
+                    coefficients(k, c)[0] = 1.0f;
+                }
+            }
+        }
+
+        uint32_t get_num_sections() const {
+            return fNumSections;
+        }
+
+        uint8_t get_num_channels() const {
+            return fNumChannels;
+        }
+
+        /**
+         * configures a section as one of the filter types of `Filter` ( e.g `Filter::PEQ` ).
+         *
+         * @param section          index of section
+         * @param type             filter type
+         * @param dbGain           gain of filter ( for peaking and shelving filters )
+         * @param center_frequency center or cutoff frequency in Hz
+         * @param bandwidth        bandwidth in octaves
+         * @param channel          index of channel or `ALL_CHANNELS`
+         */
+        void set_section(const uint32_t section,
+                         const uint8_t  type,
+                         const float    dbGain,
+                         const float    center_frequency,
+                         const float    bandwidth,
+                         const uint8_t  channel = ALL_CHANNELS) {
+            float mCoefficients[NUM_COEFFICIENTS];
+            if (Filter::compute_coefficients(mCoefficients, type, dbGain, center_frequency, bandwidth, fSampleRate, false)) {
+                set_coefficients(section, mCoefficients, channel);
+            }
+        }
+
+        /**
+         * sets the coefficients of a section normalized to `a0`.
+         *
+         * @param section      index of section
+         * @param coefficients `{ b0, b1, b2, a1, a2 }`
+         * @param channel      index of channel or `ALL_CHANNELS`
+         */
+        void set_coefficients(const uint32_t section, const float* coefficients, const uint8_t channel = ALL_CHANNELS) {
+            if (section >= fNumSections) {
+                return;
+            }
+            for (uint8_t c = 0; c < fNumChannels; c++) {
+                if (channel == ALL_CHANNELS || channel == c) {
+                    float* mCoefficients = this->coefficients(section, c);
+                    for (uint8_t i = 0; i < NUM_COEFFICIENTS; i++) {
+                        mCoefficients[i] = coefficients[i];
+                    }
+                }
+            }
+        }
+
+        /**
+         * @return coefficients `{ b0, b1, b2, a1, a2 }` of a section
+         */
+        const float* get_coefficients(const uint32_t section, const uint8_t channel = 0) const {
+            return fCoefficients.data() + (static_cast<size_t>(channel < fNumChannels ? channel : 0) * fNumSections + (section < fNumSections ? section : 0)) * NUM_COEFFICIENTS;
+        }
+
+        void reset() {
+            std::fill(fState.begin(), fState.end(), 0.0f);
+        }
+
+        float process(const float signal) {
+            float mSample = signal;
+            process_scalar(&mSample, 1, 0);
+            return mSample;
+        }
+
+        void process(float* signal_buffer, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_channel(signal_buffer, length, 0);
+        }
+
+        void process(float* signal_buffer_left, float* signal_buffer_right, const uint32_t length = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_channel(signal_buffer_left, length, 0);
+            if (fNumChannels > 1) {
+                process_channel(signal_buffer_right, length, 1);
+            }
+        }
+
+        /**
+         * filters channel `c` of the buffer with channel `c` of the filter. channels without a matching filter channel
+         * are not changed.
+         */
+        void process(AudioBuffer& buffer) {
+            const uint8_t mChannels = buffer.num_channels() < fNumChannels ? buffer.num_channels() : fNumChannels;
+            float*        mBuffers[MAX_CHANNELS];
+            for (uint8_t c = 0; c < mChannels; c++) {
+                mBuffers[c] = buffer.channel(c);
+            }
+            process(mBuffers, mChannels, buffer.num_frames());
+        }
+
+        /**
+         * filters the buffers `0 ... num_buffers - 1` with the channels `0 ... num_buffers - 1`.
+         */
+        void process(float* const* buffers, const uint8_t num_buffers, const uint32_t length) {
+            const uint8_t mChannels = num_buffers < fNumChannels ? num_buffers : fNumChannels;
+            uint8_t       c         = 0;
+#if KLANGWELLEN_SIMD_X86
+            if (BufferKernels::get_isa() >= BufferKernels::ISA_AVX2) {
+                /* groups of channels, the last group may be partially filled */
+                for (; c + MIN_GROUP_CHANNELS <= mChannels; c += GROUP_SIZE) {
+                    const uint8_t mGroup = mChannels - c < GROUP_SIZE ? mChannels - c : GROUP_SIZE;
+                    process_channels_avx2(buffers + c, c, mGroup, length);
+                }
+            }
+#endif
+            for (; c < mChannels; c++) {
+                process_channel(buffers[c], length, c);
+            }
+        }
+
+    private:
+        static constexpr uint8_t NUM_COEFFICIENTS   = 5;
+        static constexpr uint8_t GROUP_SIZE         = 8;
+        static constexpr uint8_t MIN_GROUP_CHANNELS = 4;
+
+        const uint32_t     fNumSections;
+        const uint8_t      fNumChannels;
+        const float        fSampleRate;
+        /* `{ b0, b1, b2, a1, a2 }` per channel and section, `[channel][section][coefficient]` */
+        std::vector<float> fCoefficients;
+        /* `{ s1, s2 }` per channel and section, `[channel][section][state]` */
+        std::vector<float> fState;
+        /* coefficients and state of a group of channels, `[section][coefficient][channel]` */
+        std::vector<float> fGroupCoefficients;
+        std::vector<float> fGroupState;
+
+        float* coefficients(const uint32_t section, const uint8_t channel) {
+            return fCoefficients.data() + (static_cast<size_t>(channel) * fNumSections + section) * NUM_COEFFICIENTS;
+        }
+
+        float* state(const uint32_t section, const uint8_t channel) {
+            return fState.data() + (static_cast<size_t>(channel) * fNumSections + section) * 2;
+        }
+
+        void process_channel(float* signal_buffer, const uint32_t length, const uint8_t channel) {
+            switch (BufferKernels::get_isa()) {
+#if KLANGWELLEN_SIMD_X86
+                case BufferKernels::ISA_AVX512:
+                    for (uint32_t k = 0; k < fNumSections; k += 16) {
+                        process_sections_avx512(signal_buffer, length, channel, k, fNumSections - k < 16 ? fNumSections - k : 16);
+                    }
+                    return;
+                case BufferKernels::ISA_AVX2:
+                    for (uint32_t k = 0; k < fNumSections; k += 8) {
+                        process_sections_avx2(signal_buffer, length, channel, k, fNumSections - k < 8 ? fNumSections - k : 8);
+                    }
+                    return;
+#endif
+                default:
+                    process_scalar(signal_buffer, length, channel);
+                    return;
+            }
+        }
+
+        void process_scalar(float* signal_buffer, const uint32_t length, const uint8_t channel) {
+            for (uint32_t k = 0; k < fNumSections; k++) {
+                const float* mCoefficients = coefficients(k, channel);
+                const float  b0            = mCoefficients[0];
+                const float  b1            = mCoefficients[1];
+                const float  b2            = mCoefficients[2];
+                const float  a1            = mCoefficients[3];
+                const float  a2            = mCoefficients[4];
+                float*       mState        = state(k, channel);
+                float        s1            = mState[0];
+                float        s2            = mState[1];
+                for (uint32_t i = 0; i < length; i++) {
+                    const float x    = signal_buffer[i];
+                    const float y    = b0 * x + s1;
+                    s1               = b1 * x - a1 * y + s2;
+                    s2               = b2 * x - a2 * y;
+                    signal_buffer[i] = y;
+                }
+                mState[0] = s1;
+                mState[1] = s2;
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        /*
+         * computes the sections `first ... first + count - 1` of one channel with one section per lane. at step `t` lane
+         * `k` processes sample `t - k` and receives its input from the output of lane `k - 1` at step `t - 1`. the first
+         * and last `count - 1` steps only update the lanes that have a sample to process.
+         */
+        KLANGWELLEN_TARGET_AVX2
+        void process_sections_avx2(float* signal_buffer, const uint32_t length, const uint8_t channel, const uint32_t first, const uint32_t count) {
+            alignas(32) float mCoefficients[NUM_COEFFICIENTS][8] = {};
+            alignas(32) float mState[2][8]                       = {};
+            for (uint32_t k = 0; k < count; k++) {
+                for (uint8_t i = 0; i < NUM_COEFFICIENTS; i++) {
+                    mCoefficients[i][k] = coefficients(first + k, channel)[i];
+                }
+                mState[0][k] = state(first + k, channel)[0];
+                mState[1][k] = state(first + k, channel)[1];
+            }
+            const __m256  b0     = _mm256_load_ps(mCoefficients[0]);
+            const __m256  b1     = _mm256_load_ps(mCoefficients[1]);
+            const __m256  b2     = _mm256_load_ps(mCoefficients[2]);
+            const __m256  a1     = _mm256_load_ps(mCoefficients[3]);
+            const __m256  a2     = _mm256_load_ps(mCoefficients[4]);
+            __m256        s1     = _mm256_load_ps(mState[0]);
+            __m256        s2     = _mm256_load_ps(mState[1]);
+            __m256        y      = _mm256_setzero_ps();
+            const __m256i mShift = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+            const __m256i mLast  = _mm256_set1_epi32(static_cast<int>(count - 1));
+            const __m256i mLane  = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const uint32_t mSteps = length + count - 1;
+            for (uint32_t t = 0; t < mSteps; t++) {
+                const float  mInput = t < length ? signal_buffer[t] : 0.0f;
+                const __m256 x      = _mm256_blend_ps(_mm256_permutevar8x32_ps(y, mShift), _mm256_set1_ps(mInput), 0x01);
+                y                   = _mm256_fmadd_ps(b0, x, s1);
+                const __m256 s1n    = _mm256_fmadd_ps(b1, x, _mm256_fnmadd_ps(a1, y, s2));
+                const __m256 s2n    = _mm256_fnmadd_ps(a2, y, _mm256_mul_ps(b2, x));
+                if (t + 1 >= count && t < length) {
+                    s1 = s1n;
+                    s2 = s2n;
+                } else {
+                    /* lane `k` is active if `0 <= t - k < length` */
+                    const __m256i mSample = _mm256_sub_epi32(_mm256_set1_epi32(static_cast<int>(t)), mLane);
+                    const __m256i mActive = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), mSample),
+                                                                _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(length)), mSample));
+                    s1                    = _mm256_blendv_ps(s1, s1n, _mm256_castsi256_ps(mActive));
+                    s2                    = _mm256_blendv_ps(s2, s2n, _mm256_castsi256_ps(mActive));
+                }
+                if (t + 1 >= count) {
+                    signal_buffer[t + 1 - count] = _mm256_cvtss_f32(_mm256_permutevar8x32_ps(y, mLast));
+                }
+            }
+            _mm256_store_ps(mState[0], s1);
+            _mm256_store_ps(mState[1], s2);
+            for (uint32_t k = 0; k < count; k++) {
+                state(first + k, channel)[0] = mState[0][k];
+                state(first + k, channel)[1] = mState[1][k];
+            }
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        void process_sections_avx512(float* signal_buffer, const uint32_t length, const uint8_t channel, const uint32_t first, const uint32_t count) {
+            alignas(64) float mCoefficients[NUM_COEFFICIENTS][16] = {};
+            alignas(64) float mState[2][16]                       = {};
+            for (uint32_t k = 0; k < count; k++) {
+                for (uint8_t i = 0; i < NUM_COEFFICIENTS; i++) {
+                    mCoefficients[i][k] = coefficients(first + k, channel)[i];
+                }
+                mState[0][k] = state(first + k, channel)[0];
+                mState[1][k] = state(first + k, channel)[1];
+            }
+            const __m512   b0     = _mm512_load_ps(mCoefficients[0]);
+            const __m512   b1     = _mm512_load_ps(mCoefficients[1]);
+            const __m512   b2     = _mm512_load_ps(mCoefficients[2]);
+            const __m512   a1     = _mm512_load_ps(mCoefficients[3]);
+            const __m512   a2     = _mm512_load_ps(mCoefficients[4]);
+            __m512         s1     = _mm512_load_ps(mState[0]);
+            __m512         s2     = _mm512_load_ps(mState[1]);
+            __m512         y      = _mm512_setzero_ps();
+            const __m512i  mShift = _mm512_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14);
+            const __m512i  mLast  = _mm512_set1_epi32(static_cast<int>(count - 1));
+            const __m512i  mLane  = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            const uint32_t mSteps = length + count - 1;
+            for (uint32_t t = 0; t < mSteps; t++) {
+                const float  mInput = t < length ? signal_buffer[t] : 0.0f;
+                const __m512 x      = _mm512_mask_blend_ps(0x0001, _mm512_permutexvar_ps(mShift, y), _mm512_set1_ps(mInput));
+                y                   = _mm512_fmadd_ps(b0, x, s1);
+                const __m512 s1n    = _mm512_fmadd_ps(b1, x, _mm512_fnmadd_ps(a1, y, s2));
+                const __m512 s2n    = _mm512_fnmadd_ps(a2, y, _mm512_mul_ps(b2, x));
+                if (t + 1 >= count && t < length) {
+                    s1 = s1n;
+                    s2 = s2n;
+                } else {
+                    const __m512i   mSample = _mm512_sub_epi32(_mm512_set1_epi32(static_cast<int>(t)), mLane);
+                    const __mmask16 mActive = _mm512_cmpge_epi32_mask(mSample, _mm512_setzero_si512()) &
+                                              _mm512_cmplt_epi32_mask(mSample, _mm512_set1_epi32(static_cast<int>(length)));
+                    s1                      = _mm512_mask_mov_ps(s1, mActive, s1n);
+                    s2                      = _mm512_mask_mov_ps(s2, mActive, s2n);
+                }
+                if (t + 1 >= count) {
+                    signal_buffer[t + 1 - count] = _mm512_cvtss_f32(_mm512_permutexvar_ps(mLast, y));
+                }
+            }
+            _mm512_store_ps(mState[0], s1);
+            _mm512_store_ps(mState[1], s2);
+            for (uint32_t k = 0; k < count; k++) {
+                state(first + k, channel)[0] = mState[0][k];
+                state(first + k, channel)[1] = mState[1][k];
+            }
+        }
+
+        /*
+         * computes up to 8 channels with one channel per lane. the buffers are transposed in tiles of 8 samples, each
+         * tile runs through all sections before it is transposed back.
+         */
+        KLANGWELLEN_TARGET_AVX2
+        void process_channels_avx2(float* const* buffers, const uint8_t first, const uint8_t count, const uint32_t length) {
+            float* mCoefficients = fGroupCoefficients.data();
+            float* mState        = fGroupState.data();
+            std::fill(fGroupCoefficients.begin(), fGroupCoefficients.end(), 0.0f);
+            std::fill(fGroupState.begin(), fGroupState.end(), 0.0f);
+            for (uint32_t k = 0; k < fNumSections; k++) {
+                for (uint8_t c = 0; c < count; c++) {
+                    for (uint8_t i = 0; i < NUM_COEFFICIENTS; i++) {
+                        mCoefficients[(k * NUM_COEFFICIENTS + i) * GROUP_SIZE + c] = coefficients(k, first + c)[i];
+                    }
+                    mState[(k * 2 + 0) * GROUP_SIZE + c] = state(k, first + c)[0];
+                    mState[(k * 2 + 1) * GROUP_SIZE + c] = state(k, first + c)[1];
+                }
+            }
+            for (uint32_t i = 0; i < length; i += GROUP_SIZE) {
+                const uint32_t mTile = length - i < GROUP_SIZE ? length - i : GROUP_SIZE;
+                __m256         x[GROUP_SIZE];
+                for (uint8_t c = 0; c < GROUP_SIZE; c++) {
+                    if (c >= count) {
+                        x[c] = _mm256_setzero_ps();
+                    } else if (mTile == GROUP_SIZE) {
+                        x[c] = _mm256_loadu_ps(buffers[c] + i);
+                    } else {
+                        alignas(32) float mPartial[GROUP_SIZE] = {};
+                        std::copy_n(buffers[c] + i, mTile, mPartial);
+                        x[c] = _mm256_load_ps(mPartial);
+                    }
+                }
+                BufferKernels::transpose_8x8_avx2(x);
+                for (uint32_t k = 0; k < fNumSections; k++) {
+                    const float* mSection = mCoefficients + k * NUM_COEFFICIENTS * GROUP_SIZE;
+                    const __m256 b0       = _mm256_loadu_ps(mSection);
+                    const __m256 b1       = _mm256_loadu_ps(mSection + GROUP_SIZE);
+                    const __m256 b2       = _mm256_loadu_ps(mSection + GROUP_SIZE * 2);
+                    const __m256 a1       = _mm256_loadu_ps(mSection + GROUP_SIZE * 3);
+                    const __m256 a2       = _mm256_loadu_ps(mSection + GROUP_SIZE * 4);
+                    float*       mStates  = mState + k * 2 * GROUP_SIZE;
+                    __m256       s1       = _mm256_loadu_ps(mStates);
+                    __m256       s2       = _mm256_loadu_ps(mStates + GROUP_SIZE);
+                    for (uint32_t j = 0; j < mTile; j++) {
+                        const __m256 y = _mm256_fmadd_ps(b0, x[j], s1);
+                        s1             = _mm256_fmadd_ps(b1, x[j], _mm256_fnmadd_ps(a1, y, s2));
+                        s2             = _mm256_fnmadd_ps(a2, y, _mm256_mul_ps(b2, x[j]));
+                        x[j]           = y;
+                    }
+                    _mm256_storeu_ps(mStates, s1);
+                    _mm256_storeu_ps(mStates + GROUP_SIZE, s2);
+                }
+                BufferKernels::transpose_8x8_avx2(x);
+                for (uint8_t c = 0; c < count; c++) {
+                    if (mTile == GROUP_SIZE) {
+                        _mm256_storeu_ps(buffers[c] + i, x[c]);
+                    } else {
+                        alignas(32) float mPartial[GROUP_SIZE];
+                        _mm256_store_ps(mPartial, x[c]);
+                        std::copy_n(mPartial, mTile, buffers[c] + i);
+                    }
+                }
+            }
+            for (uint32_t k = 0; k < fNumSections; k++) {
+                for (uint8_t c = 0; c < count; c++) {
+                    state(k, first + c)[0] = mState[(k * 2 + 0) * GROUP_SIZE + c];
+                    state(k, first + c)[1] = mState[(k * 2 + 1) * GROUP_SIZE + c];
+                }
+            }
+        }
+#endif
+    };
+} // namespace klangwellen
@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t) *overwrite*
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 /*
@@ -39,6 +40,7 @@
 #include <vector>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
     class SamplerListener {
@@ -253,6 +255,14 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
         int32_t get_edge_fading() const {
             return fEdgeFadePadding;
         }
@@ -0,0 +1,444 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cfenv>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define KLANGWELLEN_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define KLANGWELLEN_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define KLANGWELLEN_CPU_RELAX() std::this_thread::yield()
+#endif
+
+namespace klangwellen {
+    /**
+     * lock-free single-owner work-stealing deque ( Chase-Lev, with sequentially consistent accesses to top and bottom
+     * instead of standalone fences ). the owner pushes and pops at the bottom, all other threads steal from the top.
+     * the capacity is fixed at construction.
+     */
+    class WorkStealingDeque {
+    public:
+        static constexpr uint32_t EMPTY = 0xFFFFFFFF;
+
+        explicit WorkStealingDeque(const uint32_t capacity) : fMask(next_power_of_two(capacity) - 1),
+                                                              fBuffer(new std::atomic<uint32_t>[fMask + 1]),
+                                                              fTop(0),
+                                                              fBottom(0) {}
+
+        uint32_t capacity() const {
+            return fMask + 1;
+        }
+
+        /**
+         * resets the deque. must only be called while no other thread accesses the deque.
+         */
+        void reset() {
+            fTop.store(0, std::memory_order_relaxed);
+            fBottom.store(0, std::memory_order_relaxed);
+        }
+
+        /* owner only */
+        void push(const uint32_t task) {
+            const int64_t b = fBottom.load(std::memory_order_relaxed);
+            fBuffer[b & fMask].store(task, std::memory_order_relaxed);
+            fBottom.store(b + 1, std::memory_order_release);
+        }
+
+        /* owner only */
+        uint32_t pop() {
+            const int64_t b = fBottom.load(std::memory_order_relaxed) - 1;
+            fBottom.store(b, std::memory_order_seq_cst);
+            int64_t t = fTop.load(std::memory_order_seq_cst);
+            if (t > b) {
+                fBottom.store(b + 1, std::memory_order_relaxed);
+                return EMPTY;
+            }
+            uint32_t mTask = fBuffer[b & fMask].load(std::memory_order_relaxed);
+            if (t == b) {
+                /* last element, race against thieves */
+                if (!fTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    mTask = EMPTY;
+                }
+                fBottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return mTask;
+        }
+
+        /* any thread */
+        uint32_t steal() {
+            int64_t       t = fTop.load(std::memory_order_seq_cst);
+            const int64_t b = fBottom.load(std::memory_order_seq_cst);
+            if (t >= b) {
+                return EMPTY;
+            }
+            const uint32_t mTask = fBuffer[t & fMask].load(std::memory_order_relaxed);
+            if (!fTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return EMPTY;
+            }
+            return mTask;
+        }
+
+    private:
+        const uint32_t                           fMask;
+        std::unique_ptr<std::atomic<uint32_t>[]> fBuffer;
+        alignas(64) std::atomic<int64_t>         fTop;
+        alignas(64) std::atomic<int64_t>         fBottom;
+
+        static uint32_t next_power_of_two(const uint32_t value) {
+            uint32_t mValue = 1;
+            while (mValue < value) {
+                mValue <<= 1;
+            }
+            return mValue;
+        }
+    };
+
+    /**
+     * set of tasks with dependencies that is executed by a `Scheduler` once per `Scheduler::run`. tasks are
+     * identified by their index and must be added in a topological order ( i.e a task may only depend on tasks with a
+     * smaller index ). the task set is built and prepared outside of the audio thread, running it does not allocate.
+     */
+    class TaskSet {
+    public:
+        using TaskFunction = void (*)(void* context, uint32_t task);
+
+        TaskSet() : fFunction(nullptr), fContext(nullptr), fNumTasks(0), fNumWorkers(0) {}
+
+        TaskSet(const TaskSet&)            = delete;
+        TaskSet& operator=(const TaskSet&) = delete;
+
+        void init(const uint32_t num_tasks, const TaskFunction function, void* context) {
+            fFunction   = function;
+            fContext    = context;
+            fNumTasks   = num_tasks;
+            fNumWorkers = 0;
+            fEdges.clear();
+            fDependencies.assign(num_tasks, 0);
+            fPending.reset(new std::atomic<uint32_t>[num_tasks]);
+        }
+
+        /**
+         * @param before task that must be completed before `after` is started ( `before < after` )
+         * @param after  task that depends on `before`
+         */
+        void add_dependency(const uint32_t before, const uint32_t after) {
+            fEdges.push_back({before, after});
+            fDependencies[after]++;
+        }
+
+        uint32_t num_tasks() const {
+            return fNumTasks;
+        }
+
+    private:
+        friend class Scheduler;
+
+        struct Edge {
+            uint32_t before;
+            uint32_t after;
+        };
+
+        TaskFunction                             fFunction;
+        void*                                    fContext;
+        uint32_t                                 fNumTasks;
+        uint8_t                                  fNumWorkers;
+        std::vector<Edge>                        fEdges;
+        std::vector<uint32_t>                    fDependencies;
+        std::vector<uint32_t>                    fSuccessorBegin;
+        std::vector<uint32_t>                    fSuccessors;
+        std::vector<uint32_t>                    fStaticBegin;
+        std::vector<uint32_t>                    fStaticTasks;
+        std::unique_ptr<std::atomic<uint32_t>[]> fPending;
+
+        /*
+         * flattens the successor lists and computes the static task-to-worker assignment for deterministic mode:
+         * a task that is the only successor of its only predecessor stays on the predecessor's worker, every other
+         * task goes to the worker with the fewest tasks. each worker runs its tasks in index order.
+         */
+        void finalize(const uint8_t num_workers) {
+            fNumWorkers = num_workers;
+            fSuccessorBegin.assign(fNumTasks + 1, 0);
+            std::vector<uint32_t> mNumSuccessors(fNumTasks, 0);
+            for (const Edge& e : fEdges) {
+                mNumSuccessors[e.before]++;
+            }
+            for (uint32_t i = 0; i < fNumTasks; i++) {
+                fSuccessorBegin[i + 1] = fSuccessorBegin[i] + mNumSuccessors[i];
+            }
+            fSuccessors.assign(fEdges.size(), 0);
+            std::vector<uint32_t> mFill(fSuccessorBegin.begin(), fSuccessorBegin.end() - 1);
+            std::vector<uint32_t> mOnlyPredecessor(fNumTasks, 0xFFFFFFFF);
+            for (const Edge& e : fEdges) {
+                fSuccessors[mFill[e.before]++] = e.after;
+                mOnlyPredecessor[e.after]      = e.before;
+            }
+
+            std::vector<uint32_t> mWorkerOf(fNumTasks, 0);
+            std::vector<uint32_t> mLoad(num_workers, 0);
+            for (uint32_t i = 0; i < fNumTasks; i++) {
+                const uint32_t mPredecessor = mOnlyPredecessor[i];
+                if (fDependencies[i] == 1 && mNumSuccessors[mPredecessor] == 1) {
+                    mWorkerOf[i] = mWorkerOf[mPredecessor];
+                } else {
+                    mWorkerOf[i] = static_cast<uint32_t>(std::min_element(mLoad.begin(), mLoad.end()) - mLoad.begin());
+                }
+                mLoad[mWorkerOf[i]]++;
+            }
+            fStaticBegin.assign(num_workers + 1, 0);
+            for (uint8_t w = 0; w < num_workers; w++) {
+                fStaticBegin[w + 1] = fStaticBegin[w] + mLoad[w];
+            }
+            fStaticTasks.assign(fNumTasks, 0);
+            std::vector<uint32_t> mStaticFill(fStaticBegin.begin(), fStaticBegin.end() - 1);
+            for (uint32_t i = 0; i < fNumTasks; i++) {
+                fStaticTasks[mStaticFill[mWorkerOf[i]]++] = i;
+            }
+        }
+    };
+
+    /**
+     * fixed pool of worker threads that runs a `TaskSet` once per audio block.
+     * <p>
+     * the calling thread ( usually the audio thread ) takes part in the processing as worker 0, `run` returns when all
+     * tasks are completed. in the default mode ready tasks are pushed onto the deque of the worker that completed the
+     * last dependency and idle workers steal from the other deques. in deterministic mode every task is bound to a
+     * worker computed in `prepare` and each worker runs its tasks in a fixed order, no stealing takes place.
+     * <p>
+     * workers inherit the floating-point environment ( rounding, flush-to-zero etc. ) of the calling thread at the
+     * start of every `run`. as long as tasks do not share mutable state the results are therefore bit-identical to a
+     * single-threaded execution in both modes, deterministic mode additionally makes the thread and the order in which
+     * each task runs reproducible.
+     * <p>
+     * all threads and deques are created in the constructor. `run` does not allocate. idle workers spin for a short
+     * time and then sleep until the next `run`.
+     */
+    class Scheduler {
+    public:
+        static constexpr uint32_t DEFAULT_MAX_TASKS = 1024;
+        static constexpr uint32_t SPIN_ITERATIONS   = 4096;
+
+        /**
+         * @param num_threads total number of threads including the calling thread. `0` uses all hardware threads.
+         * @param max_tasks   maximum number of tasks per `TaskSet`. larger task sets are run on the calling thread.
+         */
+        explicit Scheduler(const uint8_t num_threads = 0, const uint32_t max_tasks = DEFAULT_MAX_TASKS)
+            : fNumThreads(num_threads > 0 ? num_threads : default_num_threads()),
+              fMaxTasks(max_tasks),
+              fDeterministic(false),
+              fTaskSet(nullptr),
+              fEpoch(0),
+              fRemaining(0),
+              fActiveWorkers(0),
+              fSleepingWorkers(0),
+              fQuit(false) {
+            for (uint8_t i = 0; i < fNumThreads; i++) {
+                fDeques.emplace_back(new WorkStealingDeque(max_tasks));
+            }
+            for (uint8_t i = 1; i < fNumThreads; i++) {
+                fThreads.emplace_back(&Scheduler::worker_loop, this, i);
+            }
+        }
+
+        Scheduler(const Scheduler&)            = delete;
+        Scheduler& operator=(const Scheduler&) = delete;
+
+        ~Scheduler() {
+            {
+                std::lock_guard<std::mutex> mLock(fMutex);
+                fQuit.store(true, std::memory_order_seq_cst);
+                fEpoch.fetch_add(1, std::memory_order_seq_cst);
+            }
+            fCondition.notify_all();
+            for (std::thread& mThread : fThreads) {
+                mThread.join();
+            }
+        }
+
+        uint8_t num_threads() const {
+            return fNumThreads;
+        }
+
+        uint32_t max_tasks() const {
+            return fMaxTasks;
+        }
+
+        void set_deterministic(const bool deterministic) {
+            fDeterministic = deterministic;
+        }
+
+        bool is_deterministic() const {
+            return fDeterministic;
+        }
+
+        /**
+         * prepares a task set for this scheduler. must be called after the task set was built and before `run`.
+         * allocates memory and should not be called from the audio thread.
+         */
+        void prepare(TaskSet& task_set) const {
+            task_set.finalize(fNumThreads);
+        }
+
+        /**
+         * runs all tasks of the task set and returns after all tasks are completed. must not be called concurrently
+         * from more than one thread.
+         */
+        void run(TaskSet& task_set) {
+            if (task_set.fNumTasks == 0) {
+                return;
+            }
+            if (fNumThreads == 1 || task_set.fNumTasks > fMaxTasks || task_set.fNumWorkers != fNumThreads) {
+                for (uint32_t i = 0; i < task_set.fNumTasks; i++) {
+                    task_set.fFunction(task_set.fContext, i);
+                }
+                return;
+            }
+
+            fTaskSet = &task_set;
+            fRunDeterministic = fDeterministic;
+            fegetenv(&fFloatingPointEnvironment);
+            for (uint32_t i = 0; i < task_set.fNumTasks; i++) {
+                task_set.fPending[i].store(task_set.fDependencies[i], std::memory_order_relaxed);
+            }
+            if (!fRunDeterministic) {
+                /* distribute tasks without dependencies over all deques, workers are idle at this point */
+                uint8_t mWorker = 0;
+                for (uint32_t i = 0; i < task_set.fNumTasks; i++) {
+                    if (task_set.fDependencies[i] == 0) {
+                        fDeques[mWorker]->push(i);
+                        mWorker = (mWorker + 1) % fNumThreads;
+                    }
+                }
+            }
+            fRemaining.store(task_set.fNumTasks, std::memory_order_relaxed);
+            fActiveWorkers.store(fNumThreads - 1, std::memory_order_relaxed);
+
+            fEpoch.fetch_add(1, std::memory_order_seq_cst);
+            if (fSleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+                { std::lock_guard<std::mutex> mLock(fMutex); }
+                fCondition.notify_all();
+            }
+
+            execute(0);
+
+            while (fActiveWorkers.load(std::memory_order_acquire) > 0) {
+                KLANGWELLEN_CPU_RELAX();
+            }
+            for (auto& mDeque : fDeques) {
+                mDeque->reset();
+            }
+            fTaskSet = nullptr;
+        }
+
+        static uint8_t default_num_threads() {
+            const unsigned int mThreads = std::thread::hardware_concurrency();
+            return static_cast<uint8_t>(std::max(1u, std::min(mThreads, 255u)));
+        }
+
+    private:
+        const uint8_t                                   fNumThreads;
+        const uint32_t                                  fMaxTasks;
+        bool                                            fDeterministic;
+        bool                                            fRunDeterministic = false;
+        TaskSet*                                        fTaskSet;
+        fenv_t                                          fFloatingPointEnvironment{};
+        std::vector<std::unique_ptr<WorkStealingDeque>> fDeques;
+        std::vector<std::thread>                        fThreads;
+        std::mutex                                      fMutex;
+        std::condition_variable                         fCondition;
+        alignas(64) std::atomic<uint64_t>               fEpoch;
+        alignas(64) std::atomic<uint32_t>               fRemaining;
+        alignas(64) std::atomic<uint32_t>               fActiveWorkers;
+        std::atomic<uint32_t>                           fSleepingWorkers;
+        std::atomic<bool>                               fQuit;
+
+        void worker_loop(const uint8_t worker) {
+            uint64_t mSeenEpoch = 0;
+            while (true) {
+                uint32_t mSpin = 0;
+                while (fEpoch.load(std::memory_order_acquire) == mSeenEpoch) {
+                    if (++mSpin < SPIN_ITERATIONS) {
+                        KLANGWELLEN_CPU_RELAX();
+                        continue;
+                    }
+                    std::unique_lock<std::mutex> mLock(fMutex);
+                    fSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+                    fCondition.wait(mLock, [&] { return fEpoch.load(std::memory_order_seq_cst) != mSeenEpoch; });
+                    fSleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+                }
+                mSeenEpoch = fEpoch.load(std::memory_order_acquire);
+                if (fQuit.load(std::memory_order_acquire)) {
+                    return;
+                }
+                fesetenv(&fFloatingPointEnvironment);
+                execute(worker);
+                fActiveWorkers.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        void execute(const uint8_t worker) {
+            TaskSet& mTaskSet = *fTaskSet;
+            if (fRunDeterministic) {
+                for (uint32_t i = mTaskSet.fStaticBegin[worker]; i < mTaskSet.fStaticBegin[worker + 1]; i++) {
+                    const uint32_t mTask = mTaskSet.fStaticTasks[i];
+                    while (mTaskSet.fPending[mTask].load(std::memory_order_acquire) > 0) {
+                        KLANGWELLEN_CPU_RELAX();
+                    }
+                    run_task(mTaskSet, mTask, worker);
+                }
+                return;
+            }
+            WorkStealingDeque& mDeque = *fDeques[worker];
+            while (fRemaining.load(std::memory_order_acquire) > 0) {
+                uint32_t mTask = mDeque.pop();
+                for (uint8_t i = 1; mTask == WorkStealingDeque::EMPTY && i < fNumThreads; i++) {
+                    mTask = fDeques[(worker + i) % fNumThreads]->steal();
+                }
+                if (mTask == WorkStealingDeque::EMPTY) {
+                    KLANGWELLEN_CPU_RELAX();
+                    continue;
+                }
+                run_task(mTaskSet, mTask, worker);
+            }
+        }
+
+        void run_task(TaskSet& task_set, const uint32_t task, const uint8_t worker) {
+            task_set.fFunction(task_set.fContext, task);
+            for (uint32_t i = task_set.fSuccessorBegin[task]; i < task_set.fSuccessorBegin[task + 1]; i++) {
+                const uint32_t mSuccessor = task_set.fSuccessors[i];
+                if (task_set.fPending[mSuccessor].fetch_sub(1, std::memory_order_acq_rel) == 1 && !fRunDeterministic) {
+                    fDeques[worker]->push(mSuccessor);
+                }
+            }
+            fRemaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    };
+} // namespace klangwellen
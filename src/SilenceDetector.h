@@ -0,0 +1,168 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cmath>
+
+#include "BufferKernels.h"
+
+namespace klangwellen {
+    /**
+     * lets a stateful processor ( e.g a reverb or a filter ) sleep once its input is silent and its tail has decayed.
+     * <p>
+     * the processor checks its input with `skip` before it processes a block and its output with `update` after it
+     * processed the block. once input and output stayed below the threshold for at least `hold` samples the detector
+     * falls asleep: `update` returns true once, so that the processor can clear its state, and from then on `skip`
+     * returns true as long as the input stays silent, i.e the processor only writes zeros. the first block with input
+     * above the threshold wakes the detector up again.
+     * <p>
+     * the hold time must cover the longest time the output of a processor can stay silent while its state is not,
+     * e.g the length of a delay line. a threshold of 0 disables the detection.
+     */
+    class SilenceDetector {
+    public:
+        static constexpr float    DEFAULT_THRESHOLD = 0.000001f; /* -120 dB */
+        static constexpr uint32_t DEFAULT_HOLD      = 64;
+
+        explicit SilenceDetector(const float threshold = DEFAULT_THRESHOLD, const uint32_t hold = DEFAULT_HOLD) : fThreshold(threshold), fHold(hold) {}
+
+        /**
+         * @param threshold absolute amplitude below which a signal counts as silent, 0 disables the detection
+         */
+        void set_threshold(const float threshold) {
+            fThreshold = threshold < 0.0f ? 0.0f : threshold;
+            if (fThreshold == 0.0f) {
+                wake();
+            }
+        }
+
+        float get_threshold() const {
+            return fThreshold;
+        }
+
+        /**
+         * @param hold number of samples input and output need to be silent before the detector falls asleep
+         */
+        void set_hold(const uint32_t hold) {
+            fHold = hold;
+        }
+
+        uint32_t get_hold() const {
+            return fHold;
+        }
+
+        bool is_sleeping() const {
+            return fSleeping;
+        }
+
+        void wake() {
+            fSleeping      = false;
+            fSilentSamples = 0;
+        }
+
+        /**
+         * checks the input of a block before it is processed.
+         *
+         * @param left  input signal
+         * @param right second input channel or `nullptr`
+         * @return true if the processor sleeps and may skip the block
+         */
+        bool skip(const float* left, const float* right, const uint32_t length) {
+            fInputSilent = is_silent(left, length) && (right == nullptr || is_silent(right, length));
+            if (!fInputSilent) {
+                wake();
+            }
+            return fSleeping;
+        }
+
+        bool skip(const float* input, const uint32_t length) {
+            return skip(input, nullptr, length);
+        }
+
+        /**
+         * checks the output of a processed block.
+         *
+         * @param left  output signal
+         * @param right second output channel or `nullptr`
+         * @return true if the detector just fell asleep, i.e the processor should clear its state
+         */
+        bool update(const float* left, const float* right, const uint32_t length) {
+            if (!fInputSilent || !is_silent(left, length) || (right != nullptr && !is_silent(right, length))) {
+                fSilentSamples = 0;
+                return false;
+            }
+            fSilentSamples = fSilentSamples > UINT32_MAX - length ? UINT32_MAX : fSilentSamples + length;
+            if (fSilentSamples < fHold || fSilentSamples == 0) {
+                return false;
+            }
+            fSleeping = true;
+            return true;
+        }
+
+        bool update(const float* output, const uint32_t length) {
+            return update(output, nullptr, length);
+        }
+
+        /**
+         * @return true if all samples are below the threshold. a signal that is not silent usually fails on its first
+         *         sample, otherwise the whole buffer is scanned with `BufferKernels::abs_max`.
+         */
+        bool is_silent(const float* buffer, const uint32_t length) const {
+            if (fThreshold == 0.0f) {
+                return false;
+            }
+            if (length == 0) {
+                return true;
+            }
+            if (std::fabs(buffer[0]) >= fThreshold) {
+                return false;
+            }
+            return length == 1 || BufferKernels::abs_max(buffer, length) < fThreshold;
+        }
+
+        /**
+         * estimates the number of samples a signal takes to decay below the threshold if it is multiplied by `gain`
+         * every `period` samples ( e.g a feedback delay line of length `period` ).
+         *
+         * @return number of samples or `UINT32_MAX` if the signal does not decay
+         */
+        static uint32_t decay_length(const uint32_t period, const float gain, const float threshold = DEFAULT_THRESHOLD) {
+            const float mGain      = std::fabs(gain);
+            const float mThreshold = threshold > 0.0f ? threshold : DEFAULT_THRESHOLD;
+            if (mGain >= 1.0f) {
+                return UINT32_MAX;
+            }
+            if (mGain == 0.0f || mThreshold >= 1.0f) {
+                return period;
+            }
+            const double mLength = static_cast<double>(period) * std::ceil(std::log(mThreshold) / std::log(mGain));
+            return mLength >= static_cast<double>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(mLength);
+        }
+
+    private:
+        float    fThreshold;
+        uint32_t fHold;
+        uint32_t fSilentSamples = 0;
+        bool     fInputSilent   = false;
+        bool     fSleeping      = false;
+    };
+} // namespace klangwellen
@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [*] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -33,6 +34,7 @@
 #include <iostream>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
     class StreamDataProvider {
@@ -141,6 +143,14 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
         void interpolate_samples(bool const interpolate_samples) {
             fInterpolateSamples = interpolate_samples;
         }
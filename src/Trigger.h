@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t) *no overwrites*
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -34,6 +35,7 @@
 #include <vector>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
 
 /**
  * generates an event from an oscillating input signal.
@@ -90,6 +92,13 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+        }
+
     private:
         typedef void (*CallbackType1_UI8)(const uint8_t);
         CallbackType1_UI8 fCallbackEvent = nullptr;
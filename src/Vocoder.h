@@ -27,6 +27,7 @@
  * - [ ] void process(float*, float*, uint32_t)
  * - [x] float process(float, float)
  * - [x] void process(float*, float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&, AudioBuffer&, AudioBuffer&)
  *
  */
 
@@ -34,7 +35,13 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "BufferKernels.h"
+#include "SilenceDetector.h"
 
 namespace klangwellen {
     /**
@@ -42,6 +49,13 @@ namespace klangwellen {
      * <p>
      * *voclib* is an implementation of a traditional channel vocoder by Philip Bennefall from
      * https://github.com/blastbay/voclib.
+     * <p>
+     * the filter states of all bands are stored structure-of-arrays, so that each filter stage runs for 8 ( AVX2 ) or
+     * 16 ( AVX-512 ) bands at once.
+     * <p>
+     * once modulator and output are below the silence threshold ( see `SilenceDetector` ) the `process` functions
+     * reset the vocoder and write zeros without processing until the modulator returns, independent of the carrier.
+     * `analyze` and `synthesize` always process.
      */
 
     class Vocoder {
@@ -128,21 +142,13 @@ namespace klangwellen {
          */
         Vocoder(uint8_t  pBands          = 24,
                 uint8_t  pFiltersPerBand = 4,
-                uint32_t pSampleRate     = KlangWellen::DEFAULT_SAMPLE_RATE) : fBands(pBands),
-                                                                           fFiltersPerBand(pFiltersPerBand),
-                                                                           fSampleRate(pSampleRate) {
-            // if (pBands < 4 || pBands > VOCLIB_MAX_BANDS) {
-            //     // System.out.println("ERROR @" + Vocoder.class.getSimpleName() + " / bands: " + pBands);
-            // }
-            // if (pFiltersPerBand < 1 || pFiltersPerBand > VOCLIB_MAX_FILTERS_PER_BAND) {
-            //     // System.out.println("ERROR @" + Vocoder.class.getSimpleName() + " / filters per band: " + pFiltersPerBand);
-            // }
+                uint32_t pSampleRate     = KlangWellen::DEFAULT_SAMPLE_RATE) : fSampleRate(pSampleRate),
+                                                                           fBands(pBands < 1 ? 1 : (pBands > VOCLIB_MAX_BANDS ? VOCLIB_MAX_BANDS : pBands)),
+                                                                           fFiltersPerBand(pFiltersPerBand < 1 ? 1 : (pFiltersPerBand > VOCLIB_MAX_FILTERS_PER_BAND ? VOCLIB_MAX_FILTERS_PER_BAND : pFiltersPerBand)),
+                                                                           fEnvelopeStride((fBands + LANES - 1) / LANES * LANES) {
             // if (pSampleRate < 8000 || pSampleRate > 192000) {
             //     // System.out.println("ERROR @" + Vocoder.class.getSimpleName() + " / sample rate: " + pSampleRate);
             // }
-            // if (pCarrierChannels < 1 || pCarrierChannels > 2) {
-            //     // System.out.println("ERROR @" + Vocoder.class.getSimpleName() + " / carrier channels: " + pCarrierChannels);
-            // }
 
             fReactionTime = 0.03;
             fFormantShift = 1.0;
@@ -163,37 +169,23 @@ namespace klangwellen {
          * Call this function continuously to generate your output.
          * carrier_buffer and modulator_buffer should contain the carrier and modulator signals respectively.
          * The modulator must always have one channel.
-         * If the carrier has two channels, the samples in carrier_buffer must be interleaved.
-         * output_buffer will be filled with the result, and must be able to hold as many channels as the carrier.
-         * If the carrier has two channels, the output buffer will be filled with interleaved samples.
-         * output_buffer may be the same pointer as either carrier_buffer or modulator_buffer as long as it can hold the
-         * same number of channels as the carrier.
+         * output_buffer will be filled with the result.
+         * output_buffer may be the same pointer as either carrier_buffer or modulator_buffer.
          * The processing is performed in place.
          * frames specifies the number of sample frames that should be processed.
-         * Returns nonzero (true) on success or 0 (false) on failure.
-         * The function will only fail if one or more of the parameters are invalid.
          */
         void process(float*         carrier_buffer,
                      float*         modulator_buffer,
                      float*         output_buffer,
                      const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
             /* Both the carrier and the modulator have a single channel. */
-            for (uint32_t i = 0; i < frames; ++i) {
-                float out = 0.0f;
-
-                /* Run the bands in parallel and accumulate the output. */
-                for (uint8_t j = 0; j < fBands; ++j) {
-                    float analysis_band  = BiQuad(modulator_buffer[i], fAnalysisBands[j].filters[0]);
-                    float synthesis_band = BiQuad(carrier_buffer[i], fSynthesisBands[j].filters[0]);
-
-                    for (uint8_t k = 1; k < fFiltersPerBand; ++k) {
-                        analysis_band  = BiQuad(analysis_band, fAnalysisBands[j].filters[k]);
-                        synthesis_band = BiQuad(synthesis_band, fSynthesisBands[j].filters[k]);
-                    }
-                    analysis_band = envelope_tick(fAnalysisEnvelopes[j], analysis_band);
-                    out += synthesis_band * analysis_band;
-                }
-                output_buffer[i] = out * fRectifyVolume;
+            if (fSilence.skip(modulator_buffer, frames)) {
+                std::fill_n(output_buffer, frames, 0.0f);
+                return;
+            }
+            process_bands(carrier_buffer, nullptr, modulator_buffer, nullptr, nullptr, output_buffer, nullptr, frames);
+            if (fSilence.update(output_buffer, frames)) {
+                reset_history();
             }
         }
 
@@ -202,32 +194,90 @@ namespace klangwellen {
                      float*         modulator_buffer,
                      float*         output_buffer_left,
                      float*         output_buffer_right,
-                     const uint32_t frames = KlangWellen::DEFAULT_SAMPLE_RATE) {
+                     const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
             /* The carrier has two channels and the modulator has 1. */
-            for (uint32_t i = 0; i < frames; i++) {
-                float out_left  = 0.0f;
-                float out_right = 0.0f;
-
-                /* Run the bands in parallel and accumulate the output. */
-                for (uint8_t j = 0; j < fBands; ++j) {
-                    float analysis_band        = BiQuad(modulator_buffer[j], fAnalysisBands[j].filters[0]);
-                    float synthesis_band_left  = BiQuad(carrier_buffer_left[i], fSynthesisBands[j].filters[0]);
-                    float synthesis_band_right = BiQuad(carrier_buffer_right[i], fSynthesisBands[j + VOCLIB_MAX_BANDS].filters[0]);
-
-                    for (uint8_t k = 1; k < fFiltersPerBand; ++k) {
-                        analysis_band        = BiQuad(analysis_band, fAnalysisBands[j].filters[k]);
-                        synthesis_band_left  = BiQuad(synthesis_band_left, fSynthesisBands[j].filters[k]);
-                        synthesis_band_right = BiQuad(synthesis_band_right, fSynthesisBands[j + VOCLIB_MAX_BANDS].filters[k]);
-                    }
-                    analysis_band = envelope_tick(fAnalysisEnvelopes[j], analysis_band);
-                    out_left += synthesis_band_left * analysis_band;
-                    out_right += synthesis_band_right * analysis_band;
-                }
-                output_buffer_left[i]  = out_left * fRectifyVolume;
-                output_buffer_right[i] = out_right * fRectifyVolume;
+            if (fSilence.skip(modulator_buffer, frames)) {
+                std::fill_n(output_buffer_left, frames, 0.0f);
+                std::fill_n(output_buffer_right, frames, 0.0f);
+                return;
+            }
+            process_bands(carrier_buffer_left, carrier_buffer_right, modulator_buffer, nullptr, nullptr, output_buffer_left, output_buffer_right, frames);
+            if (fSilence.update(output_buffer_left, output_buffer_right, frames)) {
+                reset_history();
+            }
+        }
+
+        /**
+         * processes the first channel of `modulator` against the carrier. if both `carrier` and `output` have at least
+         * two channels the first two channels are processed as a stereo signal, otherwise the first channel only.
+         */
+        void process(AudioBuffer& carrier, AudioBuffer& modulator, AudioBuffer& output) {
+            if (carrier.num_channels() == 0 || modulator.num_channels() == 0 || output.num_channels() == 0) {
+                return;
+            }
+            const uint32_t mFrames = std::min(std::min(carrier.num_frames(), modulator.num_frames()), output.num_frames());
+            if (carrier.num_channels() >= 2 && output.num_channels() >= 2) {
+                process(carrier.channel(0), carrier.channel(1), modulator.channel(0), output.channel(0), output.channel(1), mFrames);
+            } else {
+                process(carrier.channel(0), modulator.channel(0), output.channel(0), mFrames);
             }
         }
 
+        /**
+         * @return number of floats needed by an envelope buffer for `frames` frames ( see `analyze` )
+         */
+        uint32_t get_envelope_buffer_size(const uint32_t frames) const {
+            return frames * fEnvelopeStride;
+        }
+
+        /**
+         * runs only the analysis filterbank and the envelope followers on the modulator and writes the envelope of band
+         * `b` at frame `i` to `envelope_buffer[i * stride + b]`, where `stride` is the number of bands rounded up to a
+         * multiple of 16.
+         * <p>
+         * together with `synthesize` this splits the vocoder into an analysis and a synthesis stage, so that one
+         * modulator can drive any number of carriers while the modulator is analyzed only once per block, e.g:
+         * <p>
+         * `mVoice.analyze(modulator, envelopes, frames);`
+         * <p>
+         * `for (auto& mCarrier : mCarriers) { mCarrier.synthesize(envelopes, carrier, output, frames); }`
+         * <p>
+         * the analyzing and the synthesizing vocoders must have the same number of bands, their formant shift may
+         * differ.
+         *
+         * @param modulator_buffer modulator signal
+         * @param envelope_buffer  envelopes with at least `get_envelope_buffer_size(frames)` floats
+         * @param frames           number of frames
+         */
+        void analyze(const float* modulator_buffer, float* envelope_buffer, const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_bands(nullptr, nullptr, modulator_buffer, nullptr, envelope_buffer, nullptr, nullptr, frames);
+        }
+
+        /**
+         * runs only the synthesis filterbank on the carrier and applies envelopes computed by `analyze`. the synthesis
+         * state is independent of the analysis state of this instance.
+         *
+         * @param envelope_buffer envelopes computed by `analyze`
+         * @param carrier_buffer  carrier signal
+         * @param output_buffer   output, may be the same pointer as `carrier_buffer`
+         * @param frames          number of frames
+         */
+        void synthesize(const float*   envelope_buffer,
+                        const float*   carrier_buffer,
+                        float*         output_buffer,
+                        const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_bands(carrier_buffer, nullptr, nullptr, envelope_buffer, nullptr, output_buffer, nullptr, frames);
+        }
+
+        void synthesize(const float*   envelope_buffer,
+                        const float*   carrier_buffer_left,
+                        const float*   carrier_buffer_right,
+                        float*         output_buffer_left,
+                        float*         output_buffer_right,
+                        const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_bands(carrier_buffer_left, carrier_buffer_right, nullptr, envelope_buffer, nullptr, output_buffer_left, output_buffer_right, frames);
+        }
+
         /* Set the formant shift of the vocoder in octaves.
          *
          * Formant shifting changes the size of the speaker's head.
@@ -238,7 +288,7 @@ namespace klangwellen {
          * The function will only fail if the parameter is invalid.
          */
         uint8_t set_formant_shift(float pFormant_shift) {
-            if (fFormantShift < 0.25f || fFormantShift > 4.0f) {
+            if (pFormant_shift < 0.25f || pFormant_shift > 4.0f) {
                 return 0;
             }
 
@@ -254,13 +304,10 @@ namespace klangwellen {
          * Resetting the history in the middle of a stream will cause clicks.
          */
         void reset_history() {
-            for (uint8_t i = 0; i < fBands; ++i) {
-                for (uint8_t j = 0; j < fFiltersPerBand; ++j) {
-                    BiQuad_reset(fAnalysisBands[i].filters[j]);
-                    BiQuad_reset(fSynthesisBands[i].filters[j]);
-                }
-                envelope_reset(fAnalysisEnvelopes[i]);
-            }
+            std::fill_n(fAnalysisState, VOCLIB_FILTERBANK_SIZE * NUM_STATES, 0.0f);
+            std::fill_n(fSynthesisState[0], VOCLIB_FILTERBANK_SIZE * NUM_STATES, 0.0f);
+            std::fill_n(fSynthesisState[1], VOCLIB_FILTERBANK_SIZE * NUM_STATES, 0.0f);
+            std::fill_n(fEnvelopeHistory, VOCLIB_MAX_BANDS * NUM_ENVELOPE_STAGES, 0.0f);
         }
 
         /* Set the reaction time of the vocoder in seconds.
@@ -274,7 +321,7 @@ namespace klangwellen {
          * The function will only fail if the parameter is invalid.
          */
         uint8_t set_reaction_time(float pReaction_time) {
-            if (fReactionTime < 0.002f || fReactionTime > 2.0f) {
+            if (pReaction_time < 0.002f || pReaction_time > 2.0f) {
                 return 0;
             }
 
@@ -283,6 +330,50 @@ namespace klangwellen {
             return 1;
         }
 
+        /**
+         * @param threshold amplitude below which modulator and output count as silent, 0 disables the silence
+         *                  detection
+         */
+        void set_silence_threshold(const float threshold) {
+            fSilence.set_threshold(threshold);
+            fSilence.set_hold(get_tail_length());
+        }
+
+        float get_silence_threshold() const {
+            return fSilence.get_threshold();
+        }
+
+        /**
+         * @return true if the vocoder skips processing because modulator and output are silent
+         */
+        bool is_sleeping() const {
+            return fSilence.is_sleeping();
+        }
+
+        /**
+         * @return estimated number of samples the envelopes take to decay below the silence threshold after the
+         *         modulator stopped. the vocoder only falls asleep after its output was silent for this long, since
+         *         a silent carrier silences the output while the envelopes have not decayed yet.
+         */
+        uint32_t get_tail_length() const {
+            /* the 4 stages of an envelope decay as `c^n ( 1 + x + x^2 / 2 + x^3 / 6 )` with `x = -n ln( c )`. solves
+             * for the `x` at which this reaches the threshold by fixed-point iteration. */
+            const float  mThreshold = fSilence.get_threshold() > 0.0f ? fSilence.get_threshold() : SilenceDetector::DEFAULT_THRESHOLD;
+            const double mDecay     = -std::log(static_cast<double>(fEnvelopeCoefficient));
+            if (mThreshold >= 1.0f) {
+                return 0;
+            }
+            if (mDecay <= 0.0) {
+                return UINT32_MAX;
+            }
+            double x = -std::log(static_cast<double>(mThreshold));
+            for (uint8_t i = 0; i < 8; i++) {
+                x = -std::log(static_cast<double>(mThreshold)) + std::log(1.0 + x + x * x / 2.0 + x * x * x / 6.0);
+            }
+            const double mLength = std::ceil(x / mDecay);
+            return mLength >= static_cast<double>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(mLength);
+        }
+
         /* Get the current formant shift of the vocoder in octaves. */
         float get_formant_shift() {
             return fFormantShift;
@@ -307,87 +398,389 @@ namespace klangwellen {
          */
         static const uint8_t VOCLIB_MAX_FILTERS_PER_BAND = 8;
 
-    public:
-        /**
-         * this holds the data required to update samples thru a filter.
+        /* filter types. */
+        static const uint8_t   VOCLIB_LPF             = 0;                                                 /* low pass filter */
+        static const uint8_t   VOCLIB_HPF             = 1;                                                 /* High pass filter */
+        static const uint8_t   VOCLIB_BPF             = 2;                                                 /* band pass filter */
+        static const uint8_t   VOCLIB_NOTCH           = 3;                                                 /* Notch Filter */
+        static const uint8_t   VOCLIB_PEQ             = 4;                                                 /* Peaking band EQ filter */
+        static const uint8_t   VOCLIB_LSH             = 5;                                                 /* Low shelf filter */
+        static const uint8_t   VOCLIB_HSH             = 6;                                                 /* High shelf filter */
+        static const uint8_t   VOCLIB_MAX_BANDS       = 96;                                                /* The maximum number of bands that the vocoder can be initialized with (lower this number to save memory, must be a multiple of 16). */
+        static const uint32_t  VOCLIB_FILTERBANK_SIZE = VOCLIB_MAX_FILTERS_PER_BAND * VOCLIB_MAX_BANDS;    /* Number of filters of one filterbank. */
+        static const uint8_t   NUM_COEFFICIENTS       = 5;                                                 /* a0 ... a4 */
+        static const uint8_t   NUM_STATES             = 4;                                                 /* x1, x2, y1, y2 */
+        static const uint8_t   NUM_ENVELOPE_STAGES    = 4;                                                 /**/
+        static const uint8_t   LANES                  = 16;                                                /* The widest SIMD vector in bands. */
+        static const uint32_t  CHUNK_SIZE             = 32;                                                /* Number of frames processed per pass through the filterbank. */
+        static constexpr float VOCLIB_M_LN2           = 0.69314718055994530942;                            /**/
+        static constexpr float VOCLIB_M_PI            = 3.14159265358979323846;                            /**/
+        const uint32_t         fSampleRate;                                                                /* in Hz */
+        const uint8_t          fBands;                                                                     /**/
+        const uint8_t          fFiltersPerBand;                                                            /**/
+        const uint32_t         fEnvelopeStride;                                                            /* Number of bands rounded up to a multiple of LANES. */
+        float                  fFormantShift;                                                              /* In octaves. 1.0 is unchanged. */
+        float                  fReactionTime;                                                              /* In seconds. Higher values make the vocoder respond more slowly to changes in the modulator. */
+        float                  fRectifyVolume;                                                             /**/
+        float                  fEnvelopeCoefficient = 0.0f;                                                /* The coefficient of the envelopes used to smooth the analysis bands. */
+        SilenceDetector        fSilence;                                                                   /**/
+
+        /*
+         * the filterbanks are stored structure-of-arrays with one band per element, `[filter][coefficient][band]` and
+         * `[filter][state][band]`, so that one filter stage of 8 ( AVX2 ) or 16 ( AVX-512 ) bands is computed at once.
+         * unused bands have zero coefficients and produce silence.
          */
-        struct biquad {
-            float a0, a1, a2, a3, a4 = 0;
-            float x1, x2, y1, y2 = 0;
-        };
+        alignas(64) float fAnalysisCoefficients[VOCLIB_FILTERBANK_SIZE * NUM_COEFFICIENTS]{};  /* The filterbank used for analysis (these are applied to the modulator). */
+        alignas(64) float fAnalysisState[VOCLIB_FILTERBANK_SIZE * NUM_STATES]{};               /**/
+        alignas(64) float fSynthesisCoefficients[VOCLIB_FILTERBANK_SIZE * NUM_COEFFICIENTS]{}; /* The filterbank used for synthesis (these are applied to the carrier). */
+        alignas(64) float fSynthesisState[2][VOCLIB_FILTERBANK_SIZE * NUM_STATES]{};           /* The second state is only used for stereo carriers. */
+        alignas(64) float fEnvelopeHistory[VOCLIB_MAX_BANDS * NUM_ENVELOPE_STAGES]{};          /* `[stage][band]` */
+        /* per-chunk intermediate signals of a group of bands, `[frame][band]` */
+        alignas(64) float fAnalysisChunk[CHUNK_SIZE * LANES]{};
+        alignas(64) float fSynthesisChunk[CHUNK_SIZE * LANES]{};
+        alignas(64) float fOutputChunk[2][CHUNK_SIZE * LANES]{};
+
+        static float* coefficients(float* filterbank, const uint8_t filter, const uint8_t coefficient) {
+            return filterbank + (filter * NUM_COEFFICIENTS + coefficient) * VOCLIB_MAX_BANDS;
+        }
 
-        /**
-         * Stores the state required for our envelope follower.
-         */
-        struct envelope {
-            float coef       = 0;
-            float history[4] = {0};
-        };
+        static float* state(float* filterbank_state, const uint8_t filter, const uint8_t state) {
+            return filterbank_state + (filter * NUM_STATES + state) * VOCLIB_MAX_BANDS;
+        }
 
-        /**
-         * Holds a set of filters required for one vocoder band.
+        static uint8_t simd_width() {
+#if KLANGWELLEN_SIMD_X86
+            const uint8_t mISA = BufferKernels::get_isa();
+            return mISA >= BufferKernels::ISA_AVX512 ? 16 : (mISA >= BufferKernels::ISA_AVX2 ? 8 : 1);
+#else
+            return 1;
+#endif
+        }
+
+        /*
+         * runs the analysis and synthesis filterbanks chunk by chunk. each group of bands runs every filter stage over
+         * the whole chunk before the next stage, then the envelopes, and accumulates `synthesis * envelope` per band
+         * lane. the lanes are summed once per frame after all groups. all inputs of a chunk are read before its output
+         * is written, so the output may alias the carrier or the modulator.
+         * <p>
+         * without a modulator the envelopes are read from `envelopes_in`, with `envelopes_out` they are written there
+         * instead of an internal chunk. without a carrier only the analysis runs.
          */
-        struct band {
-        public:
-            biquad filters[VOCLIB_MAX_FILTERS_PER_BAND];
-            // band() {
-            //     for (uint8_t i = 0; i < VOCLIB_MAX_FILTERS_PER_BAND; i++) {
-            //         filters[i] = new biquad();
-            //     }
-            // }
-        };
+        void process_bands(const float*   carrier_left,
+                           const float*   carrier_right,
+                           const float*   modulator,
+                           const float*   envelopes_in,
+                           float*         envelopes_out,
+                           float*         output_left,
+                           float*         output_right,
+                           const uint32_t frames) {
+            const uint8_t mWidth    = simd_width();
+            const uint8_t mChannels = carrier_left == nullptr ? 0 : (carrier_right != nullptr ? 2 : 1);
+            for (uint32_t i = 0; i < frames; i += CHUNK_SIZE) {
+                const uint32_t mLength = frames - i < CHUNK_SIZE ? frames - i : CHUNK_SIZE;
+                for (uint8_t c = 0; c < mChannels; c++) {
+                    std::fill_n(fOutputChunk[c], mLength * mWidth, 0.0f);
+                }
+                for (uint8_t j = 0; j < fBands; j += mWidth) {
+                    const float* mEnvelopes;
+                    uint32_t     mStride;
+                    if (modulator != nullptr) {
+                        float* mAnalysis = envelopes_out != nullptr ? envelopes_out + i * fEnvelopeStride + j : fAnalysisChunk;
+                        mStride          = envelopes_out != nullptr ? fEnvelopeStride : mWidth;
+                        analysis_group(mWidth, modulator + i, j, mLength, mAnalysis, mStride);
+                        mEnvelopes = mAnalysis;
+                    } else {
+                        mEnvelopes = envelopes_in + i * fEnvelopeStride + j;
+                        mStride    = fEnvelopeStride;
+                    }
+                    if (mChannels > 0) {
+                        synthesis_group(mWidth, carrier_left + i, mChannels == 2 ? carrier_right + i : nullptr, mEnvelopes, mStride, j, mLength);
+                    }
+                }
+                for (uint8_t c = 0; c < mChannels; c++) {
+                    float*       mOutput = c == 0 ? output_left + i : output_right + i;
+                    const float* mChunk  = fOutputChunk[c];
+                    for (uint32_t k = 0; k < mLength; k++) {
+                        float out = 0.0f;
+                        for (uint8_t l = 0; l < mWidth; l++) {
+                            out += mChunk[k * mWidth + l];
+                        }
+                        mOutput[k] = out * fRectifyVolume;
+                    }
+                }
+            }
+            /* the scalar analysis does not compute the padding bands */
+            if (envelopes_out != nullptr && modulator != nullptr && mWidth == 1) {
+                for (uint32_t i = 0; i < frames; i++) {
+                    std::fill(envelopes_out + i * fEnvelopeStride + fBands, envelopes_out + (i + 1) * fEnvelopeStride, 0.0f);
+                }
+            }
+        }
 
-    private:
-        /* filter types. */
-        static const uint8_t   VOCLIB_LPF       = 0;                      /* low pass filter */
-        static const uint8_t   VOCLIB_HPF       = 1;                      /* High pass filter */
-        static const uint8_t   VOCLIB_BPF       = 2;                      /* band pass filter */
-        static const uint8_t   VOCLIB_NOTCH     = 3;                      /* Notch Filter */
-        static const uint8_t   VOCLIB_PEQ       = 4;                      /* Peaking band EQ filter */
-        static const uint8_t   VOCLIB_LSH       = 5;                      /* Low shelf filter */
-        static const uint8_t   VOCLIB_HSH       = 6;                      /* High shelf filter */
-        static const uint8_t   VOCLIB_MAX_BANDS = 96;                     /* The maximum number of bands that the vocoder can be initialized with (lower this number to save memory). */
-        static constexpr float VOCLIB_M_LN2     = 0.69314718055994530942; /**/
-        static constexpr float VOCLIB_M_PI      = 3.14159265358979323846; /**/
-        const uint32_t         fSampleRate;                               /* in Hz */
-        band                   fAnalysisBands[VOCLIB_MAX_BANDS];          /* The filterbank used for analysis (these are applied to the modulator). */
-        const uint8_t          fBands;                                    /**/
-        const uint8_t          fFiltersPerBand;                           /**/
-        envelope               fAnalysisEnvelopes[VOCLIB_MAX_BANDS];      /* The envelopes used to smooth the analysis bands. */
-        float                  fFormantShift;                             /* In octaves. 1.0 is unchanged. */
-        float                  fReactionTime;                             /* In seconds. Higher values make the vocoder respond more slowly to changes in the modulator. */
-        band                   fSynthesisBands[VOCLIB_MAX_BANDS * 2];     /* The filterbank used for synthesis (these are applied to the carrier). The second half of the array is only used for stereo carriers. */
-        float                  fRectifyVolume;                            /**/
-
-        /* Computes a BiQuad filter on a sample. */
-        float BiQuad(float sample, biquad& b) {
-            /* compute the result. */
-            const float r0     = b.a0 * sample;
-            const float r1     = b.a1 * b.x1;
-            const float r2     = b.a2 * b.x2;
-            const float r3     = b.a3 * b.y1;
-            const float r4     = b.a4 * b.y2;
-            const float r5     = r0 + r1;
-            const float r6     = r2 - r3 - r4;
-            const float result = r5 + r6;
-
-            /* shift x1 to x2, sample to x1. */
-            b.x2 = b.x1;
-            b.x1 = sample;
-
-            /* shift y1 to y2, result to y1. */
-            b.y2 = b.y1;
-            b.y1 = result;
-
-            return result;
-        }
-
-        /* Envelope follower. */
-
-        /* sets up a BiQuad Filter. */
-        void BiQuad_new(biquad& b, uint8_t type, float dbGain, /* gain of filter */
-                        float freq,                            /* center frequency */
-                        float srate,                           /* sampling rate */
+        void analysis_group(const uint8_t width, const float* modulator, const uint8_t band, const uint32_t length, float* envelopes, const uint32_t stride) {
+            switch (width) {
+#if KLANGWELLEN_SIMD_X86
+                case 16:
+                    analysis_group_avx512(modulator, band, length, envelopes, stride);
+                    return;
+                case 8:
+                    analysis_group_avx2(modulator, band, length, envelopes, stride);
+                    return;
+#endif
+                default:
+                    analysis_group_scalar(modulator, band, length, envelopes, stride);
+                    return;
+            }
+        }
+
+        void synthesis_group(const uint8_t  width,
+                             const float*   carrier_left,
+                             const float*   carrier_right,
+                             const float*   envelopes,
+                             const uint32_t stride,
+                             const uint8_t  band,
+                             const uint32_t length) {
+            switch (width) {
+#if KLANGWELLEN_SIMD_X86
+                case 16:
+                    synthesis_group_avx512(carrier_left, carrier_right, envelopes, stride, band, length);
+                    return;
+                case 8:
+                    synthesis_group_avx2(carrier_left, carrier_right, envelopes, stride, band, length);
+                    return;
+#endif
+                default:
+                    synthesis_group_scalar(carrier_left, carrier_right, envelopes, stride, band, length);
+                    return;
+            }
+        }
+
+        /* Computes a cascade of BiQuad filters on a chunk of one band. */
+        void BiQuad_cascade_scalar(const float* input, float* filterbank, float* filterbank_state, const uint8_t band, float* output, const uint32_t length) {
+            for (uint8_t k = 0; k < fFiltersPerBand; k++) {
+                const float  a0 = coefficients(filterbank, k, 0)[band];
+                const float  a1 = coefficients(filterbank, k, 1)[band];
+                const float  a2 = coefficients(filterbank, k, 2)[band];
+                const float  a3 = coefficients(filterbank, k, 3)[band];
+                const float  a4 = coefficients(filterbank, k, 4)[band];
+                float        x1 = state(filterbank_state, k, 0)[band];
+                float        x2 = state(filterbank_state, k, 1)[band];
+                float        y1 = state(filterbank_state, k, 2)[band];
+                float        y2 = state(filterbank_state, k, 3)[band];
+                const float* mInput = k == 0 ? input : output;
+                for (uint32_t i = 0; i < length; i++) {
+                    const float sample = mInput[i];
+                    /* compute the result. */
+                    const float r0     = a0 * sample;
+                    const float r1     = a1 * x1;
+                    const float r2     = a2 * x2;
+                    const float r3     = a3 * y1;
+                    const float r4     = a4 * y2;
+                    const float r5     = r0 + r1;
+                    const float r6     = r2 - r3 - r4;
+                    const float result = r5 + r6;
+                    /* shift x1 to x2, sample to x1, y1 to y2, result to y1. */
+                    x2        = x1;
+                    x1        = sample;
+                    y2        = y1;
+                    y1        = result;
+                    output[i] = result;
+                }
+                state(filterbank_state, k, 0)[band] = x1;
+                state(filterbank_state, k, 1)[band] = x2;
+                state(filterbank_state, k, 2)[band] = y1;
+                state(filterbank_state, k, 3)[band] = y2;
+            }
+        }
+
+        void analysis_group_scalar(const float* modulator, const uint8_t band, const uint32_t length, float* envelopes, const uint32_t stride) {
+            BiQuad_cascade_scalar(modulator, fAnalysisCoefficients, fAnalysisState, band, fAnalysisChunk, length);
+
+            /* Envelope follower. */
+            const float coef = fEnvelopeCoefficient;
+            float       h0   = fEnvelopeHistory[band];
+            float       h1   = fEnvelopeHistory[VOCLIB_MAX_BANDS + band];
+            float       h2   = fEnvelopeHistory[VOCLIB_MAX_BANDS * 2 + band];
+            float       h3   = fEnvelopeHistory[VOCLIB_MAX_BANDS * 3 + band];
+            for (uint32_t i = 0; i < length; i++) {
+                const float e00       = (1.0f - coef) * KlangWellen::abs(fAnalysisChunk[i]);
+                const float e01       = coef * h0;
+                const float e10       = (1.0f - coef) * h0;
+                const float e11       = coef * h1;
+                const float e20       = (1.0f - coef) * h1;
+                const float e21       = coef * h2;
+                const float e30       = (1.0f - coef) * h2;
+                const float e31       = coef * h3;
+                h0                    = (e00) + (e01);
+                h1                    = (e10) + (e11);
+                h2                    = (e20) + (e21);
+                h3                    = (e30) + (e31);
+                envelopes[i * stride] = h3;
+            }
+            fEnvelopeHistory[band]                        = h0;
+            fEnvelopeHistory[VOCLIB_MAX_BANDS + band]     = h1;
+            fEnvelopeHistory[VOCLIB_MAX_BANDS * 2 + band] = h2;
+            fEnvelopeHistory[VOCLIB_MAX_BANDS * 3 + band] = h3;
+        }
+
+        void synthesis_group_scalar(const float*   carrier_left,
+                                    const float*   carrier_right,
+                                    const float*   envelopes,
+                                    const uint32_t stride,
+                                    const uint8_t  band,
+                                    const uint32_t length) {
+            for (uint8_t c = 0; c < (carrier_right != nullptr ? 2 : 1); c++) {
+                BiQuad_cascade_scalar(c == 0 ? carrier_left : carrier_right, fSynthesisCoefficients, fSynthesisState[c], band, fSynthesisChunk, length);
+                for (uint32_t i = 0; i < length; i++) {
+                    fOutputChunk[c][i] += fSynthesisChunk[i] * envelopes[i * stride];
+                }
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        KLANGWELLEN_TARGET_AVX2
+        void BiQuad_cascade_avx2(const float* input, float* filterbank, float* filterbank_state, const uint8_t band, float* output, const uint32_t length) {
+            for (uint8_t k = 0; k < fFiltersPerBand; k++) {
+                const __m256 a0 = _mm256_load_ps(coefficients(filterbank, k, 0) + band);
+                const __m256 a1 = _mm256_load_ps(coefficients(filterbank, k, 1) + band);
+                const __m256 a2 = _mm256_load_ps(coefficients(filterbank, k, 2) + band);
+                const __m256 a3 = _mm256_load_ps(coefficients(filterbank, k, 3) + band);
+                const __m256 a4 = _mm256_load_ps(coefficients(filterbank, k, 4) + band);
+                __m256       x1 = _mm256_load_ps(state(filterbank_state, k, 0) + band);
+                __m256       x2 = _mm256_load_ps(state(filterbank_state, k, 1) + band);
+                __m256       y1 = _mm256_load_ps(state(filterbank_state, k, 2) + band);
+                __m256       y2 = _mm256_load_ps(state(filterbank_state, k, 3) + band);
+                for (uint32_t i = 0; i < length; i++) {
+                    /* the first stage of all bands filters the same input sample */
+                    const __m256 x = k == 0 ? _mm256_set1_ps(input[i]) : _mm256_load_ps(output + i * 8);
+                    const __m256 y = _mm256_fmadd_ps(a0, x, _mm256_fmadd_ps(a1, x1, _mm256_fnmadd_ps(a3, y1, _mm256_fnmadd_ps(a4, y2, _mm256_mul_ps(a2, x2)))));
+                    x2             = x1;
+                    x1             = x;
+                    y2             = y1;
+                    y1             = y;
+                    _mm256_store_ps(output + i * 8, y);
+                }
+                _mm256_store_ps(state(filterbank_state, k, 0) + band, x1);
+                _mm256_store_ps(state(filterbank_state, k, 1) + band, x2);
+                _mm256_store_ps(state(filterbank_state, k, 2) + band, y1);
+                _mm256_store_ps(state(filterbank_state, k, 3) + band, y2);
+            }
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        void analysis_group_avx2(const float* modulator, const uint8_t band, const uint32_t length, float* envelopes, const uint32_t stride) {
+            BiQuad_cascade_avx2(modulator, fAnalysisCoefficients, fAnalysisState, band, fAnalysisChunk, length);
+
+            const __m256 mCoef    = _mm256_set1_ps(fEnvelopeCoefficient);
+            const __m256 mCoefInv = _mm256_set1_ps(1.0f - fEnvelopeCoefficient);
+            const __m256 mAbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+            __m256       h0       = _mm256_load_ps(fEnvelopeHistory + band);
+            __m256       h1       = _mm256_load_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS + band);
+            __m256       h2       = _mm256_load_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS * 2 + band);
+            __m256       h3       = _mm256_load_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS * 3 + band);
+            for (uint32_t i = 0; i < length; i++) {
+                const __m256 x = _mm256_and_ps(_mm256_load_ps(fAnalysisChunk + i * 8), mAbsMask);
+                h3             = _mm256_fmadd_ps(mCoefInv, h2, _mm256_mul_ps(mCoef, h3));
+                h2             = _mm256_fmadd_ps(mCoefInv, h1, _mm256_mul_ps(mCoef, h2));
+                h1             = _mm256_fmadd_ps(mCoefInv, h0, _mm256_mul_ps(mCoef, h1));
+                h0             = _mm256_fmadd_ps(mCoefInv, x, _mm256_mul_ps(mCoef, h0));
+                _mm256_storeu_ps(envelopes + i * stride, h3);
+            }
+            _mm256_store_ps(fEnvelopeHistory + band, h0);
+            _mm256_store_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS + band, h1);
+            _mm256_store_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS * 2 + band, h2);
+            _mm256_store_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS * 3 + band, h3);
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        void synthesis_group_avx2(const float*   carrier_left,
+                                  const float*   carrier_right,
+                                  const float*   envelopes,
+                                  const uint32_t stride,
+                                  const uint8_t  band,
+                                  const uint32_t length) {
+            for (uint8_t c = 0; c < (carrier_right != nullptr ? 2 : 1); c++) {
+                BiQuad_cascade_avx2(c == 0 ? carrier_left : carrier_right, fSynthesisCoefficients, fSynthesisState[c], band, fSynthesisChunk, length);
+                for (uint32_t i = 0; i < length; i++) {
+                    const __m256 mProduct = _mm256_mul_ps(_mm256_load_ps(fSynthesisChunk + i * 8), _mm256_loadu_ps(envelopes + i * stride));
+                    _mm256_store_ps(fOutputChunk[c] + i * 8, _mm256_add_ps(_mm256_load_ps(fOutputChunk[c] + i * 8), mProduct));
+                }
+            }
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        void BiQuad_cascade_avx512(const float* input, float* filterbank, float* filterbank_state, const uint8_t band, float* output, const uint32_t length) {
+            for (uint8_t k = 0; k < fFiltersPerBand; k++) {
+                const __m512 a0 = _mm512_load_ps(coefficients(filterbank, k, 0) + band);
+                const __m512 a1 = _mm512_load_ps(coefficients(filterbank, k, 1) + band);
+                const __m512 a2 = _mm512_load_ps(coefficients(filterbank, k, 2) + band);
+                const __m512 a3 = _mm512_load_ps(coefficients(filterbank, k, 3) + band);
+                const __m512 a4 = _mm512_load_ps(coefficients(filterbank, k, 4) + band);
+                __m512       x1 = _mm512_load_ps(state(filterbank_state, k, 0) + band);
+                __m512       x2 = _mm512_load_ps(state(filterbank_state, k, 1) + band);
+                __m512       y1 = _mm512_load_ps(state(filterbank_state, k, 2) + band);
+                __m512       y2 = _mm512_load_ps(state(filterbank_state, k, 3) + band);
+                for (uint32_t i = 0; i < length; i++) {
+                    const __m512 x = k == 0 ? _mm512_set1_ps(input[i]) : _mm512_load_ps(output + i * 16);
+                    const __m512 y = _mm512_fmadd_ps(a0, x, _mm512_fmadd_ps(a1, x1, _mm512_fnmadd_ps(a3, y1, _mm512_fnmadd_ps(a4, y2, _mm512_mul_ps(a2, x2)))));
+                    x2             = x1;
+                    x1             = x;
+                    y2             = y1;
+                    y1             = y;
+                    _mm512_store_ps(output + i * 16, y);
+                }
+                _mm512_store_ps(state(filterbank_state, k, 0) + band, x1);
+                _mm512_store_ps(state(filterbank_state, k, 1) + band, x2);
+                _mm512_store_ps(state(filterbank_state, k, 2) + band, y1);
+                _mm512_store_ps(state(filterbank_state, k, 3) + band, y2);
+            }
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        void analysis_group_avx512(const float* modulator, const uint8_t band, const uint32_t length, float* envelopes, const uint32_t stride) {
+            BiQuad_cascade_avx512(modulator, fAnalysisCoefficients, fAnalysisState, band, fAnalysisChunk, length);
+
+            const __m512 mCoef    = _mm512_set1_ps(fEnvelopeCoefficient);
+            const __m512 mCoefInv = _mm512_set1_ps(1.0f - fEnvelopeCoefficient);
+            __m512       h0       = _mm512_load_ps(fEnvelopeHistory + band);
+            __m512       h1       = _mm512_load_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS + band);
+            __m512       h2       = _mm512_load_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS * 2 + band);
+            __m512       h3       = _mm512_load_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS * 3 + band);
+            for (uint32_t i = 0; i < length; i++) {
+                const __m512 x = _mm512_abs_ps(_mm512_load_ps(fAnalysisChunk + i * 16));
+                h3             = _mm512_fmadd_ps(mCoefInv, h2, _mm512_mul_ps(mCoef, h3));
+                h2             = _mm512_fmadd_ps(mCoefInv, h1, _mm512_mul_ps(mCoef, h2));
+                h1             = _mm512_fmadd_ps(mCoefInv, h0, _mm512_mul_ps(mCoef, h1));
+                h0             = _mm512_fmadd_ps(mCoefInv, x, _mm512_mul_ps(mCoef, h0));
+                _mm512_storeu_ps(envelopes + i * stride, h3);
+            }
+            _mm512_store_ps(fEnvelopeHistory + band, h0);
+            _mm512_store_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS + band, h1);
+            _mm512_store_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS * 2 + band, h2);
+            _mm512_store_ps(fEnvelopeHistory + VOCLIB_MAX_BANDS * 3 + band, h3);
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        void synthesis_group_avx512(const float*   carrier_left,
+                                    const float*   carrier_right,
+                                    const float*   envelopes,
+                                    const uint32_t stride,
+                                    const uint8_t  band,
+                                    const uint32_t length) {
+            for (uint8_t c = 0; c < (carrier_right != nullptr ? 2 : 1); c++) {
+                BiQuad_cascade_avx512(c == 0 ? carrier_left : carrier_right, fSynthesisCoefficients, fSynthesisState[c], band, fSynthesisChunk, length);
+                for (uint32_t i = 0; i < length; i++) {
+                    const __m512 mProduct = _mm512_mul_ps(_mm512_load_ps(fSynthesisChunk + i * 16), _mm512_loadu_ps(envelopes + i * stride));
+                    _mm512_store_ps(fOutputChunk[c] + i * 16, _mm512_add_ps(_mm512_load_ps(fOutputChunk[c] + i * 16), mProduct));
+                }
+            }
+        }
+#endif
+
+        /* sets up a BiQuad Filter for one band of a filterbank. */
+        void BiQuad_new(float* filterbank, uint8_t band, uint8_t type, float dbGain, /* gain of filter */
+                        float freq,                                                    /* center frequency */
+                        float srate,                                                   /* sampling rate */
                         float bandwidth) /* bandwidth in octaves */ {
             float A, omega, sn, cs, alpha, beta;
             float a0, a1, a2, b0, b1, b2;
@@ -468,58 +861,20 @@ namespace klangwellen {
                     return;
             }
 
-            /* precompute the coefficients. */
-            b.a0 = b0 / a0;
-            b.a1 = b1 / a0;
-            b.a2 = b2 / a0;
-            b.a3 = a1 / a0;
-            b.a4 = a2 / a0;
-        }
-
-        /* Reset the filter history. */
-        void BiQuad_reset(biquad& b) {
-            b.x1 = b.x2 = 0.0f;
-            b.y1 = b.y2 = 0.0f;
-        }
-
-        void envelope_configure(envelope& envelope, float time_in_seconds, float sample_rate) {
-            envelope.coef = (float) (KlangWellen::pow(0.01, 1.0 / (time_in_seconds * sample_rate)));
-        }
-
-        /* Reset the envelope history. */
-        void envelope_reset(envelope& envelope) {
-            envelope.history[0] = 0.0f;
-            envelope.history[1] = 0.0f;
-            envelope.history[2] = 0.0f;
-            envelope.history[3] = 0.0f;
-        }
-
-        float envelope_tick(envelope& envelope, float sample) {
-            const float coef = envelope.coef;
-            const float e00  = (1.0f - coef) * KlangWellen::abs(sample);
-            const float e01  = coef * envelope.history[0];
-            const float e10  = (1.0f - coef) * envelope.history[0];
-            const float e11  = coef * envelope.history[1];
-            const float e20  = (1.0f - coef) * envelope.history[1];
-            const float e21  = coef * envelope.history[2];
-            const float e30  = (1.0f - coef) * envelope.history[2];
-            const float e31  = coef * envelope.history[3];
-
-            envelope.history[0] = (e00) + (e01);
-            envelope.history[1] = (e10) + (e11);
-            envelope.history[2] = (e20) + (e21);
-            envelope.history[3] = (e30) + (e31);
-            return envelope.history[3];
+            /* precompute the coefficients for all filters of the band. */
+            for (uint8_t j = 0; j < fFiltersPerBand; ++j) {
+                coefficients(filterbank, j, 0)[band] = b0 / a0;
+                coefficients(filterbank, j, 1)[band] = b1 / a0;
+                coefficients(filterbank, j, 2)[band] = b2 / a0;
+                coefficients(filterbank, j, 3)[band] = a1 / a0;
+                coefficients(filterbank, j, 4)[band] = a2 / a0;
+            }
         }
 
         /* Initialize the vocoder envelopes. */
         void initialize_envelopes() {
-            uint8_t i;
-
-            envelope_configure(fAnalysisEnvelopes[0], fReactionTime, fSampleRate);
-            for (i = 1; i < fBands; ++i) {
-                fAnalysisEnvelopes[i].coef = fAnalysisEnvelopes[0].coef;
-            }
+            fEnvelopeCoefficient = (float) (KlangWellen::pow(0.01, 1.0 / (fReactionTime * fSampleRate)));
+            fSilence.set_hold(get_tail_length());
         }
 
         /* Initialize the vocoder filterbank. */
@@ -546,54 +901,29 @@ namespace klangwellen {
                 bandwidth = (nextfreq - priorfreq) / lastfreq;
 
                 if (!pCarrier_only) {
-                    BiQuad_new(fAnalysisBands[i].filters[0],
+                    BiQuad_new(fAnalysisCoefficients,
+                               i,
                                VOCLIB_BPF,
                                0.0f,
                                lastfreq,
                                fSampleRate,
                                bandwidth);
-                    for (uint8_t j = 1; j < fFiltersPerBand; ++j) {
-                        fAnalysisBands[i].filters[j].a0 = fAnalysisBands[i].filters[0].a0;
-                        fAnalysisBands[i].filters[j].a1 = fAnalysisBands[i].filters[0].a1;
-                        fAnalysisBands[i].filters[j].a2 = fAnalysisBands[i].filters[0].a2;
-                        fAnalysisBands[i].filters[j].a3 = fAnalysisBands[i].filters[0].a3;
-                        fAnalysisBands[i].filters[j].a4 = fAnalysisBands[i].filters[0].a4;
-                    }
                 }
 
                 if (fFormantShift != 1.0f) {
-                    BiQuad_new(fSynthesisBands[i].filters[0],
+                    BiQuad_new(fSynthesisCoefficients,
+                               i,
                                VOCLIB_BPF,
                                0.0f,
                                (float) (lastfreq * fFormantShift),
                                (float) fSampleRate,
                                (float) bandwidth);
                 } else {
-                    fSynthesisBands[i].filters[0].a0 = fAnalysisBands[i].filters[0].a0;
-                    fSynthesisBands[i].filters[0].a1 = fAnalysisBands[i].filters[0].a1;
-                    fSynthesisBands[i].filters[0].a2 = fAnalysisBands[i].filters[0].a2;
-                    fSynthesisBands[i].filters[0].a3 = fAnalysisBands[i].filters[0].a3;
-                    fSynthesisBands[i].filters[0].a4 = fAnalysisBands[i].filters[0].a4;
-                }
-
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a0 = fSynthesisBands[i].filters[0].a0;
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a1 = fSynthesisBands[i].filters[0].a1;
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a2 = fSynthesisBands[i].filters[0].a2;
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a3 = fSynthesisBands[i].filters[0].a3;
-                fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[0].a4 = fSynthesisBands[i].filters[0].a4;
-
-                for (uint8_t j = 1; j < fFiltersPerBand; ++j) {
-                    fSynthesisBands[i].filters[j].a0 = fSynthesisBands[i].filters[0].a0;
-                    fSynthesisBands[i].filters[j].a1 = fSynthesisBands[i].filters[0].a1;
-                    fSynthesisBands[i].filters[j].a2 = fSynthesisBands[i].filters[0].a2;
-                    fSynthesisBands[i].filters[j].a3 = fSynthesisBands[i].filters[0].a3;
-                    fSynthesisBands[i].filters[j].a4 = fSynthesisBands[i].filters[0].a4;
-
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a0 = fSynthesisBands[i].filters[0].a0;
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a1 = fSynthesisBands[i].filters[0].a1;
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a2 = fSynthesisBands[i].filters[0].a2;
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a3 = fSynthesisBands[i].filters[0].a3;
-                    fSynthesisBands[i + VOCLIB_MAX_BANDS].filters[j].a4 = fSynthesisBands[i].filters[0].a4;
+                    for (uint8_t j = 0; j < fFiltersPerBand; ++j) {
+                        for (uint8_t k = 0; k < NUM_COEFFICIENTS; ++k) {
+                            coefficients(fSynthesisCoefficients, j, k)[i] = coefficients(fAnalysisCoefficients, j, k)[i];
+                        }
+                    }
                 }
             }
         }
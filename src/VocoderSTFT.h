@@ -0,0 +1,560 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [ ] void process(float*, uint32_t)
+ * - [ ] void process(float*, float*, uint32_t)
+ * - [x] float process(float, float)
+ * - [x] void process(float*, float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&, AudioBuffer&, AudioBuffer&)
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "FFT.h"
+#include "SilenceDetector.h"
+
+namespace klangwellen {
+    /**
+     * superimposes a modulator signal ( e.g a human voice ) onto a carrier signal ( e.g sawtooth oscillator ) in the
+     * frequency domain. `VocoderSTFT` has the same interface as `Vocoder` ( including `analyze` / `synthesize` and
+     * the silence detection ) except for the constructor, whose second parameter is the FFT size instead of the number
+     * of filters per band.
+     * <p>
+     * carrier and modulator are transformed with a short-time fourier transform ( hann window, 4 times overlap-add ).
+     * the bins of the modulator are summed into bands that are spaced logarithmically between 80 Hz and 12 kHz like the
+     * bands of `Vocoder`. the band amplitudes are smoothed over time with the reaction time and interpolated between
+     * band centers into a smooth spectral envelope, which is applied to the bins of the carrier. the cost per sample
+     * depends on the FFT size but hardly on the number of bands, so 128 or more bands cost about the same as 16.
+     * formant shift stretches the spectral envelope along the frequency axis instead of rebuilding a filterbank.
+     * <p>
+     * the output is delayed by `get_latency()` samples ( FFT size minus hop size ).
+     */
+    class VocoderSTFT {
+    public:
+        /**
+         * @param bands       number of bands
+         * @param fft_size    size of the FFT, rounded up to a power of two. larger sizes resolve more bands in the low
+         *                    frequencies but react more slowly and add latency.
+         * @param sample_rate sampling rate
+         */
+        VocoderSTFT(const uint16_t bands       = 24,
+                    const uint32_t fft_size    = 1024,
+                    const uint32_t sample_rate = KlangWellen::DEFAULT_SAMPLE_RATE) : fSampleRate(sample_rate),
+                                                                                     fBands(bands < 1 ? 1 : bands),
+                                                                                     fFFT(fft_size < 64 ? 64 : fft_size),
+                                                                                     fSize(fFFT.get_size()),
+                                                                                     fHop(fSize / OVERLAP),
+                                                                                     fBins(fFFT.get_num_bins()),
+                                                                                     fWindow(fSize),
+                                                                                     fFrame(fSize),
+                                                                                     fSpectrum(fSize + 2),
+                                                                                     fCarrierSpectrum(fSize + 2),
+                                                                                     fModulatorInput(fSize),
+                                                                                     fBandLow(fBands),
+                                                                                     fBandHigh(fBands),
+                                                                                     fBandAmplitude(fBands),
+                                                                                     fBinBand(fBins),
+                                                                                     fBinFraction(fBins),
+                                                                                     fBinEnvelope(fBins) {
+            fEnvelopeStride = (fBands + ENVELOPE_LANES - 1) / ENVELOPE_LANES * ENVELOPE_LANES;
+            for (uint8_t c = 0; c < 2; c++) {
+                fCarrierInput[c].resize(fSize);
+                fAccumulator[c].resize(fSize);
+                fOutput[c].resize(fHop);
+            }
+
+            /* periodic hann window, applied before the FFT and after the inverse FFT */
+            for (uint32_t i = 0; i < fSize; i++) {
+                fWindow[i] = 0.5f - 0.5f * std::cos(2.0f * static_cast<float>(M_PI) * static_cast<float>(i) / static_cast<float>(fSize));
+            }
+            float mWindowPower  = 0.0f;
+            float mOverlapPower = 0.0f;
+            for (uint32_t i = 0; i < fSize; i++) {
+                mWindowPower += fWindow[i] * fWindow[i];
+                if (i % fHop == 0) {
+                    mOverlapPower += fWindow[i] * fWindow[i];
+                }
+            }
+            fOverlapGain = 1.0f / mOverlapPower;
+            /* band amplitude of a sine wave, scaled like the rectified envelope of `Vocoder` ( 2 / PI ) */
+            fAmplitudeGain = 2.0f / static_cast<float>(M_PI) * std::sqrt(4.0f / (static_cast<float>(fSize) * mWindowPower));
+
+            fReactionTime = 0.03f;
+            fFormantShift = 1.0f;
+            fVolume       = 1.0f;
+
+            reset_history();
+            initialize_bands();
+            initialize_envelope_map();
+            initialize_envelopes();
+        }
+
+        void set_volume(const float volume) {
+            fVolume = volume;
+        }
+
+        /**
+         * @return delay of the output in samples
+         */
+        uint32_t get_latency() const {
+            return fSize - fHop;
+        }
+
+        uint32_t get_fft_size() const {
+            return fSize;
+        }
+
+        uint16_t get_num_bands() const {
+            return fBands;
+        }
+
+        /**
+         * see `Vocoder::process`
+         */
+        void process(float*         carrier_buffer,
+                     float*         modulator_buffer,
+                     float*         output_buffer,
+                     const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            if (fSilence.skip(modulator_buffer, frames)) {
+                std::fill_n(output_buffer, frames, 0.0f);
+                return;
+            }
+            process_frames(carrier_buffer, nullptr, modulator_buffer, nullptr, nullptr, output_buffer, nullptr, frames);
+            if (fSilence.update(output_buffer, frames)) {
+                reset_history();
+            }
+        }
+
+        void process(float*         carrier_buffer_left,
+                     float*         carrier_buffer_right,
+                     float*         modulator_buffer,
+                     float*         output_buffer_left,
+                     float*         output_buffer_right,
+                     const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            if (fSilence.skip(modulator_buffer, frames)) {
+                std::fill_n(output_buffer_left, frames, 0.0f);
+                std::fill_n(output_buffer_right, frames, 0.0f);
+                return;
+            }
+            process_frames(carrier_buffer_left, carrier_buffer_right, modulator_buffer, nullptr, nullptr, output_buffer_left, output_buffer_right, frames);
+            if (fSilence.update(output_buffer_left, output_buffer_right, frames)) {
+                reset_history();
+            }
+        }
+
+        /**
+         * processes the first channel of `modulator` against the carrier. if both `carrier` and `output` have at least
+         * two channels the first two channels are processed as a stereo signal, otherwise the first channel only.
+         */
+        void process(AudioBuffer& carrier, AudioBuffer& modulator, AudioBuffer& output) {
+            if (carrier.num_channels() == 0 || modulator.num_channels() == 0 || output.num_channels() == 0) {
+                return;
+            }
+            const uint32_t mFrames = std::min(std::min(carrier.num_frames(), modulator.num_frames()), output.num_frames());
+            if (carrier.num_channels() >= 2 && output.num_channels() >= 2) {
+                process(carrier.channel(0), carrier.channel(1), modulator.channel(0), output.channel(0), output.channel(1), mFrames);
+            } else {
+                process(carrier.channel(0), modulator.channel(0), output.channel(0), mFrames);
+            }
+        }
+
+        float process(const float carrier_sample, const float modulator_sample) {
+            float mOutputSample[1];
+            float mCarrierSample[1]   = {carrier_sample};
+            float mModulatorSample[1] = {modulator_sample};
+            process(mCarrierSample, mModulatorSample, mOutputSample, 1);
+            return mOutputSample[0];
+        }
+
+        /**
+         * @return number of floats needed by an envelope buffer for `frames` frames ( see `analyze` )
+         */
+        uint32_t get_envelope_buffer_size(const uint32_t frames) const {
+            return frames * fEnvelopeStride;
+        }
+
+        /**
+         * see `Vocoder::analyze`. runs only the analysis of the modulator and writes the smoothed amplitude of band `b`
+         * at frame `i` to `envelope_buffer[i * stride + b]`, where `stride` is the number of bands rounded up to a
+         * multiple of 16. the amplitudes change once per hop, at the frame that completes the hop.
+         * <p>
+         * the analyzing and the synthesizing vocoders must both be `VocoderSTFT` with the same number of bands and the
+         * same FFT size, their formant shift may differ.
+         *
+         * @param modulator_buffer modulator signal
+         * @param envelope_buffer  envelopes with at least `get_envelope_buffer_size(frames)` floats
+         * @param frames           number of frames
+         */
+        void analyze(const float* modulator_buffer, float* envelope_buffer, const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_frames(nullptr, nullptr, modulator_buffer, nullptr, envelope_buffer, nullptr, nullptr, frames);
+        }
+
+        /**
+         * see `Vocoder::synthesize`. shapes the carrier with the band amplitudes computed by `analyze`, read at the frame
+         * that completes a hop. the synthesis state is independent of the analysis state of this instance.
+         *
+         * @param envelope_buffer envelopes computed by `analyze`
+         * @param carrier_buffer  carrier signal
+         * @param output_buffer   output, may be the same pointer as `carrier_buffer`
+         * @param frames          number of frames
+         */
+        void synthesize(const float*   envelope_buffer,
+                        const float*   carrier_buffer,
+                        float*         output_buffer,
+                        const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_frames(carrier_buffer, nullptr, nullptr, envelope_buffer, nullptr, output_buffer, nullptr, frames);
+        }
+
+        void synthesize(const float*   envelope_buffer,
+                        const float*   carrier_buffer_left,
+                        const float*   carrier_buffer_right,
+                        float*         output_buffer_left,
+                        float*         output_buffer_right,
+                        const uint32_t frames = KlangWellen::DEFAULT_AUDIOBLOCK_SIZE) {
+            process_frames(carrier_buffer_left, carrier_buffer_right, nullptr, envelope_buffer, nullptr, output_buffer_left, output_buffer_right, frames);
+        }
+
+        /**
+         * see `Vocoder::set_formant_shift`. the value must be between 0.25 and 4.0 (inclusive).
+         *
+         * @return 1 on success or 0 if the parameter is invalid
+         */
+        uint8_t set_formant_shift(const float formant_shift) {
+            if (formant_shift < 0.25f || formant_shift > 4.0f) {
+                return 0;
+            }
+            fFormantShift = formant_shift;
+            initialize_envelope_map();
+            return 1;
+        }
+
+        float get_formant_shift() const {
+            return fFormantShift;
+        }
+
+        /**
+         * see `Vocoder::set_reaction_time`. the value must be between 0.002 and 2.0 (inclusive). reaction times
+         * shorter than the hop size ( FFT size / 4 ) have no further effect.
+         *
+         * @return 1 on success or 0 if the parameter is invalid
+         */
+        uint8_t set_reaction_time(const float reaction_time) {
+            if (reaction_time < 0.002f || reaction_time > 2.0f) {
+                return 0;
+            }
+            fReactionTime = reaction_time;
+            initialize_envelopes();
+            return 1;
+        }
+
+        float get_reaction_time() const {
+            return fReactionTime;
+        }
+
+        /**
+         * @param threshold amplitude below which modulator and output count as silent, 0 disables the silence
+         *                  detection
+         */
+        void set_silence_threshold(const float threshold) {
+            fSilence.set_threshold(threshold);
+            fSilence.set_hold(get_tail_length());
+        }
+
+        float get_silence_threshold() const {
+            return fSilence.get_threshold();
+        }
+
+        /**
+         * @return true if the vocoder skips processing because modulator and output are silent
+         */
+        bool is_sleeping() const {
+            return fSilence.is_sleeping();
+        }
+
+        /**
+         * @return estimated number of samples the output takes to fall below the silence threshold after the modulator
+         *         stopped: one FFT frame of buffered input plus the decay of the band amplitudes, which are multiplied
+         *         by the envelope coefficient once per hop.
+         */
+        uint32_t get_tail_length() const {
+            const uint32_t mDecay = SilenceDetector::decay_length(fHop, fEnvelopeCoefficient, fSilence.get_threshold());
+            return mDecay > UINT32_MAX - fSize ? UINT32_MAX : fSize + mDecay;
+        }
+
+        void reset_history() {
+            std::fill(fModulatorInput.begin(), fModulatorInput.end(), 0.0f);
+            for (uint8_t c = 0; c < 2; c++) {
+                std::fill(fCarrierInput[c].begin(), fCarrierInput[c].end(), 0.0f);
+                std::fill(fAccumulator[c].begin(), fAccumulator[c].end(), 0.0f);
+                std::fill(fOutput[c].begin(), fOutput[c].end(), 0.0f);
+            }
+            std::fill(fBandAmplitude.begin(), fBandAmplitude.end(), 0.0f);
+            fAnalysisPosition  = fSize - fHop;
+            fSynthesisPosition = fSize - fHop;
+        }
+
+    private:
+        static constexpr uint32_t OVERLAP        = 4;
+        static constexpr float    MIN_FREQUENCY  = 80.0f;
+        static constexpr float    MAX_FREQUENCY  = 12000.0f;
+        static constexpr int32_t  OUTSIDE        = -1;
+        static constexpr uint32_t ENVELOPE_LANES = 16; /* envelope buffers are laid out like those of `Vocoder` */
+
+        const uint32_t     fSampleRate;
+        const uint16_t     fBands;
+        FFT                fFFT;
+        const uint32_t     fSize;
+        const uint32_t     fHop;
+        const uint32_t     fBins;
+        std::vector<float> fWindow;
+        float              fOverlapGain;
+        float              fAmplitudeGain;
+        float              fReactionTime;
+        float              fFormantShift;
+        float              fVolume;
+        float              fEnvelopeCoefficient;
+        uint32_t           fEnvelopeStride;
+        SilenceDetector    fSilence;
+        /* the last `fSize` input samples, filled from `fSize - fHop` to `fSize` between two frames. modulator and carrier
+         * advance together in `process` but separately in `analyze` and `synthesize`. */
+        uint32_t           fAnalysisPosition;
+        uint32_t           fSynthesisPosition;
+        std::vector<float> fFrame;
+        std::vector<float> fSpectrum;
+        std::vector<float> fCarrierSpectrum;
+        std::vector<float> fModulatorInput;
+        std::vector<float> fCarrierInput[2];
+        /* overlap-add of the output frames, the first `fHop` samples are complete after each frame */
+        std::vector<float> fAccumulator[2];
+        std::vector<float> fOutput[2];
+        /* bins `[ fBandLow, fBandHigh )` of each band and the smoothed band amplitudes */
+        std::vector<uint32_t> fBandLow;
+        std::vector<uint32_t> fBandHigh;
+        std::vector<float>    fBandAmplitude;
+        /* position of each output bin on the spectral envelope: band index and fraction to the next band */
+        std::vector<int32_t> fBinBand;
+        std::vector<float>   fBinFraction;
+        std::vector<float>   fBinEnvelope;
+
+        float max_frequency() const {
+            return std::min(MAX_FREQUENCY, static_cast<float>(fSampleRate) * 0.5f);
+        }
+
+        /* band centers `MIN_FREQUENCY * step^b` with edges halfway between centers on a logarithmic scale */
+        void initialize_bands() {
+            const float mStep    = std::pow(max_frequency() / MIN_FREQUENCY, 1.0f / static_cast<float>(fBands));
+            const float mBinSize = static_cast<float>(fSampleRate) / static_cast<float>(fSize);
+            for (uint16_t b = 0; b < fBands; b++) {
+                const float mCenter = MIN_FREQUENCY * std::pow(mStep, static_cast<float>(b));
+                const float mLow    = mCenter / std::sqrt(mStep);
+                const float mHigh   = mCenter * std::sqrt(mStep);
+                uint32_t    mFirst  = static_cast<uint32_t>(std::ceil(mLow / mBinSize));
+                uint32_t    mLast   = static_cast<uint32_t>(std::ceil(mHigh / mBinSize));
+                /* bands narrower than a bin use the bin closest to their center */
+                if (mLast <= mFirst) {
+                    mFirst = static_cast<uint32_t>(std::lround(mCenter / mBinSize));
+                    mLast  = mFirst + 1;
+                }
+                fBandLow[b]  = std::min(mFirst, fBins - 1);
+                fBandHigh[b] = std::min(mLast, fBins);
+            }
+        }
+
+        /* maps output bin `k` to the envelope at frequency `f_k / formant_shift` */
+        void initialize_envelope_map() {
+            const float mStep    = std::pow(max_frequency() / MIN_FREQUENCY, 1.0f / static_cast<float>(fBands));
+            const float mBinSize = static_cast<float>(fSampleRate) / static_cast<float>(fSize);
+            for (uint32_t k = 0; k < fBins; k++) {
+                const float mFrequency = static_cast<float>(k) * mBinSize / fFormantShift;
+                const float mPosition  = mFrequency > 0.0f ? std::log(mFrequency / MIN_FREQUENCY) / std::log(mStep) : -1.0f;
+                if (mPosition < -0.5f || mPosition > static_cast<float>(fBands) - 0.5f) {
+                    fBinBand[k]     = OUTSIDE;
+                    fBinFraction[k] = 0.0f;
+                    continue;
+                }
+                const float   mClamped = std::min(std::max(mPosition, 0.0f), static_cast<float>(fBands - 1));
+                const int32_t mBand    = std::min(static_cast<int32_t>(mClamped), static_cast<int32_t>(fBands) - 1);
+                fBinBand[k]            = mBand;
+                fBinFraction[k]        = mClamped - static_cast<float>(mBand);
+            }
+        }
+
+        void initialize_envelopes() {
+            fEnvelopeCoefficient = std::pow(0.01f, static_cast<float>(fHop) / (fReactionTime * static_cast<float>(fSampleRate)));
+            fSilence.set_hold(get_tail_length());
+        }
+
+        /*
+         * runs the analysis if `modulator` is set and the synthesis if `carrier_left` is set. the synthesis uses the band
+         * amplitudes from `envelope_in` if set, otherwise those of the analysis. `envelope_out` receives the band
+         * amplitudes of each frame.
+         */
+        void process_frames(const float*   carrier_left,
+                            const float*   carrier_right,
+                            const float*   modulator,
+                            const float*   envelope_in,
+                            float*         envelope_out,
+                            float*         output_left,
+                            float*         output_right,
+                            const uint32_t frames) {
+            const uint8_t mChannels = carrier_right != nullptr ? 2 : 1;
+            uint32_t      i         = 0;
+            while (i < frames) {
+                /* all inputs of a segment are read before its output is written, so buffers may alias */
+                uint32_t mLength = frames - i;
+                if (modulator != nullptr) {
+                    mLength = std::min(mLength, fSize - fAnalysisPosition);
+                }
+                if (carrier_left != nullptr) {
+                    mLength = std::min(mLength, fSize - fSynthesisPosition);
+                }
+                if (modulator != nullptr) {
+                    analyze_segment(modulator + i, envelope_out != nullptr ? envelope_out + i * fEnvelopeStride : nullptr, mLength);
+                }
+                if (carrier_left != nullptr) {
+                    const float* mEnvelope = envelope_in != nullptr ? envelope_in + (i + mLength - 1) * fEnvelopeStride : fBandAmplitude.data();
+                    synthesize_segment(carrier_left + i,
+                                       mChannels == 2 ? carrier_right + i : nullptr,
+                                       mEnvelope,
+                                       output_left + i,
+                                       mChannels == 2 ? output_right + i : nullptr,
+                                       mLength);
+                }
+                i += mLength;
+            }
+        }
+
+        /* buffers a segment of the modulator that ends at most at the end of the current hop */
+        void analyze_segment(const float* modulator, float* envelope, const uint32_t length) {
+            std::copy_n(modulator, length, fModulatorInput.data() + fAnalysisPosition);
+            fAnalysisPosition += length;
+            if (envelope != nullptr) {
+                for (uint32_t j = 0; j < length; j++) {
+                    std::copy_n(fBandAmplitude.data(), fBands, envelope + j * fEnvelopeStride);
+                }
+            }
+            if (fAnalysisPosition == fSize) {
+                analyze_frame();
+                fAnalysisPosition = fSize - fHop;
+                if (envelope != nullptr) {
+                    std::copy_n(fBandAmplitude.data(), fBands, envelope + (length - 1) * fEnvelopeStride);
+                }
+            }
+        }
+
+        /* buffers a segment of the carrier that ends at most at the end of the current hop and writes its output. the
+         * band amplitudes in `envelope` are only read if the segment completes the hop. */
+        void synthesize_segment(const float*   carrier_left,
+                                const float*   carrier_right,
+                                const float*   envelope,
+                                float*         output_left,
+                                float*         output_right,
+                                const uint32_t length) {
+            const uint32_t mOutput = fSynthesisPosition - (fSize - fHop);
+            std::copy_n(carrier_left, length, fCarrierInput[0].data() + fSynthesisPosition);
+            if (carrier_right != nullptr) {
+                std::copy_n(carrier_right, length, fCarrierInput[1].data() + fSynthesisPosition);
+            }
+            for (uint32_t j = 0; j < length; j++) {
+                output_left[j] = fOutput[0][mOutput + j] * fVolume;
+            }
+            if (carrier_right != nullptr) {
+                for (uint32_t j = 0; j < length; j++) {
+                    output_right[j] = fOutput[1][mOutput + j] * fVolume;
+                }
+            }
+            fSynthesisPosition += length;
+            if (fSynthesisPosition == fSize) {
+                synthesize_frame(carrier_right != nullptr ? 2 : 1, envelope);
+                fSynthesisPosition = fSize - fHop;
+            }
+        }
+
+        /* smoothed band amplitudes of the modulator */
+        void analyze_frame() {
+            for (uint32_t i = 0; i < fSize; i++) {
+                fFrame[i] = fModulatorInput[i] * fWindow[i];
+            }
+            fFFT.forward(fFrame.data(), fSpectrum.data());
+            for (uint16_t b = 0; b < fBands; b++) {
+                float mEnergy = 0.0f;
+                for (uint32_t k = fBandLow[b]; k < fBandHigh[b]; k++) {
+                    mEnergy += fSpectrum[k * 2] * fSpectrum[k * 2] + fSpectrum[k * 2 + 1] * fSpectrum[k * 2 + 1];
+                }
+                const float mAmplitude = std::sqrt(mEnergy) * fAmplitudeGain;
+                fBandAmplitude[b]      = fEnvelopeCoefficient * fBandAmplitude[b] + (1.0f - fEnvelopeCoefficient) * mAmplitude;
+            }
+            std::copy(fModulatorInput.begin() + fHop, fModulatorInput.end(), fModulatorInput.begin());
+        }
+
+        /* carriers shaped by the spectral envelope interpolated from the band amplitudes */
+        void synthesize_frame(const uint8_t channels, const float* band_amplitude) {
+            for (uint32_t k = 0; k < fBins; k++) {
+                const int32_t mBand = fBinBand[k];
+                if (mBand == OUTSIDE) {
+                    fBinEnvelope[k] = 0.0f;
+                } else {
+                    const int32_t mNext = mBand + 1 < fBands ? mBand + 1 : mBand;
+                    fBinEnvelope[k]     = band_amplitude[mBand] + fBinFraction[k] * (band_amplitude[mNext] - band_amplitude[mBand]);
+                }
+            }
+
+            for (uint8_t c = 0; c < channels; c++) {
+                const std::vector<float>& mInput = fCarrierInput[c];
+                for (uint32_t i = 0; i < fSize; i++) {
+                    fFrame[i] = mInput[i] * fWindow[i];
+                }
+                fFFT.forward(fFrame.data(), fCarrierSpectrum.data());
+                for (uint32_t k = 0; k < fBins; k++) {
+                    fCarrierSpectrum[k * 2] *= fBinEnvelope[k];
+                    fCarrierSpectrum[k * 2 + 1] *= fBinEnvelope[k];
+                }
+                fFFT.inverse(fCarrierSpectrum.data(), fFrame.data());
+                std::vector<float>& mAccumulator = fAccumulator[c];
+                for (uint32_t i = 0; i < fSize; i++) {
+                    mAccumulator[i] += fFrame[i] * fWindow[i];
+                }
+                for (uint32_t i = 0; i < fHop; i++) {
+                    fOutput[c][i] = mAccumulator[i] * fOverlapGain;
+                }
+                std::copy(mAccumulator.begin() + fHop, mAccumulator.end(), mAccumulator.begin());
+                std::fill(mAccumulator.end() - fHop, mAccumulator.end(), 0.0f);
+            }
+
+            for (uint8_t c = 0; c < 2; c++) {
+                std::copy(fCarrierInput[c].begin() + fHop, fCarrierInput[c].end(), fCarrierInput[c].begin());
+            }
+        }
+    };
+} // namespace klangwellen
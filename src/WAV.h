@@ -0,0 +1,157 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+namespace klangwellen {
+    /**
+     * reads RIFF WAVE files with 8, 16, 24 or 32 bit integer PCM or 32 or 64 bit floating-point samples ( also in
+     * `WAVE_FORMAT_EXTENSIBLE` files ). samples are converted to floats in the range [-1, 1] and stored interleaved.
+     */
+    class WAV {
+    public:
+        /**
+         * @param path         path of the file
+         * @param samples      receives the interleaved samples of all channels
+         * @param num_channels receives the number of channels
+         * @param sample_rate  receives the sample rate in Hz
+         * @return false if the file cannot be read or its format is not supported
+         */
+        static bool load(const char* path, std::vector<float>& samples, uint16_t& num_channels, uint32_t& sample_rate) {
+            FILE* mFile = fopen(path, "rb");
+            if (mFile == nullptr) {
+                return false;
+            }
+            std::vector<uint8_t> mData;
+            uint8_t              mChunk[4096];
+            size_t               mRead;
+            while ((mRead = fread(mChunk, 1, sizeof(mChunk), mFile)) > 0) {
+                mData.insert(mData.end(), mChunk, mChunk + mRead);
+            }
+            fclose(mFile);
+            return parse(mData.data(), mData.size(), samples, num_channels, sample_rate);
+        }
+
+        /**
+         * parses a WAVE file in memory, see `load`.
+         */
+        static bool parse(const uint8_t* data, const size_t size, std::vector<float>& samples, uint16_t& num_channels, uint32_t& sample_rate) {
+            if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+                return false;
+            }
+            uint16_t       mFormat   = 0;
+            uint16_t       mChannels = 0;
+            uint32_t       mRate     = 0;
+            uint16_t       mBits     = 0;
+            const uint8_t* mSamples  = nullptr;
+            size_t         mLength   = 0;
+            size_t         mPosition = 12;
+            while (mPosition + 8 <= size) {
+                const uint8_t* mChunk     = data + mPosition;
+                const size_t   mChunkSize = read_uint32(mChunk + 4);
+                const size_t   mAvailable = size - mPosition - 8;
+                if (memcmp(mChunk, "fmt ", 4) == 0 && mChunkSize >= 16 && mAvailable >= 16) {
+                    mFormat   = read_uint16(mChunk + 8);
+                    mChannels = read_uint16(mChunk + 10);
+                    mRate     = read_uint32(mChunk + 12);
+                    mBits     = read_uint16(mChunk + 22);
+                    if (mFormat == FORMAT_EXTENSIBLE && mChunkSize >= 26 && mAvailable >= 26) {
+                        /* the first two bytes of the sub format GUID are the format code */
+                        mFormat = read_uint16(mChunk + 32);
+                    }
+                } else if (memcmp(mChunk, "data", 4) == 0) {
+                    mSamples = mChunk + 8;
+                    /* files written while recording may not have a valid data size */
+                    mLength = mChunkSize < mAvailable ? mChunkSize : mAvailable;
+                }
+                /* chunks are padded to an even size */
+                mPosition += 8 + mChunkSize + (mChunkSize & 1);
+            }
+            if (mSamples == nullptr || mChannels == 0 || mRate == 0) {
+                return false;
+            }
+            const uint8_t mBytes = static_cast<uint8_t>(mBits / 8);
+            const bool    mPCM   = mFormat == FORMAT_PCM && (mBits == 8 || mBits == 16 || mBits == 24 || mBits == 32);
+            const bool    mFloat = mFormat == FORMAT_FLOAT && (mBits == 32 || mBits == 64);
+            if (!mPCM && !mFloat) {
+                return false;
+            }
+
+            const size_t mNumSamples = mLength / mBytes / mChannels * mChannels;
+            samples.resize(mNumSamples);
+            for (size_t i = 0; i < mNumSamples; i++) {
+                const uint8_t* s = mSamples + i * mBytes;
+                if (mFloat) {
+                    if (mBits == 32) {
+                        const uint32_t mValue = read_uint32(s);
+                        float          mFloatValue;
+                        memcpy(&mFloatValue, &mValue, sizeof(mFloatValue));
+                        samples[i] = mFloatValue;
+                    } else {
+                        const uint64_t mValue = static_cast<uint64_t>(read_uint32(s)) | static_cast<uint64_t>(read_uint32(s + 4)) << 32;
+                        double         mDoubleValue;
+                        memcpy(&mDoubleValue, &mValue, sizeof(mDoubleValue));
+                        samples[i] = static_cast<float>(mDoubleValue);
+                    }
+                } else {
+                    switch (mBits) {
+                        case 8:
+                            /* 8 bit samples are unsigned */
+                            samples[i] = (static_cast<float>(s[0]) - 128.0f) / 128.0f;
+                            break;
+                        case 16:
+                            samples[i] = static_cast<float>(static_cast<int16_t>(read_uint16(s))) / 32768.0f;
+                            break;
+                        case 24:
+                            samples[i] = static_cast<float>(static_cast<int32_t>(static_cast<uint32_t>(s[0]) << 8 | static_cast<uint32_t>(s[1]) << 16 | static_cast<uint32_t>(s[2]) << 24) >> 8) / 8388608.0f;
+                            break;
+                        default:
+                            samples[i] = static_cast<float>(static_cast<int32_t>(read_uint32(s))) / 2147483648.0f;
+                            break;
+                    }
+                }
+            }
+            num_channels = mChannels;
+            sample_rate  = mRate;
+            return true;
+        }
+
+    private:
+        static constexpr uint16_t FORMAT_PCM        = 0x0001;
+        static constexpr uint16_t FORMAT_FLOAT      = 0x0003;
+        static constexpr uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+        static uint16_t read_uint16(const uint8_t* data) {
+            return static_cast<uint16_t>(data[0] | data[1] << 8);
+        }
+
+        static uint32_t read_uint32(const uint8_t* data) {
+            return static_cast<uint32_t>(data[0]) |
+                   static_cast<uint32_t>(data[1]) << 8 |
+                   static_cast<uint32_t>(data[2]) << 16 |
+                   static_cast<uint32_t>(data[3]) << 24;
+        }
+    };
+} // namespace klangwellen
@@ -21,10 +21,11 @@
  * PROCESSOR INTERFACE
  *
  * - [ ] float process()
- * - [ ] float process(float)
+ * - [x] float process(float)
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t)
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -32,6 +33,7 @@
 #include <stdint.h>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
 
 namespace klangwellen {
 
@@ -102,6 +104,12 @@ namespace klangwellen {
             }
         }
 
+        void process(AudioBuffer& buffer) {
+            for (uint8_t i = 0; i < buffer.num_channels(); i++) {
+                process(buffer.channel(i), buffer.num_frames());
+            }
+        }
+
         float process(float sample) {
             switch (fType) {
                 case ATAN:
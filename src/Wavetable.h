@@ -25,6 +25,7 @@
  * - [ ] void process(AudioSignal&)
  * - [x] void process(float*, uint32_t) *overwrite*
  * - [ ] void process(float*, float*, uint32_t)
+ * - [x] void process(AudioBuffer&)
  */
 
 #pragma once
@@ -34,6 +35,10 @@
 #include <algorithm>
 
 #include "KlangWellen.h"
+#include "AudioBuffer.h"
+#include "WavetableFill.h"
+#include "WavetableMipmap.h"
+#include "WavetableBank.h"
 
 #ifndef PI
 #define PI M_PI
@@ -50,6 +55,16 @@
 /**
  * plays back a chunk of samples ( i.e arbitrary, single-cycle waveform like sine, triangle, saw or square waves ) at
  * different frequencies and amplitudes.
+ * <p>
+ * a single table aliases when it contains harmonics above the nyquist frequency at the current playback frequency (
+ * e.g a sawtooth or square wave above a few hundred Hz ). with a `WavetableMipmap` set, the oscillator instead reads from
+ * a band-limited table chosen by the current step size.
+ * <p>
+ * tables and mipmaps of the built-in waveforms can be borrowed from the `WavetableBank`, so that any number of
+ * oscillators share the same memory.
+ * <p>
+ * by default the playback position is a float that is advanced by the step size. for wavetables with a power-of-two
+ * size the oscillator can instead use a 32-bit fixed-point phase accumulator ( see `set_phase_accumulator` ).
  */
 namespace klangwellen {
     class Wavetable {
@@ -58,92 +73,121 @@ namespace klangwellen {
             fDeleteWavetable = true;
         }
 
+        /**
+         * plays back a table shared via `WavetableBank`. the table is not copied unless `get_wavetable` is called.
+         */
+        Wavetable(WavetableBank::SharedWavetable wavetable, const uint32_t sampling_rate) : Wavetable(nullptr, wavetable.get_wavetable_size(), sampling_rate) {
+            mWavetable       = wavetable.get();
+            fSharedWavetable = std::move(wavetable);
+        }
+
         Wavetable(float* wavetable, const uint32_t wavetable_size, const uint32_t sampling_rate) : mWavetableSize(wavetable_size),
                                                                                                    mSamplingRate(sampling_rate),
                                                                                                    mFrequency(M_DEFAULT_FREQUENCY),
                                                                                                    fInterpolationType(KlangWellen::WAVESHAPE_INTERPOLATE_NONE) {
             mWavetable                = wavetable;
+            fWritableWavetable        = wavetable;
             fDeleteWavetable          = false;
             mArrayPtr                 = 0;
             mJitterRange              = 0.0f;
             mAmplitude                = M_DEFAULT_AMPLITUDE;
             mPhaseOffset              = 0.0f;
+            mPhaseOffsetPosition      = 0.0f;
             mDesiredAmplitude         = 0.0f;
             mDesiredAmplitudeFraction = 0.0f;
             mDesiredAmplitudeSteps    = 0;
-            set_frequency(M_DEFAULT_FREQUENCY);
+            fMipmap                   = nullptr;
+            fMipmapCrossfade          = true;
+            mMipmapLevel              = 0;
+            mMipmapFraction           = 0.0f;
+            fPhaseAccumulator         = false;
+            mPhase                    = 0;
+            mPhaseIncrement           = 0;
+            mPhaseOffsetFixed         = 0;
+            mPhaseShift               = 32 - log2_size(wavetable_size);
+            update_step_size();
         }
 
         ~Wavetable() {
             if (fDeleteWavetable) {
-                delete[] mWavetable;
+                delete[] fWritableWavetable;
             }
         }
 
+        /* the waveform fill routines live in `WavetableFill` */
         static void fill(float* wavetable, const uint32_t wavetable_size, const uint8_t waveform) {
-            switch (waveform) {
-                case KlangWellen::WAVEFORM_SINE:
-                    sine(wavetable, wavetable_size);
-                    break;
-                case KlangWellen::WAVEFORM_TRIANGLE:
-                    triangle(wavetable, wavetable_size);
-                    break;
-                case KlangWellen::WAVEFORM_SQUARE:
-                    square(wavetable, wavetable_size);
-                    break;
-                case KlangWellen::WAVEFORM_SAWTOOTH:
-                    sawtooth(wavetable, wavetable_size, false);
-                    break;
-                default:
-                    sine(wavetable, wavetable_size);
-            }
+            WavetableFill::fill(wavetable, wavetable_size, waveform);
         }
 
         static void pulse(float* wavetable, const uint32_t wavetable_size, const float pulse_width) {
-            const auto mThreshold = static_cast<uint32_t>(static_cast<float>(wavetable_size) * pulse_width);
-            for (uint32_t i = 0; i < wavetable_size; i++) {
-                if (i < mThreshold) {
-                    wavetable[i] = 1.0f;
-                } else {
-                    wavetable[i] = -1.0f;
-                }
-            }
+            WavetableFill::pulse(wavetable, wavetable_size, pulse_width);
         }
 
         static void sawtooth(float* wavetable, const uint32_t wavetable_size, const bool is_ramp_up = true) {
-            const float mSign = is_ramp_up ? -1.0f : 1.0f;
-            for (uint32_t i = 0; i < wavetable_size; i++) {
-                wavetable[i] = mSign * (2.0f * (static_cast<float>(i) / static_cast<float>(wavetable_size - 1)) - 1.0f);
-            }
+            WavetableFill::sawtooth(wavetable, wavetable_size, is_ramp_up);
         }
 
         static void sine(float* wavetable, const uint32_t wavetable_size) {
-            for (uint32_t i = 0; i < wavetable_size; i++) {
-                wavetable[i] = sin(2.0f * PIf * (static_cast<float>(i) / static_cast<float>(wavetable_size)));
-            }
+            WavetableFill::sine(wavetable, wavetable_size);
         }
 
         static void square(float* wavetable, const uint32_t wavetable_size) {
-            for (uint32_t i = 0; i < wavetable_size / 2; i++) {
-                wavetable[i]                      = 1.0f;
-                wavetable[i + wavetable_size / 2] = -1.0f;
-            }
+            WavetableFill::square(wavetable, wavetable_size);
         }
 
         static void triangle(float* wavetable, const uint32_t wavetable_size) {
-            const uint32_t q  = wavetable_size / 4;
-            const float    qf = static_cast<float>(wavetable_size) * 0.25f;
-            for (uint32_t i = 0; i < q; i++) {
-                wavetable[i] = static_cast<float>(i) / qf;
-                // noinspection PointlessArithmeticExpression
-                wavetable[i + (q * 1)] = (qf - static_cast<float>(i)) / qf;
-                wavetable[i + (q * 2)] = static_cast<float>(-i) / qf;
-                wavetable[i + (q * 3)] = -(qf - static_cast<float>(i)) / qf;
+            WavetableFill::triangle(wavetable, wavetable_size);
+        }
+
+        /**
+         * fills the wavetable with `waveform`. if the table is shared via `WavetableBank` the shared table for
+         * `waveform` is used instead.
+         */
+        void set_waveform(const uint8_t waveform) {
+            if (fSharedWavetable) {
+                fSharedWavetable = WavetableBank::acquire(waveform, mWavetableSize);
+                mWavetable       = fSharedWavetable.get();
+            } else {
+                fill(fWritableWavetable, mWavetableSize, waveform);
             }
         }
 
-        void set_waveform(const uint8_t waveform) const {
-            fill(mWavetable, mWavetableSize, waveform);
+        /**
+         * plays back the band-limited tables of `mipmap` instead of the wavetable. the mipmap must have the same size as
+         * the wavetable, otherwise it is ignored. the mipmap is not copied and must outlive the oscillator. passing
+         * `nullptr` plays back the wavetable again.
+         */
+        void set_mipmap(const WavetableMipmap* mipmap) {
+            fSharedMipmap.reset();
+            apply_mipmap(mipmap);
+        }
+
+        /**
+         * plays back a mipmap shared via `WavetableBank` ( see `WavetableBank::acquire_mipmap` ).
+         */
+        void set_mipmap(WavetableBank::SharedMipmap mipmap) {
+            const WavetableMipmap* mMipmap = mipmap.get();
+            fSharedMipmap                  = std::move(mipmap);
+            apply_mipmap(mMipmap);
+        }
+
+        const WavetableMipmap* get_mipmap() const {
+            return fMipmap;
+        }
+
+        /**
+         * if enabled ( default ) the oscillator crossfades between the band-limited level for the current frequency and
+         * the next one, so that harmonics fade out smoothly when the frequency rises. if disabled the oscillator picks
+         * a single level, which is slightly brighter but changes its brightness in steps of one octave. both modes are
+         * free of aliasing.
+         */
+        void set_mipmap_crossfade(const bool crossfade) {
+            fMipmapCrossfade = crossfade;
+            update_mipmap_level();
+        }
+
+        bool get_mipmap_crossfade() const {
+            return fMipmapCrossfade;
         }
 
         float get_frequency() const {
@@ -154,7 +198,7 @@ namespace klangwellen {
             const float mNewFrequency = fabs(frequency);
             if (mFrequency != mNewFrequency) {
                 mFrequency = mNewFrequency;
-                mStepSize  = computeStepSize();
+                update_step_size();
             }
         }
 
@@ -218,7 +262,26 @@ namespace klangwellen {
             }
         }
 
-        float* get_wavetable() const {
+        /**
+         * @return wavetable that can be modified. if the table is shared via `WavetableBank` the oscillator first makes
+         * a private copy of it.
+         */
+        float* get_wavetable() {
+            if (fSharedWavetable) {
+                fWritableWavetable = new float[mWavetableSize];
+                std::copy_n(mWavetable, mWavetableSize, fWritableWavetable);
+                mWavetable       = fWritableWavetable;
+                fDeleteWavetable = true;
+                fSharedWavetable.reset();
+            }
+            return fWritableWavetable;
+        }
+
+        /**
+         * @return wavetable that is currently played back, i.e the shared table if the table is shared via
+         * `WavetableBank`. does not copy the table.
+         */
+        const float* get_wavetable() const {
             return mWavetable;
         }
 
@@ -231,7 +294,33 @@ namespace klangwellen {
         }
 
         void set_phase_offset(const float phase_offset) {
-            mPhaseOffset = phase_offset < 0 ? 1 + phase_offset : phase_offset;
+            mPhaseOffset         = phase_offset < 0 ? 1 + phase_offset : phase_offset;
+            mPhaseOffsetFixed    = to_phase(mPhaseOffset);
+            mPhaseOffsetPosition = to_position(mPhaseOffset);
+        }
+
+        /**
+         * enables the fixed-point phase accumulator. the phase is an unsigned 32-bit integer where `2^32` equals one
+         * period of the wavetable. the upper bits address the table, the lower bits are the fraction used for
+         * interpolation. the phase wraps around by integer overflow, the increment is quantized to
+         * `sampling_rate / 2^32` Hz, which makes the oscillator exactly periodic without drift over arbitrarily long
+         * renderings. the phase offset is applied in all interpolation modes. if neither amplitude nor frequency are being
+         * interpolated, `process(float*, uint32_t)` runs a branch-free loop.
+         * <p>
+         * the phase accumulator requires a wavetable size that is a power of two, otherwise it is not enabled.
+         */
+        void set_phase_accumulator(const bool enable) {
+            const bool mEnable = enable && is_power_of_two(mWavetableSize);
+            if (mEnable && !fPhaseAccumulator) {
+                mPhase = to_phase(mArrayPtr / static_cast<float>(mWavetableSize));
+            } else if (!mEnable && fPhaseAccumulator) {
+                mArrayPtr = static_cast<float>(static_cast<double>(mPhase) * PHASE_TO_NORMALIZED * mWavetableSize);
+            }
+            fPhaseAccumulator = mEnable;
+        }
+
+        bool get_phase_accumulator() const {
+            return fPhaseAccumulator;
         }
 
         float get_jitter_range() const {
@@ -245,6 +334,7 @@ namespace klangwellen {
         void reset() {
             mSignal   = 0.0f;
             mArrayPtr = 0.0f;
+            mPhase    = 0;
         }
 
         float current() const {
@@ -297,57 +387,740 @@ namespace klangwellen {
                 }
             }
 
+            if (fPhaseAccumulator) {
+                mSignal = next_sample_phase_accumulator();
+            } else if (fMipmap != nullptr) {
+                mSignal = next_sample_mipmap();
+            } else {
+                mSignal = next_sample_wavetable();
+            }
+
+            mSignal *= mAmplitude;
+            mSignal += mOffset;
+            return mSignal;
+        }
+
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            if (mDesiredAmplitudeSteps == 0 && mDesiredFrequencySteps == 0) {
+#if KLANGWELLEN_SIMD_X86
+                /* the vectorized lookup of the modulated path is faster than the scalar loop */
+                if (interpolation_type() == KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR && BufferKernels::get_isa() >= BufferKernels::ISA_AVX2) {
+                    process(signal_buffer, nullptr, nullptr, nullptr, buffer_length);
+                    return;
+                }
+#endif
+                if (fPhaseAccumulator) {
+                    process_phase_accumulator(signal_buffer, buffer_length);
+                    return;
+                }
+            }
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] = process();
+            }
+        }
+
+        void process(AudioBuffer& buffer) {
+            if (buffer.num_channels() == 0) {
+                return;
+            }
+            process(buffer.channel(0), buffer.num_frames());
+            buffer.broadcast_channel(0);
+        }
+
+        /**
+         * processes a block with a frequency per sample ( audio-rate FM ).
+         *
+         * @param signal_buffer    output buffer
+         * @param frequency_buffer frequency in Hz for each sample
+         * @param buffer_length    number of samples
+         */
+        void process(float* signal_buffer, const float* frequency_buffer, const uint32_t buffer_length) {
+            process(signal_buffer, frequency_buffer, nullptr, nullptr, buffer_length);
+        }
+
+        /**
+         * processes a block with modulation inputs. each input may be `nullptr` in which case the stored value ( and
+         * its interpolation, see `set_frequency` and `set_amplitude` ) is used. the stored values are not changed by the
+         * modulation inputs.
+         * <p>
+         * the playback positions are computed in a first pass and the table lookups run in a second pass, which is
+         * vectorized for linear interpolation, so that a modulated oscillator costs about the same as a static one. with
+         * a mipmap the level is chosen per 64 samples by the highest frequency.
+         *
+         * @param signal_buffer       output buffer
+         * @param frequency_buffer    frequency in Hz for each sample ( audio-rate FM ). with the phase accumulator
+         *                            negative frequencies play the table backwards ( through-zero FM ).
+         * @param phase_offset_buffer phase offset in periods for each sample, added to the phase offset ( audio-rate PM )
+         * @param amplitude_buffer    amplitude for each sample, replaces the amplitude ( audio-rate AM )
+         * @param buffer_length       number of samples
+         */
+        void process(float*         signal_buffer,
+                     const float*   frequency_buffer,
+                     const float*   phase_offset_buffer,
+                     const float*   amplitude_buffer,
+                     const uint32_t buffer_length) {
+            float mFrequencies[MODULATION_CHUNK_SIZE];
+            float mAmplitudes[MODULATION_CHUNK_SIZE];
+            for (uint32_t mStart = 0; mStart < buffer_length; mStart += MODULATION_CHUNK_SIZE) {
+                const uint32_t mLength = std::min(MODULATION_CHUNK_SIZE, buffer_length - mStart);
+                const float*   mFrequency;
+                const float*   mAmplitude;
+                if (frequency_buffer != nullptr) {
+                    mFrequency = frequency_buffer + mStart;
+                } else if (fPhaseAccumulator && mDesiredFrequencySteps == 0) {
+                    /* use the stored phase increment and mipmap level */
+                    mFrequency = nullptr;
+                } else {
+                    fill_frequency(mFrequencies, mLength);
+                    mFrequency = mFrequencies;
+                }
+                if (amplitude_buffer != nullptr) {
+                    mAmplitude = amplitude_buffer + mStart;
+                } else {
+                    fill_amplitude(mAmplitudes, mLength);
+                    mAmplitude = mAmplitudes;
+                }
+                const float* mPhaseOffset = phase_offset_buffer != nullptr ? phase_offset_buffer + mStart : nullptr;
+                if (fPhaseAccumulator) {
+                    process_modulated_phase_accumulator(signal_buffer + mStart, mFrequency, mPhaseOffset, mAmplitude, mLength);
+                } else {
+                    process_modulated(signal_buffer + mStart, mFrequency, mPhaseOffset, mAmplitude, mLength);
+                }
+            }
+            if (buffer_length > 0) {
+                mSignal = signal_buffer[buffer_length - 1];
+            }
+        }
+
+    private:
+        static constexpr float         PIf                   = (float) PI;
+        static constexpr float         TWO_PIf               = (float) TWO_PI;
+        static constexpr float         M_DEFAULT_AMPLITUDE   = 0.75f;
+        static constexpr float         M_DEFAULT_FREQUENCY   = 220.0f;
+        static constexpr double        NORMALIZED_TO_PHASE   = 4294967296.0;
+        static constexpr double        PHASE_TO_NORMALIZED   = 1.0 / 4294967296.0;
+        static constexpr uint32_t      MODULATION_CHUNK_SIZE = 64;
+        const float*                   mWavetable;
+        float*                         fWritableWavetable;
+        WavetableBank::SharedWavetable fSharedWavetable;
+        WavetableBank::SharedMipmap    fSharedMipmap;
+        const uint32_t                 mWavetableSize;
+        const uint32_t                 mSamplingRate;
+        bool                           fDeleteWavetable;
+        float                          mAmplitude;
+        float                          mArrayPtr;
+        float                          mDesiredAmplitude;
+        float                          mDesiredAmplitudeFraction;
+        uint16_t                       mDesiredAmplitudeSteps;
+        float                          mDesiredFrequency{};
+        float                          mDesiredFrequencyFraction{};
+        uint16_t                       mDesiredFrequencySteps{};
+        float                          mFrequency;
+        float                          mJitterRange;
+        float                          mOffset{};
+        float                          mPhaseOffset;
+        float                          mPhaseOffsetPosition;
+        float                          mSignal{};
+        float                          mStepSize{};
+        uint8_t                        fInterpolationType;
+        const WavetableMipmap*         fMipmap;
+        bool                           fMipmapCrossfade;
+        uint8_t                        mMipmapLevel;
+        float                          mMipmapFraction;
+        bool                           fPhaseAccumulator;
+        uint32_t                       mPhase;
+        uint32_t                       mPhaseIncrement;
+        uint32_t                       mPhaseOffsetFixed;
+        uint8_t                        mPhaseShift;
+
+        void update_step_size() {
+            mStepSize       = computeStepSize();
+            mPhaseIncrement = to_phase(static_cast<double>(mFrequency) / static_cast<double>(mSamplingRate));
+            update_mipmap_level();
+        }
+
+        /* converts a normalized phase ( one period equals 1.0 ) into a fixed-point phase */
+        static uint32_t to_phase(const double normalized) {
+            const double mFraction = normalized - floor(normalized);
+            return static_cast<uint32_t>(static_cast<uint64_t>(mFraction * NORMALIZED_TO_PHASE + 0.5) & 0xFFFFFFFF);
+        }
+
+        static bool is_power_of_two(const uint32_t value) {
+            return value >= 2 && (value & (value - 1)) == 0;
+        }
+
+        static uint8_t log2_size(uint32_t value) {
+            uint8_t mBits = 0;
+            while (value > 1) {
+                value >>= 1;
+                mBits++;
+            }
+            return mBits;
+        }
+
+        uint8_t interpolation_type() const {
 #if KLANGWELLEN_WAVETABLE_INTERPOLATE_SAMPLES == 0
-            mSignal = next_sample();
+            return KlangWellen::WAVESHAPE_INTERPOLATE_NONE;
 #else
-            switch (fInterpolationType) {
+            return fInterpolationType;
+#endif // KLANGWELLEN_WAVETABLE_INTERPOLATE_SAMPLES
+        }
+
+        /* reads the sample at fixed-point phase `phase`. the table size must be a power of two */
+        template<uint8_t INTERPOLATION>
+        float read_phase(const float* wavetable, const uint32_t phase) const {
+            const uint32_t mMask  = mWavetableSize - 1;
+            const uint32_t mIndex = phase >> mPhaseShift;
+            if constexpr (INTERPOLATION == KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR) {
+                const float mFrac = static_cast<float>(phase & ((1u << mPhaseShift) - 1)) * fraction_scale();
+                const float a     = wavetable[mIndex];
+                const float b     = wavetable[(mIndex + 1) & mMask];
+                return a + mFrac * (b - a);
+            } else if constexpr (INTERPOLATION == KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC) {
+                const float frac   = static_cast<float>(phase & ((1u << mPhaseShift) - 1)) * fraction_scale();
+                const float a      = wavetable[(mIndex - 1) & mMask];
+                const float b      = wavetable[mIndex];
+                const float c      = wavetable[(mIndex + 1) & mMask];
+                const float d      = wavetable[(mIndex + 2) & mMask];
+                const float tmp    = d + 3.0f * b;
+                const float fracsq = frac * frac;
+                const float fracb  = frac * fracsq;
+                return fracb * (-a - 3.f * c + tmp) / 6.f + fracsq * ((a + c) / 2.f - b) + frac * (c + (-2.f * a - tmp) / 6.f) + b;
+            } else {
+                return wavetable[mIndex];
+            }
+        }
+
+        float read_phase(const float* wavetable, const uint32_t phase) const {
+            switch (interpolation_type()) {
                 case KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR:
-                    mSignal = next_sample_interpolate_linear();
+                    return read_phase<KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR>(wavetable, phase);
+                case KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC:
+                    return read_phase<KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC>(wavetable, phase);
+                default:
+                    return read_phase<KlangWellen::WAVESHAPE_INTERPOLATE_NONE>(wavetable, phase);
+            }
+        }
+
+        float fraction_scale() const {
+            return 1.0f / static_cast<float>(1u << mPhaseShift);
+        }
+
+        float next_sample_phase_accumulator() {
+            const uint32_t mPhaseOffsetted = mPhase + mPhaseOffsetFixed;
+            float          mOutput;
+            if (fMipmap != nullptr) {
+                mOutput = read_phase(fMipmap->get_level(mMipmapLevel), mPhaseOffsetted);
+                if (mMipmapFraction > 0.0f) {
+                    const float b = read_phase(fMipmap->get_level(mMipmapLevel + 1), mPhaseOffsetted);
+                    mOutput += mMipmapFraction * (b - mOutput);
+                }
+            } else {
+                mOutput = read_phase(mWavetable, mPhaseOffsetted);
+            }
+            mPhase += mPhaseIncrement;
+            return mOutput;
+        }
+
+        void process_phase_accumulator(float* signal_buffer, const uint32_t buffer_length) {
+            if (buffer_length == 0) {
+                return;
+            }
+            const float* mTable = mWavetable;
+            const float* mNext  = nullptr;
+            if (fMipmap != nullptr) {
+                mTable = fMipmap->get_level(mMipmapLevel);
+                if (mMipmapFraction > 0.0f) {
+                    mNext = fMipmap->get_level(mMipmapLevel + 1);
+                }
+            }
+            switch (interpolation_type()) {
+                case KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR:
+                    render_phase_accumulator<KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR>(signal_buffer, buffer_length, mTable, mNext);
                     break;
                 case KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC:
-                    mSignal = next_sample_interpolate_cubic();
+                    render_phase_accumulator<KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC>(signal_buffer, buffer_length, mTable, mNext);
                     break;
                 default:
-                    mSignal = next_sample();
+                    render_phase_accumulator<KlangWellen::WAVESHAPE_INTERPOLATE_NONE>(signal_buffer, buffer_length, mTable, mNext);
                     break;
             }
+            mSignal = signal_buffer[buffer_length - 1];
+        }
+
+        template<uint8_t INTERPOLATION>
+        void render_phase_accumulator(float* signal_buffer, const uint32_t buffer_length, const float* wavetable, const float* next) {
+            const uint32_t mIncrement   = mPhaseIncrement;
+            const uint32_t mOffsetPhase = mPhaseOffsetFixed;
+            const float    mAmp         = mAmplitude;
+            const float    mDC          = mOffset;
+            uint32_t       mPhaseLocal  = mPhase;
+            if (next == nullptr) {
+                for (uint32_t i = 0; i < buffer_length; i++) {
+                    signal_buffer[i] = read_phase<INTERPOLATION>(wavetable, mPhaseLocal + mOffsetPhase) * mAmp + mDC;
+                    mPhaseLocal += mIncrement;
+                }
+            } else {
+                const float mFade = mMipmapFraction;
+                for (uint32_t i = 0; i < buffer_length; i++) {
+                    const float a    = read_phase<INTERPOLATION>(wavetable, mPhaseLocal + mOffsetPhase);
+                    const float b    = read_phase<INTERPOLATION>(next, mPhaseLocal + mOffsetPhase);
+                    signal_buffer[i] = (a + mFade * (b - a)) * mAmp + mDC;
+                    mPhaseLocal += mIncrement;
+                }
+            }
+            mPhase = mPhaseLocal;
+        }
+
+        void apply_mipmap(const WavetableMipmap* mipmap) {
+            fMipmap = (mipmap != nullptr && mipmap->get_wavetable_size() == mWavetableSize) ? mipmap : nullptr;
+            update_mipmap_level();
+        }
+
+        float next_sample_wavetable() {
+            const float mOutput = read_sample(mWavetable);
+            advance_array_ptr();
+            return mOutput;
+        }
+
+        /* reads from the mipmap level for the current step size and crossfades with the next level */
+        float next_sample_mipmap() {
+            const float* mLower = fMipmap->get_level(mMipmapLevel);
+            float        mOutput;
+#if KLANGWELLEN_WAVETABLE_INTERPOLATE_SAMPLES != 0
+            if (mMipmapFraction > 0.0f && fInterpolationType == KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR) {
+                /* the common case: both levels are read at the same position */
+                const float*   mUpper    = fMipmap->get_level(mMipmapLevel + 1);
+                const float    mPosition = offset_position();
+                const uint32_t p0        = static_cast<uint32_t>(mPosition);
+                const uint32_t p1        = p0 + 1 >= mWavetableSize ? 0 : p0 + 1;
+                const float    mFrac     = mPosition - static_cast<float>(p0);
+                const float    a         = mLower[p0] + mMipmapFraction * (mUpper[p0] - mLower[p0]);
+                const float    b         = mLower[p1] + mMipmapFraction * (mUpper[p1] - mLower[p1]);
+                mOutput                  = a + mFrac * (b - a);
+            } else
 #endif // KLANGWELLEN_WAVETABLE_INTERPOLATE_SAMPLES
+            if (mMipmapFraction > 0.0f) {
+                const float a = read_sample(mLower);
+                const float b = read_sample(fMipmap->get_level(mMipmapLevel + 1));
+                mOutput       = a + mMipmapFraction * (b - a);
+            } else {
+                mOutput = read_sample(mLower);
+            }
+            advance_array_ptr();
+            return mOutput;
+        }
 
-            mSignal *= mAmplitude;
-            mSignal += mOffset;
-            return mSignal;
+        /* reads the sample at the playback position plus the phase offset */
+        float read_sample(const float* wavetable) const {
+            return read_position(wavetable, offset_position());
         }
 
-        void process(float* signal_buffer, const uint32_t buffer_length) {
-            for (uint16_t i = 0; i < buffer_length; i++) {
-                signal_buffer[i] = process();
+        /* reads the sample at float position `position` in [0, size) */
+        template<uint8_t INTERPOLATION>
+        float read_position(const float* wavetable, const float position) const {
+            const uint32_t mIndex = static_cast<uint32_t>(position);
+            if constexpr (INTERPOLATION == KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR) {
+                const float    mFrac = position - static_cast<float>(mIndex);
+                const float    a     = wavetable[mIndex];
+                const uint32_t p1    = mIndex + 1;
+                const float    b     = wavetable[p1 >= mWavetableSize ? p1 - mWavetableSize : p1];
+                return a + mFrac * (b - a);
+            } else if constexpr (INTERPOLATION == KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC) {
+                const float    frac   = position - static_cast<float>(mIndex);
+                const float    a      = mIndex > 0 ? wavetable[mIndex - 1] : wavetable[mWavetableSize - 1];
+                const float    b      = wavetable[mIndex];
+                const uint32_t p1     = mIndex + 1;
+                const float    c      = wavetable[p1 >= mWavetableSize ? p1 - mWavetableSize : p1];
+                const uint32_t p2     = mIndex + 2;
+                const float    d      = wavetable[p2 >= mWavetableSize ? p2 - mWavetableSize : p2];
+                const float    tmp    = d + 3.0f * b;
+                const float    fracsq = frac * frac;
+                const float    fracb  = frac * fracsq;
+                return fracb * (-a - 3.f * c + tmp) / 6.f + fracsq * ((a + c) / 2.f - b) + frac * (c + (-2.f * a - tmp) / 6.f) + b;
+            } else {
+                return wavetable[mIndex];
             }
         }
 
-    private:
-        static constexpr float PIf                 = (float) PI;
-        static constexpr float TWO_PIf             = (float) TWO_PI;
-        static constexpr float M_DEFAULT_AMPLITUDE = 0.75f;
-        static constexpr float M_DEFAULT_FREQUENCY = 220.0f;
-        float*                 mWavetable;
-        const uint32_t         mWavetableSize;
-        const uint32_t         mSamplingRate;
-        bool                   fDeleteWavetable;
-        float                  mAmplitude;
-        float                  mArrayPtr;
-        float                  mDesiredAmplitude;
-        float                  mDesiredAmplitudeFraction;
-        uint16_t               mDesiredAmplitudeSteps;
-        float                  mDesiredFrequency{};
-        float                  mDesiredFrequencyFraction{};
-        uint16_t               mDesiredFrequencySteps{};
-        float                  mFrequency;
-        float                  mJitterRange;
-        float                  mOffset{};
-        float                  mPhaseOffset;
-        float                  mSignal{};
-        float                  mStepSize{};
-        uint8_t                fInterpolationType;
+        float read_position(const float* wavetable, const float position) const {
+            switch (interpolation_type()) {
+                case KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR:
+                    return read_position<KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR>(wavetable, position);
+                case KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC:
+                    return read_position<KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC>(wavetable, position);
+                default:
+                    return read_position<KlangWellen::WAVESHAPE_INTERPOLATE_NONE>(wavetable, position);
+            }
+        }
+
+        /* converts a normalized phase ( one period equals 1.0 ) into a position in samples in [0, size) */
+        float to_position(const float normalized) const {
+            /* `floorf` is a library call without SSE4.1, truncating and correcting negative values is not */
+            float mFraction = normalized - static_cast<float>(static_cast<int32_t>(normalized));
+            mFraction       = mFraction < 0.0f ? mFraction + 1.0f : mFraction;
+            return wrap_position(mFraction * static_cast<float>(mWavetableSize));
+        }
+
+        /* wraps a position in [0, 2 * size) into [0, size), also if the sum of two positions rounds up to the size */
+        float wrap_position(const float position) const {
+            const float mSize     = static_cast<float>(mWavetableSize);
+            const float mPosition = position >= mSize ? position - mSize : position;
+            return mPosition < mSize ? mPosition : 0.0f;
+        }
+
+        float offset_position() const {
+            return wrap_position(mArrayPtr + mPhaseOffsetPosition);
+        }
+
+        /*
+         * level `k` is free of aliasing for step sizes up to `2^k`, i.e the oscillator uses level `ceil(log2(step))`.
+         * with crossfading it blends towards the next level over the octave, which reaches the next level exactly where
+         * the following octave starts.
+         */
+        void update_mipmap_level() {
+            if (fMipmap == nullptr) {
+                return;
+            }
+            select_mipmap_level(mStepSize, mMipmapLevel, mMipmapFraction);
+        }
+
+        void select_mipmap_level(const float step_size, uint8_t& level, float& fraction) const {
+            const uint8_t mMaxLevel = fMipmap->get_num_levels() - 1;
+            level                   = 0;
+            fraction                = 0.0f;
+            if (step_size <= 1.0f) {
+                return;
+            }
+            const float mOctave = log2f(step_size);
+            const float mLevel  = ceilf(mOctave);
+            if (mLevel >= mMaxLevel) {
+                level = mMaxLevel;
+                return;
+            }
+            level = static_cast<uint8_t>(mLevel);
+            if (fMipmapCrossfade) {
+                fraction = mOctave - (mLevel - 1.0f);
+            }
+        }
+
+        /* advances the frequency interpolation in the same way as `process()` and writes the frequencies */
+        void fill_frequency(float* frequency, const uint32_t length) {
+            if (mDesiredFrequencySteps == 0) {
+                std::fill_n(frequency, length, mFrequency);
+                return;
+            }
+            for (uint32_t i = 0; i < length; i++) {
+                if (mDesiredFrequencySteps > 0) {
+                    mDesiredFrequencySteps--;
+                    set_frequency(mDesiredFrequencySteps == 0 ? mDesiredFrequency : mFrequency + mDesiredFrequencyFraction);
+                }
+                frequency[i] = mFrequency;
+            }
+        }
+
+        /* advances the amplitude interpolation in the same way as `process()` and writes the amplitudes */
+        void fill_amplitude(float* amplitude, const uint32_t length) {
+            if (mDesiredAmplitudeSteps == 0) {
+                std::fill_n(amplitude, length, mAmplitude);
+                return;
+            }
+            for (uint32_t i = 0; i < length; i++) {
+                if (mDesiredAmplitudeSteps > 0) {
+                    mDesiredAmplitudeSteps--;
+                    if (mDesiredAmplitudeSteps == 0) {
+                        mAmplitude = mDesiredAmplitude;
+                    } else {
+                        mAmplitude += mDesiredAmplitudeFraction;
+                    }
+                }
+                amplitude[i] = mAmplitude;
+            }
+        }
+
+        /* step size of the highest frequency of a chunk, used to select the mipmap level */
+        float max_step_size(const float* frequency, const uint32_t length) const {
+            float mMax = 0.0f;
+            for (uint32_t i = 0; i < length; i++) {
+                mMax = std::max(mMax, std::fabs(frequency[i]));
+            }
+            return mMax * (static_cast<float>(mWavetableSize) / static_cast<float>(mSamplingRate));
+        }
+
+        void select_modulated_mipmap(const float* frequency, const uint32_t length, const float*& table, const float*& next, float& fade) const {
+            table = mWavetable;
+            next  = nullptr;
+            fade  = 0.0f;
+            if (fMipmap == nullptr) {
+                return;
+            }
+            uint8_t mLevel;
+            select_mipmap_level(max_step_size(frequency, length), mLevel, fade);
+            table = fMipmap->get_level(mLevel);
+            if (fade > 0.0f) {
+                next = fMipmap->get_level(mLevel + 1);
+            }
+        }
+
+        /*
+         * float playback position: the first pass advances the playback position and computes the position of each
+         * sample including the phase offset, the second pass reads the table at these positions.
+         */
+        void process_modulated(float* signal_buffer, const float* frequency, const float* phase_offset, const float* amplitude, const uint32_t length) {
+            float       mPositions[MODULATION_CHUNK_SIZE];
+            const float mSize      = static_cast<float>(mWavetableSize);
+            const float mStepPerHz = mSize / static_cast<float>(mSamplingRate);
+            float       mPosition  = mArrayPtr;
+            for (uint32_t i = 0; i < length; i++) {
+                mPositions[i] = mPosition;
+                mPosition += frequency[i] * mStepPerHz;
+                while (mPosition >= mSize) {
+                    mPosition -= mSize;
+                }
+                while (mPosition < 0) {
+                    mPosition += mSize;
+                }
+            }
+            mArrayPtr = mPosition;
+            /* the phase offsets do not depend on the previous sample */
+            if (phase_offset != nullptr) {
+#if KLANGWELLEN_SIMD_X86
+                if (BufferKernels::get_isa() >= BufferKernels::ISA_AVX2) {
+                    add_phase_offsets_avx2(mPositions, phase_offset, length);
+                } else
+#endif
+                {
+                    add_phase_offsets(mPositions, phase_offset, 0, length);
+                }
+            } else {
+                for (uint32_t i = 0; i < length; i++) {
+                    mPositions[i] = wrap_position(mPositions[i] + mPhaseOffsetPosition);
+                }
+            }
+
+            const float* mTable;
+            const float* mNext;
+            float        mFade;
+            select_modulated_mipmap(frequency, length, mTable, mNext, mFade);
+            switch (interpolation_type()) {
+                case KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR:
+#if KLANGWELLEN_SIMD_X86
+                    if (BufferKernels::get_isa() >= BufferKernels::ISA_AVX2) {
+                        render_positions_linear_avx2(signal_buffer, mPositions, amplitude, length, mTable, mNext, mFade);
+                        break;
+                    }
+#endif
+                    render_positions<KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR>(signal_buffer, mPositions, amplitude, 0, length, mTable, mNext, mFade);
+                    break;
+                case KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC:
+                    render_positions<KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC>(signal_buffer, mPositions, amplitude, 0, length, mTable, mNext, mFade);
+                    break;
+                default:
+                    render_positions<KlangWellen::WAVESHAPE_INTERPOLATE_NONE>(signal_buffer, mPositions, amplitude, 0, length, mTable, mNext, mFade);
+                    break;
+            }
+        }
+
+        void add_phase_offsets(float* positions, const float* phase_offset, const uint32_t start, const uint32_t end) const {
+            for (uint32_t i = start; i < end; i++) {
+                positions[i] = wrap_position(positions[i] + to_position(mPhaseOffset + phase_offset[i]));
+            }
+        }
+
+        template<uint8_t INTERPOLATION>
+        void render_positions(float* signal_buffer, const float* positions, const float* amplitude, const uint32_t start, const uint32_t end, const float* wavetable, const float* next, const float fade) const {
+            if (next == nullptr) {
+                for (uint32_t i = start; i < end; i++) {
+                    signal_buffer[i] = read_position<INTERPOLATION>(wavetable, positions[i]) * amplitude[i] + mOffset;
+                }
+            } else {
+                for (uint32_t i = start; i < end; i++) {
+                    const float a    = read_position<INTERPOLATION>(wavetable, positions[i]);
+                    const float b    = read_position<INTERPOLATION>(next, positions[i]);
+                    signal_buffer[i] = (a + fade * (b - a)) * amplitude[i] + mOffset;
+                }
+            }
+        }
+
+        /*
+         * phase accumulator: the first pass computes the phase of each sample ( a prefix sum of the increments ), the
+         * second pass reads the table at these phases.
+         */
+        void process_modulated_phase_accumulator(float* signal_buffer, const float* frequency, const float* phase_offset, const float* amplitude, const uint32_t length) {
+            uint32_t     mPhases[MODULATION_CHUNK_SIZE];
+            const double mHzToPhase = NORMALIZED_TO_PHASE / static_cast<double>(mSamplingRate);
+            uint32_t     mCurrent   = mPhase;
+            if (frequency == nullptr) {
+                for (uint32_t i = 0; i < length; i++) {
+                    const int64_t mModulation = phase_offset != nullptr ? static_cast<int64_t>(static_cast<double>(phase_offset[i]) * NORMALIZED_TO_PHASE) : 0;
+                    mPhases[i]                = mCurrent + mPhaseOffsetFixed + static_cast<uint32_t>(mModulation);
+                    mCurrent += mPhaseIncrement;
+                }
+            } else if (phase_offset != nullptr) {
+                for (uint32_t i = 0; i < length; i++) {
+                    const int64_t mModulation = static_cast<int64_t>(static_cast<double>(phase_offset[i]) * NORMALIZED_TO_PHASE);
+                    mPhases[i]                = mCurrent + mPhaseOffsetFixed + static_cast<uint32_t>(mModulation);
+                    mCurrent += static_cast<uint32_t>(static_cast<int64_t>(static_cast<double>(frequency[i]) * mHzToPhase));
+                }
+            } else {
+                for (uint32_t i = 0; i < length; i++) {
+                    mPhases[i] = mCurrent + mPhaseOffsetFixed;
+                    mCurrent += static_cast<uint32_t>(static_cast<int64_t>(static_cast<double>(frequency[i]) * mHzToPhase));
+                }
+            }
+            mPhase = mCurrent;
+
+            const float* mTable;
+            const float* mNext;
+            float        mFade;
+            if (frequency != nullptr) {
+                select_modulated_mipmap(frequency, length, mTable, mNext, mFade);
+            } else {
+                mTable = fMipmap != nullptr ? fMipmap->get_level(mMipmapLevel) : mWavetable;
+                mNext  = fMipmap != nullptr && mMipmapFraction > 0.0f ? fMipmap->get_level(mMipmapLevel + 1) : nullptr;
+                mFade  = mMipmapFraction;
+            }
+            switch (interpolation_type()) {
+                case KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR:
+#if KLANGWELLEN_SIMD_X86
+                    if (BufferKernels::get_isa() == BufferKernels::ISA_AVX512) {
+                        render_phases_linear_avx512(signal_buffer, mPhases, amplitude, length, mTable, mNext, mFade);
+                        break;
+                    }
+                    if (BufferKernels::get_isa() == BufferKernels::ISA_AVX2) {
+                        render_phases_linear_avx2(signal_buffer, mPhases, amplitude, length, mTable, mNext, mFade);
+                        break;
+                    }
+#endif
+                    render_phases<KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR>(signal_buffer, mPhases, amplitude, 0, length, mTable, mNext, mFade);
+                    break;
+                case KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC:
+                    render_phases<KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC>(signal_buffer, mPhases, amplitude, 0, length, mTable, mNext, mFade);
+                    break;
+                default:
+                    render_phases<KlangWellen::WAVESHAPE_INTERPOLATE_NONE>(signal_buffer, mPhases, amplitude, 0, length, mTable, mNext, mFade);
+                    break;
+            }
+        }
+
+        template<uint8_t INTERPOLATION>
+        void render_phases(float* signal_buffer, const uint32_t* phases, const float* amplitude, const uint32_t start, const uint32_t end, const float* wavetable, const float* next, const float fade) const {
+            if (next == nullptr) {
+                for (uint32_t i = start; i < end; i++) {
+                    signal_buffer[i] = read_phase<INTERPOLATION>(wavetable, phases[i]) * amplitude[i] + mOffset;
+                }
+            } else {
+                for (uint32_t i = start; i < end; i++) {
+                    const float a    = read_phase<INTERPOLATION>(wavetable, phases[i]);
+                    const float b    = read_phase<INTERPOLATION>(next, phases[i]);
+                    signal_buffer[i] = (a + fade * (b - a)) * amplitude[i] + mOffset;
+                }
+            }
+        }
+
+#if KLANGWELLEN_SIMD_X86
+        KLANGWELLEN_TARGET_AVX2
+        void add_phase_offsets_avx2(float* positions, const float* phase_offset, const uint32_t length) const {
+            const __m256 mPhaseOffsetBase = _mm256_set1_ps(mPhaseOffset);
+            const __m256 mSize            = _mm256_set1_ps(static_cast<float>(mWavetableSize));
+            uint32_t     i                = 0;
+            for (; i + 8 <= length; i += 8) {
+                const __m256 mNormalized = _mm256_add_ps(mPhaseOffsetBase, _mm256_loadu_ps(phase_offset + i));
+                const __m256 mFraction   = _mm256_sub_ps(mNormalized, _mm256_floor_ps(mNormalized));
+                __m256       mPosition   = _mm256_fmadd_ps(mFraction, mSize, _mm256_loadu_ps(positions + i));
+                /* same as `wrap_position` */
+                mPosition = _mm256_sub_ps(mPosition, _mm256_and_ps(_mm256_cmp_ps(mPosition, mSize, _CMP_GE_OQ), mSize));
+                mPosition = _mm256_andnot_ps(_mm256_cmp_ps(mPosition, mSize, _CMP_GE_OQ), mPosition);
+                _mm256_storeu_ps(positions + i, mPosition);
+            }
+            add_phase_offsets(positions, phase_offset, i, length);
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        void render_positions_linear_avx2(float* signal_buffer, const float* positions, const float* amplitude, const uint32_t length, const float* wavetable, const float* next, const float fade) const {
+            const __m256i mSize = _mm256_set1_epi32(static_cast<int>(mWavetableSize));
+            const __m256i mOne  = _mm256_set1_epi32(1);
+            const __m256  mFade = _mm256_set1_ps(fade);
+            const __m256  mDC   = _mm256_set1_ps(mOffset);
+            uint32_t      i     = 0;
+            for (; i + 8 <= length; i += 8) {
+                const __m256  mPosition = _mm256_loadu_ps(positions + i);
+                const __m256i mIndex    = _mm256_cvttps_epi32(mPosition);
+                const __m256i mNextRaw  = _mm256_add_epi32(mIndex, mOne);
+                const __m256i mIndex1   = _mm256_andnot_si256(_mm256_cmpeq_epi32(mNextRaw, mSize), mNextRaw);
+                const __m256  mFrac     = _mm256_sub_ps(mPosition, _mm256_cvtepi32_ps(mIndex));
+                const __m256  a         = _mm256_i32gather_ps(wavetable, mIndex, 4);
+                const __m256  b         = _mm256_i32gather_ps(wavetable, mIndex1, 4);
+                __m256        mSample   = _mm256_fmadd_ps(mFrac, _mm256_sub_ps(b, a), a);
+                if (next != nullptr) {
+                    const __m256 c     = _mm256_i32gather_ps(next, mIndex, 4);
+                    const __m256 d     = _mm256_i32gather_ps(next, mIndex1, 4);
+                    const __m256 mNext = _mm256_fmadd_ps(mFrac, _mm256_sub_ps(d, c), c);
+                    mSample            = _mm256_fmadd_ps(mFade, _mm256_sub_ps(mNext, mSample), mSample);
+                }
+                _mm256_storeu_ps(signal_buffer + i, _mm256_fmadd_ps(mSample, _mm256_loadu_ps(amplitude + i), mDC));
+            }
+            render_positions<KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR>(signal_buffer, positions, amplitude, i, length, wavetable, next, fade);
+        }
+
+        KLANGWELLEN_TARGET_AVX2
+        void render_phases_linear_avx2(float* signal_buffer, const uint32_t* phases, const float* amplitude, const uint32_t length, const float* wavetable, const float* next, const float fade) const {
+            const __m256i mMask          = _mm256_set1_epi32(static_cast<int>(mWavetableSize - 1));
+            const __m256i mFractionMask  = _mm256_set1_epi32(static_cast<int>((1u << mPhaseShift) - 1));
+            const __m256  mFractionScale = _mm256_set1_ps(fraction_scale());
+            const __m128i mShift         = _mm_cvtsi32_si128(mPhaseShift);
+            const __m256i mOne           = _mm256_set1_epi32(1);
+            const __m256  mFade          = _mm256_set1_ps(fade);
+            const __m256  mDC            = _mm256_set1_ps(mOffset);
+            uint32_t      i              = 0;
+            for (; i + 8 <= length; i += 8) {
+                const __m256i mPhase  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(phases + i));
+                const __m256i mIndex  = _mm256_srl_epi32(mPhase, mShift);
+                const __m256i mIndex1 = _mm256_and_si256(_mm256_add_epi32(mIndex, mOne), mMask);
+                const __m256  mFrac   = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(mPhase, mFractionMask)), mFractionScale);
+                const __m256  a       = _mm256_i32gather_ps(wavetable, mIndex, 4);
+                const __m256  b       = _mm256_i32gather_ps(wavetable, mIndex1, 4);
+                __m256        mSample = _mm256_fmadd_ps(mFrac, _mm256_sub_ps(b, a), a);
+                if (next != nullptr) {
+                    const __m256 c     = _mm256_i32gather_ps(next, mIndex, 4);
+                    const __m256 d     = _mm256_i32gather_ps(next, mIndex1, 4);
+                    const __m256 mNext = _mm256_fmadd_ps(mFrac, _mm256_sub_ps(d, c), c);
+                    mSample            = _mm256_fmadd_ps(mFade, _mm256_sub_ps(mNext, mSample), mSample);
+                }
+                _mm256_storeu_ps(signal_buffer + i, _mm256_fmadd_ps(mSample, _mm256_loadu_ps(amplitude + i), mDC));
+            }
+            render_phases<KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR>(signal_buffer, phases, amplitude, i, length, wavetable, next, fade);
+        }
+
+        KLANGWELLEN_TARGET_AVX512
+        void render_phases_linear_avx512(float* signal_buffer, const uint32_t* phases, const float* amplitude, const uint32_t length, const float* wavetable, const float* next, const float fade) const {
+            const __m512i mMask          = _mm512_set1_epi32(static_cast<int>(mWavetableSize - 1));
+            const __m512i mFractionMask  = _mm512_set1_epi32(static_cast<int>((1u << mPhaseShift) - 1));
+            const __m512  mFractionScale = _mm512_set1_ps(fraction_scale());
+            const __m128i mShift         = _mm_cvtsi32_si128(mPhaseShift);
+            const __m512i mOne           = _mm512_set1_epi32(1);
+            const __m512  mFade          = _mm512_set1_ps(fade);
+            const __m512  mDC            = _mm512_set1_ps(mOffset);
+            uint32_t      i              = 0;
+            for (; i + 16 <= length; i += 16) {
+                const __m512i mPhase  = _mm512_loadu_si512(phases + i);
+                const __m512i mIndex  = _mm512_srl_epi32(mPhase, mShift);
+                const __m512i mIndex1 = _mm512_and_si512(_mm512_add_epi32(mIndex, mOne), mMask);
+                const __m512  mFrac   = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(mPhase, mFractionMask)), mFractionScale);
+                const __m512  a       = _mm512_i32gather_ps(mIndex, wavetable, 4);
+                const __m512  b       = _mm512_i32gather_ps(mIndex1, wavetable, 4);
+                __m512        mSample = _mm512_fmadd_ps(mFrac, _mm512_sub_ps(b, a), a);
+                if (next != nullptr) {
+                    const __m512 c     = _mm512_i32gather_ps(mIndex, next, 4);
+                    const __m512 d     = _mm512_i32gather_ps(mIndex1, next, 4);
+                    const __m512 mNext = _mm512_fmadd_ps(mFrac, _mm512_sub_ps(d, c), c);
+                    mSample            = _mm512_fmadd_ps(mFade, _mm512_sub_ps(mNext, mSample), mSample);
+                }
+                _mm512_storeu_ps(signal_buffer + i, _mm512_fmadd_ps(mSample, _mm512_loadu_ps(amplitude + i), mDC));
+            }
+            render_phases<KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR>(signal_buffer, phases, amplitude, i, length, wavetable, next, fade);
+        }
+#endif
 
         void advance_array_ptr() {
             // mArrayPtr += mStepSize * (mEnableJitter ? (klangwellen::KlangWellen::random() * mJitterRange + 1.0f) : 1.0f);
@@ -364,43 +1137,5 @@ namespace klangwellen {
         float computeStepSize() const {
             return mFrequency * (static_cast<float>(mWavetableSize) / static_cast<float>(mSamplingRate));
         }
-
-        float next_sample() {
-            const float mOutput = mWavetable[static_cast<int>(mArrayPtr)];
-            advance_array_ptr();
-            return mOutput;
-        }
-
-        float next_sample_interpolate_cubic() {
-            const uint32_t mSampleOffset   = static_cast<int>(mPhaseOffset * mWavetableSize) % mWavetableSize;
-            const float    mArrayPtrOffset = mArrayPtr + mSampleOffset;
-            /* cubic interpolation */
-            const float    frac    = mArrayPtrOffset - static_cast<int>(mArrayPtrOffset);
-            const float    a       = static_cast<int>(mArrayPtrOffset) > 0 ? mWavetable[static_cast<int>(mArrayPtrOffset) - 1] : mWavetable[mWavetableSize - 1];
-            const float    b       = mWavetable[static_cast<int>(mArrayPtrOffset) % mWavetableSize];
-            const uint32_t p1      = static_cast<uint32_t>(mArrayPtrOffset) + 1;
-            const float    c       = mWavetable[p1 >= mWavetableSize ? p1 - mWavetableSize : p1];
-            const uint32_t p2      = static_cast<uint32_t>(mArrayPtrOffset) + 2;
-            const float    d       = mWavetable[p2 >= mWavetableSize ? p2 - mWavetableSize : p2];
-            const float    tmp     = d + 3.0f * b;
-            const float    fracsq  = frac * frac;
-            const float    fracb   = frac * fracsq;
-            const float    mOutput = (fracb * (-a - 3.f * c + tmp) / 6.f + fracsq * ((a + c) / 2.f - b) + frac * (c + (-2.f * a - tmp) / 6.f) + b);
-            advance_array_ptr();
-            return mOutput;
-        }
-
-        float next_sample_interpolate_linear() {
-            const uint32_t mSampleOffset   = static_cast<uint32_t>(mPhaseOffset * mWavetableSize) % mWavetableSize;
-            const float    mArrayPtrOffset = mArrayPtr + mSampleOffset;
-            /* linear interpolation */
-            const float    mFrac   = mArrayPtrOffset - static_cast<int>(mArrayPtrOffset);
-            const float    a       = mWavetable[static_cast<int>(mArrayPtrOffset)];
-            const uint32_t p1      = static_cast<uint32_t>(mArrayPtrOffset) + 1;
-            const float    b       = mWavetable[p1 >= mWavetableSize ? p1 - mWavetableSize : p1];
-            const float    mOutput = a + mFrac * (b - a);
-            advance_array_ptr();
-            return mOutput;
-        }
     };
-}
\ No newline at end of file
+}
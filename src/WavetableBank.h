@@ -0,0 +1,294 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <type_traits>
+#include <vector>
+
+#if !defined(ARDUINO)
+#include <atomic>
+#include <mutex>
+#endif
+
+#include "KlangWellen.h"
+#include "WavetableFill.h"
+#include "WavetableMipmap.h"
+
+namespace klangwellen {
+    /**
+     * process-wide collection of immutable wavetables and wavetable mipmaps, keyed by waveform and size.
+     * <p>
+     * `acquire` returns a reference-counted handle to a table. the first request for a waveform and size creates the
+     * table, all further requests share it, and the table is freed when the last handle is released. this makes memory
+     * use and the cost of creating a voice independent of the number of voices, e.g:
+     * <p>
+     * `Wavetable mOscillator(WavetableBank::acquire(KlangWellen::WAVEFORM_SINE, 2048), 48000);`
+     * <p>
+     * tables are aligned to cache lines and must not be modified. acquiring and releasing handles is thread-safe (
+     * except on arduino ), copying a handle only increments an atomic counter. acquiring a table that does not exist yet
+     * allocates memory and should not be done in the audio thread.
+     */
+    class WavetableBank {
+        struct Entry;
+
+    public:
+        static constexpr uint32_t ALIGNMENT = 64;
+
+        /**
+         * reference-counted handle to a shared table ( `T = float` ) or mipmap ( `T = WavetableMipmap` ).
+         */
+        template<typename T>
+        class Shared {
+        public:
+            Shared() : fEntry(nullptr) {}
+
+            Shared(const Shared& other) : fEntry(other.fEntry) {
+                if (fEntry != nullptr) {
+                    retain(fEntry);
+                }
+            }
+
+            Shared(Shared&& other) noexcept : fEntry(other.fEntry) {
+                other.fEntry = nullptr;
+            }
+
+            Shared& operator=(Shared other) noexcept {
+                Entry* mEntry = fEntry;
+                fEntry        = other.fEntry;
+                other.fEntry  = mEntry;
+                return *this;
+            }
+
+            ~Shared() {
+                reset();
+            }
+
+            /**
+             * releases the table. the handle is empty afterwards.
+             */
+            void reset() {
+                if (fEntry != nullptr) {
+                    release(fEntry);
+                    fEntry = nullptr;
+                }
+            }
+
+            const T* get() const {
+                if (fEntry == nullptr) {
+                    return nullptr;
+                }
+                if constexpr (std::is_same<T, WavetableMipmap>::value) {
+                    return fEntry->mipmap;
+                } else {
+                    return fEntry->table;
+                }
+            }
+
+            explicit operator bool() const {
+                return fEntry != nullptr;
+            }
+
+            uint8_t get_waveform() const {
+                return fEntry != nullptr ? fEntry->waveform : 0;
+            }
+
+            uint32_t get_wavetable_size() const {
+                return fEntry != nullptr ? fEntry->size : 0;
+            }
+
+            /**
+             * @return number of handles sharing the table
+             */
+            uint32_t use_count() const {
+                return fEntry != nullptr ? static_cast<uint32_t>(fEntry->references) : 0;
+            }
+
+        private:
+            friend class WavetableBank;
+
+            Entry* fEntry;
+
+            explicit Shared(Entry* entry) : fEntry(entry) {}
+        };
+
+        using SharedWavetable = Shared<float>;
+        using SharedMipmap    = Shared<WavetableMipmap>;
+
+        /**
+         * @return shared table filled with `waveform` ( see `WavetableFill::fill` )
+         */
+        static SharedWavetable acquire(const uint8_t waveform, const uint32_t wavetable_size) {
+            return SharedWavetable(instance().find_or_create(waveform, wavetable_size, false));
+        }
+
+        /**
+         * @return shared band-limited mipmap of `waveform` ( see `WavetableMipmap` )
+         */
+        static SharedMipmap acquire_mipmap(const uint8_t waveform, const uint32_t wavetable_size) {
+            return SharedMipmap(instance().find_or_create(waveform, wavetable_size, true));
+        }
+
+        /**
+         * @return number of tables and mipmaps currently held by the bank
+         */
+        static size_t size() {
+            WavetableBank& mBank = instance();
+#if !defined(ARDUINO)
+            std::lock_guard<std::mutex> mLock(mBank.fMutex);
+#endif
+            return mBank.fEntries.size();
+        }
+
+        /**
+         * @return number of bytes allocated for tables and mipmaps
+         */
+        static size_t memory_usage() {
+            WavetableBank& mBank = instance();
+#if !defined(ARDUINO)
+            std::lock_guard<std::mutex> mLock(mBank.fMutex);
+#endif
+            size_t mBytes = 0;
+            for (const Entry* mEntry : mBank.fEntries) {
+                const size_t mLevels = mEntry->mipmap != nullptr ? mEntry->mipmap->get_num_levels() : 1;
+                mBytes += mLevels * mEntry->size * sizeof(float);
+            }
+            return mBytes;
+        }
+
+    private:
+        struct Entry {
+            uint8_t  waveform;
+            uint32_t size;
+            bool     is_mipmap;
+#if !defined(ARDUINO)
+            std::atomic<uint32_t> references;
+#else
+            uint32_t references;
+#endif
+            uint8_t*         memory;
+            float*           table;
+            WavetableMipmap* mipmap;
+        };
+
+#if !defined(ARDUINO)
+        std::mutex fMutex;
+#endif
+        std::vector<Entry*> fEntries;
+
+        WavetableBank() = default;
+
+        /* the bank is never destroyed so that handles in static objects can be released at any time */
+        static WavetableBank& instance() {
+            static WavetableBank* mBank = new WavetableBank();
+            return *mBank;
+        }
+
+        Entry* find_or_create(const uint8_t waveform, const uint32_t wavetable_size, const bool is_mipmap) {
+#if !defined(ARDUINO)
+            std::lock_guard<std::mutex> mLock(fMutex);
+#endif
+            for (Entry* mEntry : fEntries) {
+                if (mEntry->waveform == waveform && mEntry->size == wavetable_size && mEntry->is_mipmap == is_mipmap) {
+                    /* an entry whose count already dropped to 0 is about to be removed by its last owner */
+                    if (try_retain(mEntry)) {
+                        return mEntry;
+                    }
+                }
+            }
+            Entry* mEntry      = new Entry();
+            mEntry->waveform   = waveform;
+            mEntry->size       = wavetable_size;
+            mEntry->is_mipmap  = is_mipmap;
+            mEntry->references = 1;
+            mEntry->memory     = nullptr;
+            mEntry->table      = nullptr;
+            mEntry->mipmap     = nullptr;
+            if (is_mipmap) {
+                mEntry->mipmap = new WavetableMipmap(waveform, wavetable_size);
+            } else {
+                mEntry->memory        = new uint8_t[static_cast<size_t>(wavetable_size) * sizeof(float) + ALIGNMENT];
+                const uintptr_t mAddr = reinterpret_cast<uintptr_t>(mEntry->memory);
+                mEntry->table         = reinterpret_cast<float*>((mAddr + ALIGNMENT - 1) & ~static_cast<uintptr_t>(ALIGNMENT - 1));
+                WavetableFill::fill(mEntry->table, wavetable_size, waveform);
+            }
+            fEntries.push_back(mEntry);
+            return mEntry;
+        }
+
+        void remove(Entry* entry) {
+            {
+#if !defined(ARDUINO)
+                std::lock_guard<std::mutex> mLock(fMutex);
+#endif
+                for (size_t i = 0; i < fEntries.size(); i++) {
+                    if (fEntries[i] == entry) {
+                        fEntries[i] = fEntries.back();
+                        fEntries.pop_back();
+                        break;
+                    }
+                }
+            }
+            delete entry->mipmap;
+            delete[] entry->memory;
+            delete entry;
+        }
+
+        static void retain(Entry* entry) {
+#if !defined(ARDUINO)
+            entry->references.fetch_add(1, std::memory_order_relaxed);
+#else
+            entry->references++;
+#endif
+        }
+
+        static bool try_retain(Entry* entry) {
+#if !defined(ARDUINO)
+            uint32_t mCount = entry->references.load(std::memory_order_relaxed);
+            while (mCount > 0) {
+                if (entry->references.compare_exchange_weak(mCount, mCount + 1, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+#else
+            if (entry->references == 0) {
+                return false;
+            }
+            entry->references++;
+            return true;
+#endif
+        }
+
+        static void release(Entry* entry) {
+#if !defined(ARDUINO)
+            if (entry->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                instance().remove(entry);
+            }
+#else
+            if (--entry->references == 0) {
+                instance().remove(entry);
+            }
+#endif
+        }
+    };
+} // namespace klangwellen
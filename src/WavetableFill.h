@@ -0,0 +1,99 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cmath>
+
+#include "KlangWellen.h"
+
+namespace klangwellen {
+    /**
+     * fills single-cycle tables with the built-in waveforms. used by `Wavetable` and `WavetableBank`.
+     */
+    class WavetableFill {
+    public:
+        static void fill(float* wavetable, const uint32_t wavetable_size, const uint8_t waveform) {
+            switch (waveform) {
+                case KlangWellen::WAVEFORM_SINE:
+                    sine(wavetable, wavetable_size);
+                    break;
+                case KlangWellen::WAVEFORM_TRIANGLE:
+                    triangle(wavetable, wavetable_size);
+                    break;
+                case KlangWellen::WAVEFORM_SQUARE:
+                    square(wavetable, wavetable_size);
+                    break;
+                case KlangWellen::WAVEFORM_SAWTOOTH:
+                    sawtooth(wavetable, wavetable_size, false);
+                    break;
+                default:
+                    sine(wavetable, wavetable_size);
+            }
+        }
+
+        static void pulse(float* wavetable, const uint32_t wavetable_size, const float pulse_width) {
+            const auto mThreshold = static_cast<uint32_t>(static_cast<float>(wavetable_size) * pulse_width);
+            for (uint32_t i = 0; i < wavetable_size; i++) {
+                if (i < mThreshold) {
+                    wavetable[i] = 1.0f;
+                } else {
+                    wavetable[i] = -1.0f;
+                }
+            }
+        }
+
+        static void sawtooth(float* wavetable, const uint32_t wavetable_size, const bool is_ramp_up = true) {
+            const float mSign = is_ramp_up ? -1.0f : 1.0f;
+            for (uint32_t i = 0; i < wavetable_size; i++) {
+                wavetable[i] = mSign * (2.0f * (static_cast<float>(i) / static_cast<float>(wavetable_size - 1)) - 1.0f);
+            }
+        }
+
+        static void sine(float* wavetable, const uint32_t wavetable_size) {
+            for (uint32_t i = 0; i < wavetable_size; i++) {
+                wavetable[i] = sin(2.0f * PIf * (static_cast<float>(i) / static_cast<float>(wavetable_size)));
+            }
+        }
+
+        static void square(float* wavetable, const uint32_t wavetable_size) {
+            for (uint32_t i = 0; i < wavetable_size / 2; i++) {
+                wavetable[i]                      = 1.0f;
+                wavetable[i + wavetable_size / 2] = -1.0f;
+            }
+        }
+
+        static void triangle(float* wavetable, const uint32_t wavetable_size) {
+            const uint32_t q  = wavetable_size / 4;
+            const float    qf = static_cast<float>(wavetable_size) * 0.25f;
+            for (uint32_t i = 0; i < q; i++) {
+                wavetable[i] = static_cast<float>(i) / qf;
+                // noinspection PointlessArithmeticExpression
+                wavetable[i + (q * 1)] = (qf - static_cast<float>(i)) / qf;
+                wavetable[i + (q * 2)] = static_cast<float>(-i) / qf;
+                wavetable[i + (q * 3)] = -(qf - static_cast<float>(i)) / qf;
+            }
+        }
+
+    private:
+        static constexpr float PIf = static_cast<float>(M_PI);
+    };
+} // namespace klangwellen
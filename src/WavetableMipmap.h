@@ -0,0 +1,218 @@
+/*
+ * KlangWellen
+ *
+ * This file is part of the *KlangWellen* library (https://github.com/dennisppaul/klangwellen).
+ * Copyright (c) 2024 Dennis P Paul
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <cmath>
+
+#include "KlangWellen.h"
+
+namespace klangwellen {
+    /**
+     * set of band-limited versions of a single-cycle waveform, one per octave.
+     * <p>
+     * level `k` contains the harmonics `1 ... size / 2^(k+1)` of the waveform. when a wavetable of `size` samples is
+     * played back with a step size of `s` samples per output sample, level `k` is free of aliasing for `s <= 2^k`. the
+     * levels are built once by harmonic truncation: the fourier series of the built-in waveforms is computed
+     * analytically, arbitrary single-cycle waveforms are analyzed with a DFT. all levels have the same size as the
+     * original table.
+     * <p>
+     * a mipmap is immutable after construction and can be shared by any number of `Wavetable` instances with the same
+     * wavetable size ( see `Wavetable::set_mipmap` ).
+     */
+    class WavetableMipmap {
+    public:
+        /**
+         * builds a mipmap for one of the built-in waveforms `KlangWellen::WAVEFORM_SINE`, `WAVEFORM_TRIANGLE`,
+         * `WAVEFORM_SAWTOOTH` or `WAVEFORM_SQUARE`. the waveforms match the ones created by `Wavetable::fill`.
+         */
+        WavetableMipmap(const uint8_t waveform, const uint32_t wavetable_size) : WavetableMipmap(wavetable_size) {
+            double* mSine   = new double[fNumHarmonics + 1]();
+            double* mCosine = new double[fNumHarmonics + 1]();
+            for (uint32_t h = 1; h <= fNumHarmonics; h++) {
+                const double mHarmonic = static_cast<double>(h);
+                const bool   mOdd      = (h & 1) == 1;
+                switch (waveform) {
+                    case KlangWellen::WAVEFORM_TRIANGLE:
+                        if (mOdd) {
+                            const double mSign = ((h - 1) / 2) % 2 == 0 ? 1.0 : -1.0;
+                            mSine[h]           = mSign * 8.0 / (M_PI * M_PI * mHarmonic * mHarmonic);
+                        }
+                        break;
+                    case KlangWellen::WAVEFORM_SAWTOOTH:
+                        mSine[h] = -2.0 / (M_PI * mHarmonic);
+                        break;
+                    case KlangWellen::WAVEFORM_SQUARE:
+                        if (mOdd) {
+                            mSine[h] = 4.0 / (M_PI * mHarmonic);
+                        }
+                        break;
+                    default:
+                        mSine[h] = h == 1 ? 1.0 : 0.0;
+                        break;
+                }
+            }
+            build(mSine, mCosine);
+            delete[] mSine;
+            delete[] mCosine;
+        }
+
+        /**
+         * builds a mipmap from an arbitrary single-cycle waveform. the DC offset of the waveform is preserved.
+         */
+        WavetableMipmap(const float* wavetable, const uint32_t wavetable_size) : WavetableMipmap(wavetable_size) {
+            double*       mSine   = new double[fNumHarmonics + 1]();
+            double*       mCosine = new double[fNumHarmonics + 1]();
+            const double* mTrig   = trigonometry_table();
+            const double  mNorm   = 2.0 / static_cast<double>(fSize);
+            for (uint32_t i = 0; i < fSize; i++) {
+                mCosine[0] += wavetable[i];
+            }
+            mCosine[0] /= static_cast<double>(fSize);
+            for (uint32_t h = 1; h <= fNumHarmonics; h++) {
+                double   a = 0.0;
+                double   b = 0.0;
+                uint32_t j = 0;
+                for (uint32_t i = 0; i < fSize; i++) {
+                    a += wavetable[i] * mTrig[fSize + j];
+                    b += wavetable[i] * mTrig[j];
+                    j += h;
+                    if (j >= fSize) {
+                        j -= fSize;
+                    }
+                }
+                /* the nyquist bin of an even sized table is real and counted only once */
+                const double mScale = (fSize % 2 == 0 && h * 2 == fSize) ? mNorm * 0.5 : mNorm;
+                mCosine[h]          = a * mScale;
+                mSine[h]            = b * mScale;
+            }
+            delete[] mTrig;
+            build(mSine, mCosine);
+            delete[] mSine;
+            delete[] mCosine;
+        }
+
+        ~WavetableMipmap() {
+            delete[] fMemory;
+        }
+
+        WavetableMipmap(const WavetableMipmap&)            = delete;
+        WavetableMipmap& operator=(const WavetableMipmap&) = delete;
+
+        uint32_t get_wavetable_size() const {
+            return fSize;
+        }
+
+        uint8_t get_num_levels() const {
+            return fNumLevels;
+        }
+
+        /**
+         * @return table of level `level` ( 0 contains all harmonics )
+         */
+        const float* get_level(const uint8_t level) const {
+            return fTables + static_cast<size_t>(level < fNumLevels ? level : fNumLevels - 1) * fStride;
+        }
+
+        /**
+         * @return number of harmonics contained in level `level`
+         */
+        uint32_t get_num_harmonics(const uint8_t level) const {
+            const uint32_t mHarmonics = fSize >> (level + 1);
+            return mHarmonics > 0 ? mHarmonics : 1;
+        }
+
+    private:
+        const uint32_t fSize;
+        const uint32_t fNumHarmonics;
+        const uint8_t  fNumLevels;
+        uint32_t       fStride;
+        uint8_t*       fMemory;
+        float*         fTables;
+
+        explicit WavetableMipmap(const uint32_t wavetable_size) : fSize(wavetable_size),
+                                                                  fNumHarmonics(wavetable_size / 2),
+                                                                  fNumLevels(compute_num_levels(wavetable_size)) {
+            /* levels start at cache line boundaries */
+            constexpr uint32_t mAlignment = 64;
+            fStride                       = (fSize + mAlignment / sizeof(float) - 1) & ~static_cast<uint32_t>(mAlignment / sizeof(float) - 1);
+            fMemory                       = new uint8_t[static_cast<size_t>(fStride) * fNumLevels * sizeof(float) + mAlignment];
+            const uintptr_t mAddr         = reinterpret_cast<uintptr_t>(fMemory);
+            fTables                       = reinterpret_cast<float*>((mAddr + mAlignment - 1) & ~static_cast<uintptr_t>(mAlignment - 1));
+        }
+
+        static uint8_t compute_num_levels(const uint32_t wavetable_size) {
+            uint8_t mLevels = 1;
+            while ((wavetable_size >> (mLevels + 1)) > 0) {
+                mLevels++;
+            }
+            return mLevels;
+        }
+
+        /* `sin(2 PI i / size)` for `i < size` followed by `cos(2 PI i / size)` */
+        double* trigonometry_table() const {
+            double* mTrig = new double[fSize * 2];
+            for (uint32_t i = 0; i < fSize; i++) {
+                const double r     = 2.0 * M_PI * static_cast<double>(i) / static_cast<double>(fSize);
+                mTrig[i]           = sin(r);
+                mTrig[fSize + i] = cos(r);
+            }
+            return mTrig;
+        }
+
+        /*
+         * synthesizes the levels from the sine and cosine coefficients. the levels are built from the highest ( fewest
+         * harmonics ) to the lowest, each one adding its additional harmonics to an accumulator.
+         */
+        void build(const double* sine, const double* cosine) {
+            const double* mTrig        = trigonometry_table();
+            double*       mAccumulator = new double[fSize];
+            for (uint32_t i = 0; i < fSize; i++) {
+                mAccumulator[i] = cosine[0];
+            }
+            uint32_t mHarmonic = 1;
+            for (int32_t mLevel = fNumLevels - 1; mLevel >= 0; mLevel--) {
+                const uint32_t mHarmonics = get_num_harmonics(static_cast<uint8_t>(mLevel));
+                for (; mHarmonic <= mHarmonics && mHarmonic <= fNumHarmonics; mHarmonic++) {
+                    const double a = cosine[mHarmonic];
+                    const double b = sine[mHarmonic];
+                    if (a == 0.0 && b == 0.0) {
+                        continue;
+                    }
+                    uint32_t j = 0;
+                    for (uint32_t i = 0; i < fSize; i++) {
+                        mAccumulator[i] += a * mTrig[fSize + j] + b * mTrig[j];
+                        j += mHarmonic;
+                        if (j >= fSize) {
+                            j -= fSize;
+                        }
+                    }
+                }
+                float* mTable = fTables + static_cast<size_t>(mLevel) * fStride;
+                for (uint32_t i = 0; i < fSize; i++) {
+                    mTable[i] = static_cast<float>(mAccumulator[i]);
+                }
+            }
+            delete[] mAccumulator;
+            delete[] mTrig;
+        }
+    };
+} // namespace klangwellen
@@ -0,0 +1,238 @@
+/*
+ * test for `ConvolutionReverb` and `WAV`.
+ *
+ * checks for partition sizes from 16 to 256, impulse responses from 0 samples up to two stages after the head, each
+ * supported instruction set of `BufferKernels` and with and without background threads, that
+ *
+ * - the output equals a direct convolution of the input with the impulse response delayed by the latency
+ * - host blocks of irregular sizes produce the same output
+ *
+ * and that `WAV::parse` reads 16 and 24 bit PCM samples from plain and `WAVE_FORMAT_EXTENSIBLE` headers.
+ *
+ * the exit code is 1 if a check fails.
+ *
+ *     $ ./klangwellen_test_convolution
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmath>
+#include <vector>
+
+#include "BufferKernels.h"
+#include "ConvolutionReverb.h"
+#include "WAV.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t INPUT_LENGTH = 1500;
+static constexpr float    TOLERANCE    = 1e-4f;
+
+static const char* ISA_NAMES[] = {"scalar", "sse2", "avx2", "avx512"};
+
+static uint32_t fFailures = 0;
+
+static void check(const bool condition, const char* message, const char* context) {
+    if (!condition) {
+        printf("FAILED: %s ( %s )\n", message, context);
+        fFailures++;
+    }
+}
+
+static uint32_t fRandom = 1;
+
+static float noise() {
+    fRandom = fRandom * 1664525u + 1013904223u;
+    return static_cast<float>(fRandom >> 8) / 8388608.0f - 1.0f;
+}
+
+/* exponentially decaying noise, like the impulse response of a room */
+static std::vector<float> impulse_response(const uint32_t length) {
+    std::vector<float> mImpulseResponse(length);
+    for (uint32_t i = 0; i < length; i++) {
+        mImpulseResponse[i] = 0.5f * noise() * std::exp(-4.0f * static_cast<float>(i) / static_cast<float>(length));
+    }
+    return mImpulseResponse;
+}
+
+/* `( input * impulse_response )[ i - latency ]`, the input is zero after its last sample */
+static std::vector<float> direct_convolution(const std::vector<float>& input,
+                                             const std::vector<float>& impulse_response,
+                                             const uint32_t            latency,
+                                             const uint32_t            length) {
+    std::vector<float> mOutput(length, 0.0f);
+    for (uint32_t i = latency; i < length; i++) {
+        const uint32_t n    = i - latency;
+        double         mSum = 0.0;
+        for (uint32_t k = 0; k < input.size() && k <= n; k++) {
+            if (n - k < impulse_response.size()) {
+                mSum += static_cast<double>(input[k]) * static_cast<double>(impulse_response[n - k]);
+            }
+        }
+        mOutput[i] = static_cast<float>(mSum);
+    }
+    return mOutput;
+}
+
+static void test_convolution(const std::vector<float>& input,
+                             const std::vector<float>& impulse_response,
+                             const std::vector<float>& expected,
+                             const uint32_t            partition_size,
+                             const bool                background_thread) {
+    const uint32_t length = static_cast<uint32_t>(impulse_response.size());
+    char           mContext[128];
+    snprintf(mContext,
+             sizeof(mContext),
+             "isa: %s, partition size: %u, impulse response: %u, background thread: %s",
+             ISA_NAMES[BufferKernels::get_isa()],
+             partition_size,
+             length,
+             background_thread ? "on" : "off");
+
+    const uint32_t    mLength = static_cast<uint32_t>(expected.size());
+    ConvolutionReverb mReverb(48000, partition_size, background_thread);
+    mReverb.load(impulse_response.data(), length);
+    check(mReverb.get_latency() == partition_size, "latency differs from the partition size", mContext);
+
+    /* host blocks of irregular sizes, including single samples */
+    const uint32_t     BLOCK_SIZES[] = {1, 7, 64, 100, 3, 513, 256, 31};
+    std::vector<float> mOutput(mLength, 0.0f);
+    std::copy(input.begin(), input.end(), mOutput.begin());
+    uint32_t i = 0;
+    for (uint32_t b = 0; i < mLength; b++) {
+        const uint32_t mBlock = std::min(BLOCK_SIZES[b % 8], mLength - i);
+        if (mBlock == 1) {
+            mOutput[i] = mReverb.process(mOutput[i]);
+        } else {
+            mReverb.process(mOutput.data() + i, mBlock);
+        }
+        i += mBlock;
+    }
+
+    float mDifference = 0.0f;
+    float mPeak       = 0.0f;
+    for (uint32_t j = 0; j < mLength; j++) {
+        mDifference = std::max(mDifference, std::fabs(mOutput[j] - expected[j]));
+        mPeak       = std::max(mPeak, std::fabs(expected[j]));
+    }
+    check(mDifference <= TOLERANCE * std::max(1.0f, mPeak), "output differs from the direct convolution", mContext);
+}
+
+/* writes a little endian integer of `bytes` bytes */
+static void write(std::vector<uint8_t>& data, const uint32_t value, const uint8_t bytes) {
+    for (uint8_t i = 0; i < bytes; i++) {
+        data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static void write(std::vector<uint8_t>& data, const char* tag) {
+    data.insert(data.end(), tag, tag + 4);
+}
+
+/* a WAVE file with the samples `values` of `bits` bits, an unknown chunk before the `fmt ` chunk and odd padding */
+static std::vector<uint8_t> wave(const std::vector<int32_t>& values, const uint16_t bits, const uint16_t channels, const bool extensible) {
+    const uint8_t        mBytes = static_cast<uint8_t>(bits / 8);
+    std::vector<uint8_t> mData;
+    write(mData, "RIFF");
+    write(mData, 0, 4);
+    write(mData, "WAVE");
+    write(mData, "junk");
+    write(mData, 3, 4);
+    write(mData, 0, 4); /* 3 bytes and one byte of padding */
+    write(mData, "fmt ");
+    write(mData, extensible ? 40 : 16, 4);
+    write(mData, extensible ? 0xFFFE : 0x0001, 2);
+    write(mData, channels, 2);
+    write(mData, 44100, 4);
+    write(mData, 44100 * channels * mBytes, 4);
+    write(mData, channels * mBytes, 2);
+    write(mData, bits, 2);
+    if (extensible) {
+        write(mData, 22, 2);
+        write(mData, bits, 2);
+        write(mData, 0, 4);
+        /* sub format GUID `00000001-0000-0010-8000-00aa00389b71`, i.e PCM */
+        const uint8_t GUID[] = {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+        mData.insert(mData.end(), GUID, GUID + sizeof(GUID));
+    }
+    write(mData, "data");
+    write(mData, static_cast<uint32_t>(values.size() * mBytes), 4);
+    for (const int32_t mValue : values) {
+        write(mData, static_cast<uint32_t>(mValue), mBytes);
+    }
+    const uint32_t mSize = static_cast<uint32_t>(mData.size() - 8);
+    for (uint8_t i = 0; i < 4; i++) {
+        mData[4 + i] = static_cast<uint8_t>(mSize >> (8 * i));
+    }
+    return mData;
+}
+
+static void test_wav(const uint16_t bits, const bool extensible) {
+    char mContext[64];
+    snprintf(mContext, sizeof(mContext), "bits: %u, extensible: %s", bits, extensible ? "yes" : "no");
+
+    const int32_t              mFullScale = 1 << (bits - 1);
+    const std::vector<int32_t> mValues    = {0, mFullScale / 2, -mFullScale / 2, mFullScale - 1, -mFullScale, 1, -1, mFullScale / 4};
+    const std::vector<uint8_t> mData      = wave(mValues, bits, 2, extensible);
+
+    std::vector<float> mSamples;
+    uint16_t           mChannels   = 0;
+    uint32_t           mSampleRate = 0;
+    check(WAV::parse(mData.data(), mData.size(), mSamples, mChannels, mSampleRate), "file is not parsed", mContext);
+    check(mChannels == 2 && mSampleRate == 44100, "format differs", mContext);
+    check(mSamples.size() == mValues.size(), "number of samples differs", mContext);
+    for (size_t i = 0; i < mSamples.size() && i < mValues.size(); i++) {
+        const float mExpected = static_cast<float>(mValues[i]) / static_cast<float>(mFullScale);
+        check(mSamples[i] == mExpected, "sample differs", mContext);
+    }
+
+    /* a file cut off in the middle of the data chunk keeps the complete frames */
+    std::vector<float> mTruncated;
+    check(WAV::parse(mData.data(), mData.size() - bits / 8 - 1, mTruncated, mChannels, mSampleRate) &&
+              mTruncated.size() == mValues.size() - 2,
+          "truncated file is not parsed",
+          mContext);
+}
+
+int main() {
+    std::vector<float> mInput(INPUT_LENGTH);
+    for (float& mSample : mInput) {
+        mSample = noise();
+    }
+    const uint8_t mISA = BufferKernels::get_isa();
+    for (const uint32_t mPartitionSize : {16u, 64u, 256u}) {
+        const uint32_t mHead = 2 * mPartitionSize * ConvolutionReverb::STAGE_FACTOR;
+        /* empty, within one partition, the head only, and one and two stages after the head */
+        const uint32_t LENGTHS[] = {0, 1, mPartitionSize - 3, mHead, mHead + 1, 3 * mHead + 17, 34 * mHead + 5};
+        for (const uint32_t mLength : LENGTHS) {
+            const std::vector<float> mImpulseResponse = impulse_response(mLength);
+            const std::vector<float> mExpected        = direct_convolution(mInput,
+                                                                           mImpulseResponse,
+                                                                           mPartitionSize,
+                                                                           INPUT_LENGTH + mLength + 2 * mPartitionSize);
+            for (uint8_t mInstructionSet = BufferKernels::ISA_SCALAR; mInstructionSet <= BufferKernels::ISA_AVX512; mInstructionSet++) {
+                if (!BufferKernels::set_isa(mInstructionSet)) {
+                    continue;
+                }
+                for (const bool mBackgroundThread : {false, true}) {
+                    test_convolution(mInput, mImpulseResponse, mExpected, mPartitionSize, mBackgroundThread);
+                }
+            }
+        }
+    }
+    BufferKernels::set_isa(mISA);
+
+    for (const uint16_t mBits : {16, 24}) {
+        for (const bool mExtensible : {false, true}) {
+            test_wav(mBits, mExtensible);
+        }
+    }
+
+    if (fFailures > 0) {
+        printf("%u check(s) failed\n", fFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
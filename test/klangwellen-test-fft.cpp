@@ -0,0 +1,151 @@
+/*
+ * test for `FFT`.
+ *
+ * checks for sizes from 4 to 8192 that
+ *
+ * - `forward` equals a discrete fourier transform computed directly in double precision within float rounding, and the
+ *   imaginary parts of the DC and nyquist bins are 0
+ * - `inverse` equals the inverse discrete fourier transform of a spectrum of a real signal within float rounding
+ * - `inverse( forward( x ) )` equals `x` within float rounding
+ * - the size is rounded up to a power of two of at least 4
+ *
+ * `FFT` has no vectorized kernels, so unlike the other tests it is not run for each instruction set of `BufferKernels`.
+ *
+ * the exit code is 1 if a check fails.
+ *
+ *     $ ./klangwellen_test_fft
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmath>
+#include <vector>
+
+#include "FFT.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t MAX_SIZE  = 8192;
+static constexpr float    TOLERANCE = 1e-5f;
+
+static uint32_t fFailures = 0;
+
+static void check(const bool condition, const char* message, const char* context) {
+    if (!condition) {
+        printf("FAILED: %s ( %s )\n", message, context);
+        fFailures++;
+    }
+}
+
+static uint32_t fRandom = 1;
+
+static float noise() {
+    fRandom = fRandom * 1664525u + 1013904223u;
+    return static_cast<float>(fRandom >> 8) / 8388608.0f - 1.0f;
+}
+
+static float max_difference(const std::vector<float>& a, const std::vector<float>& b) {
+    float mMax = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        mMax = std::max(mMax, std::fabs(a[i] - b[i]));
+    }
+    return mMax;
+}
+
+static float peak(const std::vector<float>& a) {
+    float mMax = 0.0f;
+    for (const float mValue : a) {
+        mMax = std::max(mMax, std::fabs(mValue));
+    }
+    return mMax;
+}
+
+/* bins `0 ... size / 2` of `sum( x[ n ] exp( -2 PI i k n / size ) )` as interleaved real and imaginary parts */
+static std::vector<float> dft(const std::vector<float>& signal) {
+    const size_t       mSize = signal.size();
+    std::vector<float> mSpectrum(mSize + 2);
+    for (size_t k = 0; k <= mSize / 2; k++) {
+        double mReal      = 0.0;
+        double mImaginary = 0.0;
+        for (size_t n = 0; n < mSize; n++) {
+            /* `k n` modulo the size keeps the argument of the sine exact */
+            const double r = 2.0 * M_PI * static_cast<double>((k * n) % mSize) / static_cast<double>(mSize);
+            mReal += signal[n] * std::cos(r);
+            mImaginary -= signal[n] * std::sin(r);
+        }
+        mSpectrum[k * 2]     = static_cast<float>(mReal);
+        mSpectrum[k * 2 + 1] = static_cast<float>(mImaginary);
+    }
+    return mSpectrum;
+}
+
+/* the real signal with the bins `spectrum`, i.e `1 / size sum( X[ k ] exp( 2 PI i k n / size ) )` over all bins */
+static std::vector<float> inverse_dft(const std::vector<float>& spectrum) {
+    const size_t       mSize = spectrum.size() - 2;
+    std::vector<float> mSignal(mSize);
+    for (size_t n = 0; n < mSize; n++) {
+        double mSum = 0.0;
+        for (size_t k = 0; k <= mSize / 2; k++) {
+            const double r = 2.0 * M_PI * static_cast<double>((k * n) % mSize) / static_cast<double>(mSize);
+            /* the bins above nyquist are the conjugates of the bins below it */
+            const double w = (k == 0 || k == mSize / 2) ? 1.0 : 2.0;
+            mSum += w * (spectrum[k * 2] * std::cos(r) - spectrum[k * 2 + 1] * std::sin(r));
+        }
+        mSignal[n] = static_cast<float>(mSum / static_cast<double>(mSize));
+    }
+    return mSignal;
+}
+
+static void test_fft(const uint32_t size) {
+    char mContext[32];
+    snprintf(mContext, sizeof(mContext), "size: %u", size);
+
+    FFT mFFT(size);
+    check(mFFT.get_size() == size && mFFT.get_num_bins() == size / 2 + 1, "size differs", mContext);
+
+    std::vector<float> mSignal(size);
+    for (float& mSample : mSignal) {
+        mSample = noise();
+    }
+    std::vector<float> mSpectrum(size + 2);
+    mFFT.forward(mSignal.data(), mSpectrum.data());
+    const std::vector<float> mExpected = dft(mSignal);
+    check(max_difference(mSpectrum, mExpected) <= TOLERANCE * peak(mExpected), "`forward` differs from the DFT", mContext);
+    check(mSpectrum[1] == 0.0f && mSpectrum[size + 1] == 0.0f, "DC or nyquist bin is not real", mContext);
+
+    std::vector<float> mRoundTrip(size);
+    mFFT.inverse(mSpectrum.data(), mRoundTrip.data());
+    check(max_difference(mRoundTrip, mSignal) <= TOLERANCE, "`inverse( forward( x ) )` differs from `x`", mContext);
+
+    /* a spectrum that is not the output of `forward` */
+    std::vector<float> mBins(size + 2);
+    for (float& mBin : mBins) {
+        mBin = noise();
+    }
+    mBins[1]        = 0.0f;
+    mBins[size + 1] = 0.0f;
+    std::vector<float> mOutput(size);
+    mFFT.inverse(mBins.data(), mOutput.data());
+    const std::vector<float> mExpectedSignal = inverse_dft(mBins);
+    check(max_difference(mOutput, mExpectedSignal) <= TOLERANCE * peak(mExpectedSignal), "`inverse` differs from the inverse DFT", mContext);
+}
+
+int main() {
+    for (uint32_t mSize = 4; mSize <= MAX_SIZE; mSize <<= 1) {
+        test_fft(mSize);
+    }
+
+    const char* mContext = "rounding";
+    check(FFT(0).get_size() == 4 && FFT(3).get_size() == 4, "size is not at least 4", mContext);
+    check(FFT(5).get_size() == 8 && FFT(1000).get_size() == 1024 && FFT(1024).get_size() == 1024,
+          "size is not rounded up to a power of two",
+          mContext);
+
+    if (fFailures > 0) {
+        printf("%u check(s) failed\n", fFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,239 @@
+/*
+ * test for `Reverb`.
+ *
+ * compares the reverb at its tuning sample rate of 44100 Hz with a reference implementation of the freeverb algorithm
+ * it was generated from ( one delay line per comb and allpass indexed with a shared counter ). checks with constant
+ * parameters and silence detection disabled that
+ *
+ * - `process( float )` and `process( AudioSignal& )` produce the same output as the reference
+ * - the block `process` functions with the scalar kernel produce the same output as the reference, for mono and
+ *   stereo and blocks of irregular sizes
+ * - the block `process` functions with the vectorized kernels differ from the reference only by rounding
+ *
+ * the exit code is 1 if a check fails.
+ *
+ *     $ ./klangwellen_test_reverb
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmath>
+#include <vector>
+
+#include "AudioBuffer.h"
+#include "AudioSignal.h"
+#include "BufferKernels.h"
+#include "Reverb.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 44100;
+static constexpr uint32_t NUM_SAMPLES = 20000;
+static constexpr float    TOLERANCE   = 1e-5f;
+
+static const char* ISA_NAMES[] = {"scalar", "sse2", "avx2", "avx512"};
+
+static uint32_t fFailures = 0;
+
+static void check(const bool condition, const char* message, const char* context) {
+    if (!condition) {
+        printf("FAILED: %s ( %s )\n", message, context);
+        fFailures++;
+    }
+}
+
+/* one channel of freeverb with the default parameters of `Reverb` */
+class ReferenceChannel {
+public:
+    explicit ReferenceChannel(const uint8_t channel) : fChannel(channel) {}
+
+    float process(const float input, const float dry) {
+        const float mDamp        = 0.4f * 0.5f;
+        const float mDampInverse = 1 - mDamp;
+        const float mFeedback    = 0.7f + 0.28f * 0.5f;
+        const float mWet         = 0.3333f;
+        const float mDry         = 1 - mWet;
+        float       mCombNext[8];
+        for (uint8_t k = 0; k < 8; k++) {
+            fFilter[k]                 = mDampInverse * fComb[k] + mDamp * fFilter[k];
+            fCombLine[k][fIOTA & 2047] = input + mFeedback * fFilter[k];
+            mCombNext[k]               = fCombLine[k][(fIOTA - COMB_TUNING[fChannel][k]) & 2047];
+        }
+        float mSignal = mCombNext[7];
+        for (int8_t k = 6; k >= 0; k--) {
+            mSignal += mCombNext[k];
+        }
+        for (uint8_t k = 0; k < 8; k++) {
+            fComb[k] = mCombNext[k];
+        }
+        for (uint8_t k = 0; k < 4; k++) {
+            fAllpassLine[k][fIOTA & 1023] = mSignal + 0.5f * fAllpass[k];
+            const float mNext             = fAllpassLine[k][(fIOTA - ALLPASS_TUNING[fChannel][k]) & 1023];
+            mSignal                       = fAllpass[k] - mSignal;
+            fAllpass[k]                   = mNext;
+        }
+        fIOTA++;
+        return mDry * dry + mWet * mSignal;
+    }
+
+private:
+    static constexpr uint32_t COMB_TUNING[2][8]    = {{1617, 1557, 1491, 1422, 1356, 1277, 1188, 1116},
+                                                      {1640, 1580, 1514, 1445, 1379, 1300, 1211, 1139}};
+    static constexpr uint32_t ALLPASS_TUNING[2][4] = {{556, 441, 341, 225},
+                                                      {579, 464, 364, 248}};
+
+    const uint8_t fChannel;
+    uint32_t      fIOTA = 0;
+    float         fCombLine[8][2048]{};
+    float         fAllpassLine[4][1024]{};
+    float         fFilter[8]{};
+    float         fComb[8]{};
+    float         fAllpass[4]{};
+};
+
+static uint32_t fRandom = 1;
+
+static float noise() {
+    fRandom = fRandom * 1664525u + 1013904223u;
+    return static_cast<float>(fRandom >> 8) / 8388608.0f - 1.0f;
+}
+
+static Reverb* create_reverb() {
+    Reverb* mReverb = new Reverb(SAMPLE_RATE);
+    mReverb->set_silence_threshold(0.0f);
+    return mReverb;
+}
+
+static bool identical(const std::vector<float>& a, const std::vector<float>& b) {
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static float max_difference(const std::vector<float>& a, const std::vector<float>& b) {
+    float mMax = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        mMax = std::max(mMax, std::fabs(a[i] - b[i]));
+    }
+    return mMax;
+}
+
+/* processes `left` and `right` in place in blocks of irregular sizes, a mono signal if `right` is empty */
+static void process_blocks(Reverb& reverb, std::vector<float>& left, std::vector<float>& right) {
+    const uint32_t BLOCK_SIZES[] = {64, 1, 7, 128, 3, 200, 16, 1000, 2};
+    uint32_t       i             = 0;
+    for (uint32_t b = 0; i < left.size(); b++) {
+        const uint32_t mBlock = std::min(BLOCK_SIZES[b % 9], static_cast<uint32_t>(left.size()) - i);
+        if (right.empty()) {
+            AudioBuffer mBuffer(left.data() + i, mBlock);
+            reverb.process(mBuffer);
+        } else {
+            reverb.process(left.data() + i, right.data() + i, mBlock);
+        }
+        i += mBlock;
+    }
+}
+
+int main() {
+    std::vector<float> mLeft(NUM_SAMPLES);
+    std::vector<float> mRight(NUM_SAMPLES);
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        /* bursts of noise with silence in between */
+        const bool mBurst = (i / 2000) % 2 == 0;
+        mLeft[i]          = mBurst ? noise() : 0.0f;
+        mRight[i]         = mBurst ? 0.5f * noise() : 0.0f;
+    }
+
+    /* the reference */
+    std::vector<float> mExpectedLeft(NUM_SAMPLES);
+    std::vector<float> mExpectedRight(NUM_SAMPLES);
+    std::vector<float> mExpectedMono(NUM_SAMPLES);
+    {
+        ReferenceChannel* mReferenceLeft  = new ReferenceChannel(0);
+        ReferenceChannel* mReferenceRight = new ReferenceChannel(1);
+        ReferenceChannel* mReferenceMono  = new ReferenceChannel(0);
+        for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+            const float mInput = 1.500000e-02f * (mLeft[i] + mRight[i]);
+            mExpectedLeft[i]   = mReferenceLeft->process(mInput, mLeft[i]);
+            mExpectedRight[i]  = mReferenceRight->process(mInput, mRight[i]);
+            mExpectedMono[i]   = mReferenceMono->process(1.500000e-02f * (mLeft[i] + mLeft[i]), mLeft[i]);
+        }
+        delete mReferenceLeft;
+        delete mReferenceRight;
+        delete mReferenceMono;
+    }
+
+    /* the single frame paths */
+    {
+        Reverb*            mReverb = create_reverb();
+        std::vector<float> mOutput(NUM_SAMPLES);
+        for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+            mOutput[i] = mReverb->process(mLeft[i]);
+        }
+        check(identical(mOutput, mExpectedMono), "`process( float )` differs from the reference", "mono");
+        delete mReverb;
+
+        mReverb = create_reverb();
+        std::vector<float> mOutputLeft(NUM_SAMPLES);
+        std::vector<float> mOutputRight(NUM_SAMPLES);
+        for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+            AudioSignal mSignal;
+            mSignal.left    = mLeft[i];
+            mSignal.right   = mRight[i];
+            mReverb->process(mSignal);
+            mOutputLeft[i]  = mSignal.left;
+            mOutputRight[i] = mSignal.right;
+        }
+        check(identical(mOutputLeft, mExpectedLeft) && identical(mOutputRight, mExpectedRight),
+              "`process( AudioSignal& )` differs from the reference",
+              "stereo");
+        delete mReverb;
+    }
+
+    /* the block paths with each supported kernel */
+    const uint8_t mISA = BufferKernels::get_isa();
+    for (uint8_t mInstructionSet = BufferKernels::ISA_SCALAR; mInstructionSet <= BufferKernels::ISA_AVX512; mInstructionSet++) {
+        if (!BufferKernels::set_isa(mInstructionSet)) {
+            continue;
+        }
+        const char* mContext = ISA_NAMES[mInstructionSet];
+
+        Reverb*            mReverb      = create_reverb();
+        std::vector<float> mOutputLeft  = mLeft;
+        std::vector<float> mOutputRight = mRight;
+        process_blocks(*mReverb, mOutputLeft, mOutputRight);
+        delete mReverb;
+
+        mReverb                        = create_reverb();
+        std::vector<float> mOutputMono = mLeft;
+        std::vector<float> mNone;
+        process_blocks(*mReverb, mOutputMono, mNone);
+        delete mReverb;
+
+        if (mInstructionSet == BufferKernels::ISA_SCALAR) {
+            check(identical(mOutputLeft, mExpectedLeft) && identical(mOutputRight, mExpectedRight),
+                  "stereo block output differs from the reference",
+                  mContext);
+            check(identical(mOutputMono, mExpectedMono), "mono block output differs from the reference", mContext);
+        } else {
+            check(max_difference(mOutputLeft, mExpectedLeft) < TOLERANCE && max_difference(mOutputRight, mExpectedRight) < TOLERANCE,
+                  "stereo block output differs from the reference by more than rounding",
+                  mContext);
+            check(max_difference(mOutputMono, mExpectedMono) < TOLERANCE,
+                  "mono block output differs from the reference by more than rounding",
+                  mContext);
+        }
+    }
+    BufferKernels::set_isa(mISA);
+
+    if (fFailures > 0) {
+        printf("%u check(s) failed\n", fFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
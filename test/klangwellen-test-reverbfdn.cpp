@@ -0,0 +1,209 @@
+/*
+ * test for `ReverbFDN`.
+ *
+ * checks for 8, 16 and 32 lines and both feedback matrices with silence detection disabled that
+ *
+ * - the vectorized kernels produce the same output as the scalar kernel within 1e-7, for stereo blocks of irregular
+ *   sizes
+ * - `process( float )`, `process( AudioSignal& )` and the block `process` functions produce the same output with
+ *   each supported instruction set of `BufferKernels`
+ * - the energy of the impulse response decays by 60 dB within 25% of the decay time ( measured from the slope between
+ *   -5 and -25 dB, ~0.86 of the decay time without damping since the interpolation of the modulated lines damps high
+ *   frequencies )
+ *
+ * the exit code is 1 if a check fails.
+ *
+ *     $ ./klangwellen_test_reverbfdn
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmath>
+#include <vector>
+
+#include "AudioBuffer.h"
+#include "AudioSignal.h"
+#include "BufferKernels.h"
+#include "ReverbFDN.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t NUM_SAMPLES = 48000;
+static constexpr float    TOLERANCE   = 1e-7f;
+
+static const char* ISA_NAMES[] = {"scalar", "sse2", "avx2", "avx512"};
+
+static uint32_t fFailures = 0;
+
+static void check(const bool condition, const char* message, const char* context) {
+    if (!condition) {
+        printf("FAILED: %s ( %s )\n", message, context);
+        fFailures++;
+    }
+}
+
+static uint32_t fRandom = 1;
+
+static float noise() {
+    fRandom = fRandom * 1664525u + 1013904223u;
+    return static_cast<float>(fRandom >> 8) / 8388608.0f - 1.0f;
+}
+
+static ReverbFDN* create_reverb(const uint8_t num_lines, const uint8_t matrix) {
+    ReverbFDN* mReverb = new ReverbFDN(num_lines, SAMPLE_RATE, matrix);
+    mReverb->set_silence_threshold(0.0f);
+    return mReverb;
+}
+
+static bool identical(const std::vector<float>& a, const std::vector<float>& b) {
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static float max_difference(const std::vector<float>& a, const std::vector<float>& b) {
+    float mMax = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        mMax = std::max(mMax, std::fabs(a[i] - b[i]));
+    }
+    return mMax;
+}
+
+/* processes `left` and `right` in place in blocks of irregular sizes */
+static void process_blocks(ReverbFDN& reverb, std::vector<float>& left, std::vector<float>& right) {
+    const uint32_t BLOCK_SIZES[] = {64, 1, 7, 128, 3, 200, 16, 1000, 2};
+    uint32_t       i             = 0;
+    for (uint32_t b = 0; i < left.size(); b++) {
+        const uint32_t mBlock = std::min(BLOCK_SIZES[b % 9], static_cast<uint32_t>(left.size()) - i);
+        reverb.process(left.data() + i, right.data() + i, mBlock);
+        i += mBlock;
+    }
+}
+
+/* 60 dB decay time in seconds of the energy of the impulse response, extrapolated from -5 to -25 dB */
+static float measured_decay_time(const uint8_t num_lines, const uint8_t matrix, const float decay_time) {
+    ReverbFDN* mReverb = create_reverb(num_lines, matrix);
+    mReverb->set_wet(1.0f);
+    mReverb->set_decay_time(decay_time);
+    mReverb->set_damping(0.0f);
+    std::vector<float> mInput(2 * SAMPLE_RATE, 0.0f);
+    std::vector<float> mOutput(mInput.size());
+    mInput[0] = 1.0f;
+    mReverb->process(mOutput.data(), nullptr, mInput.data(), nullptr, static_cast<uint32_t>(mInput.size()));
+    delete mReverb;
+
+    /* energy remaining after each sample ( schroeder integration ) */
+    std::vector<double> mEnergy(mOutput.size() + 1, 0.0);
+    for (size_t i = mOutput.size(); i > 0; i--) {
+        mEnergy[i - 1] = mEnergy[i] + static_cast<double>(mOutput[i - 1]) * mOutput[i - 1];
+    }
+    size_t mBegin = 0;
+    while (mBegin < mOutput.size() && mEnergy[mBegin] > mEnergy[0] * std::pow(10.0, -0.5)) {
+        mBegin++;
+    }
+    size_t mEnd = mBegin;
+    while (mEnd < mOutput.size() && mEnergy[mEnd] > mEnergy[0] * std::pow(10.0, -2.5)) {
+        mEnd++;
+    }
+    return 3.0f * static_cast<float>(mEnd - mBegin) / static_cast<float>(SAMPLE_RATE);
+}
+
+static void test_reverb(const std::vector<float>& left, const std::vector<float>& right, const uint8_t num_lines, const uint8_t matrix) {
+    /* the scalar kernel is the reference */
+    std::vector<float> mExpectedLeft  = left;
+    std::vector<float> mExpectedRight = right;
+    const uint8_t      mISA           = BufferKernels::get_isa();
+    BufferKernels::set_isa(BufferKernels::ISA_SCALAR);
+    ReverbFDN* mReference = create_reverb(num_lines, matrix);
+    process_blocks(*mReference, mExpectedLeft, mExpectedRight);
+    delete mReference;
+
+    for (uint8_t mInstructionSet = BufferKernels::ISA_SCALAR; mInstructionSet <= BufferKernels::ISA_AVX512; mInstructionSet++) {
+        if (!BufferKernels::set_isa(mInstructionSet)) {
+            continue;
+        }
+        char mContext[64];
+        snprintf(mContext,
+                 sizeof(mContext),
+                 "isa: %s, lines: %u, matrix: %s",
+                 ISA_NAMES[mInstructionSet],
+                 num_lines,
+                 matrix == ReverbFDN::HADAMARD ? "hadamard" : "householder");
+
+        ReverbFDN*         mReverb      = create_reverb(num_lines, matrix);
+        std::vector<float> mOutputLeft  = left;
+        std::vector<float> mOutputRight = right;
+        process_blocks(*mReverb, mOutputLeft, mOutputRight);
+        delete mReverb;
+        check(max_difference(mOutputLeft, mExpectedLeft) <= TOLERANCE && max_difference(mOutputRight, mExpectedRight) <= TOLERANCE,
+              "stereo block output differs from the scalar kernel",
+              mContext);
+
+        /* the single frame paths */
+        mReverb = create_reverb(num_lines, matrix);
+        std::vector<float> mFrameLeft(NUM_SAMPLES);
+        std::vector<float> mFrameRight(NUM_SAMPLES);
+        for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+            AudioSignal mSignal;
+            mSignal.left   = left[i];
+            mSignal.right  = right[i];
+            mReverb->process(mSignal);
+            mFrameLeft[i]  = mSignal.left;
+            mFrameRight[i] = mSignal.right;
+        }
+        delete mReverb;
+        check(identical(mFrameLeft, mOutputLeft) && identical(mFrameRight, mOutputRight),
+              "`process( AudioSignal& )` differs from the block output",
+              mContext);
+
+        mReverb = create_reverb(num_lines, matrix);
+        std::vector<float> mSamples(NUM_SAMPLES);
+        for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+            mSamples[i] = mReverb->process(left[i]);
+        }
+        delete mReverb;
+        mReverb                  = create_reverb(num_lines, matrix);
+        std::vector<float> mMono = left;
+        for (uint32_t i = 0; i < NUM_SAMPLES; i += 100) {
+            AudioBuffer mBuffer(mMono.data() + i, std::min(100u, NUM_SAMPLES - i));
+            mReverb->process(mBuffer);
+        }
+        delete mReverb;
+        check(identical(mSamples, mMono), "`process( float )` differs from the mono block output", mContext);
+    }
+    BufferKernels::set_isa(mISA);
+}
+
+int main() {
+    std::vector<float> mLeft(NUM_SAMPLES);
+    std::vector<float> mRight(NUM_SAMPLES);
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        /* bursts of noise with silence in between */
+        const bool mBurst = (i / 8000) % 2 == 0;
+        mLeft[i]          = mBurst ? noise() : 0.0f;
+        mRight[i]         = mBurst ? 0.5f * noise() : 0.0f;
+    }
+
+    for (const uint8_t mLines : {8, 16, 32}) {
+        for (const uint8_t mMatrix : {ReverbFDN::HADAMARD, ReverbFDN::HOUSEHOLDER}) {
+            test_reverb(mLeft, mRight, mLines, mMatrix);
+
+            char mContext[48];
+            snprintf(mContext, sizeof(mContext), "lines: %u, matrix: %s", mLines, mMatrix == ReverbFDN::HADAMARD ? "hadamard" : "householder");
+            const float mDecayTime = measured_decay_time(mLines, mMatrix, 1.0f);
+            check(mDecayTime > 0.75f && mDecayTime < 1.25f, "decay time differs from the set decay time", mContext);
+        }
+    }
+
+    if (fFailures > 0) {
+        printf("%u check(s) failed\n", fFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
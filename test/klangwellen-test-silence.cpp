@@ -0,0 +1,218 @@
+/*
+ * test for the silence detection of stateful processors.
+ *
+ * checks `SilenceDetector` on its own and, for `Reverb`, `Delay`, `Filter`, `FilterLowPassMoogLadder` and `Vocoder`
+ * driven with an impulse followed by silence, that
+ *
+ * - the processor does not fall asleep before its output with silence detection disabled decayed below the threshold,
+ *   nor before `get_tail_length()` samples if the tail length is its hold ( `Filter`, `FilterLowPassMoogLadder` and
+ *   `Vocoder`, the delay lines of `Reverb` and `Delay` hold for their length )
+ * - the processor falls asleep after its tail decayed
+ * - new input wakes the processor up again
+ * - the output matches the output with silence detection disabled within the threshold
+ *
+ * the moog ladder is also checked at 40 Hz, where the response to a short burst rises slowly and the filter used to
+ * fall asleep after the first block.
+ *
+ * the exit code is 1 if a check fails.
+ *
+ *     $ ./klangwellen_test_silence
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmath>
+#include <vector>
+
+#include "AudioBuffer.h"
+#include "Delay.h"
+#include "Filter.h"
+#include "FilterLowPassMoogLadder.h"
+#include "Reverb.h"
+#include "SilenceDetector.h"
+#include "Vocoder.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t BLOCK_SIZE  = 64;
+static constexpr float    THRESHOLD   = SilenceDetector::DEFAULT_THRESHOLD;
+
+static uint32_t fFailures = 0;
+
+static void check(const bool condition, const char* message, const char* processor) {
+    if (!condition) {
+        printf("FAILED: %s ( %s )\n", message, processor);
+        fFailures++;
+    }
+}
+
+struct Result {
+    std::vector<float> output;
+    uint32_t           sleep = UINT32_MAX; /* number of samples processed when the processor was first found asleep */
+    bool               awake = false;      /* true if the processor was awake after the second impulse */
+};
+
+/* an impulse, silence for `length` samples, a second impulse and silence for another `BLOCK_SIZE` samples */
+static std::vector<float> impulses(const uint32_t length, const uint32_t burst = 1) {
+    std::vector<float> mInput(length + 2 * BLOCK_SIZE, 0.0f);
+    for (uint32_t i = 0; i < burst; i++) {
+        mInput[i]                       = 1.0f;
+        mInput[length + BLOCK_SIZE + i] = 1.0f;
+    }
+    return mInput;
+}
+
+/* processes `input` in blocks with `process( processor, buffer, length )` */
+template <typename PROCESSOR, typename PROCESS>
+static Result run(PROCESSOR& processor, PROCESS process, const std::vector<float>& input, const uint32_t second_impulse) {
+    Result mResult;
+    mResult.output = input;
+    for (uint32_t i = 0; i < input.size(); i += BLOCK_SIZE) {
+        process(processor, mResult.output.data() + i, BLOCK_SIZE);
+        if (mResult.sleep == UINT32_MAX && processor.is_sleeping()) {
+            mResult.sleep = i + BLOCK_SIZE;
+        }
+        if (i == second_impulse) {
+            mResult.awake = !processor.is_sleeping();
+        }
+    }
+    return mResult;
+}
+
+static float max_difference(const std::vector<float>& a, const std::vector<float>& b) {
+    float mMax = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        mMax = std::max(mMax, std::fabs(a[i] - b[i]));
+    }
+    return mMax;
+}
+
+/*
+ * runs the processor returned by `create` with and without silence detection. the hold of each processor is at most
+ * its tail length, so it must be asleep one tail length after its output decayed, i.e after twice the tail length.
+ */
+template <typename CREATE, typename PROCESS>
+static void test_processor(const char* name, CREATE create, PROCESS process, const bool hold_is_tail, const uint32_t burst = 1) {
+    auto           mProcessor  = create();
+    const uint32_t mTail       = mProcessor->get_tail_length();
+    const uint32_t mLength     = (2 * mTail / BLOCK_SIZE + 4) * BLOCK_SIZE;
+    const auto     mInput      = impulses(mLength, burst);
+    const Result   mDetected   = run(*mProcessor, process, mInput, mLength + BLOCK_SIZE);
+    auto           mReference  = create();
+    mReference->set_silence_threshold(0.0f);
+    const Result mDisabled = run(*mReference, process, mInput, mLength + BLOCK_SIZE);
+    delete mProcessor;
+    delete mReference;
+
+    check(mTail > 0 && mTail < UINT32_MAX, "tail length is not finite", name);
+    uint32_t mDecayed = 0;
+    for (uint32_t i = 0; i < mLength; i++) {
+        if (std::fabs(mDisabled.output[i]) >= THRESHOLD) {
+            mDecayed = i + 1;
+        }
+    }
+    check(mDecayed > 0 && mDetected.sleep > mDecayed, "processor falls asleep before its output decayed", name);
+    check(!hold_is_tail || mDetected.sleep >= mTail, "processor falls asleep before its tail length", name);
+    check(mDetected.sleep <= mLength, "processor does not fall asleep after its tail decayed", name);
+    check(mDetected.awake, "processor does not wake up on new input", name);
+    check(mDisabled.sleep == UINT32_MAX, "processor falls asleep with silence detection disabled", name);
+    check(max_difference(mDetected.output, mDisabled.output) <= THRESHOLD,
+          "output differs from the output with silence detection disabled",
+          name);
+}
+
+static void test_silence_detector() {
+    const char*     mName = "SilenceDetector";
+    SilenceDetector mDetector(THRESHOLD, 100);
+    float           mSilent[32]{};
+    float           mLoud[32]{};
+    mLoud[16] = 0.5f;
+
+    /* falls asleep once input and output were silent for at least the hold */
+    uint32_t mSleeps = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        check(!mDetector.skip(mSilent, 32), "detector sleeps before the hold", mName);
+        mSleeps += mDetector.update(mSilent, 32) ? 1 : 0;
+    }
+    check(mSleeps == 1 && mDetector.is_sleeping(), "detector does not fall asleep after the hold", mName);
+    check(mDetector.skip(mSilent, 32), "sleeping detector does not skip silent input", mName);
+
+    /* input above the threshold wakes it up, output above the threshold restarts the hold */
+    check(!mDetector.skip(mLoud, 32) && !mDetector.is_sleeping(), "detector does not wake up on input", mName);
+    mDetector.update(mLoud, 32);
+    check(!mDetector.skip(mSilent, 32) && !mDetector.update(mLoud, 32), "detector ignores loud output", mName);
+    for (uint8_t i = 0; i < 3; i++) {
+        mDetector.skip(mSilent, 32);
+        check(!mDetector.update(mSilent, 32), "hold does not restart after loud output", mName);
+    }
+
+    /* a threshold of 0 disables the detection */
+    mDetector.set_threshold(0.0f);
+    for (uint8_t i = 0; i < 8; i++) {
+        mDetector.skip(mSilent, 32);
+        check(!mDetector.update(mSilent, 32), "detector falls asleep with threshold 0", mName);
+    }
+
+    check(SilenceDetector::decay_length(1, 0.5f, THRESHOLD) == 20, "decay length of a one pole is wrong", mName);
+    check(SilenceDetector::decay_length(100, 0.5f, THRESHOLD) == 2000, "decay length of a delay line is wrong", mName);
+    check(SilenceDetector::decay_length(1, 1.0f, THRESHOLD) == UINT32_MAX, "decay length without decay is finite", mName);
+}
+
+int main() {
+    test_silence_detector();
+
+    test_processor(
+        "Reverb",
+        [] { return new Reverb(SAMPLE_RATE); },
+        [](Reverb& reverb, float* buffer, const uint32_t length) {
+            AudioBuffer mBuffer(buffer, length);
+            reverb.process(mBuffer);
+        },
+        false);
+    test_processor(
+        "Delay",
+        [] { return new Delay(0.05f, 0.75f, 0.8f, SAMPLE_RATE); },
+        [](Delay& delay, float* buffer, const uint32_t length) { delay.process(buffer, length); },
+        false);
+    test_processor(
+        "Filter",
+        [] { return new Filter(Filter::LPF, 0.0f, 200.0f, 1.0f, true, SAMPLE_RATE); },
+        [](Filter& filter, float* buffer, const uint32_t length) { filter.process(buffer, length); },
+        true);
+    test_processor(
+        "FilterLowPassMoogLadder",
+        [] { return new FilterLowPassMoogLadder(SAMPLE_RATE); },
+        [](FilterLowPassMoogLadder& filter, float* buffer, const uint32_t length) { filter.process(buffer, length); },
+        true);
+    test_processor(
+        "FilterLowPassMoogLadder at 40 Hz",
+        [] {
+            FilterLowPassMoogLadder* mFilter = new FilterLowPassMoogLadder(SAMPLE_RATE);
+            mFilter->set_frequency(40.0f);
+            return mFilter;
+        },
+        [](FilterLowPassMoogLadder& filter, float* buffer, const uint32_t length) { filter.process(buffer, length); },
+        true,
+        16);
+    test_processor(
+        "Vocoder",
+        [] { return new Vocoder(24, 4, SAMPLE_RATE); },
+        [](Vocoder& vocoder, float* buffer, const uint32_t length) {
+            /* a constant carrier, only the modulator stops */
+            float mCarrier[BLOCK_SIZE];
+            for (uint32_t i = 0; i < length; i++) {
+                mCarrier[i] = (i & 8) ? 0.5f : -0.5f;
+            }
+            vocoder.process(mCarrier, buffer, buffer, length);
+        },
+        true);
+
+    if (fFailures > 0) {
+        printf("%u check(s) failed\n", fFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
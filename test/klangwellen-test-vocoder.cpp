@@ -0,0 +1,285 @@
+/*
+ * test for `Vocoder`.
+ *
+ * compares the vocoder with a reference implementation of the scalar band loop of voclib it was derived from ( one
+ * biquad chain and envelope follower per band, processed band after band ). checks for several band and filter
+ * counts, with silence detection disabled, that
+ *
+ * - `process` with the scalar kernel produces the same output as the reference, mono and stereo
+ * - `process` with the vectorized kernels differs from the reference only by rounding
+ * - `analyze` followed by `synthesize` produces the same output as `process` with each supported kernel, also with a
+ *   formant shift and with several carriers sharing one analysis
+ *
+ * the exit code is 1 if a check fails.
+ *
+ *     $ ./klangwellen_test_vocoder
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmath>
+#include <vector>
+
+#include "BufferKernels.h"
+#include "KlangWellen.h"
+#include "Vocoder.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t NUM_SAMPLES = 8192;
+static constexpr uint32_t BLOCK_SIZE  = 512;
+static constexpr float    TOLERANCE   = 1e-5f;
+
+static const char* ISA_NAMES[] = {"scalar", "sse2", "avx2", "avx512"};
+
+static uint32_t fFailures = 0;
+
+static void check(const bool condition, const char* message, const char* context) {
+    if (!condition) {
+        printf("FAILED: %s ( %s )\n", message, context);
+        fFailures++;
+    }
+}
+
+/* the mono band loop of voclib with the default reaction time, volume and formant shift of `Vocoder` */
+class ReferenceVocoder {
+public:
+    ReferenceVocoder(const uint8_t bands, const uint8_t filters_per_band) : fBands(bands), fFiltersPerBand(filters_per_band) {
+        const float mSampleRate = SAMPLE_RATE;
+        const float mMinimum    = 80.0f;
+        const float mMaximum    = mSampleRate > 12000.0f ? 12000.0f : mSampleRate;
+        const float mStep       = KlangWellen::pow(mMaximum / mMinimum, 1.0 / bands);
+        float       mFrequency  = 0.0f;
+        for (uint8_t i = 0; i < bands; i++) {
+            const float mPrevious = mFrequency;
+            mFrequency            = mFrequency > 0.0f ? mFrequency * mStep : mMinimum;
+            const float mNext     = mFrequency * mStep;
+            design(fCoefficients[i], mFrequency, mSampleRate, (mNext - mPrevious) / mFrequency);
+        }
+        fEnvelopeCoefficient = static_cast<float>(KlangWellen::pow(0.01, 1.0 / (0.03f * mSampleRate)));
+    }
+
+    float process(const float carrier, const float modulator) {
+        float mOutput = 0.0f;
+        for (uint8_t j = 0; j < fBands; j++) {
+            float mAnalysis  = modulator;
+            float mSynthesis = carrier;
+            for (uint8_t k = 0; k < fFiltersPerBand; k++) {
+                mAnalysis  = biquad(fCoefficients[j], fAnalysis[j][k], mAnalysis);
+                mSynthesis = biquad(fCoefficients[j], fSynthesis[j][k], mSynthesis);
+            }
+            mOutput += mSynthesis * envelope(fEnvelope[j], mAnalysis);
+        }
+        return mOutput * 1.0f;
+    }
+
+private:
+    static constexpr float VOCLIB_M_LN2 = 0.69314718055994530942;
+    static constexpr float VOCLIB_M_PI  = 3.14159265358979323846;
+
+    const uint8_t fBands;
+    const uint8_t fFiltersPerBand;
+    float         fCoefficients[96][5]{};
+    float         fAnalysis[96][8][4]{};
+    float         fSynthesis[96][8][4]{};
+    float         fEnvelope[96][4]{};
+    float         fEnvelopeCoefficient;
+
+    /* band pass `{ b0, b1, b2, a1, a2 } / a0` */
+    static void design(float* coefficients, const float frequency, const float sample_rate, const float bandwidth) {
+        const float omega = 2.0 * VOCLIB_M_PI * frequency / sample_rate;
+        const float sn    = KlangWellen::fast_sin(omega);
+        const float cs    = KlangWellen::fast_cos(omega);
+        const float alpha = sn * KlangWellen::fast_sinh(VOCLIB_M_LN2 / 2 * bandwidth * omega / sn);
+        const float a0    = 1 + alpha;
+        coefficients[0]   = alpha / a0;
+        coefficients[1]   = 0 / a0;
+        coefficients[2]   = -alpha / a0;
+        coefficients[3]   = (-2 * cs) / a0;
+        coefficients[4]   = (1 - alpha) / a0;
+    }
+
+    /* state is `{ x1, x2, y1, y2 }` */
+    static float biquad(const float* coefficients, float* state, const float sample) {
+        const float r0     = coefficients[0] * sample;
+        const float r1     = coefficients[1] * state[0];
+        const float r2     = coefficients[2] * state[1];
+        const float r3     = coefficients[3] * state[2];
+        const float r4     = coefficients[4] * state[3];
+        const float r5     = r0 + r1;
+        const float r6     = r2 - r3 - r4;
+        const float result = r5 + r6;
+        state[1]           = state[0];
+        state[0]           = sample;
+        state[3]           = state[2];
+        state[2]           = result;
+        return result;
+    }
+
+    float envelope(float* history, const float sample) const {
+        /* each stage follows the previous stage of the last sample */
+        const float c = fEnvelopeCoefficient;
+        history[3]    = (1.0f - c) * history[2] + c * history[3];
+        history[2]    = (1.0f - c) * history[1] + c * history[2];
+        history[1]    = (1.0f - c) * history[0] + c * history[1];
+        history[0]    = (1.0f - c) * std::fabs(sample) + c * history[0];
+        return history[3];
+    }
+};
+
+static uint32_t fRandom = 1;
+
+static float noise() {
+    fRandom = fRandom * 1664525u + 1013904223u;
+    return static_cast<float>(fRandom >> 8) / 8388608.0f - 1.0f;
+}
+
+static Vocoder* create_vocoder(const uint8_t bands, const uint8_t filters_per_band, const float formant_shift = 1.0f) {
+    Vocoder* mVocoder = new Vocoder(bands, filters_per_band, SAMPLE_RATE);
+    mVocoder->set_silence_threshold(0.0f);
+    if (formant_shift != 1.0f) {
+        mVocoder->set_formant_shift(formant_shift);
+    }
+    return mVocoder;
+}
+
+static bool identical(const std::vector<float>& a, const std::vector<float>& b) {
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static float max_difference(const std::vector<float>& a, const std::vector<float>& b) {
+    float mMax = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        mMax = std::max(mMax, std::fabs(a[i] - b[i]));
+    }
+    return mMax;
+}
+
+struct Signals {
+    std::vector<float> carrier_left;
+    std::vector<float> carrier_right;
+    std::vector<float> modulator;
+};
+
+static void test_process(const Signals& signals, const uint8_t bands, const uint8_t filters_per_band, const char* context) {
+    /* the envelopes of the reference run twice, the analysis of both channels is the same */
+    ReferenceVocoder*  mReferenceLeft  = new ReferenceVocoder(bands, filters_per_band);
+    ReferenceVocoder*  mReferenceRight = new ReferenceVocoder(bands, filters_per_band);
+    std::vector<float> mExpectedLeft(NUM_SAMPLES);
+    std::vector<float> mExpectedRight(NUM_SAMPLES);
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        mExpectedLeft[i]  = mReferenceLeft->process(signals.carrier_left[i], signals.modulator[i]);
+        mExpectedRight[i] = mReferenceRight->process(signals.carrier_right[i], signals.modulator[i]);
+    }
+    delete mReferenceLeft;
+    delete mReferenceRight;
+
+    Vocoder*           mMono = create_vocoder(bands, filters_per_band);
+    std::vector<float> mOutput(NUM_SAMPLES);
+    std::vector<float> mCarrier   = signals.carrier_left;
+    std::vector<float> mModulator = signals.modulator;
+    for (uint32_t i = 0; i < NUM_SAMPLES; i += BLOCK_SIZE) {
+        mMono->process(mCarrier.data() + i, mModulator.data() + i, mOutput.data() + i, BLOCK_SIZE);
+    }
+    delete mMono;
+
+    Vocoder*           mStereo = create_vocoder(bands, filters_per_band);
+    std::vector<float> mOutputLeft(NUM_SAMPLES);
+    std::vector<float> mOutputRight(NUM_SAMPLES);
+    std::vector<float> mCarrierRight = signals.carrier_right;
+    for (uint32_t i = 0; i < NUM_SAMPLES; i += BLOCK_SIZE) {
+        mStereo->process(mCarrier.data() + i,
+                         mCarrierRight.data() + i,
+                         mModulator.data() + i,
+                         mOutputLeft.data() + i,
+                         mOutputRight.data() + i,
+                         BLOCK_SIZE);
+    }
+    delete mStereo;
+
+    if (BufferKernels::get_isa() == BufferKernels::ISA_SCALAR) {
+        check(identical(mOutput, mExpectedLeft), "mono output differs from the reference", context);
+        check(identical(mOutputLeft, mExpectedLeft) && identical(mOutputRight, mExpectedRight),
+              "stereo output differs from the reference",
+              context);
+    } else {
+        check(max_difference(mOutput, mExpectedLeft) < TOLERANCE, "mono output differs from the reference by more than rounding", context);
+        check(max_difference(mOutputLeft, mExpectedLeft) < TOLERANCE && max_difference(mOutputRight, mExpectedRight) < TOLERANCE,
+              "stereo output differs from the reference by more than rounding",
+              context);
+    }
+}
+
+/* one analyzing vocoder drives two carriers, each compared with a vocoder that runs `process` on the same carrier */
+static void test_analyze_synthesize(const Signals& signals, const uint8_t bands, const uint8_t filters_per_band, const char* context) {
+    const float        FORMANT_SHIFTS[] = {1.0f, 1.5f};
+    Vocoder*           mAnalysis        = create_vocoder(bands, filters_per_band);
+    Vocoder*           mSynthesis[2];
+    Vocoder*           mProcess[2];
+    std::vector<float> mSplit[2];
+    std::vector<float> mExpected[2];
+    for (uint8_t c = 0; c < 2; c++) {
+        mSynthesis[c] = create_vocoder(bands, filters_per_band, FORMANT_SHIFTS[c]);
+        mProcess[c]   = create_vocoder(bands, filters_per_band, FORMANT_SHIFTS[c]);
+        mSplit[c].resize(NUM_SAMPLES);
+        mExpected[c].resize(NUM_SAMPLES);
+    }
+    std::vector<float> mEnvelopes(mAnalysis->get_envelope_buffer_size(BLOCK_SIZE));
+    std::vector<float> mModulator = signals.modulator;
+    std::vector<float> mCarrier   = signals.carrier_left;
+    for (uint32_t i = 0; i < NUM_SAMPLES; i += BLOCK_SIZE) {
+        mAnalysis->analyze(mModulator.data() + i, mEnvelopes.data(), BLOCK_SIZE);
+        for (uint8_t c = 0; c < 2; c++) {
+            mSynthesis[c]->synthesize(mEnvelopes.data(), mCarrier.data() + i, mSplit[c].data() + i, BLOCK_SIZE);
+            mProcess[c]->process(mCarrier.data() + i, mModulator.data() + i, mExpected[c].data() + i, BLOCK_SIZE);
+        }
+    }
+    for (uint8_t c = 0; c < 2; c++) {
+        check(identical(mSplit[c], mExpected[c]), "`analyze` and `synthesize` differ from `process`", context);
+        delete mSynthesis[c];
+        delete mProcess[c];
+    }
+    delete mAnalysis;
+}
+
+int main() {
+    Signals mSignals;
+    mSignals.carrier_left.resize(NUM_SAMPLES);
+    mSignals.carrier_right.resize(NUM_SAMPLES);
+    mSignals.modulator.resize(NUM_SAMPLES);
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        /* a saw wave carrier and a modulator of noise bursts */
+        mSignals.carrier_left[i]  = 2.0f * static_cast<float>(i % 109) / 109.0f - 1.0f;
+        mSignals.carrier_right[i] = 2.0f * static_cast<float>(i % 73) / 73.0f - 1.0f;
+        mSignals.modulator[i]     = (i / 1024) % 2 == 0 ? noise() : 0.1f * noise();
+    }
+
+    const uint8_t BANDS[][2] = {{24, 4}, {13, 6}, {40, 1}, {96, 8}};
+    const uint8_t mISA       = BufferKernels::get_isa();
+    for (uint8_t mInstructionSet = BufferKernels::ISA_SCALAR; mInstructionSet <= BufferKernels::ISA_AVX512; mInstructionSet++) {
+        if (!BufferKernels::set_isa(mInstructionSet)) {
+            continue;
+        }
+        for (const auto& mBands : BANDS) {
+            char mContext[64];
+            snprintf(mContext, sizeof(mContext), "isa: %s, bands: %u, filters: %u", ISA_NAMES[mInstructionSet], mBands[0], mBands[1]);
+            test_process(mSignals, mBands[0], mBands[1], mContext);
+            test_analyze_synthesize(mSignals, mBands[0], mBands[1], mContext);
+        }
+    }
+    BufferKernels::set_isa(mISA);
+
+    if (fFailures > 0) {
+        printf("%u check(s) failed\n", fFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
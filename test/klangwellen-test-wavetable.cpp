@@ -0,0 +1,149 @@
+/*
+ * test for the modulation inputs of `Wavetable`.
+ *
+ * checks for each interpolation type, with and without the phase accumulator, that
+ *
+ * - a phase modulation buffer changes the output
+ * - phase offsets are applied with their fractional part ( no staircase )
+ * - a constant phase modulation buffer produces the same output as `set_phase_offset`
+ * - the vectorized paths produce the same output as the scalar paths
+ *
+ * the exit code is 1 if a check fails.
+ *
+ *     $ ./klangwellen_test_wavetable
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cmath>
+#include <vector>
+
+#include "Wavetable.h"
+
+using namespace klangwellen;
+
+static constexpr uint32_t WAVETABLE_SIZE = 1024;
+static constexpr uint32_t SAMPLE_RATE    = 48000;
+static constexpr uint32_t NUM_SAMPLES    = 1000;
+
+static const char* INTERPOLATION_NAMES[] = {"none", "linear", "cubic"};
+
+static uint32_t fFailures = 0;
+
+static void check(const bool condition, const char* message, const uint8_t interpolation, const bool phase_accumulator) {
+    if (!condition) {
+        printf("FAILED: %s ( interpolation: %s, phase accumulator: %s )\n",
+               message,
+               INTERPOLATION_NAMES[interpolation],
+               phase_accumulator ? "on" : "off");
+        fFailures++;
+    }
+}
+
+static Wavetable* create_wavetable(const uint8_t interpolation, const bool phase_accumulator, const float frequency) {
+    Wavetable* mWavetable = new Wavetable(WAVETABLE_SIZE, SAMPLE_RATE);
+    Wavetable::fill(mWavetable->get_wavetable(), WAVETABLE_SIZE, KlangWellen::WAVEFORM_SINE);
+    mWavetable->set_interpolation(interpolation);
+    mWavetable->set_phase_accumulator(phase_accumulator);
+    mWavetable->set_frequency(frequency);
+    mWavetable->set_amplitude(1.0f);
+    return mWavetable;
+}
+
+static float max_difference(const std::vector<float>& a, const std::vector<float>& b) {
+    float mMax = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        mMax = std::max(mMax, std::fabs(a[i] - b[i]));
+    }
+    return mMax;
+}
+
+static void test_modulation_changes_output(const uint8_t interpolation, const bool phase_accumulator) {
+    std::vector<float> mPhaseOffset(NUM_SAMPLES);
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        mPhaseOffset[i] = 0.25f * std::sin(static_cast<float>(i) * 0.05f);
+    }
+    Wavetable*         mModulated   = create_wavetable(interpolation, phase_accumulator, 440.0f);
+    Wavetable*         mUnmodulated = create_wavetable(interpolation, phase_accumulator, 440.0f);
+    std::vector<float> a(NUM_SAMPLES);
+    std::vector<float> b(NUM_SAMPLES);
+    mModulated->process(a.data(), nullptr, mPhaseOffset.data(), nullptr, NUM_SAMPLES);
+    mUnmodulated->process(b.data(), NUM_SAMPLES);
+    check(max_difference(a, b) > 0.5f, "phase modulation does not change the output", interpolation, phase_accumulator);
+    delete mModulated;
+    delete mUnmodulated;
+}
+
+static void test_fractional_offset(const uint8_t interpolation, const bool phase_accumulator) {
+    if (interpolation != KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR) {
+        return;
+    }
+    /* at frequency 0 the oscillator stays at position 0, an offset of half a sample reads between sample 0 and 1 */
+    Wavetable*         mWavetable = create_wavetable(interpolation, phase_accumulator, 0.0f);
+    std::vector<float> mPhaseOffset(NUM_SAMPLES, 0.5f / WAVETABLE_SIZE);
+    std::vector<float> mOutput(NUM_SAMPLES);
+    mWavetable->process(mOutput.data(), nullptr, mPhaseOffset.data(), nullptr, NUM_SAMPLES);
+    const float* mTable    = mWavetable->get_wavetable();
+    const float  mExpected = 0.5f * (mTable[0] + mTable[1]);
+    check(std::fabs(mOutput[NUM_SAMPLES - 1] - mExpected) < 1e-6f, "fractional phase offset is not interpolated", interpolation, phase_accumulator);
+    delete mWavetable;
+}
+
+static void test_constant_modulation(const uint8_t interpolation, const bool phase_accumulator) {
+    const float        mOffset     = 0.0371f;
+    Wavetable*         mModulated  = create_wavetable(interpolation, phase_accumulator, 440.0f);
+    Wavetable*         mWithOffset = create_wavetable(interpolation, phase_accumulator, 440.0f);
+    std::vector<float> mPhaseOffset(NUM_SAMPLES, mOffset);
+    std::vector<float> a(NUM_SAMPLES);
+    std::vector<float> b(NUM_SAMPLES);
+    mModulated->process(a.data(), nullptr, mPhaseOffset.data(), nullptr, NUM_SAMPLES);
+    mWithOffset->set_phase_offset(mOffset);
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        b[i] = mWithOffset->process();
+    }
+    check(max_difference(a, b) < 1e-5f, "constant phase modulation differs from `set_phase_offset`", interpolation, phase_accumulator);
+    delete mModulated;
+    delete mWithOffset;
+}
+
+static void test_scalar_and_vectorized(const uint8_t interpolation, const bool phase_accumulator) {
+    std::vector<float> mFrequency(NUM_SAMPLES);
+    std::vector<float> mPhaseOffset(NUM_SAMPLES);
+    for (uint32_t i = 0; i < NUM_SAMPLES; i++) {
+        mFrequency[i]   = 440.0f + 220.0f * std::sin(static_cast<float>(i) * 0.01f);
+        mPhaseOffset[i] = 0.25f * std::sin(static_cast<float>(i) * 0.05f) - 0.5f;
+    }
+    const uint8_t      mISA = BufferKernels::get_isa();
+    std::vector<float> a(NUM_SAMPLES);
+    std::vector<float> b(NUM_SAMPLES);
+    BufferKernels::set_isa(BufferKernels::ISA_SCALAR);
+    Wavetable* mScalar = create_wavetable(interpolation, phase_accumulator, 440.0f);
+    mScalar->process(a.data(), mFrequency.data(), mPhaseOffset.data(), nullptr, NUM_SAMPLES);
+    BufferKernels::set_isa(mISA);
+    Wavetable* mVectorized = create_wavetable(interpolation, phase_accumulator, 440.0f);
+    mVectorized->process(b.data(), mFrequency.data(), mPhaseOffset.data(), nullptr, NUM_SAMPLES);
+    check(max_difference(a, b) < 1e-5f, "vectorized output differs from scalar output", interpolation, phase_accumulator);
+    delete mScalar;
+    delete mVectorized;
+}
+
+int main() {
+    const uint8_t INTERPOLATIONS[] = {KlangWellen::WAVESHAPE_INTERPOLATE_NONE,
+                                      KlangWellen::WAVESHAPE_INTERPOLATE_LINEAR,
+                                      KlangWellen::WAVESHAPE_INTERPOLATE_CUBIC};
+    for (const uint8_t mInterpolation : INTERPOLATIONS) {
+        for (const bool mPhaseAccumulator : {false, true}) {
+            test_modulation_changes_output(mInterpolation, mPhaseAccumulator);
+            test_fractional_offset(mInterpolation, mPhaseAccumulator);
+            test_constant_modulation(mInterpolation, mPhaseAccumulator);
+            test_scalar_and_vectorized(mInterpolation, mPhaseAccumulator);
+        }
+    }
+    if (fFailures > 0) {
+        printf("%u check(s) failed\n", fFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}